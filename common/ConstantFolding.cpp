@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ConstantFolding"
+
+#include "ConstantFolding.h"
+
+#include <android-base/logging.h>
+#include <nnapi/TypeUtils.h>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "CpuExecutor.h"
+#include "ModelUtils.h"
+#include "Tracing.h"
+
+namespace android::nn {
+namespace {
+
+bool isConstantInput(const Operand& operand) {
+    return operand.lifetime == Operand::LifeTime::CONSTANT_COPY ||
+           operand.lifetime == Operand::LifeTime::CONSTANT_REFERENCE ||
+           operand.lifetime == Operand::LifeTime::POINTER ||
+           operand.lifetime == Operand::LifeTime::NO_VALUE;
+}
+
+// Control flow operations may not terminate, and the others may not be deterministic or may not be
+// supported by CpuExecutor.
+bool canFold(OperationType type) {
+    switch (type) {
+        case OperationType::IF:
+        case OperationType::WHILE:
+        case OperationType::OEM_OPERATION:
+        case OperationType::RANDOM_MULTINOMIAL:
+            return false;
+        default:
+            return !isExtension(type);
+    }
+}
+
+// A folded output must be a temporary whose size is known before evaluation and fits a
+// DataLocation.
+bool canFoldOutput(const Operand& operand) {
+    if (operand.lifetime != Operand::LifeTime::TEMPORARY_VARIABLE || isExtension(operand.type)) {
+        return false;
+    }
+    const size_t size = getNonExtensionSize(operand).value_or(0);
+    return size > 0 && size <= std::numeric_limits<uint32_t>::max();
+}
+
+// Runs the operations of the main subgraph selected by isFolded, and returns the values they
+// produce for the operands at outputIndexes, or std::nullopt if they cannot be evaluated.
+std::optional<std::vector<std::vector<uint8_t>>> evaluateOperations(
+        Model* model, const std::vector<bool>& isFolded,
+        const std::vector<uint32_t>& outputIndexes) {
+    std::vector<RunTimePoolInfo> poolInfos;
+    if (!setRunTimePoolInfosFromCanonicalMemories(&poolInfos, model->pools)) {
+        LOG(WARNING) << "foldConstantOperations -- could not map the model pools";
+        return std::nullopt;
+    }
+
+    // The folded operations are run as a main subgraph without inputs whose outputs are the
+    // folded operands used by the remaining operations.
+    Model::Subgraph subgraph = {
+            .operands = model->main.operands,
+            .operations = {},
+            .inputIndexes = {},
+            .outputIndexes = outputIndexes,
+    };
+    for (size_t i = 0; i < model->main.operations.size(); ++i) {
+        if (isFolded[i]) {
+            subgraph.operations.push_back(model->main.operations[i]);
+        }
+    }
+    std::vector<std::vector<uint8_t>> values;
+    values.reserve(outputIndexes.size());
+    Request request;
+    for (uint32_t index : outputIndexes) {
+        Operand& operand = subgraph.operands[index];
+        operand.lifetime = Operand::LifeTime::SUBGRAPH_OUTPUT;
+        std::vector<uint8_t>& value = values.emplace_back(getNonExtensionSize(operand).value());
+        request.outputs.push_back({
+                .lifetime = Request::Argument::LifeTime::POINTER,
+                .location = {.pointer = static_cast<void*>(value.data()),
+                             .length = static_cast<uint32_t>(value.size())},
+                .dimensions = {},
+        });
+    }
+
+    std::swap(model->main, subgraph);
+    CpuExecutor executor;
+    const int result = executor.run(*model, request, poolInfos, {});
+    std::swap(model->main, subgraph);
+    if (result != ANEURALNETWORKS_NO_ERROR) {
+        LOG(WARNING) << "foldConstantOperations -- could not evaluate the constant operations: "
+                     << result;
+        return std::nullopt;
+    }
+    return values;
+}
+
+// Folds the constant operations of the main subgraph, and returns the number of operations folded.
+uint32_t foldOperations(Model* model) {
+    const Model::Subgraph& main = model->main;
+
+    // The operations are sorted in execution order, so one pass finds all constant operations.
+    std::vector<bool> isFoldedOperand(main.operands.size(), false);
+    std::vector<bool> isFoldedOperation(main.operations.size(), false);
+    for (size_t i = 0; i < main.operations.size(); ++i) {
+        const Operation& operation = main.operations[i];
+        const bool hasConstantInputs = std::all_of(
+                operation.inputs.begin(), operation.inputs.end(), [&](uint32_t index) {
+                    return isConstantInput(main.operands[index]) || isFoldedOperand[index];
+                });
+        const bool hasFoldableOutputs = std::all_of(
+                operation.outputs.begin(), operation.outputs.end(),
+                [&main](uint32_t index) { return canFoldOutput(main.operands[index]); });
+        if (canFold(operation.type) && hasConstantInputs && hasFoldableOutputs) {
+            isFoldedOperation[i] = true;
+            for (uint32_t index : operation.outputs) {
+                isFoldedOperand[index] = true;
+            }
+        }
+    }
+
+    // Only the folded operands read by the remaining operations need to be evaluated. Folded
+    // operations that do not contribute to them are dead and removed later.
+    std::vector<uint32_t> foldedIndexes;
+    std::vector<bool> isFoldedOutput(main.operands.size(), false);
+    for (size_t i = 0; i < main.operations.size(); ++i) {
+        if (isFoldedOperation[i]) {
+            continue;
+        }
+        for (uint32_t index : main.operations[i].inputs) {
+            if (isFoldedOperand[index] && !isFoldedOutput[index]) {
+                isFoldedOutput[index] = true;
+                foldedIndexes.push_back(index);
+            }
+        }
+    }
+    if (foldedIndexes.empty()) {
+        return 0;
+    }
+
+    auto values = evaluateOperations(model, isFoldedOperation, foldedIndexes);
+    if (!values.has_value()) {
+        return 0;
+    }
+    for (size_t i = 0; i < foldedIndexes.size(); ++i) {
+        Operand& operand = model->main.operands[foldedIndexes[i]];
+        const std::vector<uint8_t>& value = (*values)[i];
+        operand.lifetime = Operand::LifeTime::CONSTANT_COPY;
+        operand.location = model->operandValues.append(value.data(), value.size());
+    }
+
+    std::vector<Operation> operations;
+    for (size_t i = 0; i < model->main.operations.size(); ++i) {
+        if (!isFoldedOperation[i]) {
+            operations.push_back(std::move(model->main.operations[i]));
+        }
+    }
+    const uint32_t operationsFolded =
+            static_cast<uint32_t>(model->main.operations.size() - operations.size());
+    model->main.operations = std::move(operations);
+    return operationsFolded;
+}
+
+}  // namespace
+
+uint32_t foldConstantOperations(Model* model) {
+    CHECK(model != nullptr);
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "foldConstantOperations");
+
+    const uint32_t operationsFolded = foldOperations(model);
+    const uint32_t operationsRemoved = operationsFolded + removeDeadOperations(model);
+    if (operationsRemoved > 0) {
+        removeDeadOperands(model);
+    }
+    VLOG(CPUEXE) << "foldConstantOperations folded " << operationsFolded << " and removed "
+                 << operationsRemoved - operationsFolded << " dead operations";
+    return operationsRemoved;
+}
+
+}  // namespace android::nn
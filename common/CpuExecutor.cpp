@@ -22,12 +22,18 @@
 #include <nnapi/SharedMemory.h>
 #include <nnapi/TypeUtils.h>
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "ControlFlow.h"
+#include "CpuFusionPlan.h"
+#include "CpuKernelTable.h"
+#include "CpuPackedWeights.h"
+#include "CpuStaticShapes.h"
 #include "NeuralNetworks.h"
 #include "OperationResolver.h"
 #include "Operations.h"
@@ -62,12 +68,58 @@ namespace android {
 namespace nn {
 namespace {
 
+// The profile of the operation being run on this thread, if it is being profiled, so that the
+// buffers allocated by setInfoAndAllocateIfNeeded are attributed to it.
+thread_local CpuOperationProfile* tProfiledOperation = nullptr;
+
+void recordAllocation(uint32_t length) {
+    if (tProfiledOperation != nullptr) {
+        ++tProfiledOperation->allocations;
+        tProfiledOperation->bytesAllocated += length;
+    }
+}
+
+// Returns the total size of the data of the operands.
+uint64_t getOperandBytes(const std::vector<uint32_t>& indexes, const RunTimeOperandInfo* operands) {
+    uint64_t bytes = 0;
+    for (uint32_t index : indexes) {
+        const RunTimeOperandInfo& info = operands[index];
+        if (info.lifetime == Operand::LifeTime::NO_VALUE ||
+            info.lifetime == Operand::LifeTime::SUBGRAPH) {
+            continue;
+        }
+        bytes += isExtension(info.type)
+                         ? info.length
+                         : getNonExtensionSize(info.type, info.dimensions).value_or(info.length);
+    }
+    return bytes;
+}
+
+// Returns the inputs of the operations that are not outputs of an earlier one of them.
+std::vector<uint32_t> getExternalInputs(const Operation* operations, uint32_t operationCount) {
+    std::vector<uint32_t> inputs;
+    for (uint32_t i = 0; i < operationCount; ++i) {
+        for (uint32_t input : operations[i].inputs) {
+            const bool isProduced =
+                    std::any_of(operations, operations + i, [input](const Operation& operation) {
+                        const auto& outputs = operation.outputs;
+                        return std::find(outputs.begin(), outputs.end(), input) != outputs.end();
+                    });
+            if (!isProduced) {
+                inputs.push_back(input);
+            }
+        }
+    }
+    return inputs;
+}
+
 class OperationExecutionContext : public IOperationExecutionContext {
     DISALLOW_IMPLICIT_CONSTRUCTORS(OperationExecutionContext);
 
    public:
-    OperationExecutionContext(const Operation* operation, RunTimeOperandInfo* operands)
-        : operation(operation), operands(operands) {}
+    OperationExecutionContext(const Operation* operation, RunTimeOperandInfo* operands,
+                              const CpuPackedWeights* packedWeights)
+        : operation(operation), operands(operands), packedWeights(packedWeights) {}
 
     uint32_t getNumInputs() const override;
     OperandType getInputType(uint32_t index) const override;
@@ -88,6 +140,8 @@ class OperationExecutionContext : public IOperationExecutionContext {
     bool isOmittedInput(uint32_t index) const override;
     bool isOmittedOutput(uint32_t index) const override;
 
+    const void* getPackedInputBuffer(uint32_t index, PackedLayout layout) const override;
+
     // Return false if any of inputs or outputs is omitted, i.e. has lifetime of NO_VALUE.
     bool checkNoOmittedOperand() const;
     // Return false if any of inputs has dimension 0.
@@ -100,6 +154,7 @@ class OperationExecutionContext : public IOperationExecutionContext {
 
     const Operation* operation;
     RunTimeOperandInfo* operands;
+    const CpuPackedWeights* packedWeights;
 
     int result = ANEURALNETWORKS_NO_ERROR;
 };
@@ -228,8 +283,21 @@ bool setInfoAndAllocateIfNeeded(RunTimeOperandInfo* info, const Shape& shape, in
                 return false;
             }
             info->length = length;
+            recordAllocation(length);
         }
     }
+    // Grow a resizable buffer instead of failing. The capacity is at least doubled so that an
+    // output growing on every loop iteration is reallocated only a logarithmic number of times.
+    if (info->isResizableBuffer && !isExtension(info->type) && !info->isSufficient()) {
+        const uint32_t required = nonExtensionOperandSizeOfData(info->type, info->dimensions);
+        const uint64_t doubled = static_cast<uint64_t>(info->length) * 2;
+        const uint32_t capacity = std::max<uint64_t>(
+                required, std::min<uint64_t>(doubled, std::numeric_limits<uint32_t>::max()));
+        delete[] info->buffer;
+        info->buffer = new uint8_t[capacity];
+        info->length = capacity;
+        recordAllocation(capacity);
+    }
     if (!info->isSufficient()) {
         uint32_t length = nonExtensionOperandSizeOfData(info->type, info->dimensions);
         LOG(ERROR) << "Insufficient size for model operand: require = " << length
@@ -241,6 +309,31 @@ bool setInfoAndAllocateIfNeeded(RunTimeOperandInfo* info, const Shape& shape, in
     return true;
 }
 
+// Allocates the outputs of an operation whose output shapes were inferred when the model was
+// prepared, and are therefore already in the runtime info. See CpuStaticShapes.
+bool allocateStaticOutputs(const Operation& operation, RunTimeOperandInfo* operands, int* result) {
+    for (uint32_t index : operation.outputs) {
+        RunTimeOperandInfo* info = &operands[index];
+        if (info->lifetime == Operand::LifeTime::NO_VALUE) {
+            continue;
+        }
+        if (info->buffer == nullptr) {
+            const uint32_t length = nonExtensionOperandSizeOfData(info->type, info->dimensions);
+            info->buffer = new uint8_t[length];
+            info->length = length;
+            recordAllocation(length);
+        }
+        if (!info->isSufficient()) {
+            LOG(ERROR) << "Insufficient size for model operand: require = "
+                       << nonExtensionOperandSizeOfData(info->type, info->dimensions)
+                       << ", provided = " << info->length;
+            *result = ANEURALNETWORKS_OUTPUT_INSUFFICIENT_SIZE;
+            return false;
+        }
+    }
+    return true;
+}
+
 bool OperationExecutionContext::setOutputShape(uint32_t index, const Shape& shape) {
     return setInfoAndAllocateIfNeeded(getOutputInfo(index), shape, &result);
 }
@@ -253,6 +346,16 @@ bool OperationExecutionContext::isOmittedOutput(uint32_t index) const {
     return getOutputInfo(index)->lifetime == Operand::LifeTime::NO_VALUE;
 }
 
+const void* OperationExecutionContext::getPackedInputBuffer(uint32_t index,
+                                                            PackedLayout layout) const {
+    const RunTimeOperandInfo* info = getInputInfo(index);
+    if (packedWeights == nullptr || (info->lifetime != Operand::LifeTime::CONSTANT_COPY &&
+                                     info->lifetime != Operand::LifeTime::CONSTANT_REFERENCE)) {
+        return nullptr;
+    }
+    return packedWeights->lookup(info->buffer, info->length, info->dimensions, layout);
+}
+
 bool OperationExecutionContext::checkNoOmittedOperand() const {
     for (uint32_t i = 0; i < operation->inputs.size(); i++) {
         NN_RET_CHECK(!isOmittedInput(i))
@@ -402,6 +505,22 @@ bool setRunTimePoolInfosFromMemoryPools(std::vector<RunTimePoolInfo>* poolInfos,
     return true;
 }
 
+const uint8_t* getConstantOperandData(const Model& model, const Operand& operand,
+                                      const std::vector<RunTimePoolInfo>& poolInfos) {
+    switch (operand.lifetime) {
+        case Operand::LifeTime::CONSTANT_COPY:
+            return model.operandValues.data() + operand.location.offset;
+        case Operand::LifeTime::CONSTANT_REFERENCE:
+            return poolInfos[operand.location.poolIndex].getBuffer() + operand.location.offset;
+        case Operand::LifeTime::POINTER:
+            return std::visit(
+                    [](auto* pointer) { return static_cast<const uint8_t*>(pointer); },
+                    operand.location.pointer);
+        default:
+            return nullptr;
+    }
+}
+
 #ifdef NN_INCLUDE_CPU_IMPLEMENTATION
 template <typename T>
 inline bool convertToNhwcImpl(T* to, const T* from, const std::vector<uint32_t>& fromDim) {
@@ -475,6 +594,24 @@ static bool convertToNhwc(RunTimeOperandInfo& to, const RunTimeOperandInfo& from
     return true;
 }
 
+// Allocates the NHWC temporary that an operation with the given layout writes its output to. In
+// the NHWC layout the temporary aliases the output buffer. A resizable output, such as a WHILE
+// body output, is then grown through the temporary and takes over the reallocated buffer.
+static bool allocateNhwcOutput(RunTimeOperandInfo& output_tmp, RunTimeOperandInfo& output,
+                               const Shape& shape, bool data_layout, int* result) {
+    output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
+    if (data_layout) {
+        return setInfoAndAllocateIfNeeded(&output_tmp, shape, result);
+    }
+    output_tmp.buffer = output.buffer;
+    output_tmp.length = output.length;
+    output_tmp.isResizableBuffer = output.isResizableBuffer;
+    const bool success = setInfoAndAllocateIfNeeded(&output_tmp, shape, result);
+    output.buffer = output_tmp.buffer;
+    output.length = output_tmp.length;
+    return success;
+}
+
 static bool convertFromNhwc(RunTimeOperandInfo& to, const RunTimeOperandInfo& from,
                             bool data_layout, int* result) {
     if (from.dimensions.size() != 4) {
@@ -540,6 +677,22 @@ static void consumeOperationInputs(const std::vector<uint32_t>& inputs,
     }
 }
 
+#ifdef NN_INCLUDE_CPU_IMPLEMENTATION
+// Returns the result code of an operation that has been run, and frees the inputs it was the last
+// user of.
+static int finishOperation(const Operation& operation, RunTimeOperandInfo* operands, bool success,
+                           int result) {
+    if (!success && result == ANEURALNETWORKS_NO_ERROR) {
+        result = ANEURALNETWORKS_OP_FAILED;
+    }
+    if (result != ANEURALNETWORKS_NO_ERROR) {
+        LOG(ERROR) << operation.type << " failed.";
+    }
+    consumeOperationInputs(operation.inputs, operands);
+    return result;
+}
+#endif  // NN_INCLUDE_CPU_IMPLEMENTATION
+
 // This function only frees TEMPORARY_VARIABLE operands that are unused
 // outputs because consumeOperationInputs takes care of any operands
 // that are inputs to an operation.
@@ -562,7 +715,29 @@ int CpuExecutor::run(const Model& model, const Request& request,
     VLOG(CPUEXE) << "CpuExecutor::run() with request(" << SHOW_IF_DEBUG(request) << ")";
     mModelOperandValues = model.operandValues.data();
     mModelPoolInfos = &modelPoolInfos;
+    mMainSubgraph = &model.main;
     mReferencedSubgraphs = &model.referenced;
+    if (mPackedWeights != nullptr && mPackedWeights->isFor(model, modelPoolInfos)) {
+        mModelPackedWeights = mPackedWeights.get();
+    }
+    if (mFusionPlan != nullptr && mFusionPlan->isFor(model)) {
+        mModelFusionPlan = mFusionPlan.get();
+    }
+    if (mStaticShapes != nullptr && mStaticShapes->isFor(model)) {
+        mModelStaticShapes = mStaticShapes.get();
+    }
+    if (mKernelTable != nullptr && mKernelTable->isFor(model)) {
+        mModelKernelTable = mKernelTable.get();
+    }
+
+    // Fall back to a cache private to this run if the client did not provide one for this model.
+    // A private cache only pays off when referenced subgraphs may run more than once, so a model
+    // without control flow computes the runtime info of its main subgraph directly.
+    std::shared_ptr<CpuExecutorSubgraphCache> clientSubgraphCache = mSubgraphCache;
+    if (mSubgraphCache == nullptr || !mSubgraphCache->bind(model, modelPoolInfos)) {
+        mSubgraphCache = model.referenced.empty() ? nullptr
+                                                  : std::make_shared<CpuExecutorSubgraphCache>();
+    }
 
     // b/109953668, disable OpenMP
 #ifdef NNAPI_OPENMP
@@ -593,22 +768,126 @@ int CpuExecutor::run(const Model& model, const Request& request,
     mFinished = true;
     mModelOperandValues = nullptr;
     mModelPoolInfos = nullptr;
+    mMainSubgraph = nullptr;
     mReferencedSubgraphs = nullptr;
+    mModelPackedWeights = nullptr;
+    mModelFusionPlan = nullptr;
+    mModelStaticShapes = nullptr;
+    mModelKernelTable = nullptr;
+    mSubgraphCache = std::move(clientSubgraphCache);
+    return result;
+}
+
+template <typename Execute>
+std::optional<int> CpuExecutor::executeProfiled(const Model::Subgraph& subgraph,
+                                                uint32_t operationIndex, uint32_t operationCount,
+                                                RunTimeOperandInfo* operands,
+                                                const Execute& execute) {
+    if (mProfiler == nullptr) {
+        return execute();
+    }
+    const Operation* operations = &subgraph.operations[operationIndex];
+    CpuOperationProfile profile = {
+            .type = operations[0].type,
+            .subgraphIndex =
+                    &subgraph == mMainSubgraph
+                            ? 0
+                            : static_cast<uint32_t>(&subgraph - mReferencedSubgraphs->data()) + 1,
+            .operationIndex = operationIndex,
+            .operationCount = operationCount,
+            .start = {},
+            .duration = {},
+            // Inputs are measured before the operations, which may free them.
+            .bytesRead = operationCount == 1
+                                 ? getOperandBytes(operations[0].inputs, operands)
+                                 : getOperandBytes(getExternalInputs(operations, operationCount),
+                                                   operands),
+            .bytesWritten = 0,
+            .allocations = 0,
+            .bytesAllocated = 0,
+    };
+    CpuOperationProfile* const outerProfiledOperation = tProfiledOperation;
+    tProfiledOperation = &profile;
+    profile.start = mProfiler->now();
+    const std::optional<int> result = execute();
+    profile.duration = mProfiler->now() - profile.start;
+    tProfiledOperation = outerProfiledOperation;
+
+    if (result.has_value()) {
+        profile.bytesWritten =
+                getOperandBytes(operations[operationCount - 1].outputs, operands);
+        mProfiler->record(profile);
+    }
     return result;
 }
 
 int CpuExecutor::executeSubgraph(const Model::Subgraph& subgraph, RunTimeOperandInfo* operands) {
     VLOG(CPUEXE) << "CpuExecutor::executeSubgraph " << subgraph;
-    // The graph has serialized the operation in execution order.
-    for (const auto& operation : subgraph.operations) {
-        NN_RETURN_IF_ERROR(executeOperation(operation, operands));
+    // The graph has serialized the operation in execution order. A profiler measures the same
+    // fused chains and kernels that run without it.
+    const auto& operations = subgraph.operations;
+    const CpuKernel* kernels =
+            mModelKernelTable != nullptr ? mModelKernelTable->getKernels(subgraph).data() : nullptr;
+    for (uint32_t i = 0; i < operations.size();) {
+        const CpuFusedChain* chain =
+                mModelFusionPlan != nullptr ? mModelFusionPlan->lookup(subgraph, i) : nullptr;
+        if (chain != nullptr) {
+            if (const auto result =
+                        executeProfiled(subgraph, i, chain->operationCount, operands, [&] {
+                            return executeFusedChain(*chain, &operations[i], operands);
+                        })) {
+                NN_RETURN_IF_ERROR(*result);
+                i += chain->operationCount;
+                continue;
+            }
+        }
+        NN_RETURN_IF_ERROR(*executeProfiled(subgraph, i, 1, operands, [&] {
+            return std::optional<int>(executeOperation(operations[i], operands,
+                                                       hasStaticShapes(subgraph, i, operands),
+                                                       kernels != nullptr ? &kernels[i] : nullptr));
+        }));
+        ++i;
     }
     return ANEURALNETWORKS_NO_ERROR;
 }
 
+bool CpuExecutorSubgraphCache::bind(const Model& model,
+                                    const std::vector<RunTimePoolInfo>& modelPoolInfos) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mModel == nullptr) {
+        mModel = &model;
+        mModelPoolInfos = &modelPoolInfos;
+    }
+    return mModel == &model && mModelPoolInfos == &modelPoolInfos;
+}
+
+const std::vector<RunTimeOperandInfo>* CpuExecutorSubgraphCache::lookup(
+        const Model::Subgraph& subgraph) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto it = mSubgraphs.find(&subgraph);
+    return it != mSubgraphs.end() ? &it->second : nullptr;
+}
+
+const std::vector<RunTimeOperandInfo>& CpuExecutorSubgraphCache::insert(
+        const Model::Subgraph& subgraph, std::vector<RunTimeOperandInfo> operands) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSubgraphs.try_emplace(&subgraph, std::move(operands)).first->second;
+}
+
 std::vector<RunTimeOperandInfo> CpuExecutor::initializeRunTimeInfo(
         const Model::Subgraph& subgraph) {
-    VLOG(CPUEXE) << "CpuExecutor::initializeRunTimeInfo";
+    if (mSubgraphCache == nullptr) {
+        return computeRunTimeInfo(subgraph);
+    }
+    if (const auto* operands = mSubgraphCache->lookup(subgraph)) {
+        return *operands;
+    }
+    return mSubgraphCache->insert(subgraph, computeRunTimeInfo(subgraph));
+}
+
+std::vector<RunTimeOperandInfo> CpuExecutor::computeRunTimeInfo(
+        const Model::Subgraph& subgraph) const {
+    VLOG(CPUEXE) << "CpuExecutor::computeRunTimeInfo";
     const size_t count = subgraph.operands.size();
     std::vector<RunTimeOperandInfo> operands(count);
     std::vector<uint32_t> numberOfConsumers =
@@ -715,8 +994,27 @@ void CpuExecutor::updateForArguments(const std::vector<uint32_t>& indexes,
     }
 }
 
+bool CpuExecutor::hasStaticShapes(const Model::Subgraph& subgraph, uint32_t operationIndex,
+                                  const RunTimeOperandInfo* operands) const {
+    if (mModelStaticShapes == nullptr || !mModelStaticShapes->isStatic(subgraph, operationIndex)) {
+        return false;
+    }
+    // A request may also omit a model input or output that the shapes were inferred with.
+    const Operation& operation = subgraph.operations[operationIndex];
+    const auto isAsInferred = [&subgraph, operands](uint32_t index) {
+        const Operand& operand = subgraph.operands[index];
+        return operands[index].dimensions == operand.dimensions &&
+               (operands[index].lifetime == Operand::LifeTime::NO_VALUE) ==
+                       (operand.lifetime == Operand::LifeTime::NO_VALUE);
+    };
+    return std::all_of(operation.inputs.begin(), operation.inputs.end(), isAsInferred) &&
+           std::all_of(operation.outputs.begin(), operation.outputs.end(), isAsInferred);
+}
+
 int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
-                                  [[maybe_unused]] RunTimeOperandInfo* operands) {
+                                  [[maybe_unused]] RunTimeOperandInfo* operands,
+                                  [[maybe_unused]] bool hasStaticShapes,
+                                  [[maybe_unused]] const CpuKernel* kernel) {
 #ifdef NN_INCLUDE_CPU_IMPLEMENTATION
     if (hasDeadlinePassed(mDeadline)) {
         return ANEURALNETWORKS_MISSED_DEADLINE_TRANSIENT;
@@ -742,6 +1040,12 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
     bool success = false;
     int result = ANEURALNETWORKS_NO_ERROR;
 
+    // An operation resolved when the model was prepared skips the dispatch on its type.
+    if (kernel != nullptr && kernel->registration != nullptr) {
+        success = executeKernel(*kernel, operation, operands, hasStaticShapes, &result);
+        return finishOperation(operation, operands, success, result);
+    }
+
     // Function to verify that the number of input and output parameters
     // matches what is expected.  Also checks that all the parameters have
     // values. This function is to be used only for operations that do not
@@ -826,11 +1130,8 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                 success = false;
                 break;
             }
-            output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
-            output_tmp.buffer = data_layout ? nullptr : output.buffer;
-            output_tmp.length = data_layout ? 0 : output.length;
             if (!depthToSpacePrepare(input_tmp.shape(), blockSize, &outShape) ||
-                !setInfoAndAllocateIfNeeded(&output_tmp, outShape, &result)) {
+                !allocateNhwcOutput(output_tmp, output, outShape, data_layout, &result)) {
                 if (!data_layout) output.dimensions = output_tmp.dimensions;
                 break;
             }
@@ -890,12 +1191,8 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                 success = false;
                 break;
             }
-            output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
-            output_tmp.buffer = data_layout ? nullptr : output.buffer;
-            output_tmp.length = data_layout ? 0 : output.length;
-
             if (!spaceToDepthPrepare(input_tmp.shape(), blockSize, &outShape) ||
-                !setInfoAndAllocateIfNeeded(&output_tmp, outShape, &result)) {
+                !allocateNhwcOutput(output_tmp, output, outShape, data_layout, &result)) {
                 if (!data_layout) output.dimensions = output_tmp.dimensions;
                 break;
             }
@@ -1111,14 +1408,10 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                 success = false;
                 break;
             }
-            output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
-            output_tmp.buffer = data_layout ? nullptr : output.buffer;
-            output_tmp.length = data_layout ? 0 : output.length;
-
             if (!batchToSpacePrepare(input_tmp.shape(),
                                      reinterpret_cast<const int32_t*>(blockSize.buffer),
                                      blockSize.shape(), &outShape) ||
-                !setInfoAndAllocateIfNeeded(&output_tmp, outShape, &result)) {
+                !allocateNhwcOutput(output_tmp, output, outShape, data_layout, &result)) {
                 if (!data_layout) output.dimensions = output_tmp.dimensions;
                 break;
             }
@@ -1183,15 +1476,11 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                 success = false;
                 break;
             }
-            output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
-            output_tmp.buffer = data_layout ? nullptr : output.buffer;
-            output_tmp.length = data_layout ? 0 : output.length;
-
             if (!spaceToBatchPrepare(
                         input_tmp.shape(), reinterpret_cast<const int32_t*>(blockSize.buffer),
                         blockSize.shape(), reinterpret_cast<const int32_t*>(paddings.buffer),
                         paddings.shape(), &outShape) ||
-                !setInfoAndAllocateIfNeeded(&output_tmp, outShape, &result)) {
+                !allocateNhwcOutput(output_tmp, output, outShape, data_layout, &result)) {
                 if (!data_layout) output.dimensions = output_tmp.dimensions;
                 break;
             }
@@ -1502,10 +1791,6 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                 success = false;
                 break;
             }
-            output_tmp.lifetime = Operand::LifeTime::TEMPORARY_VARIABLE;
-            output_tmp.buffer = data_layout ? nullptr : output.buffer;
-            output_tmp.length = data_layout ? 0 : output.length;
-
             if (inCount == 9) {
                 Shape inputShape = input_tmp.shape();
                 Shape filterShape = filter.shape();
@@ -1522,7 +1807,7 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
             if (!groupedConvPrepare(input_tmp.shape(), filter.shape(), bias.shape(), padding_left,
                                     padding_right, padding_top, padding_bottom, stride_width,
                                     stride_height, numGroups, &outShape) ||
-                !setInfoAndAllocateIfNeeded(&output_tmp, outShape, &result)) {
+                !allocateNhwcOutput(output_tmp, output, outShape, data_layout, &result)) {
                 if (!data_layout) output.dimensions = output_tmp.dimensions;
                 success = false;
                 break;
@@ -1654,29 +1939,103 @@ int CpuExecutor::executeOperation([[maybe_unused]] const Operation& operation,
                        operationRegistration->execute == nullptr) {
                 LOG(ERROR) << "Incomplete operation registration: " << operation.type;
             } else {
-                OperationExecutionContext context(&operation, operands);
-                success = operationRegistration->flags.allowOmittedOperand ||
-                          context.checkNoOmittedOperand();
-                success = success && (operationRegistration->flags.allowZeroSizedInput ||
-                                      context.checkNoZeroSizedInput());
-                success = success && operationRegistration->prepare(&context) &&
-                          operationRegistration->execute(&context);
-                result = context.getResultCode();
+                success = executeKernel(CpuKernel::create(operationRegistration), operation,
+                                        operands, hasStaticShapes, &result);
             }
         }
     }
-    if (!success && result == ANEURALNETWORKS_NO_ERROR) {
-        result = ANEURALNETWORKS_OP_FAILED;
+    return finishOperation(operation, operands, success, result);
+#else
+    LOG(ERROR) << "Built without CPU execution support";
+    return ANEURALNETWORKS_OP_FAILED;
+#endif  // NN_INCLUDE_CPU_IMPLEMENTATION
+}
+
+bool CpuExecutor::executeKernel([[maybe_unused]] const CpuKernel& kernel,
+                                [[maybe_unused]] const Operation& operation,
+                                [[maybe_unused]] RunTimeOperandInfo* operands,
+                                [[maybe_unused]] bool hasStaticShapes,
+                                [[maybe_unused]] int* result) {
+#ifdef NN_INCLUDE_CPU_IMPLEMENTATION
+    OperationExecutionContext context(&operation, operands, mModelPackedWeights);
+    if (hasStaticShapes) {
+        const bool success =
+                allocateStaticOutputs(operation, operands, result) && kernel.execute(&context);
+        *result = *result != ANEURALNETWORKS_NO_ERROR ? *result : context.getResultCode();
+        return success;
     }
-    if (result != ANEURALNETWORKS_NO_ERROR) {
-        LOG(ERROR) << operation.type << " failed.";
+    bool success = kernel.allowOmittedOperand || context.checkNoOmittedOperand();
+    success = success && (kernel.allowZeroSizedInput || context.checkNoZeroSizedInput());
+    success = success && kernel.prepare(&context) && kernel.execute(&context);
+    *result = context.getResultCode();
+    return success;
+#else
+    return false;
+#endif  // NN_INCLUDE_CPU_IMPLEMENTATION
+}
+
+#ifdef NN_INCLUDE_CPU_IMPLEMENTATION
+// Returns true if a tensor of the given dimensions is broadcast to the value dimensions by
+// repeating it, that is if its dimensions other than leading ones are the trailing dimensions of
+// the value.
+static bool isRepeatedToDimensions(const std::vector<uint32_t>& dimensions,
+                                   const std::vector<uint32_t>& valueDimensions) {
+    if (dimensions.empty() || dimensions.size() > valueDimensions.size()) {
+        return false;
     }
+    const auto first = std::find_if(dimensions.begin(), dimensions.end(),
+                                    [](uint32_t dimension) { return dimension != 1; });
+    return std::equal(first, dimensions.end(),
+                      valueDimensions.end() - std::distance(first, dimensions.end()));
+}
+#endif  // NN_INCLUDE_CPU_IMPLEMENTATION
 
-    consumeOperationInputs(ins, operands);
+std::optional<int> CpuExecutor::executeFusedChain([[maybe_unused]] const CpuFusedChain& chain,
+                                                  [[maybe_unused]] const Operation* operations,
+                                                  [[maybe_unused]] RunTimeOperandInfo* operands) {
+#ifdef NN_INCLUDE_CPU_IMPLEMENTATION
+    // Unknown and zero-sized shapes are left to the kernels of the individual operations.
+    const RunTimeOperandInfo& input = operands[chain.inputOperand];
+    const Shape inputShape = input.shape();
+    if (input.buffer == nullptr || inputShape.dimensions.empty()) {
+        return std::nullopt;
+    }
+    const uint32_t count = getNumberOfElements(inputShape);
+    if (count == 0) {
+        return std::nullopt;
+    }
+    std::vector<CpuFusedChain::Operand> others(chain.steps.size());
+    for (size_t i = 0; i < chain.steps.size(); ++i) {
+        if (!chain.steps[i].isBinary()) {
+            continue;
+        }
+        const RunTimeOperandInfo& other = operands[chain.steps[i].otherOperand];
+        if (other.buffer == nullptr ||
+            !isRepeatedToDimensions(other.dimensions, inputShape.dimensions)) {
+            return std::nullopt;
+        }
+        others[i] = {.buffer = reinterpret_cast<const float*>(other.buffer),
+                     .count = getNumberOfElements(other.shape())};
+    }
+
+    if (hasDeadlinePassed(mDeadline)) {
+        return ANEURALNETWORKS_MISSED_DEADLINE_TRANSIENT;
+    }
+    RunTimeOperandInfo& output = operands[chain.outputOperand];
+    Shape outputShape = output.shape();
+    outputShape.dimensions = inputShape.dimensions;
+    int result = ANEURALNETWORKS_NO_ERROR;
+    if (setInfoAndAllocateIfNeeded(&output, outputShape, &result)) {
+        chain.compute(input.buffer, inputShape, others, output.buffer, output.shape(), count);
+    } else {
+        LOG(ERROR) << "Fused chain starting with " << operations[0].type << " failed.";
+    }
+    for (uint32_t i = 0; i < chain.operationCount; ++i) {
+        consumeOperationInputs(operations[i].inputs, operands);
+    }
     return result;
 #else
-    LOG(ERROR) << "Built without CPU execution support";
-    return ANEURALNETWORKS_OP_FAILED;
+    return std::nullopt;
 #endif  // NN_INCLUDE_CPU_IMPLEMENTATION
 }
 
@@ -1747,16 +2106,24 @@ int CpuExecutor::executeWhileOperation(const Operation& operation, RunTimeOperan
     // iteration = 2   cond inputs = body inputs = tmp2           body outputs = tmp1
     // iteration = 3   cond inputs = body inputs = ...            body outputs = ...
 
-    // For body output double buffering.
-    std::vector<uint8_t*> tmp1(bodySubgraph.outputIndexes.size());
-    std::vector<uint8_t*> tmp2(bodySubgraph.outputIndexes.size());
+    // For body output double buffering. The buffers persist across iterations: a body output with
+    // unknown shape is written into the existing buffer when it fits and the buffer is grown
+    // otherwise, so a loop over a growing tensor does not reallocate on every iteration.
+    struct LoopBuffer {
+        uint8_t* buffer = nullptr;
+        uint32_t capacity = 0;
+        // False if the buffer belongs to the outer output operand.
+        bool owned = true;
+    };
+    std::vector<LoopBuffer> tmp1(bodySubgraph.outputIndexes.size());
+    std::vector<LoopBuffer> tmp2(bodySubgraph.outputIndexes.size());
 
     // Ensure objects are freed
     auto cleanupGuard = base::make_scope_guard(
             [&tmp1, &tmp2, &condOperands, &bodyOperands, &operation, &operands] {
-                auto freeLoopOutputs = [](const std::vector<uint8_t*>& tmp) {
-                    for (auto buffer : tmp) {
-                        if (buffer != nullptr) {
+                auto freeLoopOutputs = [](const std::vector<LoopBuffer>& tmp) {
+                    for (const auto& [buffer, capacity, owned] : tmp) {
+                        if (owned && buffer != nullptr) {
                             delete[] buffer;
                         }
                     }
@@ -1769,13 +2136,21 @@ int CpuExecutor::executeWhileOperation(const Operation& operation, RunTimeOperan
                 consumeOperationInputs(operation.inputs, operands);
             });
 
-    // For body outputs with unknown shape, we skip double buffering and
-    // allocate on each iteration instead. This allows growing output tensors
-    // inside a WHILE loop.
+    // For body outputs with unknown shape, the dimensions are reset on each iteration and the
+    // buffer is resized as needed. This allows growing output tensors inside a WHILE loop.
     std::vector<bool> bodyOutputHasUnknownShape(bodySubgraph.outputIndexes.size());
     for (uint32_t i = 0, n = bodySubgraph.outputIndexes.size(); i < n; ++i) {
         const Operand& operand = bodySubgraph.operands[bodySubgraph.outputIndexes[i]];
-        bodyOutputHasUnknownShape[i] = nonExtensionOperandSizeOfData(operand) == 0;
+        const uint32_t size = nonExtensionOperandSizeOfData(operand);
+        bodyOutputHasUnknownShape[i] = size == 0;
+        // If the outer output already has a buffer large enough for a fully specified body output,
+        // use it as tmp1 so that the result does not need to be copied out when the loop ends
+        // after an odd number of iterations.
+        const RunTimeOperandInfo& outerOperand = operands[operation.outputs[i]];
+        if (size != 0 && outerOperand.buffer != nullptr && outerOperand.length >= size) {
+            tmp1[i] = {
+                    .buffer = outerOperand.buffer, .capacity = outerOperand.length, .owned = false};
+        }
     }
 
     // Initialize condition inputs from outer operands.
@@ -1825,34 +2200,67 @@ int CpuExecutor::executeWhileOperation(const Operation& operation, RunTimeOperan
         for (uint32_t i = 0, n = bodySubgraph.outputIndexes.size(); i < n; ++i) {
             RunTimeOperandInfo& info = bodyOperands[bodySubgraph.outputIndexes[i]];
             if (bodyOutputHasUnknownShape[i]) {
-                // Reset dimensions and buffer.
+                // Reset dimensions. The buffer is kept and grown if the new shape requires it.
                 info.dimensions = bodySubgraph.operands[bodySubgraph.outputIndexes[i]].dimensions;
-                if (outputBuffer[i] != nullptr) {
-                    delete[] outputBuffer[i];
-                    outputBuffer[i] = nullptr;
-                }
             }
-            info.buffer = outputBuffer[i];
+            info.buffer = outputBuffer[i].buffer;
+            info.length = outputBuffer[i].capacity;
+            info.isResizableBuffer = outputBuffer[i].owned;
         }
 
         NN_RETURN_IF_ERROR(executeSubgraph(bodySubgraph, bodyOperands.data()));
 
-        // Update output buffer information in case we have allocated new buffers.
+        // Update output buffer information in case we have allocated or grown buffers.
         for (uint32_t i = 0, n = bodySubgraph.outputIndexes.size(); i < n; ++i) {
-            outputBuffer[i] = bodyOperands[bodySubgraph.outputIndexes[i]].buffer;
+            const RunTimeOperandInfo& info = bodyOperands[bodySubgraph.outputIndexes[i]];
+            outputBuffer[i].buffer = info.buffer;
+            outputBuffer[i].capacity = info.length;
         }
     }
 
-    // Copy body outputs to outer outputs.
+    // Returns the loop-owned buffer holding the given operand's data, if any.
+    auto findOwnedLoopBuffer = [&tmp1, &tmp2](const uint8_t* buffer) -> LoopBuffer* {
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+        for (auto* tmp : {&tmp1, &tmp2}) {
+            for (LoopBuffer& loopBuffer : *tmp) {
+                if (loopBuffer.owned && loopBuffer.buffer == buffer) {
+                    return &loopBuffer;
+                }
+            }
+        }
+        return nullptr;
+    };
+
+    // Move body outputs to outer outputs.
     for (uint32_t i = 0, n = operation.outputs.size(); i < n; ++i) {
         RunTimeOperandInfo& outerOperand = operands[operation.outputs[i]];
         RunTimeOperandInfo& innerOperand = condOperands[condSubgraph.inputIndexes[i]];
+        // An outer operand that would otherwise have to allocate a buffer takes over the loop
+        // buffer instead. An outer operand with a resizable buffer belongs to the body of an
+        // enclosing WHILE loop, which picks up the new buffer after its body finishes.
+        const bool canAdoptBuffer =
+                outerOperand.isResizableBuffer ||
+                (outerOperand.buffer == nullptr &&
+                 outerOperand.lifetime == Operand::LifeTime::TEMPORARY_VARIABLE);
+        LoopBuffer* loopBuffer = findOwnedLoopBuffer(innerOperand.buffer);
+        if (canAdoptBuffer && loopBuffer != nullptr) {
+            delete[] outerOperand.buffer;
+            outerOperand.buffer = loopBuffer->buffer;
+            outerOperand.length = loopBuffer->capacity;
+            loopBuffer->buffer = nullptr;
+        }
         if (int error; !setInfoAndAllocateIfNeeded(&outerOperand, innerOperand.shape(), &error)) {
             return error;
         }
-        CHECK_EQ(outerOperand.length, innerOperand.length);
-        // TODO: Use the outer buffer as tmp1 to avoid copies.
-        std::memcpy(outerOperand.buffer, innerOperand.buffer, innerOperand.length);
+        // No copy is needed if the last iteration wrote directly into the outer buffer.
+        if (outerOperand.buffer != innerOperand.buffer) {
+            const uint32_t size =
+                    nonExtensionOperandSizeOfData(innerOperand.type, innerOperand.dimensions);
+            CHECK_LE(size, outerOperand.length);
+            std::memcpy(outerOperand.buffer, innerOperand.buffer, size);
+        }
     }
 
     return ANEURALNETWORKS_NO_ERROR;
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuExecutorProfiler"
+
+#include "CpuExecutorProfiler.h"
+
+#include <nnapi/TypeUtils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace android {
+namespace nn {
+
+namespace {
+
+// Chrome trace timestamps and durations are in microseconds.
+double toMicros(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+}  // namespace
+
+CpuExecutorProfiler::CpuExecutorProfiler(size_t maxRecordedOperations)
+    : kStartTime(std::chrono::steady_clock::now()), kMaxRecordedOperations(maxRecordedOperations) {}
+
+std::chrono::nanoseconds CpuExecutorProfiler::now() const {
+    return std::chrono::steady_clock::now() - kStartTime;
+}
+
+void CpuExecutorProfiler::record(const CpuOperationProfile& profile) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const Key key(profile.subgraphIndex, profile.operationIndex, profile.type,
+                  profile.operationCount);
+    auto [it, inserted] = mSummaries.try_emplace(key);
+    Summary& summary = it->second;
+    if (inserted) {
+        summary.type = profile.type;
+        summary.subgraphIndex = profile.subgraphIndex;
+        summary.operationIndex = profile.operationIndex;
+        summary.operationCount = profile.operationCount;
+    }
+    ++summary.count;
+    summary.totalDuration += profile.duration;
+    summary.maxDuration = std::max(summary.maxDuration, profile.duration);
+    summary.bytesRead += profile.bytesRead;
+    summary.bytesWritten += profile.bytesWritten;
+    summary.allocations += profile.allocations;
+    summary.bytesAllocated += profile.bytesAllocated;
+
+    if (mRecordedOperations.size() < kMaxRecordedOperations) {
+        mRecordedOperations.push_back(profile);
+    } else {
+        ++mDroppedOperationCount;
+    }
+}
+
+std::vector<CpuExecutorProfiler::Summary> CpuExecutorProfiler::getSummaries() const {
+    std::vector<Summary> summaries;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        summaries.reserve(mSummaries.size());
+        for (const auto& [key, summary] : mSummaries) {
+            summaries.push_back(summary);
+        }
+    }
+    std::stable_sort(summaries.begin(), summaries.end(), [](const Summary& a, const Summary& b) {
+        return a.totalDuration > b.totalDuration;
+    });
+    return summaries;
+}
+
+std::vector<CpuOperationProfile> CpuExecutorProfiler::getRecordedOperations() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRecordedOperations;
+}
+
+uint64_t CpuExecutorProfiler::getDroppedOperationCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mDroppedOperationCount;
+}
+
+std::string CpuExecutorProfiler::toChromeTrace() const {
+    const std::vector<CpuOperationProfile> operations = getRecordedOperations();
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "{\"traceEvents\":[";
+    for (size_t i = 0; i < operations.size(); ++i) {
+        const CpuOperationProfile& operation = operations[i];
+        oss << (i == 0 ? "" : ",") << "\n{\"name\":\"" << operation.type
+            << "\",\"cat\":\"operation\",\"ph\":\"X\",\"pid\":0,\"tid\":0"
+            << ",\"ts\":" << toMicros(operation.start)
+            << ",\"dur\":" << toMicros(operation.duration)
+            << ",\"args\":{\"subgraph\":" << operation.subgraphIndex
+            << ",\"index\":" << operation.operationIndex
+            << ",\"operations\":" << operation.operationCount
+            << ",\"bytesRead\":" << operation.bytesRead
+            << ",\"bytesWritten\":" << operation.bytesWritten
+            << ",\"allocations\":" << operation.allocations
+            << ",\"bytesAllocated\":" << operation.bytesAllocated << "}}";
+    }
+    oss << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return oss.str();
+}
+
+std::string CpuExecutorProfiler::toSummaryTable() const {
+    const std::vector<Summary> summaries = getSummaries();
+    std::ostringstream oss;
+    oss << std::left << std::setw(32) << "operation" << std::right << std::setw(9) << "subgraph"
+        << std::setw(7) << "index" << std::setw(9) << "count" << std::setw(13) << "total_us"
+        << std::setw(11) << "mean_us" << std::setw(11) << "max_us" << std::setw(14) << "bytes_read"
+        << std::setw(15) << "bytes_written" << std::setw(8) << "allocs" << std::setw(15)
+        << "bytes_alloced" << "\n";
+    oss << std::fixed << std::setprecision(1);
+    for (const Summary& summary : summaries) {
+        std::ostringstream type;
+        type << summary.type;
+        if (summary.operationCount > 1) {
+            type << " (" << summary.operationCount << " fused)";
+        }
+        oss << std::left << std::setw(32) << type.str() << std::right << std::setw(9)
+            << summary.subgraphIndex << std::setw(7) << summary.operationIndex << std::setw(9)
+            << summary.count << std::setw(13) << toMicros(summary.totalDuration) << std::setw(11)
+            << toMicros(summary.totalDuration) / summary.count << std::setw(11)
+            << toMicros(summary.maxDuration) << std::setw(14) << summary.bytesRead
+            << std::setw(15) << summary.bytesWritten << std::setw(8) << summary.allocations
+            << std::setw(15) << summary.bytesAllocated << "\n";
+    }
+    return oss.str();
+}
+
+void CpuExecutorProfiler::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mRecordedOperations.clear();
+    mSummaries.clear();
+    mDroppedOperationCount = 0;
+}
+
+}  // namespace nn
+}  // namespace android
@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuFusionPlan"
+
+#include "CpuFusionPlan.h"
+
+#include <android-base/logging.h>
+#include <nnapi/TypeUtils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "Tracing.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+using Kind = CpuFusedStep::Kind;
+
+// The number of elements a chain computes at a time. A block of values stays in the cache while
+// all steps are applied to it.
+constexpr uint32_t kBlockSize = 256;
+
+bool isFloat32Tensor(const Operand& operand) {
+    return operand.type == OperandType::TENSOR_FLOAT32;
+}
+
+bool isBinary(OperationType type) {
+    return type == OperationType::ADD || type == OperationType::SUB ||
+           type == OperationType::MUL || type == OperationType::DIV;
+}
+
+std::optional<int32_t> getConstantActivation(const Operand& operand,
+                                             const Model::OperandValues& operandValues) {
+    if (operand.type != OperandType::INT32 ||
+        operand.lifetime != Operand::LifeTime::CONSTANT_COPY) {
+        return std::nullopt;
+    }
+    int32_t activation = 0;
+    std::memcpy(&activation, operandValues.data() + operand.location.offset, sizeof(activation));
+    return activation;
+}
+
+// Appends the operation to the chain if it is an elementwise operation of the chain value alone.
+bool appendStep(const Operation& operation, uint32_t value, const std::vector<Operand>& operands,
+                const Model::OperandValues& operandValues, CpuFusedChain* chain) {
+    if (operation.outputs.size() != 1) {
+        return false;
+    }
+    const Operand& output = operands[operation.outputs[0]];
+    const auto isUnaryOfValue = [&operation, value] {
+        return operation.inputs.size() == 1 && operation.inputs[0] == value;
+    };
+    const auto appendUnary = [&](Kind kind) {
+        if (!isUnaryOfValue() || !isFloat32Tensor(output)) {
+            return false;
+        }
+        chain->steps.push_back({.kind = kind});
+        return true;
+    };
+    const auto appendBinary = [&](Kind kind) {
+        const auto& inputs = operation.inputs;
+        if (inputs.size() != 3 || !isFloat32Tensor(output) ||
+            (inputs[0] == value) == (inputs[1] == value)) {
+            return false;
+        }
+        const bool valueIsFirst = inputs[0] == value;
+        const uint32_t other = valueIsFirst ? inputs[1] : inputs[0];
+        const auto activation = getConstantActivation(operands[inputs[2]], operandValues);
+        if (!isFloat32Tensor(operands[other]) || !activation.has_value()) {
+            return false;
+        }
+        CpuFusedStep step = {.kind = kind, .otherOperand = other, .valueIsFirst = valueIsFirst};
+        CalculateActivationRangeFloat(*activation, &step.activationMin, &step.activationMax);
+        chain->steps.push_back(step);
+        return true;
+    };
+
+    switch (operation.type) {
+        case OperationType::ADD:
+            return appendBinary(Kind::ADD);
+        case OperationType::SUB:
+            return appendBinary(Kind::SUB);
+        case OperationType::MUL:
+            return appendBinary(Kind::MUL);
+        case OperationType::DIV:
+            return appendBinary(Kind::DIV);
+        case OperationType::RELU:
+            return appendUnary(Kind::RELU);
+        case OperationType::RELU1:
+            return appendUnary(Kind::RELU1);
+        case OperationType::RELU6:
+            return appendUnary(Kind::RELU6);
+        case OperationType::LOGISTIC:
+            return appendUnary(Kind::LOGISTIC);
+        case OperationType::TANH:
+            return appendUnary(Kind::TANH);
+        case OperationType::QUANTIZE:
+            if (!isUnaryOfValue() || (output.type != OperandType::TENSOR_QUANT8_ASYMM &&
+                                      output.type != OperandType::TENSOR_QUANT8_ASYMM_SIGNED)) {
+                return false;
+            }
+            chain->quantizesOutput = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Starts a chain with the operation. The value of a chain starting with a binary operation is the
+// input with more elements if their sizes are known, so that the other input can be broadcast.
+bool startChain(const Operation& operation, const std::vector<Operand>& operands,
+                const Model::OperandValues& operandValues, CpuFusedChain* chain) {
+    if (operation.inputs.empty() || operation.outputs.size() != 1) {
+        return false;
+    }
+    if (operation.type == OperationType::DEQUANTIZE) {
+        const Operand& input = operands[operation.inputs[0]];
+        if (operation.inputs.size() != 1 || !isFloat32Tensor(operands[operation.outputs[0]]) ||
+            (input.type != OperandType::TENSOR_QUANT8_ASYMM &&
+             input.type != OperandType::TENSOR_QUANT8_ASYMM_SIGNED &&
+             input.type != OperandType::TENSOR_QUANT8_SYMM)) {
+            return false;
+        }
+        chain->inputOperand = operation.inputs[0];
+        chain->dequantizesInput = true;
+        return true;
+    }
+    uint32_t value = operation.inputs[0];
+    if (isBinary(operation.type) && operation.inputs.size() == 3 &&
+        isFloat32Tensor(operands[operation.inputs[0]]) &&
+        isFloat32Tensor(operands[operation.inputs[1]])) {
+        const size_t firstSize = getNonExtensionSize(operands[operation.inputs[0]]).value_or(0);
+        const size_t secondSize = getNonExtensionSize(operands[operation.inputs[1]]).value_or(0);
+        if (firstSize != 0 && secondSize > firstSize) {
+            value = operation.inputs[1];
+        }
+    }
+    if (!isFloat32Tensor(operands[value])) {
+        return false;
+    }
+    chain->inputOperand = value;
+    return appendStep(operation, value, operands, operandValues, chain);
+}
+
+template <typename Function>
+void applyUnary(float* values, uint32_t size, Function function) {
+    for (uint32_t i = 0; i < size; ++i) {
+        values[i] = function(values[i]);
+    }
+}
+
+// Applies a binary step to the values of the elements [begin, begin + size) of the chain. The
+// other input is broadcast along the leading dimensions, so its index wraps around.
+template <typename Function>
+void applyBinary(const CpuFusedStep& step, const CpuFusedChain::Operand& other, uint32_t begin,
+                 float* values, uint32_t size, Function function) {
+    const auto apply = [&step, function](float value, float otherValue) {
+        const float result =
+                step.valueIsFirst ? function(value, otherValue) : function(otherValue, value);
+        return std::min(std::max(result, step.activationMin), step.activationMax);
+    };
+    if (other.count == 1) {
+        const float otherValue = other.buffer[0];
+        for (uint32_t i = 0; i < size; ++i) {
+            values[i] = apply(values[i], otherValue);
+        }
+        return;
+    }
+    uint32_t otherIndex = begin % other.count;
+    for (uint32_t i = 0; i < size; ++i) {
+        values[i] = apply(values[i], other.buffer[otherIndex]);
+        if (++otherIndex == other.count) {
+            otherIndex = 0;
+        }
+    }
+}
+
+// The activations match reluFloat, logisticFloat and tanhFloat32 in Activation.cpp.
+void applyStep(const CpuFusedStep& step, const CpuFusedChain::Operand& other, uint32_t begin,
+               float* values, uint32_t size) {
+    switch (step.kind) {
+        case Kind::ADD:
+            return applyBinary(step, other, begin, values, size,
+                               [](float a, float b) { return a + b; });
+        case Kind::SUB:
+            return applyBinary(step, other, begin, values, size,
+                               [](float a, float b) { return a - b; });
+        case Kind::MUL:
+            return applyBinary(step, other, begin, values, size,
+                               [](float a, float b) { return a * b; });
+        case Kind::DIV:
+            return applyBinary(step, other, begin, values, size,
+                               [](float a, float b) { return a / b; });
+        case Kind::RELU:
+            return applyUnary(values, size, [](float v) {
+                return std::min(std::max(0.f, v), std::numeric_limits<float>::max());
+            });
+        case Kind::RELU1:
+            return applyUnary(values, size,
+                              [](float v) { return std::min(std::max(-1.f, v), 1.f); });
+        case Kind::RELU6:
+            return applyUnary(values, size,
+                              [](float v) { return std::min(std::max(0.f, v), 6.f); });
+        case Kind::LOGISTIC:
+            return applyUnary(values, size, [](float v) { return 1.f / (1.f + std::exp(-v)); });
+        case Kind::TANH:
+            return applyUnary(values, size, [](float v) { return std::tanh(v); });
+    }
+}
+
+// The dequantization formula also appears in Dequantize.cpp.
+template <typename T>
+void dequantize(const T* input, const Shape& inputShape, float* values, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        const int32_t value = input[i];
+        values[i] = inputShape.scale * (value - inputShape.offset);
+    }
+}
+
+// The quantization formula also appears in Quantize.cpp.
+template <typename T>
+void quantize(const float* values, uint32_t size, const Shape& outputShape, T* output) {
+    constexpr float kMin = std::numeric_limits<T>::min();
+    constexpr float kMax = std::numeric_limits<T>::max();
+    for (uint32_t i = 0; i < size; ++i) {
+        output[i] = static_cast<T>(std::max<float>(
+                kMin, std::min<float>(kMax, outputShape.offset +
+                                                    std::round(values[i] / outputShape.scale))));
+    }
+}
+
+}  // namespace
+
+void CpuFusedChain::compute(const uint8_t* input, const Shape& inputShape,
+                            const std::vector<Operand>& others, uint8_t* output,
+                            const Shape& outputShape, uint32_t count) const {
+    NNTRACE_COMP("CpuFusedChain::compute");
+    float values[kBlockSize];
+    for (uint32_t begin = 0; begin < count; begin += kBlockSize) {
+        const uint32_t size = std::min(kBlockSize, count - begin);
+        if (!dequantizesInput) {
+            std::memcpy(values, input + begin * sizeof(float), size * sizeof(float));
+        } else if (inputShape.type == OperandType::TENSOR_QUANT8_ASYMM) {
+            dequantize(input + begin, inputShape, values, size);
+        } else {
+            dequantize(reinterpret_cast<const int8_t*>(input) + begin, inputShape, values, size);
+        }
+        for (size_t i = 0; i < steps.size(); ++i) {
+            applyStep(steps[i], others[i], begin, values, size);
+        }
+        if (!quantizesOutput) {
+            std::memcpy(output + begin * sizeof(float), values, size * sizeof(float));
+        } else if (outputShape.type == OperandType::TENSOR_QUANT8_ASYMM) {
+            quantize(values, size, outputShape, output + begin);
+        } else {
+            quantize(values, size, outputShape, reinterpret_cast<int8_t*>(output) + begin);
+        }
+    }
+}
+
+std::shared_ptr<const CpuFusionPlan> CpuFusionPlan::create(const Model& model) {
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "CpuFusionPlan::create");
+    std::shared_ptr<CpuFusionPlan> plan(new CpuFusionPlan(&model));
+    plan->addChains(model.main, model.operandValues);
+    for (const auto& subgraph : model.referenced) {
+        plan->addChains(subgraph, model.operandValues);
+    }
+    VLOG(CPUEXE) << "CpuFusionPlan::create fused " << plan->getFusedOperationCount()
+                 << " operations into " << plan->getFusedChainCount() << " chains";
+    return plan;
+}
+
+const CpuFusedChain* CpuFusionPlan::lookup(const Model::Subgraph& subgraph,
+                                           uint32_t operationIndex) const {
+    const auto it = mChains.find(Key(&subgraph, operationIndex));
+    return it != mChains.end() ? &it->second : nullptr;
+}
+
+void CpuFusionPlan::addChains(const Model::Subgraph& subgraph,
+                              const Model::OperandValues& operandValues) {
+    const auto& operands = subgraph.operands;
+    const auto& operations = subgraph.operations;
+    const auto consumers = countNumberOfConsumers(operands.size(), operations);
+    if (!consumers.has_value()) {
+        return;
+    }
+    // The value of a chain may only be passed to the next operation if no other operation reads it.
+    const auto isOnlyUsedByNext = [&operands, &consumers](uint32_t index) {
+        return operands[index].lifetime == Operand::LifeTime::TEMPORARY_VARIABLE &&
+               (*consumers)[index] == 1;
+    };
+
+    uint32_t first = 0;
+    while (first < operations.size()) {
+        CpuFusedChain chain;
+        if (!startChain(operations[first], operands, operandValues, &chain)) {
+            ++first;
+            continue;
+        }
+        uint32_t value = operations[first].outputs[0];
+        uint32_t end = first + 1;
+        while (end < operations.size() && !chain.quantizesOutput && isOnlyUsedByNext(value) &&
+               appendStep(operations[end], value, operands, operandValues, &chain)) {
+            value = operations[end].outputs[0];
+            ++end;
+        }
+        if (end - first < 2) {
+            ++first;
+            continue;
+        }
+        chain.operationCount = end - first;
+        chain.outputOperand = value;
+        mFusedOperationCount += chain.operationCount;
+        mChains.emplace(Key(&subgraph, first), std::move(chain));
+        first = end;
+    }
+}
+
+}  // namespace nn
+}  // namespace android
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuKernelTable"
+
+#include "CpuKernelTable.h"
+
+#include <android-base/logging.h>
+
+#include <memory>
+#include <vector>
+
+#include "Tracing.h"
+
+namespace android {
+namespace nn {
+
+CpuKernel CpuKernel::create(const OperationRegistration* registration) {
+    CpuKernel kernel;
+    if (registration == nullptr || registration->prepare == nullptr ||
+        registration->execute == nullptr) {
+        return kernel;
+    }
+    kernel.registration = registration;
+    if (const Function* prepare = registration->prepare.target<Function>()) {
+        kernel.prepareFunction = *prepare;
+    }
+    if (const Function* execute = registration->execute.target<Function>()) {
+        kernel.executeFunction = *execute;
+    }
+    kernel.allowOmittedOperand = registration->flags.allowOmittedOperand;
+    kernel.allowZeroSizedInput = registration->flags.allowZeroSizedInput;
+    return kernel;
+}
+
+std::shared_ptr<const CpuKernelTable> CpuKernelTable::create(
+        const Model& model, const IOperationResolver* operationResolver) {
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "CpuKernelTable::create");
+    CHECK(operationResolver != nullptr);
+    std::shared_ptr<CpuKernelTable> table(new CpuKernelTable(&model));
+    table->addSubgraph(model.main, *operationResolver);
+    for (const auto& subgraph : model.referenced) {
+        table->addSubgraph(subgraph, *operationResolver);
+    }
+    VLOG(CPUEXE) << "CpuKernelTable::create resolved " << table->getRegisteredCount()
+                 << " registered operations";
+    return table;
+}
+
+const std::vector<CpuKernel>& CpuKernelTable::getKernels(const Model::Subgraph& subgraph) const {
+    const auto it = mKernels.find(&subgraph);
+    CHECK(it != mKernels.end()) << "Subgraph is not part of the model of the kernel table";
+    return it->second;
+}
+
+void CpuKernelTable::addSubgraph(const Model::Subgraph& subgraph,
+                                 const IOperationResolver& operationResolver) {
+    std::vector<CpuKernel>& kernels = mKernels[&subgraph];
+    kernels.reserve(subgraph.operations.size());
+    for (const Operation& operation : subgraph.operations) {
+        // IF and WHILE are run by CpuExecutor even if a resolver registers them.
+        const bool isControlFlow =
+                operation.type == OperationType::IF || operation.type == OperationType::WHILE;
+        const CpuKernel& kernel = kernels.emplace_back(CpuKernel::create(
+                isControlFlow ? nullptr : operationResolver.findOperation(operation.type)));
+        if (kernel.registration != nullptr) {
+            ++mRegisteredCount;
+        }
+    }
+}
+
+}  // namespace nn
+}  // namespace android
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuPackedWeights"
+
+#include "CpuPackedWeights.h"
+
+#include <android-base/logging.h>
+#include <nnapi/TypeUtils.h>
+
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "BatchMatmul.h"
+#include "Conv2D.h"
+#include "Tracing.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+bool isConstant(const Operand& operand) {
+    return operand.lifetime == Operand::LifeTime::CONSTANT_COPY ||
+           operand.lifetime == Operand::LifeTime::CONSTANT_REFERENCE;
+}
+
+// Swaps the last two dimensions of a tensor of elements of the given size.
+std::vector<uint8_t> transposeRowsColumns(const uint8_t* data,
+                                          const std::vector<uint32_t>& dimensions,
+                                          size_t elementSize) {
+    const size_t rank = dimensions.size();
+    const size_t rows = dimensions[rank - 2];
+    const size_t columns = dimensions[rank - 1];
+    size_t batches = 1;
+    for (size_t i = 0; i < rank - 2; ++i) {
+        batches *= dimensions[i];
+    }
+    std::vector<uint8_t> transposed(batches * rows * columns * elementSize);
+    for (size_t b = 0; b < batches; ++b) {
+        const uint8_t* matrix = data + b * rows * columns * elementSize;
+        uint8_t* transposedMatrix = transposed.data() + b * rows * columns * elementSize;
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < columns; ++c) {
+                std::memcpy(transposedMatrix + (c * rows + r) * elementSize,
+                            matrix + (r * columns + c) * elementSize, elementSize);
+            }
+        }
+    }
+    return transposed;
+}
+
+}  // namespace
+
+std::shared_ptr<const CpuPackedWeights> CpuPackedWeights::create(
+        const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos) {
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "CpuPackedWeights::create");
+    std::shared_ptr<CpuPackedWeights> packedWeights(
+            new CpuPackedWeights(&model, &modelPoolInfos));
+
+    auto packSubgraph = [&packedWeights](const Model::Subgraph& subgraph) {
+        const auto& operands = subgraph.operands;
+        for (const Operation& operation : subgraph.operations) {
+            const auto& inputs = operation.inputs;
+            switch (operation.type) {
+                case OperationType::CONV_2D: {
+                    const Operand& input = operands[inputs[conv_2d::kInputTensor]];
+                    const Operand& filter = operands[inputs[conv_2d::kFilterTensor]];
+                    const Operand& bias = operands[inputs[conv_2d::kBiasTensor]];
+                    if (input.type == OperandType::TENSOR_QUANT8_ASYMM_SIGNED &&
+                        filter.type == OperandType::TENSOR_QUANT8_ASYMM_SIGNED &&
+                        isConstant(filter)) {
+                        packedWeights->pack(filter, PackedLayout::UINT8_FROM_INT8);
+                    } else if (input.type == OperandType::TENSOR_FLOAT16 && isConstant(filter) &&
+                               isConstant(bias)) {
+                        packedWeights->pack(filter, PackedLayout::FLOAT32_FROM_FLOAT16);
+                        packedWeights->pack(bias, PackedLayout::FLOAT32_FROM_FLOAT16);
+                    }
+                    break;
+                }
+                case OperationType::BATCH_MATMUL: {
+                    const Operand& rhs = operands[inputs[batch_matmul_op::kInputRHSTensor]];
+                    const Operand& adjY = operands[inputs[batch_matmul_op::kInputRHSAdj]];
+                    // The kernel transposes the right-hand side unless it is adjoint.
+                    if (isConstant(rhs) && rhs.dimensions.size() >= 2 && isConstant(adjY) &&
+                        *packedWeights->getConstantBuffer(adjY) == 0) {
+                        packedWeights->pack(rhs, PackedLayout::TRANSPOSED_ROWS_COLUMNS);
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    };
+    packSubgraph(model.main);
+    for (const auto& subgraph : model.referenced) {
+        packSubgraph(subgraph);
+    }
+
+    VLOG(CPUEXE) << "CpuPackedWeights::create packed " << packedWeights->getPackedCount()
+                 << " constant operands into " << packedWeights->getPackedBytes() << " bytes";
+    return packedWeights;
+}
+
+std::shared_ptr<const CpuPackedWeights> CpuPackedWeights::createFromCache(
+        const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos,
+        const std::vector<CachedCopy>& copies) {
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "CpuPackedWeights::createFromCache");
+    std::shared_ptr<CpuPackedWeights> packedWeights(
+            new CpuPackedWeights(&model, &modelPoolInfos));
+    if (copies.empty()) {
+        return packedWeights;
+    }
+    const uint8_t* pool = modelPoolInfos.empty() ? nullptr : modelPoolInfos[0].getBuffer();
+    const uint64_t poolSize = modelPoolInfos.empty() ? 0 : modelPoolInfos[0].getSize();
+    for (const CachedCopy& copy : copies) {
+        if (static_cast<uint64_t>(copy.constantOffset) + copy.constantLength > poolSize ||
+            static_cast<uint64_t>(copy.packedOffset) + copy.packedSize > poolSize ||
+            getPackedSize(copy.type, copy.dimensions, copy.constantLength, copy.layout) !=
+                    copy.packedSize) {
+            continue;
+        }
+        Key key(pool + copy.constantOffset, copy.constantLength, copy.dimensions, copy.layout);
+        packedWeights->mPackedBytes += copy.packedSize;
+        packedWeights->mPacked.emplace(std::move(key),
+                                       PoolValues{.bytes = pool + copy.packedOffset,
+                                                  .byteCount = copy.packedSize});
+    }
+    VLOG(CPUEXE) << "CpuPackedWeights::createFromCache found " << packedWeights->getPackedCount()
+                 << " packed constant operands";
+    return packedWeights;
+}
+
+std::optional<size_t> CpuPackedWeights::getPackedSize(OperandType type,
+                                                      const std::vector<uint32_t>& dimensions,
+                                                      uint32_t length, PackedLayout layout) {
+    if (isExtension(type) || nonExtensionOperandSizeOfData(type, dimensions) != length) {
+        return std::nullopt;
+    }
+    switch (layout) {
+        case PackedLayout::UINT8_FROM_INT8:
+            if (type == OperandType::TENSOR_QUANT8_ASYMM_SIGNED) {
+                return length;
+            }
+            break;
+        case PackedLayout::FLOAT32_FROM_FLOAT16:
+            if (type == OperandType::TENSOR_FLOAT16) {
+                return length / sizeof(_Float16) * sizeof(float);
+            }
+            break;
+        case PackedLayout::TRANSPOSED_ROWS_COLUMNS:
+            if (dimensions.size() >= 2) {
+                return length;
+            }
+            break;
+    }
+    return std::nullopt;
+}
+
+const void* CpuPackedWeights::lookup(const void* buffer, uint32_t length,
+                                     const std::vector<uint32_t>& dimensions,
+                                     PackedLayout layout) const {
+    const auto it = mPacked.find(KeyView(buffer, length, dimensions, layout));
+    if (it == mPacked.end()) {
+        return nullptr;
+    }
+    return std::visit([](const auto& values) -> const void* { return values.data(); },
+                      it->second);
+}
+
+const uint8_t* CpuPackedWeights::getConstantBuffer(const Operand& operand) const {
+    if (operand.lifetime == Operand::LifeTime::CONSTANT_COPY) {
+        return mModel->operandValues.data() + operand.location.offset;
+    }
+    CHECK(operand.lifetime == Operand::LifeTime::CONSTANT_REFERENCE);
+    CHECK_LT(operand.location.poolIndex, mModelPoolInfos->size());
+    return (*mModelPoolInfos)[operand.location.poolIndex].getBuffer() + operand.location.offset;
+}
+
+void CpuPackedWeights::pack(const Operand& operand, PackedLayout layout) {
+    const uint8_t* buffer = getConstantBuffer(operand);
+    Key key(buffer, operand.location.length, operand.dimensions, layout);
+    if (mPacked.count(key) > 0) {
+        return;
+    }
+    const size_t elementSize = getNonExtensionSize(operand.type);
+    const size_t count = operand.location.length / elementSize;
+    Values packed;
+    switch (layout) {
+        case PackedLayout::UINT8_FROM_INT8: {
+            std::vector<uint8_t> values(count);
+            const auto* input = reinterpret_cast<const int8_t*>(buffer);
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<uint8_t>(static_cast<int32_t>(input[i]) + 128);
+            }
+            packed = std::move(values);
+            break;
+        }
+        case PackedLayout::FLOAT32_FROM_FLOAT16: {
+            std::vector<float> values(count);
+            const auto* input = reinterpret_cast<const _Float16*>(buffer);
+            for (size_t i = 0; i < count; ++i) {
+                values[i] = static_cast<float>(input[i]);
+            }
+            packed = std::move(values);
+            break;
+        }
+        case PackedLayout::TRANSPOSED_ROWS_COLUMNS:
+            packed = transposeRowsColumns(buffer, operand.dimensions, elementSize);
+            break;
+    }
+    mPackedBytes += std::visit(
+            [](const auto& values) { return values.size() * sizeof(*values.data()); }, packed);
+    mPacked.emplace(std::move(key), std::move(packed));
+}
+
+}  // namespace nn
+}  // namespace android
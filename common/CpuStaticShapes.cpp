@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuStaticShapes"
+
+#include "CpuStaticShapes.h"
+
+#include <android-base/logging.h>
+#include <nnapi/TypeUtils.h>
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "Tracing.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+bool isConstant(const Operand& operand) {
+    return operand.lifetime == Operand::LifeTime::CONSTANT_COPY ||
+           operand.lifetime == Operand::LifeTime::CONSTANT_REFERENCE ||
+           operand.lifetime == Operand::LifeTime::POINTER;
+}
+
+// Whether the type and dimensions of the operand are the same on every run.
+bool hasStaticShape(const Operand& operand) {
+    return operand.lifetime == Operand::LifeTime::NO_VALUE ||
+           (!isExtension(operand.type) && !tensorHasUnspecifiedDimensions(operand));
+}
+
+// Runs prepare() of an operation on the operands of the model. The values of the constant inputs
+// are those of the model, and the other inputs read zeros. Output shapes are checked against the
+// model instead of being stored.
+class ShapeInferenceContext : public IOperationExecutionContext {
+   public:
+    ShapeInferenceContext(const Operation& operation, const Model& model,
+                          const std::vector<RunTimePoolInfo>& modelPoolInfos)
+        : mOperation(operation), mModel(model), mModelPoolInfos(modelPoolInfos) {}
+
+    uint32_t getNumInputs() const override { return mOperation.inputs.size(); }
+    OperandType getInputType(uint32_t index) const override { return getInput(index).type; }
+    Shape getInputShape(uint32_t index) const override { return getShape(getInput(index)); }
+    const void* getInputBuffer(uint32_t index) const override;
+    const Operand::ExtraParams& getInputExtraParams(uint32_t index) const override {
+        return getInput(index).extraParams;
+    }
+
+    uint32_t getNumOutputs() const override { return mOperation.outputs.size(); }
+    OperandType getOutputType(uint32_t index) const override { return getOutput(index).type; }
+    Shape getOutputShape(uint32_t index) const override { return getShape(getOutput(index)); }
+    void* getOutputBuffer(uint32_t /*index*/) override { return nullptr; }
+    bool setOutputShape(uint32_t index, const Shape& shape) override;
+
+    bool isOmittedInput(uint32_t index) const override {
+        return getInput(index).lifetime == Operand::LifeTime::NO_VALUE;
+    }
+    bool isOmittedOutput(uint32_t index) const override {
+        return getOutput(index).lifetime == Operand::LifeTime::NO_VALUE;
+    }
+
+    // Returns true if prepare() set the shape of every output that is not omitted, and did not
+    // read the value of an input that is not a constant.
+    bool hasStaticOutputShapes() const;
+
+   private:
+    const Operand& getInput(uint32_t index) const {
+        CHECK_LT(index, mOperation.inputs.size());
+        return mModel.main.operands[mOperation.inputs[index]];
+    }
+    const Operand& getOutput(uint32_t index) const {
+        CHECK_LT(index, mOperation.outputs.size());
+        return mModel.main.operands[mOperation.outputs[index]];
+    }
+    static Shape getShape(const Operand& operand) {
+        return {
+                .type = operand.type,
+                .dimensions = operand.dimensions,
+                .scale = operand.scale,
+                .offset = operand.zeroPoint,
+                .extraParams = operand.extraParams,
+        };
+    }
+
+    const Operation& mOperation;
+    const Model& mModel;
+    const std::vector<RunTimePoolInfo>& mModelPoolInfos;
+    std::vector<bool> mOutputShapeSet = std::vector<bool>(mOperation.outputs.size(), false);
+    mutable bool mReadNonConstantInput = false;
+    mutable std::vector<std::vector<uint8_t>> mZeros;
+};
+
+const void* ShapeInferenceContext::getInputBuffer(uint32_t index) const {
+    const Operand& operand = getInput(index);
+    switch (operand.lifetime) {
+        case Operand::LifeTime::CONSTANT_COPY:
+            return mModel.operandValues.data() + operand.location.offset;
+        case Operand::LifeTime::CONSTANT_REFERENCE:
+            CHECK_LT(operand.location.poolIndex, mModelPoolInfos.size());
+            return mModelPoolInfos[operand.location.poolIndex].getBuffer() +
+                   operand.location.offset;
+        case Operand::LifeTime::POINTER:
+            return std::visit([](const auto* pointer) { return static_cast<const void*>(pointer); },
+                              operand.location.pointer);
+        case Operand::LifeTime::NO_VALUE:
+            return nullptr;
+        default:
+            mReadNonConstantInput = true;
+            return mZeros.emplace_back(nonExtensionOperandSizeOfData(operand.type,
+                                                                     operand.dimensions))
+                    .data();
+    }
+}
+
+bool ShapeInferenceContext::setOutputShape(uint32_t index, const Shape& shape) {
+    const Operand& operand = getOutput(index);
+    NN_RET_CHECK(shape.type == operand.type && shape.scale == operand.scale &&
+                 shape.offset == operand.zeroPoint && shape.extraParams == operand.extraParams)
+            << mOperation.type << " output " << index << " does not have the model type";
+    NN_RET_CHECK(shape.dimensions == operand.dimensions)
+            << mOperation.type << " output " << index << " does not have the model dimensions";
+    mOutputShapeSet[index] = true;
+    return true;
+}
+
+bool ShapeInferenceContext::hasStaticOutputShapes() const {
+    for (uint32_t i = 0; i < mOperation.outputs.size(); ++i) {
+        if (!mOutputShapeSet[i] && !isOmittedOutput(i)) {
+            return false;
+        }
+    }
+    return !mReadNonConstantInput;
+}
+
+// Returns true if prepare() of the operation computes the same output shapes, which are those of
+// the model, on every run.
+bool inferStaticShapes(const Operation& operation, const Model& model,
+                       const std::vector<RunTimePoolInfo>& modelPoolInfos,
+                       const IOperationResolver& operationResolver) {
+    if (operation.type == OperationType::IF || operation.type == OperationType::WHILE) {
+        return false;
+    }
+    const OperationRegistration* registration = operationResolver.findOperation(operation.type);
+    if (registration == nullptr || registration->prepare == nullptr ||
+        registration->execute == nullptr) {
+        return false;
+    }
+    const auto& operands = model.main.operands;
+    for (uint32_t index : operation.inputs) {
+        const Operand& operand = operands[index];
+        // prepare() usually reads scalars, so their values must not change between runs.
+        if (!hasStaticShape(operand) || (isNonExtensionScalar(operand.type) &&
+                                         !isConstant(operand) &&
+                                         operand.lifetime != Operand::LifeTime::NO_VALUE)) {
+            return false;
+        }
+        if (!registration->flags.allowOmittedOperand &&
+            operand.lifetime == Operand::LifeTime::NO_VALUE) {
+            return false;
+        }
+    }
+    for (uint32_t index : operation.outputs) {
+        const Operand& operand = operands[index];
+        if (!hasStaticShape(operand) || operand.lifetime == Operand::LifeTime::SUBGRAPH_INPUT ||
+            isConstant(operand) ||
+            (!registration->flags.allowOmittedOperand &&
+             operand.lifetime == Operand::LifeTime::NO_VALUE)) {
+            return false;
+        }
+    }
+    ShapeInferenceContext context(operation, model, modelPoolInfos);
+    return registration->prepare(&context) && context.hasStaticOutputShapes();
+}
+
+}  // namespace
+
+std::shared_ptr<const CpuStaticShapes> CpuStaticShapes::create(
+        const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos,
+        const IOperationResolver* operationResolver) {
+    NNTRACE_CPU(NNTRACE_PHASE_PREPARATION, "CpuStaticShapes::create");
+    CHECK(operationResolver != nullptr);
+    std::shared_ptr<CpuStaticShapes> shapes(new CpuStaticShapes(&model));
+    const auto& operations = model.main.operations;
+    for (size_t i = 0; i < operations.size(); ++i) {
+        if (inferStaticShapes(operations[i], model, modelPoolInfos, *operationResolver)) {
+            shapes->mIsStatic[i] = true;
+            ++shapes->mStaticOperationCount;
+        }
+    }
+    VLOG(CPUEXE) << "CpuStaticShapes::create inferred the output shapes of "
+                 << shapes->getStaticOperationCount() << " of " << operations.size()
+                 << " operations";
+    return shapes;
+}
+
+}  // namespace nn
+}  // namespace android
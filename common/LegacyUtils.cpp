@@ -24,6 +24,11 @@
 #include <nnapi/TypeUtils.h>
 #include <poll.h>
 
+#ifdef __ANDROID__
+#include <linux/sync_file.h>
+#include <sys/ioctl.h>
+#endif  // __ANDROID__
+
 #include <algorithm>
 #include <functional>
 #include <limits>
@@ -1824,6 +1829,21 @@ FenceState syncWait(int fd, int timeout) {
     return FenceState::UNKNOWN;
 }
 
+FenceState syncWaitWithStatus(int fd, int timeout) {
+    const FenceState state = syncWait(fd, timeout);
+#ifdef __ANDROID__
+    if (state == FenceState::SIGNALED) {
+        // A sync file also becomes readable when it is signaled with an error.
+        struct sync_file_info info = {};
+        if (ioctl(fd, SYNC_IOC_FILE_INFO, &info) == 0 && info.status < 0) {
+            errno = -info.status;
+            return FenceState::ERROR;
+        }
+    }
+#endif  // __ANDROID__
+    return state;
+}
+
 #ifdef NN_DEBUGGABLE
 uint32_t getProp(const char* str, uint32_t defaultValue) {
     const std::string propStr = android::base::GetProperty(str, "");
@@ -29,6 +29,7 @@
 
 #include "GraphDump.h"
 #include "LegacyUtils.h"
+#include "ValidatedModelCache.h"
 #include "nnapi/TypeUtils.h"
 #include "nnapi/Types.h"
 #include "nnapi/Validation.h"
@@ -72,8 +73,9 @@ bool invalid(const Model& model, Version version, bool strictSlicing) {
     if (model.main.outputIndexes.size() == 0) return true;
 
     // We shouldn't have to check whether the model is valid. However, it could
-    // be invalid if there is an error in the slicing algorithm.
-    auto maybeVersion = validate(model);
+    // be invalid if there is an error in the slicing algorithm. The device that the slice is
+    // for may validate it again.
+    auto maybeVersion = ValidatedModelCache::get()->validate(model);
     if (!maybeVersion.has_value()) {
         LOG(WARNING) << "Sliced model fails validate(): " << maybeVersion.error();
         CHECK(!strictSlicing);
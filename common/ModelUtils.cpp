@@ -289,4 +289,32 @@ void removeDeadOperands(Model* model) {
     keepSelectedElements(&model->extensionNameToPrefix, extensionsUsed);
 }
 
+uint32_t removeDeadOperations(Model* model) {
+    CHECK(model != nullptr);
+    auto& operations = model->main.operations;
+
+    // The operations are sorted in execution order, so walking them backwards visits every consumer
+    // of an operand before its producer.
+    std::vector<bool> operandsUsed(model->main.operands.size(), false);
+    for (uint32_t index : model->main.outputIndexes) {
+        operandsUsed.at(index) = true;
+    }
+    std::vector<bool> operationsUsed(operations.size(), false);
+    for (size_t i = operations.size(); i-- > 0;) {
+        const auto& outputs = operations[i].outputs;
+        if (std::none_of(outputs.begin(), outputs.end(),
+                         [&operandsUsed](uint32_t index) { return operandsUsed.at(index); })) {
+            continue;
+        }
+        operationsUsed[i] = true;
+        for (uint32_t index : operations[i].inputs) {
+            operandsUsed.at(index) = true;
+        }
+    }
+
+    const auto operationsRemoved = std::count(operationsUsed.begin(), operationsUsed.end(), false);
+    keepSelectedElements(&operations, operationsUsed);
+    return static_cast<uint32_t>(operationsRemoved);
+}
+
 }  // namespace android::nn
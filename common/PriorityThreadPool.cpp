@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#define LOG_TAG "PriorityThreadPool"
+
+#include "PriorityThreadPool.h"
+
+#include <android-base/logging.h>
+#include <nnapi/TypeUtils.h>
+#include <nnapi/Types.h>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <utility>
+
+#include "LegacyUtils.h"
+
+namespace android {
+namespace nn {
+
+PriorityThreadPool::PriorityThreadPool(uint32_t maxThreads, uint32_t maxQueuedTasks)
+    : kMaxThreads(std::max(maxThreads, 1u)), kMaxQueuedTasks(std::max(maxQueuedTasks, 1u)) {}
+
+PriorityThreadPool::~PriorityThreadPool() {
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mStopping = true;
+        threads = std::move(mThreads);
+    }
+    mTaskQueued.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void PriorityThreadPool::schedule(Priority priority, Task task) {
+    schedule(priority, {}, std::move(task), nullptr);
+}
+
+void PriorityThreadPool::schedule(Priority priority, const OptionalTimePoint& deadline, Task task,
+                                  Task onDeadlineMissed) {
+    CHECK(task != nullptr);
+    CHECK(!deadline.has_value() || onDeadlineMissed != nullptr);
+    std::unique_lock<std::mutex> lock(mMutex);
+    CHECK(!mStopping);
+    if (mQueuedTasks >= kMaxQueuedTasks) {
+        mStats.blockedSchedules++;
+        mTaskDequeued.wait(lock, [this]() REQUIRES(mMutex) {
+            return mQueuedTasks < kMaxQueuedTasks;
+        });
+    }
+    const size_t index = static_cast<size_t>(priority);
+    CHECK_LT(index, mQueues.size());
+    // Insert the task after the tasks that have to finish first, which keeps the tasks without a
+    // deadline in the order they were scheduled.
+    std::deque<QueuedTask>& queue = mQueues[index];
+    const auto position = std::find_if(queue.begin(), queue.end(), [&deadline](const auto& other) {
+        return deadline.has_value() && (!other.deadline.has_value() || *deadline < *other.deadline);
+    });
+    queue.insert(position, {.task = std::move(task),
+                            .onDeadlineMissed = std::move(onDeadlineMissed),
+                            .deadline = deadline,
+                            .queueTime = Clock::now()});
+    mQueuedTasks++;
+
+    // Start another worker if the idle ones cannot take all the queued tasks.
+    const uint32_t idleThreads = mThreads.size() - mBusyThreads;
+    if (mQueuedTasks > idleThreads && mThreads.size() < kMaxThreads) {
+        mThreads.emplace_back([this] { run(); });
+    }
+    lock.unlock();
+    mTaskQueued.notify_one();
+}
+
+PriorityThreadPool::Stats PriorityThreadPool::getStats() const {
+    std::lock_guard<std::mutex> guard(mMutex);
+    return mStats;
+}
+
+void PriorityThreadPool::run() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+        mTaskQueued.wait(lock, [this]() REQUIRES(mMutex) { return mStopping || mQueuedTasks > 0; });
+        if (mQueuedTasks == 0) {
+            return;
+        }
+
+        // The highest priority queue that is not empty.
+        auto queue = std::find_if(mQueues.rbegin(), mQueues.rend(),
+                                  [](const auto& tasks) { return !tasks.empty(); });
+        CHECK(queue != mQueues.rend());
+        QueuedTask next = std::move(queue->front());
+        queue->pop_front();
+        mQueuedTasks--;
+        mBusyThreads++;
+        const TimePoint now = Clock::now();
+        const Duration queueTime = now - next.queueTime;
+        mStats.totalQueueTime += queueTime;
+        mStats.maxQueueTime = std::max(mStats.maxQueueTime, queueTime);
+        const bool missedDeadline = next.deadline.has_value() && *next.deadline <= now;
+        lock.unlock();
+        mTaskDequeued.notify_one();
+
+        if (missedDeadline) {
+            VLOG(EXECUTION) << "PriorityThreadPool dropped a task that missed its deadline after "
+                            << std::chrono::duration_cast<std::chrono::microseconds>(queueTime)
+                                       .count()
+                            << "us in the queue";
+            next.onDeadlineMissed();
+        } else {
+            next.task();
+        }
+        const bool late = !missedDeadline && next.deadline.has_value() &&
+                          *next.deadline < Clock::now();
+
+        lock.lock();
+        mBusyThreads--;
+        if (missedDeadline) {
+            mStats.droppedTasks++;
+        } else {
+            mStats.completedTasks++;
+            mStats.lateTasks += late ? 1 : 0;
+        }
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const PriorityThreadPool::Stats& stats) {
+    // Tasks still running are already included in totalQueueTime, which slightly overstates the
+    // mean while the pool is busy.
+    const auto dequeuedTasks =
+            static_cast<Duration::rep>(stats.completedTasks + stats.droppedTasks);
+    const Duration meanQueueTime =
+            dequeuedTasks > 0 ? stats.totalQueueTime / dequeuedTasks : Duration{};
+    return os << "{.completedTasks=" << stats.completedTasks
+              << ", .droppedTasks=" << stats.droppedTasks << ", .lateTasks=" << stats.lateTasks
+              << ", .blockedSchedules=" << stats.blockedSchedules
+              << ", .meanQueueTime=" << meanQueueTime << ", .maxQueueTime=" << stats.maxQueueTime
+              << "}";
+}
+
+PriorityThreadPool* getDriverThreadPool() {
+    // Bounds the number of requests waiting for a thread, beyond which the binder threads
+    // submitting more are blocked.
+    constexpr uint32_t kMaxQueuedTasks = 64;
+    // Intentionally leaked because a driver service is expected to live forever, and its tasks may
+    // still be running when the process exits.
+    static PriorityThreadPool* const pool = new PriorityThreadPool(
+            std::max(std::thread::hardware_concurrency(), 1u), kMaxQueuedTasks);
+    return pool;
+}
+
+}  // namespace nn
+}  // namespace android
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "ValidatedModelCache"
+
+#include "ValidatedModelCache.h"
+
+#include <android-base/logging.h>
+#include <nnapi/Validation.h>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "LegacyUtils.h"
+#include "TokenHasher.h"
+#include "Tracing.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+template <typename T>
+bool update(TokenHasher* hasher, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return hasher->update(&value, sizeof(value));
+}
+
+template <typename T>
+bool update(TokenHasher* hasher, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return update(hasher, values.size()) &&
+           hasher->update(values.data(), values.size() * sizeof(T));
+}
+
+bool updateFromString(TokenHasher* hasher, const std::string& s) {
+    return update(hasher, s.size()) && hasher->update(s.data(), s.size());
+}
+
+bool updateSubgraph(TokenHasher* hasher, const Model::Subgraph& subgraph) {
+    bool success = update(hasher, subgraph.operands.size());
+    for (const Operand& operand : subgraph.operands) {
+        const DataLocation& location = operand.location;
+        const bool hasPointer =
+                std::visit([](auto* pointer) { return pointer != nullptr; }, location.pointer);
+        success &= update(hasher, operand.type) && update(hasher, operand.dimensions) &&
+                   update(hasher, operand.scale) && update(hasher, operand.zeroPoint) &&
+                   update(hasher, operand.lifetime) && update(hasher, hasPointer) &&
+                   update(hasher, location.poolIndex) && update(hasher, location.offset) &&
+                   update(hasher, location.length) && update(hasher, location.padding) &&
+                   update(hasher, operand.extraParams.index());
+        if (const auto* params =
+                    std::get_if<Operand::SymmPerChannelQuantParams>(&operand.extraParams)) {
+            success &= update(hasher, params->scales) && update(hasher, params->channelDim);
+        } else if (const auto* extensionParams =
+                           std::get_if<Operand::ExtensionParams>(&operand.extraParams)) {
+            success &= update(hasher, *extensionParams);
+        }
+    }
+    success &= update(hasher, subgraph.operations.size());
+    for (const Operation& operation : subgraph.operations) {
+        success &= update(hasher, operation.type) && update(hasher, operation.inputs) &&
+                   update(hasher, operation.outputs);
+    }
+    success &= update(hasher, subgraph.inputIndexes) && update(hasher, subgraph.outputIndexes);
+    return success;
+}
+
+}  // namespace
+
+ValidatedModelCache* ValidatedModelCache::get() {
+    static ValidatedModelCache cache;
+    return &cache;
+}
+
+std::optional<ValidatedModelCache::Fingerprint> ValidatedModelCache::makeFingerprint(
+        const Model& model) {
+    NNTRACE_FULL(NNTRACE_LAYER_UTILITY, NNTRACE_PHASE_COMPILATION,
+                 "ValidatedModelCache::makeFingerprint");
+    const Fingerprint initialFingerprint{};
+    TokenHasher hasher(initialFingerprint.data());
+    bool success = update(&hasher, model.operandValues.size()) &&
+                   update(&hasher, model.pools.size()) && updateSubgraph(&hasher, model.main) &&
+                   update(&hasher, model.referenced.size());
+    for (const auto& subgraph : model.referenced) {
+        success &= updateSubgraph(&hasher, subgraph);
+    }
+    success &= update(&hasher, model.extensionNameToPrefix.size());
+    for (const auto& [name, prefix] : model.extensionNameToPrefix) {
+        success &= updateFromString(&hasher, name) && update(&hasher, prefix);
+    }
+    if (!success || !hasher.finish()) {
+        return std::nullopt;
+    }
+
+    Fingerprint fingerprint;
+    const uint8_t* digest = hasher.getCacheToken();
+    std::copy(digest, digest + fingerprint.size(), fingerprint.begin());
+    return fingerprint;
+}
+
+Result<Version> ValidatedModelCache::validate(const Model& model) {
+    const std::optional<Fingerprint> fingerprint = makeFingerprint(model);
+    if (fingerprint.has_value()) {
+        if (const auto version = lookup(model, *fingerprint)) {
+            VLOG(COMPILATION) << "ValidatedModelCache::validate: reusing the validation of an "
+                                 "identical model";
+            return *version;
+        }
+    }
+
+    const Version version = NN_TRY(nn::validate(model));
+    if (!fingerprint.has_value()) {
+        return version;
+    }
+
+    Entry entry = {.version = version,
+                   .pools = std::vector<std::weak_ptr<const Memory>>(model.pools.begin(),
+                                                                     model.pools.end())};
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEntries.insert_or_assign(*fingerprint, std::move(entry)).second) {
+        mOrder.push_back(*fingerprint);
+    }
+    while (mOrder.size() > kMaxEntries) {
+        mEntries.erase(mOrder.front());
+        mOrder.pop_front();
+    }
+    return version;
+}
+
+std::optional<Version> ValidatedModelCache::lookup(const Model& model) const {
+    const std::optional<Fingerprint> fingerprint = makeFingerprint(model);
+    return fingerprint.has_value() ? lookup(model, *fingerprint) : std::nullopt;
+}
+
+std::optional<Version> ValidatedModelCache::lookup(const Model& model,
+                                                   const Fingerprint& fingerprint) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto it = mEntries.find(fingerprint);
+    if (it == mEntries.end()) {
+        return std::nullopt;
+    }
+    // The fingerprint does not cover the memory pools, which are validated as objects. A pool
+    // that has been freed since may have been replaced by another one at the same address.
+    const auto& pools = it->second.pools;
+    for (size_t i = 0; i < pools.size(); ++i) {
+        if (pools[i].lock() != model.pools[i]) {
+            return std::nullopt;
+        }
+    }
+    return it->second.version;
+}
+
+size_t ValidatedModelCache::size() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+void ValidatedModelCache::clear() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mOrder.clear();
+}
+
+}  // namespace nn
+}  // namespace android
@@ -96,6 +96,12 @@ void transposeRowsColumns(const T* inputData, const Shape& inputShape, T* output
                                      convertShapeToTflshape(transposedShape), outputData);
 }
 
+// Returns the RHS with its rows and columns swapped when the model was prepared, or nullptr.
+template <typename T>
+const T* getTransposedRHS(const IOperationExecutionContext* context) {
+    return context->getPackedInputBuffer<T>(kInputRHSTensor, PackedLayout::TRANSPOSED_ROWS_COLUMNS);
+}
+
 // Creates a temporary space in heap.
 // Note that it is caller's responsibility to free the memory.
 template <typename T>
@@ -112,18 +118,21 @@ std::unique_ptr<T[]> getTempData(uint32_t numElems) {
 // RHS <..., C, B> X LHS <..., B, A>
 // where output is a C X A column-oriented, which is equivalent to
 // A X C row-oriented.
+//
+// transposedRHSData is the RHS with its rows and columns swapped if it was packed when the model
+// was prepared, or nullptr otherwise.
 template <typename T>
 bool batchMatMulGeneric(const T* inputLHSData, const Shape& inputLHSShape, const T* inputRHSData,
-                        const Shape& inputRHSShape, const bool adjX, const bool adjY, T* outputData,
-                        const Shape& outputShape) {
+                        const Shape& inputRHSShape, const T* transposedRHSData, const bool adjX,
+                        const bool adjY, T* outputData, const Shape& outputShape) {
     NNTRACE_TRANS("batchMatMulGeneric");
     // Only performs transpose without conjugation for adjoint since complex number is not
     // supported.
     NNTRACE_COMP_SWITCH("reference_ops::Transpose");
     const T* realInputLHSData = inputLHSData;
     const T* realInputRHSData = inputRHSData;
-    auto tempInputLHSData = getTempData<T>(getNumberOfElements(inputLHSShape));
-    auto tempInputRHSData = getTempData<T>(getNumberOfElements(inputRHSShape));
+    std::unique_ptr<T[]> tempInputLHSData;
+    std::unique_ptr<T[]> tempInputRHSData;
     // For LHS, it's passed as RHS and column-oriented.
     // If adjX is false, needs to swap shape but no need to do data transpose.
     // If adjX is true, no need to swap shape but needs to do data transpose.
@@ -131,10 +140,14 @@ bool batchMatMulGeneric(const T* inputLHSData, const Shape& inputLHSShape, const
     // If adjY is false, needs to swap shape also needs to do data transpose.
     // If adjY is true, no need to swap shape also no need to do data transpose.
     if (adjX) {
+        tempInputLHSData = getTempData<T>(getNumberOfElements(inputLHSShape));
         transposeRowsColumns(inputLHSData, inputLHSShape, tempInputLHSData.get());
         realInputLHSData = tempInputLHSData.get();
     }
-    if (!adjY) {
+    if (!adjY && transposedRHSData != nullptr) {
+        realInputRHSData = transposedRHSData;
+    } else if (!adjY) {
+        tempInputRHSData = getTempData<T>(getNumberOfElements(inputRHSShape));
         transposeRowsColumns(inputRHSData, inputRHSShape, tempInputRHSData.get());
         realInputRHSData = tempInputRHSData.get();
     }
@@ -150,19 +163,23 @@ bool batchMatMulGeneric(const T* inputLHSData, const Shape& inputLHSShape, const
 // Performs batch matmul for quantized types.
 template <typename T>
 bool batchMatMulQuantized(const T* inputLHSData, const Shape& inputLHSShape, const T* inputRHSData,
-                          const Shape& inputRHSShape, const bool adjX, const bool adjY,
-                          T* outputData, const Shape& outputShape) {
+                          const Shape& inputRHSShape, const T* transposedRHSData, const bool adjX,
+                          const bool adjY, T* outputData, const Shape& outputShape) {
     NNTRACE_TRANS("batchMatMulQuantized");
     NNTRACE_COMP_SWITCH("reference_ops::Transpose");
     const T* realInputLHSData = inputLHSData;
     const T* realInputRHSData = inputRHSData;
-    auto tempInputLHSData = getTempData<T>(getNumberOfElements(inputLHSShape));
-    auto tempInputRHSData = getTempData<T>(getNumberOfElements(inputRHSShape));
+    std::unique_ptr<T[]> tempInputLHSData;
+    std::unique_ptr<T[]> tempInputRHSData;
     if (adjX) {
+        tempInputLHSData = getTempData<T>(getNumberOfElements(inputLHSShape));
         transposeRowsColumns(inputLHSData, inputLHSShape, tempInputLHSData.get());
         realInputLHSData = tempInputLHSData.get();
     }
-    if (!adjY) {
+    if (!adjY && transposedRHSData != nullptr) {
+        realInputRHSData = transposedRHSData;
+    } else if (!adjY) {
+        tempInputRHSData = getTempData<T>(getNumberOfElements(inputRHSShape));
         transposeRowsColumns(inputRHSData, inputRHSShape, tempInputRHSData.get());
         realInputRHSData = tempInputRHSData.get();
     }
@@ -233,6 +250,7 @@ bool execute(IOperationExecutionContext* context) {
                                       context->getInputShape(kInputLHSTensor),
                                       context->getInputBuffer<float>(kInputRHSTensor),
                                       context->getInputShape(kInputRHSTensor),
+                                      getTransposedRHS<float>(context),
                                       context->getInputValue<bool>(kInputLHSAdj),
                                       context->getInputValue<bool>(kInputRHSAdj),
                                       context->getOutputBuffer<float>(kOutputTensor),
@@ -242,6 +260,7 @@ bool execute(IOperationExecutionContext* context) {
                                       context->getInputShape(kInputLHSTensor),
                                       context->getInputBuffer<_Float16>(kInputRHSTensor),
                                       context->getInputShape(kInputRHSTensor),
+                                      getTransposedRHS<_Float16>(context),
                                       context->getInputValue<bool>(kInputLHSAdj),
                                       context->getInputValue<bool>(kInputRHSAdj),
                                       context->getOutputBuffer<_Float16>(kOutputTensor),
@@ -251,6 +270,7 @@ bool execute(IOperationExecutionContext* context) {
                                       context->getInputShape(kInputLHSTensor),
                                       context->getInputBuffer<int32_t>(kInputRHSTensor),
                                       context->getInputShape(kInputRHSTensor),
+                                      getTransposedRHS<int32_t>(context),
                                       context->getInputValue<bool>(kInputLHSAdj),
                                       context->getInputValue<bool>(kInputRHSAdj),
                                       context->getOutputBuffer<int32_t>(kOutputTensor),
@@ -260,6 +280,7 @@ bool execute(IOperationExecutionContext* context) {
                                         context->getInputShape(kInputLHSTensor),
                                         context->getInputBuffer<int8_t>(kInputRHSTensor),
                                         context->getInputShape(kInputRHSTensor),
+                                        getTransposedRHS<int8_t>(context),
                                         context->getInputValue<bool>(kInputLHSAdj),
                                         context->getInputValue<bool>(kInputRHSAdj),
                                         context->getOutputBuffer<int8_t>(kOutputTensor),
@@ -271,7 +271,10 @@ bool convNhwc(const uint8_t* inputData, const Shape& inputShape, const uint8_t*
 
 // Passing input, filter and output shapes by value, so that we can change the
 // offsets without modifying the actual shapes.
-bool convNhwc(const int8_t* inputData, Shape inputShape, const int8_t* filterData,
+//
+// The filter has already been converted by convertInt8ToUInt8, e.g. when the model was prepared,
+// while filterShape still describes the int8 filter.
+bool convNhwc(const int8_t* inputData, Shape inputShape, const uint8_t* unsignedFilterData,
               Shape filterShape, const int32_t* biasData, const Shape& biasShape,
               int32_t padding_left, int32_t padding_right, int32_t padding_top,
               int32_t padding_bottom, int32_t stride_width, int32_t stride_height,
@@ -283,14 +286,12 @@ bool convNhwc(const int8_t* inputData, Shape inputShape, const int8_t* filterDat
     convertInt8ToUInt8(inputData, &unsignedInput);
     inputShape.offset += 128;
 
-    std::vector<uint8_t> unsignedFilter(getNumberOfElements(filterShape));
-    convertInt8ToUInt8(filterData, &unsignedFilter);
     filterShape.offset += 128;
 
     std::vector<uint8_t> unsignedOutput(getNumberOfElements(outputShape));
     outputShape.offset += 128;
 
-    NN_RET_CHECK(convNhwc(unsignedInput.data(), inputShape, unsignedFilter.data(), filterShape,
+    NN_RET_CHECK(convNhwc(unsignedInput.data(), inputShape, unsignedFilterData, filterShape,
                           biasData, biasShape, padding_left, padding_right, padding_top,
                           padding_bottom, stride_width, stride_height, dilation_width_factor,
                           dilation_height_factor, activation, unsignedOutput.data(), outputShape));
@@ -300,8 +301,24 @@ bool convNhwc(const int8_t* inputData, Shape inputShape, const int8_t* filterDat
     return true;
 }
 
-bool convNhwc(const _Float16* inputData, const Shape& inputShape, const _Float16* filterData,
-              const Shape& filterShape, const _Float16* biasData, const Shape& biasShape,
+bool convNhwc(const int8_t* inputData, const Shape& inputShape, const int8_t* filterData,
+              const Shape& filterShape, const int32_t* biasData, const Shape& biasShape,
+              int32_t padding_left, int32_t padding_right, int32_t padding_top,
+              int32_t padding_bottom, int32_t stride_width, int32_t stride_height,
+              int32_t dilation_width_factor, int32_t dilation_height_factor, int32_t activation,
+              int8_t* outputData, const Shape& outputShape) {
+    std::vector<uint8_t> unsignedFilter(getNumberOfElements(filterShape));
+    convertInt8ToUInt8(filterData, &unsignedFilter);
+
+    return convNhwc(inputData, inputShape, unsignedFilter.data(), filterShape, biasData,
+                    biasShape, padding_left, padding_right, padding_top, padding_bottom,
+                    stride_width, stride_height, dilation_width_factor, dilation_height_factor,
+                    activation, outputData, outputShape);
+}
+
+// The filter and bias have already been widened to float, e.g. when the model was prepared.
+bool convNhwc(const _Float16* inputData, const Shape& inputShape, const float* filterData,
+              const Shape& filterShape, const float* biasData, const Shape& biasShape,
               int32_t padding_left, int32_t padding_right, int32_t padding_top,
               int32_t padding_bottom, int32_t stride_width, int32_t stride_height,
               int32_t dilation_width_factor, int32_t dilation_height_factor, int32_t activation,
@@ -309,23 +326,37 @@ bool convNhwc(const _Float16* inputData, const Shape& inputShape, const _Float16
     NNTRACE_TRANS("convFloat16");
 
     std::vector<float> inputData_float32(getNumberOfElements(inputShape));
-    std::vector<float> filterData_float32(getNumberOfElements(filterShape));
-    std::vector<float> biasData_float32(getNumberOfElements(biasShape));
     std::vector<float> outputData_float32(getNumberOfElements(outputShape));
 
     convertFloat16ToFloat32(inputData, &inputData_float32);
-    convertFloat16ToFloat32(filterData, &filterData_float32);
-    convertFloat16ToFloat32(biasData, &biasData_float32);
 
-    convNhwc(inputData_float32.data(), inputShape, filterData_float32.data(), filterShape,
-             biasData_float32.data(), biasShape, padding_left, padding_right, padding_top,
-             padding_bottom, stride_width, stride_height, dilation_width_factor,
-             dilation_height_factor, activation, outputData_float32.data(), outputShape);
+    convNhwc(inputData_float32.data(), inputShape, filterData, filterShape, biasData, biasShape,
+             padding_left, padding_right, padding_top, padding_bottom, stride_width,
+             stride_height, dilation_width_factor, dilation_height_factor, activation,
+             outputData_float32.data(), outputShape);
     convertFloat32ToFloat16(outputData_float32, outputData);
 
     return true;
 }
 
+bool convNhwc(const _Float16* inputData, const Shape& inputShape, const _Float16* filterData,
+              const Shape& filterShape, const _Float16* biasData, const Shape& biasShape,
+              int32_t padding_left, int32_t padding_right, int32_t padding_top,
+              int32_t padding_bottom, int32_t stride_width, int32_t stride_height,
+              int32_t dilation_width_factor, int32_t dilation_height_factor, int32_t activation,
+              _Float16* outputData, const Shape& outputShape) {
+    std::vector<float> filterData_float32(getNumberOfElements(filterShape));
+    std::vector<float> biasData_float32(getNumberOfElements(biasShape));
+
+    convertFloat16ToFloat32(filterData, &filterData_float32);
+    convertFloat16ToFloat32(biasData, &biasData_float32);
+
+    return convNhwc(inputData, inputShape, filterData_float32.data(), filterShape,
+                    biasData_float32.data(), biasShape, padding_left, padding_right, padding_top,
+                    padding_bottom, stride_width, stride_height, dilation_width_factor,
+                    dilation_height_factor, activation, outputData, outputShape);
+}
+
 template <typename T_Input, typename T_Filter, typename T_Bias>
 bool conv(const T_Input* inputData, const Shape& inputShape, const T_Filter* filterData,
           const Shape& filterShape, const T_Bias* biasData, const Shape& biasShape,
@@ -608,7 +639,22 @@ bool execute(IOperationExecutionContext* context) {
                         param.dilation_height_factor, param.activation, param.useNchw,
                         context->getOutputBuffer<float>(kOutputTensor),
                         context->getOutputShape(kOutputTensor));
-        case OperandType::TENSOR_FLOAT16:
+        case OperandType::TENSOR_FLOAT16: {
+            const float* packedFilter = context->getPackedInputBuffer<float>(
+                    kFilterTensor, PackedLayout::FLOAT32_FROM_FLOAT16);
+            const float* packedBias = context->getPackedInputBuffer<float>(
+                    kBiasTensor, PackedLayout::FLOAT32_FROM_FLOAT16);
+            if (packedFilter != nullptr && packedBias != nullptr) {
+                return conv(context->getInputBuffer<_Float16>(kInputTensor),
+                            context->getInputShape(kInputTensor), packedFilter,
+                            context->getInputShape(kFilterTensor), packedBias,
+                            context->getInputShape(kBiasTensor), param.padding_left,
+                            param.padding_right, param.padding_top, param.padding_bottom,
+                            param.stride_width, param.stride_height, param.dilation_width_factor,
+                            param.dilation_height_factor, param.activation, param.useNchw,
+                            context->getOutputBuffer<_Float16>(kOutputTensor),
+                            context->getOutputShape(kOutputTensor));
+            }
             return conv(context->getInputBuffer<_Float16>(kInputTensor),
                         context->getInputShape(kInputTensor),
                         context->getInputBuffer<_Float16>(kFilterTensor),
@@ -620,6 +666,7 @@ bool execute(IOperationExecutionContext* context) {
                         param.dilation_height_factor, param.activation, param.useNchw,
                         context->getOutputBuffer<_Float16>(kOutputTensor),
                         context->getOutputShape(kOutputTensor));
+        }
         case OperandType::TENSOR_QUANT8_ASYMM:
             if (context->getInputType(kFilterTensor) ==
                 OperandType::TENSOR_QUANT8_SYMM_PER_CHANNEL) {
@@ -673,6 +720,20 @@ bool execute(IOperationExecutionContext* context) {
                         context->getOutputShape(kOutputTensor));
             } else if (context->getInputType(kFilterTensor) ==
                        OperandType::TENSOR_QUANT8_ASYMM_SIGNED) {
+                if (const uint8_t* packedFilter = context->getPackedInputBuffer<uint8_t>(
+                            kFilterTensor, PackedLayout::UINT8_FROM_INT8)) {
+                    return conv(context->getInputBuffer<int8_t>(kInputTensor),
+                                context->getInputShape(kInputTensor), packedFilter,
+                                context->getInputShape(kFilterTensor),
+                                context->getInputBuffer<int32_t>(kBiasTensor),
+                                context->getInputShape(kBiasTensor), param.padding_left,
+                                param.padding_right, param.padding_top, param.padding_bottom,
+                                param.stride_width, param.stride_height,
+                                param.dilation_width_factor, param.dilation_height_factor,
+                                param.activation, param.useNchw,
+                                context->getOutputBuffer<int8_t>(kOutputTensor),
+                                context->getOutputShape(kOutputTensor));
+                }
                 return conv(context->getInputBuffer<int8_t>(kInputTensor),
                             context->getInputShape(kInputTensor),
                             context->getInputBuffer<int8_t>(kFilterTensor),
@@ -31,7 +31,7 @@ namespace nn {
 namespace quantize {
 namespace {
 
-// The quantization formula also appears in Elementwise.cpp.
+// The quantization formula also appears in Elementwise.cpp and CpuFusionPlan.cpp.
 template <typename T>
 bool quantizeToQuant8(const T* inputData, uint8_t* outputData, const Shape& outputShape) {
     NNTRACE_COMP("quantizeToQuant8");
@@ -44,7 +44,7 @@ bool quantizeToQuant8(const T* inputData, uint8_t* outputData, const Shape& outp
     return true;
 }
 
-// The quantization formula also appears in Elementwise.cpp.
+// The quantization formula also appears in Elementwise.cpp and CpuFusionPlan.cpp.
 template <typename T>
 bool quantizeToQuant8Signed(const T* inputData, int8_t* outputData, const Shape& outputShape) {
     NNTRACE_COMP("quantizeToQuant8Signed");
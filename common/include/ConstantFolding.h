@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CONSTANT_FOLDING_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CONSTANT_FOLDING_H
+
+#include <nnapi/Types.h>
+
+#include <cstdint>
+
+namespace android::nn {
+
+/**
+ * @brief Folds the constant operations of the main subgraph and removes its dead operations.
+ *
+ * An operation is constant if all of its inputs are constants, omitted, or outputs of other
+ * constant operations, and all of its outputs are temporaries of known size. The constant
+ * operations are evaluated once with CpuExecutor, the values they produce for the remaining
+ * operations become CONSTANT_COPY operands, and the constant operations are removed. Operations
+ * whose outputs are not used are then removed as well, see removeDeadOperations.
+ *
+ * IF, WHILE, OEM, RANDOM_MULTINOMIAL and extension operations are never folded. If the constant
+ * operations cannot be evaluated, none of them is folded.
+ *
+ * The model must be valid, and remains valid with the same inputs and outputs.
+ *
+ * @pre model != nullptr
+ *
+ * @param model The model to be simplified.
+ * @return The number of operations removed from the main subgraph.
+ */
+uint32_t foldConstantOperations(Model* model);
+
+}  // namespace android::nn
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CONSTANT_FOLDING_H
@@ -22,10 +22,13 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
 #include "ControlFlow.h"
+#include "CpuExecutorProfiler.h"
 #include "LegacyUtils.h"
 #include "OperationResolver.h"
 #include "OperationsExecutionUtils.h"
@@ -61,7 +64,9 @@ struct RunTimeOperandInfo {
     // location information in the model to figure out if this points
     // to memory we have allocated for an temporary operand.
     uint8_t* buffer;  // TODO(b/148273353): Change the type to void*.
-    // The length of the buffer.
+    // The capacity of the buffer, which is not necessarily the size of the data. A resizable
+    // buffer keeps its capacity when the operand shrinks, so the size of the data must be
+    // computed from the type and dimensions, as isSufficient does.
     uint32_t length;
     // Whether this is a temporary variable, a model input, a constant, etc.
     Operand::LifeTime lifetime;
@@ -73,6 +78,16 @@ struct RunTimeOperandInfo {
 
     Operand::ExtraParams extraParams;
 
+    // Whether the buffer is owned by the executor and may be reallocated to fit a larger output,
+    // such as a WHILE loop body output that is reused across iterations. Buffers provided by
+    // the client are never resizable.
+    //
+    // The flag is copied along with the buffer when one RunTimeOperandInfo is assigned to
+    // another, e.g. when a WHILE loop passes body outputs on as condition and body inputs. Only
+    // operation outputs are ever reallocated, and the WHILE loop that owns the buffer keeps
+    // track of it, so an input aliasing a resizable buffer never frees or grows it.
+    bool isResizableBuffer = false;
+
     Shape shape() const {
         return {
                 .type = type,
@@ -126,6 +141,47 @@ bool setRunTimePoolInfosFromCanonicalMemories(std::vector<RunTimePoolInfo>* pool
 bool setRunTimePoolInfosFromMemoryPools(std::vector<RunTimePoolInfo>* poolInfos,
                                         const std::vector<Request::MemoryPool>& pools);
 
+// Returns the value of a constant operand of the model, or nullptr if the operand is not a
+// constant. poolInfos must be the mapped pools of the model.
+const uint8_t* getConstantOperandData(const Model& model, const Operand& operand,
+                                      const std::vector<RunTimePoolInfo>& poolInfos);
+
+// Caches the initial runtime operand information of each subgraph of a model, so that it is
+// computed once instead of every time the subgraph is run, e.g. by a WHILE operation nested in
+// the body of another WHILE loop, or by every execution of a prepared model.
+//
+// The cached information refers to the model and its memory pools. A cache is bound to the model
+// and pool infos of the first run that uses it, and must not outlive them. This class is
+// thread-safe, so a prepared model may share one cache among concurrent executions.
+class CpuExecutorSubgraphCache {
+   public:
+    // Binds the cache to the model and pool infos if it is not bound yet. Returns false if the
+    // cache is bound to a different model or pool infos.
+    bool bind(const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos);
+
+    // Returns the cached information for the subgraph, or nullptr if there is none.
+    const std::vector<RunTimeOperandInfo>* lookup(const Model::Subgraph& subgraph) const;
+
+    // Caches the information for the subgraph unless another thread has already done so, and
+    // returns the cached information.
+    const std::vector<RunTimeOperandInfo>& insert(const Model::Subgraph& subgraph,
+                                                  std::vector<RunTimeOperandInfo> operands);
+
+   private:
+    mutable std::mutex mMutex;
+    const Model* mModel = nullptr;
+    const std::vector<RunTimePoolInfo>* mModelPoolInfos = nullptr;
+    // Entries are never modified or erased once inserted, so references to them remain valid.
+    std::unordered_map<const Model::Subgraph*, std::vector<RunTimeOperandInfo>> mSubgraphs;
+};
+
+class CpuFusionPlan;
+struct CpuFusedChain;
+struct CpuKernel;
+class CpuKernelTable;
+class CpuPackedWeights;
+class CpuStaticShapes;
+
 // This class is used to execute a model on the CPU.
 class CpuExecutor {
    public:
@@ -158,9 +214,49 @@ class CpuExecutor {
     void setDeadline(const TimePoint& deadline) { mDeadline = deadline; }
     void setLoopTimeout(uint64_t duration) { mLoopTimeoutDuration = duration; }
 
+    // Shares the initial subgraph runtime info among executions of the same model. If no cache
+    // is set, or the cache is bound to a different model, the executor uses a private cache
+    // that lives for the duration of run() if the model has referenced subgraphs.
+    void setSubgraphCache(std::shared_ptr<CpuExecutorSubgraphCache> cache) {
+        mSubgraphCache = std::move(cache);
+    }
+
+    // Lets kernels use the constant inputs packed when the model was prepared. The packed weights
+    // are ignored if they were created from a different model or pool infos.
+    void setPackedWeights(std::shared_ptr<const CpuPackedWeights> packedWeights) {
+        mPackedWeights = std::move(packedWeights);
+    }
+
+    // Runs the chains of elementwise operations found when the model was prepared as single loops.
+    // The plan is ignored if it was created from a different model, and while profiling, so that
+    // every operation is measured.
+    void setFusionPlan(std::shared_ptr<const CpuFusionPlan> fusionPlan) {
+        mFusionPlan = std::move(fusionPlan);
+    }
+
+    // Skips prepare() of the operations whose output shapes were inferred when the model was
+    // prepared. The shapes are ignored if they were inferred for a different model.
+    void setStaticShapes(std::shared_ptr<const CpuStaticShapes> staticShapes) {
+        mStaticShapes = std::move(staticShapes);
+    }
+
+    // Runs the operations with the kernels resolved when the model was prepared. The table is
+    // ignored if it was created from a different model.
+    void setKernelTable(std::shared_ptr<const CpuKernelTable> kernelTable) {
+        mKernelTable = std::move(kernelTable);
+    }
+
+    // Records the wall time, operand sizes and allocations of every operation run by the executor
+    // into the profiler. Profiling is disabled if the profiler is nullptr, which is the default.
+    void setProfiler(std::shared_ptr<CpuExecutorProfiler> profiler) {
+        mProfiler = std::move(profiler);
+    }
+
    private:
-    // Creates runtime info from what's in the model.
+    // Creates runtime info from what's in the model, reusing the cached info if available.
     std::vector<RunTimeOperandInfo> initializeRunTimeInfo(const Model::Subgraph& subgraph);
+    // Computes runtime info from what's in the model.
+    std::vector<RunTimeOperandInfo> computeRunTimeInfo(const Model::Subgraph& subgraph) const;
     // Adjusts the runtime info for the arguments passed to the model,
     // modifying the buffer location, and possibly the dimensions.
     void updateForArguments(const std::vector<uint32_t>& indexes,
@@ -169,8 +265,30 @@ class CpuExecutor {
                             RunTimeOperandInfo* operands);
     // Runs one subgraph.
     int executeSubgraph(const Model::Subgraph& subgraph, RunTimeOperandInfo* operands);
-    // Runs one operation of the graph.
-    int executeOperation(const Operation& operation, RunTimeOperandInfo* operands);
+    // Runs one operation of the graph. If hasStaticShapes is true, the output shapes of the
+    // operation are already in the runtime info, and prepare() is skipped. If kernel is not
+    // nullptr, it is the kernel of the operation resolved when the model was prepared.
+    int executeOperation(const Operation& operation, RunTimeOperandInfo* operands,
+                         bool hasStaticShapes = false, const CpuKernel* kernel = nullptr);
+    // Runs one operation of the graph with its registered kernel. Returns false on failure, and
+    // stores the result code, if any, in *result.
+    bool executeKernel(const CpuKernel& kernel, const Operation& operation,
+                       RunTimeOperandInfo* operands, bool hasStaticShapes, int* result);
+    // Returns true if the output shapes of the operation were inferred when the model was prepared
+    // and its operands are still those they were inferred for.
+    bool hasStaticShapes(const Model::Subgraph& subgraph, uint32_t operationIndex,
+                         const RunTimeOperandInfo* operands) const;
+    // Runs the operations of a fused chain starting at operations[0] as one loop. Returns
+    // std::nullopt without running anything if the runtime shapes of the operands do not allow it.
+    std::optional<int> executeFusedChain(const CpuFusedChain& chain, const Operation* operations,
+                                         RunTimeOperandInfo* operands);
+    // Returns execute(), which runs the operationCount operations of the subgraph starting at
+    // operationIndex, or returns std::nullopt without running them. If mProfiler is set, records
+    // the operations that ran into it as one profile.
+    template <typename Execute>
+    std::optional<int> executeProfiled(const Model::Subgraph& subgraph, uint32_t operationIndex,
+                                       uint32_t operationCount, RunTimeOperandInfo* operands,
+                                       const Execute& execute);
     int executeIfOperation(const Operation& operation, RunTimeOperandInfo* operands);
     int executeWhileOperation(const Operation& operation, RunTimeOperandInfo* operands);
 
@@ -181,7 +299,30 @@ class CpuExecutor {
     // The fields are only valid while run() is being executed.
     const uint8_t* mModelOperandValues = nullptr;
     const std::vector<RunTimePoolInfo>* mModelPoolInfos = nullptr;
+    const Model::Subgraph* mMainSubgraph = nullptr;
     const std::vector<Model::Subgraph>* mReferencedSubgraphs = nullptr;
+    const CpuPackedWeights* mModelPackedWeights = nullptr;
+    const CpuFusionPlan* mModelFusionPlan = nullptr;
+    const CpuStaticShapes* mModelStaticShapes = nullptr;
+    const CpuKernelTable* mModelKernelTable = nullptr;
+
+    // Initial runtime info of the subgraphs of the model.
+    std::shared_ptr<CpuExecutorSubgraphCache> mSubgraphCache;
+
+    // Kernel-ready copies of the constant inputs of the model.
+    std::shared_ptr<const CpuPackedWeights> mPackedWeights;
+
+    // Chains of elementwise operations of the model to run fused.
+    std::shared_ptr<const CpuFusionPlan> mFusionPlan;
+
+    // Operations of the model whose output shapes are inferred once.
+    std::shared_ptr<const CpuStaticShapes> mStaticShapes;
+
+    // Kernels of the operations of the model.
+    std::shared_ptr<const CpuKernelTable> mKernelTable;
+
+    // Receives the per-operation measurements if profiling is enabled.
+    std::shared_ptr<CpuExecutorProfiler> mProfiler;
 
     // The output operand shapes returning to the runtime.
     std::vector<OutputShape> mOutputShapes;
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_EXECUTOR_PROFILER_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_EXECUTOR_PROFILER_H
+
+#include <android-base/thread_annotations.h>
+#include <nnapi/Types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace android {
+namespace nn {
+
+// The measurements of one operation run by a CpuExecutor, or of a chain of operations that the
+// CpuExecutor fused and ran as one.
+struct CpuOperationProfile {
+    // The type of the operation, or of the first operation of a fused chain.
+    OperationType type;
+    // The subgraph of the operation: 0 for the main subgraph, i + 1 for the referenced subgraph i.
+    uint32_t subgraphIndex;
+    // The index of the operation within its subgraph.
+    uint32_t operationIndex;
+    // The number of operations measured: 1, or the length of the fused chain starting at
+    // operationIndex.
+    uint32_t operationCount;
+    // When the operation started, relative to the creation of the profiler.
+    std::chrono::nanoseconds start;
+    // The wall time of the operation. For IF and WHILE, this includes the operations of the
+    // subgraphs they run, which are recorded separately.
+    std::chrono::nanoseconds duration;
+    // The sizes of the input and output operands of the operation. For a fused chain, the inputs
+    // are those not computed by the chain and the outputs are those of its last operation.
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    // The buffers allocated for outputs by setInfoAndAllocateIfNeeded.
+    uint32_t allocations;
+    uint64_t bytesAllocated;
+};
+
+// CpuExecutorProfiler collects the per-operation measurements of the CpuExecutors it is attached
+// to, see CpuExecutor::setProfiler. It keeps a summary per operation of every run and the
+// individual measurements of up to maxRecordedOperations operations, which can be exported as a
+// Chrome trace (chrome://tracing or https://ui.perfetto.dev).
+//
+// Profiling costs two clock reads and a short critical section per operation. This class is
+// thread-safe, so one profiler may be attached to concurrent executions.
+class CpuExecutorProfiler {
+   public:
+    static constexpr size_t kDefaultMaxRecordedOperations = 64 * 1024;
+
+    explicit CpuExecutorProfiler(size_t maxRecordedOperations = kDefaultMaxRecordedOperations);
+
+    void record(const CpuOperationProfile& profile);
+
+    // Returns the time elapsed since the creation of the profiler.
+    std::chrono::nanoseconds now() const;
+
+    // The aggregated measurements of one operation of the model, or of one fused chain.
+    struct Summary {
+        OperationType type;
+        uint32_t subgraphIndex;
+        uint32_t operationIndex;
+        uint32_t operationCount;
+        uint64_t count = 0;
+        std::chrono::nanoseconds totalDuration{0};
+        std::chrono::nanoseconds maxDuration{0};
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+        uint64_t allocations = 0;
+        uint64_t bytesAllocated = 0;
+    };
+
+    // Returns the summaries of all operations that have run, sorted by decreasing total duration.
+    std::vector<Summary> getSummaries() const;
+
+    // Returns the recorded operations in the order they finished.
+    std::vector<CpuOperationProfile> getRecordedOperations() const;
+
+    // Returns the number of operations that were not recorded individually because
+    // maxRecordedOperations was reached. They are still part of the summaries.
+    uint64_t getDroppedOperationCount() const;
+
+    // Returns the recorded operations in the Chrome trace event JSON format.
+    std::string toChromeTrace() const;
+
+    // Returns a table of the summaries, one line per operation.
+    std::string toSummaryTable() const;
+
+    // Discards all measurements.
+    void clear();
+
+   private:
+    using Key = std::tuple<uint32_t, uint32_t, OperationType, uint32_t>;
+
+    const std::chrono::steady_clock::time_point kStartTime;
+    const size_t kMaxRecordedOperations;
+
+    mutable std::mutex mMutex;
+    std::vector<CpuOperationProfile> mRecordedOperations GUARDED_BY(mMutex);
+    std::map<Key, Summary> mSummaries GUARDED_BY(mMutex);
+    uint64_t mDroppedOperationCount GUARDED_BY(mMutex) = 0;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_EXECUTOR_PROFILER_H
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_FUSION_PLAN_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_FUSION_PLAN_H
+
+#include <nnapi/Types.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "OperationsExecutionUtils.h"
+
+namespace android {
+namespace nn {
+
+// An elementwise operation applied to the value computed by a fused chain.
+struct CpuFusedStep {
+    enum class Kind { ADD, SUB, MUL, DIV, RELU, RELU1, RELU6, LOGISTIC, TANH };
+    Kind kind;
+
+    // For ADD, SUB, MUL and DIV: the other input of the operation, whether the value is its first
+    // input, and the range the fused activation clamps the result to.
+    uint32_t otherOperand = 0;
+    bool valueIsFirst = true;
+    float activationMin = 0.0f;
+    float activationMax = 0.0f;
+
+    bool isBinary() const {
+        return kind == Kind::ADD || kind == Kind::SUB || kind == Kind::MUL || kind == Kind::DIV;
+    }
+};
+
+// A chain of consecutive elementwise operations of a subgraph where each operation only consumes
+// the output of the previous one, such as ADD followed by RELU, MUL followed by ADD, LOGISTIC
+// followed by MUL (swish), or DEQUANTIZE followed by float operations and QUANTIZE. CpuExecutor
+// runs a chain as a single loop over its input, so the intermediate results never reach memory.
+struct CpuFusedChain {
+    // The float buffer of the other input of a binary step, which is broadcast along the leading
+    // dimensions of the value, and its number of elements.
+    struct Operand {
+        const float* buffer = nullptr;
+        uint32_t count = 0;
+    };
+
+    // Computes the chain over count elements of the input. others[i] is the other input of
+    // steps[i], and is ignored for unary steps.
+    void compute(const uint8_t* input, const Shape& inputShape, const std::vector<Operand>& others,
+                 uint8_t* output, const Shape& outputShape, uint32_t count) const;
+
+    uint32_t operationCount = 0;
+    uint32_t inputOperand = 0;
+    uint32_t outputOperand = 0;
+    // Whether the chain starts with DEQUANTIZE of a quant8 input, and ends with QUANTIZE to a
+    // quant8 output. Otherwise the input and the output are float32.
+    bool dequantizesInput = false;
+    bool quantizesOutput = false;
+    std::vector<CpuFusedStep> steps;
+};
+
+// The fused chains of the subgraphs of a model, found once when the model is prepared. The chains
+// are identified by the address of their subgraph, so the plan must not outlive the model it was
+// created from. This class is immutable once created, so a prepared model may share it among
+// concurrent executions.
+class CpuFusionPlan {
+   public:
+    static std::shared_ptr<const CpuFusionPlan> create(const Model& model);
+
+    // Returns true if the plan was created from this model.
+    bool isFor(const Model& model) const { return &model == mModel; }
+
+    // Returns the chain starting at the operation of the subgraph, or nullptr if there is none.
+    const CpuFusedChain* lookup(const Model::Subgraph& subgraph, uint32_t operationIndex) const;
+
+    // Returns the number of chains and of the operations they contain.
+    size_t getFusedChainCount() const { return mChains.size(); }
+    size_t getFusedOperationCount() const { return mFusedOperationCount; }
+
+   private:
+    using Key = std::pair<const Model::Subgraph*, uint32_t>;
+
+    explicit CpuFusionPlan(const Model* model) : mModel(model) {}
+
+    void addChains(const Model::Subgraph& subgraph, const Model::OperandValues& operandValues);
+
+    const Model* const mModel;
+    std::map<Key, CpuFusedChain> mChains;
+    size_t mFusedOperationCount = 0;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_FUSION_PLAN_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_KERNEL_TABLE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_KERNEL_TABLE_H
+
+#include <nnapi/Types.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "OperationResolver.h"
+#include "OperationsExecutionUtils.h"
+
+namespace android {
+namespace nn {
+
+// The implementation of an operation registered with an IOperationResolver. The prepare and
+// execute functions of the registration are called directly if they are plain function pointers,
+// which is the case for the builtin operations, instead of through std::function.
+struct CpuKernel {
+    using Function = bool (*)(IOperationExecutionContext*);
+
+    // Returns the kernel of the registration, which may be nullptr if the operation is not
+    // registered.
+    static CpuKernel create(const OperationRegistration* registration);
+
+    bool prepare(IOperationExecutionContext* context) const {
+        return prepareFunction != nullptr ? prepareFunction(context)
+                                          : registration->prepare(context);
+    }
+    bool execute(IOperationExecutionContext* context) const {
+        return executeFunction != nullptr ? executeFunction(context)
+                                          : registration->execute(context);
+    }
+
+    const OperationRegistration* registration = nullptr;
+    Function prepareFunction = nullptr;
+    Function executeFunction = nullptr;
+    bool allowOmittedOperand = false;
+    bool allowZeroSizedInput = false;
+};
+
+// The kernels of the operations of all subgraphs of a model, resolved once when the model is
+// prepared, so that CpuExecutor neither dispatches on the operation type nor looks the operation
+// up in the resolver on every run. Operations that CpuExecutor implements itself, such as IF,
+// WHILE and the operations that are not registered, have kernels without registration.
+//
+// The kernels of a subgraph are identified by its address, so the table must not outlive the
+// model it was created from, and the resolver must outlive the table. This class is immutable
+// once created, so a prepared model may share it among concurrent executions.
+class CpuKernelTable {
+   public:
+    static std::shared_ptr<const CpuKernelTable> create(
+            const Model& model,
+            const IOperationResolver* operationResolver = BuiltinOperationResolver::get());
+
+    // Returns true if the table was created from this model.
+    bool isFor(const Model& model) const { return &model == mModel; }
+
+    // Returns the kernels of the operations of the subgraph, in the order of the operations.
+    const std::vector<CpuKernel>& getKernels(const Model::Subgraph& subgraph) const;
+
+    // Returns the number of operations that have a registered kernel.
+    size_t getRegisteredCount() const { return mRegisteredCount; }
+
+   private:
+    explicit CpuKernelTable(const Model* model) : mModel(model) {}
+
+    void addSubgraph(const Model::Subgraph& subgraph, const IOperationResolver& operationResolver);
+
+    const Model* const mModel;
+    std::map<const Model::Subgraph*, std::vector<CpuKernel>> mKernels;
+    size_t mRegisteredCount = 0;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_KERNEL_TABLE_H
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_PACKED_WEIGHTS_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_PACKED_WEIGHTS_H
+
+#include <nnapi/Types.h>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+#include "CpuExecutor.h"
+#include "OperationsExecutionUtils.h"
+
+namespace android {
+namespace nn {
+
+// Kernel-ready copies of the constant inputs of the operations of a model, computed once when the
+// model is prepared so that kernels do not transform the same weights on every execution, e.g.
+// the int8 filter of CONV_2D converted to uint8, or the right-hand side of BATCH_MATMUL
+// transposed. Kernels retrieve the packed copies with
+// IOperationExecutionContext::getPackedInputBuffer.
+//
+// A packed copy is identified by the location and the dimensions of the constant values it was
+// computed from, which do not change for a model and its memory pools. The dimensions are part of
+// the identity because operands of different shapes may alias the same values, and a layout such
+// as TRANSPOSED_ROWS_COLUMNS depends on the shape. The packed weights must therefore not outlive
+// the model and pool infos they were created from. This class is immutable once created, so a
+// prepared model may share it among concurrent executions.
+//
+// A compilation cache may store the packed copies next to the constant values, and later refer to
+// them in the mapped cache file with createFromCache instead of packing the constants again.
+class CpuPackedWeights {
+   public:
+    // A packed copy stored in memory pool 0 of a model: the values of the constant of the given
+    // type and dimensions at constantOffset, with constantLength bytes, packed in the given layout
+    // into packedSize bytes at packedOffset.
+    struct CachedCopy {
+        OperandType type;
+        uint32_t constantOffset;
+        uint32_t constantLength;
+        std::vector<uint32_t> dimensions;
+        PackedLayout layout;
+        uint32_t packedOffset;
+        uint32_t packedSize;
+    };
+
+    // Packs the constant inputs of the operations of all subgraphs of the model that a kernel
+    // consumes in a packed layout.
+    static std::shared_ptr<const CpuPackedWeights> create(
+            const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos);
+
+    // Refers to the packed copies in memory pool 0 of the model, without copying them. The model
+    // must have been validated. Copies that do not fit in the pool, or whose size is not the
+    // getPackedSize of their constant, are ignored, and so their constants are not packed.
+    static std::shared_ptr<const CpuPackedWeights> createFromCache(
+            const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos,
+            const std::vector<CachedCopy>& copies);
+
+    // Returns the size in bytes of the values of a constant of the given type and dimensions,
+    // with length bytes, packed in the layout, or std::nullopt if it cannot be packed in it.
+    static std::optional<size_t> getPackedSize(OperandType type,
+                                               const std::vector<uint32_t>& dimensions,
+                                               uint32_t length, PackedLayout layout);
+
+    // Returns true if the packed weights were created from this model and pool infos.
+    bool isFor(const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos) const {
+        return &model == mModel && &modelPoolInfos == mModelPoolInfos;
+    }
+
+    // Returns the constant values at buffer, with the given dimensions, packed in the given layout,
+    // or nullptr if they have not been packed.
+    const void* lookup(const void* buffer, uint32_t length, const std::vector<uint32_t>& dimensions,
+                       PackedLayout layout) const;
+
+    // Returns the number of packed copies and their total size in bytes.
+    size_t getPackedCount() const { return mPacked.size(); }
+    size_t getPackedBytes() const { return mPackedBytes; }
+
+   private:
+    using Key = std::tuple<const void*, uint32_t, std::vector<uint32_t>, PackedLayout>;
+    // Refers to the dimensions instead of copying them, for lookups without allocation.
+    using KeyView = std::tuple<const void*, uint32_t, const std::vector<uint32_t>&, PackedLayout>;
+    // Packed values stored in a memory pool of the model, such as a mapped cache file.
+    struct PoolValues {
+        const uint8_t* data() const { return bytes; }
+        size_t size() const { return byteCount; }
+        const uint8_t* bytes;
+        size_t byteCount;
+    };
+    using Values = std::variant<std::vector<uint8_t>, std::vector<float>, PoolValues>;
+
+    CpuPackedWeights(const Model* model, const std::vector<RunTimePoolInfo>* modelPoolInfos)
+        : mModel(model), mModelPoolInfos(modelPoolInfos) {}
+
+    // Packs the constant operand in the layout unless it has already been packed.
+    void pack(const Operand& operand, PackedLayout layout);
+    const uint8_t* getConstantBuffer(const Operand& operand) const;
+
+    const Model* const mModel;
+    const std::vector<RunTimePoolInfo>* const mModelPoolInfos;
+    std::map<Key, Values, std::less<>> mPacked;
+    size_t mPackedBytes = 0;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_PACKED_WEIGHTS_H
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_STATIC_SHAPES_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_STATIC_SHAPES_H
+
+#include <nnapi/Types.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "CpuExecutor.h"
+#include "OperationResolver.h"
+
+namespace android {
+namespace nn {
+
+// The operations of the main subgraph of a model whose prepare() was run once when the model was
+// prepared, so that CpuExecutor only runs their execute(). An operation qualifies if the model
+// fully specifies the dimensions of its inputs and outputs, its prepare() succeeds without reading
+// the values of inputs that are not constants, and the output shapes it computes are those of the
+// model. Its prepare() then validates the same shapes and constants, and computes the same output
+// shapes, on every run.
+//
+// CpuExecutor still runs prepare() if the runtime dimensions of an operand of the operation differ
+// from those of the model. The plan must not outlive the model and pool infos it was created from.
+// This class is immutable once created, so a prepared model may share it among concurrent
+// executions.
+class CpuStaticShapes {
+   public:
+    static std::shared_ptr<const CpuStaticShapes> create(
+            const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos,
+            const IOperationResolver* operationResolver = BuiltinOperationResolver::get());
+
+    // Returns true if the shapes were inferred for this model.
+    bool isFor(const Model& model) const { return &model == mModel; }
+
+    // Returns true if the output shapes of the operation of the subgraph were inferred.
+    bool isStatic(const Model::Subgraph& subgraph, uint32_t operationIndex) const {
+        return &subgraph == &mModel->main && mIsStatic[operationIndex];
+    }
+
+    // Returns the number of operations whose output shapes were inferred.
+    size_t getStaticOperationCount() const { return mStaticOperationCount; }
+
+   private:
+    explicit CpuStaticShapes(const Model* model)
+        : mModel(model), mIsStatic(model->main.operations.size(), false) {}
+
+    const Model* const mModel;
+    std::vector<bool> mIsStatic;
+    size_t mStaticOperationCount = 0;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_CPU_STATIC_SHAPES_H
@@ -282,6 +282,12 @@ enum class FenceState {
 };
 FenceState syncWait(int fd, int timeout);
 
+// Like syncWait(), but also returns FenceState::ERROR for a sync file that has been signaled with
+// an error status, which syncWait() returns as FenceState::SIGNALED. The runtime uses this to wait
+// for the fences of executions, so that an execution that signaled its fence with an error is not
+// mistaken for a successful one.
+FenceState syncWaitWithStatus(int fd, int timeout);
+
 #ifdef NN_DEBUGGABLE
 uint32_t getProp(const char* str, uint32_t defaultValue = 0);
 #endif  // NN_DEBUGGABLE
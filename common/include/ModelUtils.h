@@ -34,6 +34,20 @@ namespace android::nn {
  */
 void removeDeadOperands(Model* model);
 
+/**
+ * @brief Removes all dead operations from the main subgraph.
+ *
+ * An operation is dead if none of its outputs is an output of the main subgraph or an input of an
+ * operation that is not dead. The operands referenced only by the removed operations are left in
+ * the model, so removeDeadOperands should be called afterwards to keep the model valid.
+ *
+ * @pre model != nullptr
+ *
+ * @param model The model to have dead operations removed.
+ * @return The number of operations removed.
+ */
+uint32_t removeDeadOperations(Model* model);
+
 }  // namespace android::nn
 
 #endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_MODEL_UTILS_H
@@ -35,6 +35,18 @@ enum PaddingScheme {
     kPaddingValid = 2,
 };
 
+// The kernel-ready layouts in which a constant input may be packed at preparation time, see
+// CpuPackedWeights and IOperationExecutionContext::getPackedInputBuffer.
+enum class PackedLayout {
+    // TENSOR_QUANT8_ASYMM_SIGNED values converted by convertInt8ToUInt8. The zero point of the
+    // packed values is the zero point of the input plus 128.
+    UINT8_FROM_INT8,
+    // TENSOR_FLOAT16 values widened to float.
+    FLOAT32_FROM_FLOAT16,
+    // The last two dimensions swapped, i.e. every matrix of the input transposed.
+    TRANSPOSED_ROWS_COLUMNS,
+};
+
 // Provides inputs and outputs during operation execution.
 class IOperationExecutionContext {
    public:
@@ -57,11 +69,22 @@ class IOperationExecutionContext {
     virtual bool isOmittedInput(uint32_t index) const = 0;
     virtual bool isOmittedOutput(uint32_t index) const = 0;
 
+    // Returns the constant input packed in the given layout at preparation time, or nullptr if
+    // it has not been packed, in which case the kernel must transform the input itself.
+    virtual const void* getPackedInputBuffer(uint32_t /*index*/, PackedLayout /*layout*/) const {
+        return nullptr;
+    }
+
     template <typename T>
     const T* getInputBuffer(uint32_t index) const {
         return reinterpret_cast<const T*>(getInputBuffer(index));
     }
 
+    template <typename T>
+    const T* getPackedInputBuffer(uint32_t index, PackedLayout layout) const {
+        return reinterpret_cast<const T*>(getPackedInputBuffer(index, layout));
+    }
+
     template <typename T>
     T* getOutputBuffer(uint32_t index) {
         return reinterpret_cast<T*>(getOutputBuffer(index));
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_PRIORITY_THREAD_POOL_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_PRIORITY_THREAD_POOL_H
+
+#include <android-base/thread_annotations.h>
+#include <nnapi/Types.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace android {
+namespace nn {
+
+// A bounded pool of worker threads for asynchronous work, such as the executions and model
+// preparations that drivers run after returning to their caller. Tasks run in Priority order.
+// Within a priority, tasks with a deadline run earliest deadline first and before the tasks
+// without one, which run in the order they were scheduled. Worker threads are started on demand,
+// up to maxThreads, and then kept for later tasks.
+//
+// A task whose deadline has passed by the time a worker takes it is dropped: its onDeadlineMissed
+// callback runs instead, so that the work which can no longer be useful does not delay the rest.
+//
+// At most maxQueuedTasks tasks wait for a worker. Scheduling more blocks the caller until a task
+// is dequeued, so that a client submitting work faster than it completes is slowed down instead
+// of growing the queue without bound. A task must therefore not schedule into its own pool.
+//
+// Destroying the pool runs the queued tasks and joins the worker threads. This class is
+// thread-safe.
+class PriorityThreadPool {
+   public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        // Number of tasks that have run to completion.
+        uint64_t completedTasks = 0;
+        // Number of tasks dropped because their deadline passed while they were queued.
+        uint64_t droppedTasks = 0;
+        // Number of tasks that completed after their deadline.
+        uint64_t lateTasks = 0;
+        // Number of calls to schedule() that had to wait for the queue to have room.
+        uint64_t blockedSchedules = 0;
+        // Time the dequeued tasks spent waiting for a worker.
+        Duration totalQueueTime{};
+        Duration maxQueueTime{};
+    };
+
+    PriorityThreadPool(uint32_t maxThreads, uint32_t maxQueuedTasks);
+    ~PriorityThreadPool();
+
+    PriorityThreadPool(const PriorityThreadPool&) = delete;
+    PriorityThreadPool& operator=(const PriorityThreadPool&) = delete;
+
+    // Queues the task to run on a worker thread. Blocks while the queue is full.
+    void schedule(Priority priority, Task task);
+
+    // Queues the task to run on a worker thread before the deadline, if it has one. Runs
+    // onDeadlineMissed on a worker thread instead if the deadline passes before the task starts.
+    // Blocks while the queue is full.
+    void schedule(Priority priority, const OptionalTimePoint& deadline, Task task,
+                  Task onDeadlineMissed);
+
+    Stats getStats() const;
+
+   private:
+    struct QueuedTask {
+        Task task;
+        Task onDeadlineMissed;
+        OptionalTimePoint deadline;
+        TimePoint queueTime;
+    };
+
+    void run();
+
+    const uint32_t kMaxThreads;
+    const uint32_t kMaxQueuedTasks;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mTaskQueued;
+    std::condition_variable mTaskDequeued;
+    // Indexed by Priority.
+    std::array<std::deque<QueuedTask>, 3> mQueues GUARDED_BY(mMutex);
+    uint32_t mQueuedTasks GUARDED_BY(mMutex) = 0;
+    uint32_t mBusyThreads GUARDED_BY(mMutex) = 0;
+    bool mStopping GUARDED_BY(mMutex) = false;
+    Stats mStats GUARDED_BY(mMutex);
+    std::vector<std::thread> mThreads GUARDED_BY(mMutex);
+};
+
+std::ostream& operator<<(std::ostream& os, const PriorityThreadPool::Stats& stats);
+
+// Returns the pool that runs the asynchronous executions and model preparations of the drivers in
+// this process. It has one thread per hardware thread and is never destroyed.
+PriorityThreadPool* getDriverThreadPool();
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_PRIORITY_THREAD_POOL_H
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_VALIDATED_MODEL_CACHE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_VALIDATED_MODEL_CACHE_H
+
+#include <nnapi/Result.h>
+#include <nnapi/Types.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace android {
+namespace nn {
+
+// Remembers the models validated by this process, so that a model handed from one stage of a
+// compilation to the next, such as from the runtime to the CPU device or to an in-process driver,
+// is validated once. A model is identified by a SHA-256 fingerprint of everything validate()
+// checks, which excludes the values of constant operands, so that the copies of a model made by
+// each stage are recognized. Its memory pools must also be the objects it was validated with.
+//
+// Only models that pass validation are remembered, and the models validated first are forgotten
+// once there are kMaxEntries of them. This class is thread-safe.
+class ValidatedModelCache {
+   public:
+    using Fingerprint = CacheToken;
+
+    static constexpr size_t kMaxEntries = 64;
+
+    static ValidatedModelCache* get();
+
+    // Returns the same result as validate(model), without validating the model again if an
+    // identical model was validated before.
+    Result<Version> validate(const Model& model);
+
+    // Returns the version of the model if an identical model was validated before.
+    std::optional<Version> lookup(const Model& model) const;
+
+    // Returns the fingerprint of the model, or std::nullopt if it could not be computed.
+    static std::optional<Fingerprint> makeFingerprint(const Model& model);
+
+    size_t size() const;
+    void clear();
+
+   private:
+    struct Entry {
+        Version version;
+        std::vector<std::weak_ptr<const Memory>> pools;
+    };
+
+    std::optional<Version> lookup(const Model& model, const Fingerprint& fingerprint) const;
+
+    mutable std::mutex mMutex;
+    std::map<Fingerprint, Entry> mEntries;
+    // Fingerprints of mEntries, in the order they were validated.
+    std::deque<Fingerprint> mOrder;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_COMMON_VALIDATED_MODEL_CACHE_H
@@ -47,6 +47,7 @@ static int property_get(const char* key, char* value, const char* default_value)
 #include <algorithm>
 #include <chrono>
 #include <memory>
+#include <string>
 
 namespace android {
 
@@ -66,7 +67,8 @@ BlobCache::BlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize
       mPolicySelect(policy.first),
       mPolicyCapacity(policy.second),
       mTotalSize(0),
-      mAccessCount(0) {
+      mAccessCount(0),
+      mInflation(0) {
     int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
 #ifdef _WIN32
     srand(now);
@@ -78,7 +80,19 @@ BlobCache::BlobCache(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize
     ALOGV("initializing random seed using %lld", (unsigned long long)now);
 }
 
-void BlobCache::set(const void* key, size_t keySize, const void* value, size_t valueSize) {
+void BlobCache::set(const void* key, size_t keySize, const void* value, size_t valueSize,
+                    uint64_t cost) {
+    setBlobs(nullptr, key, keySize, value, valueSize, cost, /*fillsMiss=*/true);
+}
+
+void BlobCache::setInPlace(const std::shared_ptr<const void>& owner, const void* key,
+                           size_t keySize, const void* value, size_t valueSize, uint64_t cost) {
+    setBlobs(owner, key, keySize, value, valueSize, cost, /*fillsMiss=*/false);
+}
+
+void BlobCache::setBlobs(const std::shared_ptr<const void>& owner, const void* key,
+                         size_t keySize, const void* value, size_t valueSize, uint64_t cost,
+                         bool fillsMiss) {
     if (mMaxKeySize < keySize) {
         ALOGV("set: not caching because the key is too large: %zu (limit: %zu)", keySize,
               mMaxKeySize);
@@ -104,6 +118,11 @@ void BlobCache::set(const void* key, size_t keySize, const void* value, size_t v
         return;
     }
 
+    auto makeBlob = [&owner](const void* data, size_t size) {
+        return owner ? std::make_shared<Blob>(data, size, owner)
+                     : std::make_shared<Blob>(data, size, true);
+    };
+
     std::shared_ptr<Blob> dummyKey(new Blob(key, keySize, false));
     CacheEntry dummyEntry(dummyKey, NULL, 0);
 
@@ -111,8 +130,8 @@ void BlobCache::set(const void* key, size_t keySize, const void* value, size_t v
         auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), dummyEntry);
         if (index == mCacheEntries.end() || dummyEntry < *index) {
             // Create a new cache entry.
-            std::shared_ptr<Blob> keyBlob(new Blob(key, keySize, true));
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
+            std::shared_ptr<Blob> keyBlob = makeBlob(key, keySize);
+            std::shared_ptr<Blob> valueBlob = makeBlob(value, valueSize);
             size_t newEntrySize = keySize + valueSize;
             size_t newTotalSize = mTotalSize + newEntrySize;
             if (mMaxTotalSize < newTotalSize) {
@@ -135,13 +154,20 @@ void BlobCache::set(const void* key, size_t keySize, const void* value, size_t v
                     break;
                 }
             }
-            mCacheEntries.insert(index, CacheEntry(keyBlob, valueBlob, ++mAccessCount));
+            auto inserted =
+                    mCacheEntries.insert(index, CacheEntry(keyBlob, valueBlob, ++mAccessCount));
+            inserted->setFrequency(1);
+            inserted->setCost(cost);
+            updatePriority(*inserted);
             mTotalSize = newTotalSize;
+            if (fillsMiss) {
+                mStatistics.missBytes += valueSize;
+            }
             ALOGV("set: created new cache entry with %zu byte key and %zu byte value", keySize,
                   valueSize);
         } else {
             // Update the existing cache entry.
-            std::shared_ptr<Blob> valueBlob(new Blob(value, valueSize, true));
+            std::shared_ptr<Blob> valueBlob = makeBlob(value, valueSize);
             std::shared_ptr<Blob> oldValueBlob(index->getValue());
             size_t newTotalSize = mTotalSize + valueSize - oldValueBlob->getSize();
             if (mMaxTotalSize < newTotalSize) {
@@ -165,7 +191,8 @@ void BlobCache::set(const void* key, size_t keySize, const void* value, size_t v
                 }
             }
             index->setValue(valueBlob);
-            index->setRecency(++mAccessCount);
+            index->setCost(cost);
+            touch(*index);
             mTotalSize = newTotalSize;
             ALOGV("set: updated existing cache entry with %zu byte key and %zu byte "
                   "value",
@@ -195,6 +222,7 @@ size_t BlobCache::get(const void* key, size_t keySize, void** value,
     auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), dummyEntry);
     if (index == mCacheEntries.end() || dummyEntry < *index) {
         ALOGV("get: no cache entry found for key of size %zu", keySize);
+        mStatistics.misses++;
         *value = nullptr;
         return 0;
     }
@@ -207,7 +235,9 @@ size_t BlobCache::get(const void* key, size_t keySize, void** value,
         ALOGV("get: copying %zu bytes to caller's buffer", valueBlobSize);
         memcpy(buf, valueBlob->getData(), valueBlobSize);
         *value = buf;
-        index->setRecency(++mAccessCount);
+        mStatistics.hits++;
+        mStatistics.hitBytes += valueBlobSize;
+        touch(*index);
     } else {
         ALOGV("get: cannot allocate caller's buffer: needs %zu", valueBlobSize);
         *value = nullptr;
@@ -215,6 +245,61 @@ size_t BlobCache::get(const void* key, size_t keySize, void** value,
     return valueBlobSize;
 }
 
+size_t BlobCache::get(const void* key, size_t keySize, std::shared_ptr<const void>* value) {
+    if (mMaxKeySize < keySize) {
+        ALOGV("get: not searching because the key is too large: %zu (limit %zu)", keySize,
+              mMaxKeySize);
+        value->reset();
+        return 0;
+    }
+    std::shared_ptr<Blob> dummyKey(new Blob(key, keySize, false));
+    CacheEntry dummyEntry(dummyKey, NULL, 0);
+    auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), dummyEntry);
+    if (index == mCacheEntries.end() || dummyEntry < *index) {
+        ALOGV("get: no cache entry found for key of size %zu", keySize);
+        mStatistics.misses++;
+        value->reset();
+        return 0;
+    }
+
+    // The key was found. Share the value Blob with the caller, so that the
+    // value outlives the cache entry if the entry is evicted or replaced.
+    std::shared_ptr<Blob> valueBlob(index->getValue());
+    *value = std::shared_ptr<const void>(valueBlob, valueBlob->getData());
+    mStatistics.hits++;
+    mStatistics.hitBytes += valueBlob->getSize();
+    touch(*index);
+    return valueBlob->getSize();
+}
+
+size_t BlobCache::find(const void* key, size_t keySize, std::shared_ptr<const void>* value) const {
+    std::shared_ptr<Blob> dummyKey(new Blob(key, keySize, false));
+    CacheEntry dummyEntry(dummyKey, NULL, 0);
+    auto index = std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), dummyEntry);
+    if (index == mCacheEntries.end() || dummyEntry < *index) {
+        value->reset();
+        return 0;
+    }
+    std::shared_ptr<Blob> valueBlob(index->getValue());
+    *value = std::shared_ptr<const void>(valueBlob, valueBlob->getData());
+    return valueBlob->getSize();
+}
+
+void BlobCache::forEach(const std::function<void(const void* key, size_t keySize,
+                                                 const void* value, size_t valueSize)>& f) const {
+    for (const CacheEntry& e : mCacheEntries) {
+        std::shared_ptr<Blob> const& keyBlob = e.getKey();
+        std::shared_ptr<Blob> const& valueBlob = e.getValue();
+        f(keyBlob->getData(), keyBlob->getSize(), valueBlob->getData(), valueBlob->getSize());
+    }
+}
+
+std::string BlobCache::getBuildId() {
+    char buildId[PROPERTY_VALUE_MAX];
+    int len = property_get("ro.build.id", buildId, "");
+    return std::string(buildId, len);
+}
+
 static inline size_t align_sizet(size_t size) {
     constexpr size_t alignment = alignof(size_t) - 1;
     return (size + alignment) & ~alignment;
@@ -283,6 +368,8 @@ int BlobCache::flatten(void* buffer, size_t size) const {
 int BlobCache::unflatten(void const* buffer, size_t size) {
     // All errors should result in the BlobCache being in an empty state.
     mCacheEntries.clear();
+    mPriorities.clear();
+    mTotalSize = 0;
 
     // Read the cache header
     if (size < sizeof(Header)) {
@@ -310,6 +397,8 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
     for (size_t i = 0; i < numEntries; i++) {
         if (byteOffset + sizeof(EntryHeader) > size) {
             mCacheEntries.clear();
+            mPriorities.clear();
+            mTotalSize = 0;
             ALOGE("unflatten: not enough room for cache entry header");
             return -EINVAL;
         }
@@ -322,12 +411,14 @@ int BlobCache::unflatten(void const* buffer, size_t size) {
         size_t totalSize = align_sizet(entrySize);
         if (byteOffset + totalSize > size) {
             mCacheEntries.clear();
+            mPriorities.clear();
+            mTotalSize = 0;
             ALOGE("unflatten: not enough room for cache entry");
             return -EINVAL;
         }
 
         const uint8_t* data = eheader->mData;
-        set(data, keySize, data + keySize, valueSize);
+        setBlobs(nullptr, data, keySize, data + keySize, valueSize, 1, /*fillsMiss=*/false);
 
         byteOffset += totalSize;
     }
@@ -348,17 +439,53 @@ size_t BlobCache::findVictim() {
         case Select::RANDOM:
             return size_t(blob_random() % (mCacheEntries.size()));
         case Select::LRU:
-            return std::min_element(mCacheEntries.begin(), mCacheEntries.end(),
-                                    [](const CacheEntry& a, const CacheEntry& b) {
-                                        return a.getRecency() < b.getRecency();
-                                    }) -
-                   mCacheEntries.begin();
+        case Select::GDSF:
+            return findEntry(*mPriorities.begin()->second);
         default:
             ALOGE("findVictim: unknown mPolicySelect: %d", mPolicySelect);
             return 0;
     }
 }
 
+size_t BlobCache::findEntry(const Blob& key) const {
+    return std::lower_bound(mCacheEntries.begin(), mCacheEntries.end(), key,
+                            [](const CacheEntry& entry, const Blob& key) {
+                                return *entry.getKey() < key;
+                            }) -
+           mCacheEntries.begin();
+}
+
+void BlobCache::touch(CacheEntry& entry) {
+    entry.setRecency(++mAccessCount);
+    entry.setFrequency(entry.getFrequency() + 1);
+    updatePriority(entry);
+}
+
+void BlobCache::updatePriority(CacheEntry& entry) {
+    double priority;
+    switch (mPolicySelect) {
+        case Select::LRU:
+            priority = entry.getRecency();
+            break;
+        case Select::GDSF: {
+            const size_t size = entry.getKey()->getSize() + entry.getValue()->getSize();
+            priority = mInflation + double(entry.getFrequency()) * entry.getCost() / size;
+            break;
+        }
+        default:
+            return;
+    }
+    erasePriority(entry);
+    entry.setPriority(priority);
+    mPriorities.emplace(priority, entry.getKey().get());
+}
+
+void BlobCache::erasePriority(const CacheEntry& entry) {
+    if (!mPriorities.empty()) {
+        mPriorities.erase(std::make_pair(entry.getPriority(), entry.getKey().get()));
+    }
+}
+
 size_t BlobCache::findDownTo(size_t newEntrySize, size_t onBehalfOf) {
     auto oldEntrySize = [this, onBehalfOf]() -> size_t {
         if (onBehalfOf == NoEntry) return 0;
@@ -401,6 +528,10 @@ bool BlobCache::clean(size_t newEntrySize, size_t onBehalfOf) {
         const size_t i = findVictim();
         const CacheEntry& entry(mCacheEntries[i]);
         const size_t entrySize = entry.getKey()->getSize() + entry.getValue()->getSize();
+        if (mPolicySelect == Select::GDSF) {
+            mInflation = entry.getPriority();
+        }
+        erasePriority(entry);
         mTotalSize -= entrySize;
         mCacheEntries.erase(mCacheEntries.begin() + i);
         cleaned = true;
@@ -428,6 +559,9 @@ BlobCache::Blob::Blob(const void* data, size_t size, bool copyData)
     }
 }
 
+BlobCache::Blob::Blob(const void* data, size_t size, const std::shared_ptr<const void>& owner)
+    : mData(data), mSize(size), mOwnsData(false), mOwner(owner) {}
+
 BlobCache::Blob::~Blob() {
     if (mOwnsData) {
         free(const_cast<void*>(mData));
@@ -450,14 +584,19 @@ size_t BlobCache::Blob::getSize() const {
     return mSize;
 }
 
-BlobCache::CacheEntry::CacheEntry() : mRecency(0) {}
+BlobCache::CacheEntry::CacheEntry() : mRecency(0), mFrequency(0), mCost(0), mPriority(0) {}
 
 BlobCache::CacheEntry::CacheEntry(const std::shared_ptr<Blob>& key,
                                   const std::shared_ptr<Blob>& value, uint32_t recency)
-    : mKey(key), mValue(value), mRecency(recency) {}
+    : mKey(key), mValue(value), mRecency(recency), mFrequency(0), mCost(0), mPriority(0) {}
 
 BlobCache::CacheEntry::CacheEntry(const CacheEntry& ce)
-    : mKey(ce.mKey), mValue(ce.mValue), mRecency(ce.mRecency) {}
+    : mKey(ce.mKey),
+      mValue(ce.mValue),
+      mRecency(ce.mRecency),
+      mFrequency(ce.mFrequency),
+      mCost(ce.mCost),
+      mPriority(ce.mPriority) {}
 
 bool BlobCache::CacheEntry::operator<(const CacheEntry& rhs) const {
     return *mKey < *rhs.mKey;
@@ -467,6 +606,9 @@ const BlobCache::CacheEntry& BlobCache::CacheEntry::operator=(const CacheEntry&
     mKey = rhs.mKey;
     mValue = rhs.mValue;
     mRecency = rhs.mRecency;
+    mFrequency = rhs.mFrequency;
+    mCost = rhs.mCost;
+    mPriority = rhs.mPriority;
     return *this;
 }
 
@@ -490,4 +632,28 @@ void BlobCache::CacheEntry::setRecency(uint32_t recency) {
     mRecency = recency;
 }
 
+uint32_t BlobCache::CacheEntry::getFrequency() const {
+    return mFrequency;
+}
+
+void BlobCache::CacheEntry::setFrequency(uint32_t frequency) {
+    mFrequency = frequency;
+}
+
+uint64_t BlobCache::CacheEntry::getCost() const {
+    return mCost;
+}
+
+void BlobCache::CacheEntry::setCost(uint64_t cost) {
+    mCost = cost;
+}
+
+double BlobCache::CacheEntry::getPriority() const {
+    return mPriority;
+}
+
+void BlobCache::CacheEntry::setPriority(double priority) {
+    mPriority = priority;
+}
+
 }  // namespace android
@@ -21,6 +21,8 @@
 
 #include <functional>
 #include <memory>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -39,6 +41,11 @@ class BlobCache {
         RANDOM,  // evict random entries
         LRU,     // evict least-recently-used entries
 
+        // evict entries with the lowest Greedy-Dual-Size-Frequency priority,
+        // which favors keeping entries that are small, frequently accessed,
+        // and expensive to recreate (see set's cost argument)
+        GDSF,
+
         DEFAULT = RANDOM,
     };
 
@@ -64,6 +71,32 @@ class BlobCache {
 
     static Policy defaultPolicy() { return Policy(Select::DEFAULT, Capacity::DEFAULT); }
 
+    // Statistics counts the lookups of the cache, for tuning its size and
+    // policy.
+    struct Statistics {
+        // hits and misses count the calls to get that retrieved a value and
+        // that did not find the key, respectively.  Calls to get that find
+        // the key but cannot return the value, e.g. because the buffer is too
+        // small, are not counted.
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        // hitBytes is the total size of the values found by get.
+        uint64_t hitBytes = 0;
+
+        // missBytes is the total size of the values inserted by set for keys
+        // that were not in the cache.  The size of a value that is not found is
+        // only known once the caller has created the value and inserted it.
+        uint64_t missBytes = 0;
+
+        double hitRate() const {
+            return hits + misses == 0 ? 0.0 : double(hits) / (hits + misses);
+        }
+        double byteHitRate() const {
+            return hitBytes + missBytes == 0 ? 0.0 : double(hitBytes) / (hitBytes + missBytes);
+        }
+    };
+
     // Create an empty blob cache. The blob cache will cache key/value pairs
     // with key and value sizes less than or equal to maxKeySize and
     // maxValueSize, respectively. The total combined size of ALL cache entries
@@ -81,12 +114,31 @@ class BlobCache {
     // will be in the cache after set returns.  Note, however, that a subsequent
     // call to set may evict old key/value pairs from the cache.
     //
+    // cost is the cost of recreating the value if it is evicted, e.g. the time
+    // it took to compile it, in any unit used consistently.  Only the
+    // Select::GDSF policy takes it into account.
+    //
     // Preconditions:
     //   key != NULL
     //   0 < keySize
     //   value != NULL
     //   0 < valueSize
-    void set(const void* key, size_t keySize, const void* value, size_t valueSize);
+    void set(const void* key, size_t keySize, const void* value, size_t valueSize,
+             uint64_t cost = 1);
+
+    // setInPlace behaves like set, except that neither the key nor the value
+    // is copied.  The cache entry refers to them in place and holds a
+    // reference to owner for as long as it does, so the key and value must
+    // remain valid and unmodified for as long as owner is alive.  This lets a
+    // cache file that has been mapped into memory be loaded without copying
+    // its contents.  Entries inserted by setInPlace do not count as misses in
+    // the statistics.
+    //
+    // Preconditions:
+    //   owner != NULL
+    //   the preconditions of set
+    void setInPlace(const std::shared_ptr<const void>& owner, const void* key, size_t keySize,
+                    const void* value, size_t valueSize, uint64_t cost = 1);
 
     // get retrieves from the cache the binary value associated with a given
     // binary key.  If the key is present in the cache then the length of the
@@ -136,6 +188,37 @@ class BlobCache {
         return size;
     }
 
+    // get retrieves from the cache the binary value associated with a given
+    // binary key without copying it.  If the key is present in the cache then
+    // *value is set to point to the cached value and the length of the value is
+    // returned.  The value remains valid for as long as *value refers to it,
+    // even if the entry is later evicted or replaced.  If the key is not
+    // present in the cache then *value is reset and 0 is returned.
+    //
+    //   Preconditions:
+    //     key != NULL
+    //     0 < keySize
+    //     value != NULL
+    size_t get(const void* key, size_t keySize, std::shared_ptr<const void>* value);
+
+    // find behaves like the variant of get above, except that it does not
+    // count as an access of the entry, either for the eviction policy or in
+    // the statistics.
+    size_t find(const void* key, size_t keySize, std::shared_ptr<const void>* value) const;
+
+    // forEach calls f with the key and value of every entry in the cache.  The
+    // cache must not be modified from within f.
+    void forEach(const std::function<void(const void* key, size_t keySize, const void* value,
+                                          size_t valueSize)>& f) const;
+
+    // getStatistics returns the lookup statistics since the cache was
+    // created.
+    const Statistics& getStatistics() const { return mStatistics; }
+
+    // getBuildId returns the build id of the device.  Serialized caches record
+    // it so that they can be invalidated when the build is updated.
+    static std::string getBuildId();
+
     // getFlattenedSize returns the number of bytes needed to store the entire
     // serialized cache.
     size_t getFlattenedSize() const;
@@ -191,10 +274,35 @@ class BlobCache {
     // to have some effect, and false otherwise.
     bool isCleanable() const;
 
+    // setBlobs implements set and setInPlace.  If owner is NULL then the key
+    // and value are copied; otherwise they are referred to in place.
+    // fillsMiss indicates whether a new entry counts towards missBytes.
+    void setBlobs(const std::shared_ptr<const void>& owner, const void* key, size_t keySize,
+                  const void* value, size_t valueSize, uint64_t cost, bool fillsMiss);
+
     // findVictim selects an entry to remove from the cache.  The
-    // cache must not be empty.
+    // cache must not be empty.  Selection takes O(log n) time for
+    // every policy.
     size_t findVictim();
 
+    class Blob;
+    class CacheEntry;
+
+    // findEntry returns the index of the entry with the given key, which
+    // must be in the cache.
+    size_t findEntry(const Blob& key) const;
+
+    // touch records an access of entry: it updates the recency and
+    // frequency of the entry, and its priority.
+    void touch(CacheEntry& entry);
+
+    // updatePriority recomputes the eviction priority of entry according to
+    // mPolicySelect, and updates mPriorities accordingly.
+    void updatePriority(CacheEntry& entry);
+
+    // erasePriority removes entry from mPriorities.
+    void erasePriority(const CacheEntry& entry);
+
     // findDownTo determines how far to clean the cache -- until it
     // results in a total size that does not exceed the return value
     // of findDownTo.  newEntrySize and onBehalfOf have the same
@@ -205,6 +313,8 @@ class BlobCache {
     class Blob {
        public:
         Blob(const void* data, size_t size, bool copyData);
+        // Refers to data in place, keeping owner alive as long as the Blob.
+        Blob(const void* data, size_t size, const std::shared_ptr<const void>& owner);
         ~Blob();
 
         bool operator<(const Blob& rhs) const;
@@ -226,6 +336,10 @@ class BlobCache {
         // mOwnsData indicates whether or not this Blob object should free the
         // memory pointed to by mData when the Blob gets destructed.
         bool mOwnsData;
+
+        // mOwner keeps the memory pointed to by mData alive when the Blob
+        // refers to data in place, e.g. within a memory-mapped cache file.
+        std::shared_ptr<const void> mOwner;
     };
 
     // A CacheEntry is a single key/value pair in the cache.
@@ -247,6 +361,15 @@ class BlobCache {
         uint32_t getRecency() const;
         void setRecency(uint32_t recency);
 
+        uint32_t getFrequency() const;
+        void setFrequency(uint32_t frequency);
+
+        uint64_t getCost() const;
+        void setCost(uint64_t cost);
+
+        double getPriority() const;
+        void setPriority(double priority);
+
        private:
         // mKey is the key that identifies the cache entry.
         std::shared_ptr<Blob> mKey;
@@ -257,6 +380,18 @@ class BlobCache {
         // mRecency is the last "time" (as indicated by
         // BlobCache::mAccessCount) that this entry was accessed.
         uint32_t mRecency;
+
+        // mFrequency is the number of times this entry was accessed since it
+        // was added to the cache.
+        uint32_t mFrequency;
+
+        // mCost is the cost of recreating the value, as passed to set.
+        uint64_t mCost;
+
+        // mPriority is the eviction priority of this entry, as recorded in
+        // BlobCache::mPriorities.  Entries with lower priorities are evicted
+        // first.
+        double mPriority;
     };
 
     // A Header is the header for the entire BlobCache serialization format. No
@@ -339,6 +474,21 @@ class BlobCache {
     // recently an entry was accessed, for the Select::LRU policy.
     uint32_t mAccessCount;
 
+    // mInflation is the "L" value of the Select::GDSF policy: the priority of
+    // the most recently evicted entry.  It is added to the priority of every
+    // entry when the entry is accessed, so that entries which were accessed
+    // frequently in the past but not recently eventually age out.
+    double mInflation;
+
+    // mPriorities orders the cache entries by eviction priority, so that the
+    // entry to evict can be found in O(log n) time.  Each element pairs the
+    // priority of an entry with the key of the entry; the key makes the
+    // element unique.  It is empty for the Select::RANDOM policy.
+    std::set<std::pair<double, const Blob*>> mPriorities;
+
+    // mStatistics counts the lookups of the cache.
+    Statistics mStatistics;
+
     // mRandState is the pseudo-random number generator state. It is passed to
     // nrand48 to generate random numbers when needed.
     unsigned short mRandState[3];
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "BlobCache.h"
+
+namespace android {
+namespace {
+
+const size_t kMaxKeySize = 64;
+const size_t kMaxValueSize = 64 * 1024 * 1024;
+const size_t kMaxTotalSize = 128 * 1024 * 1024;
+
+const char kKey[] = "benchmark-key";
+
+// Value sizes range from a small blob to a large compiled model.
+void ValueSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(16)->Range(4 * 1024, 16 * 1024 * 1024);
+}
+
+void BM_BlobCacheSet(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    for (auto _ : state) {
+        cache.set(kKey, sizeof(kKey), value.data(), value.size());
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_BlobCacheSet)->Apply(ValueSizes);
+
+void BM_BlobCacheGetCopy(benchmark::State& state) {
+    std::vector<uint8_t> value(state.range(0), 0x5a);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    cache.set(kKey, sizeof(kKey), value.data(), value.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(kKey, sizeof(kKey), value.data(), value.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_BlobCacheGetCopy)->Apply(ValueSizes);
+
+void BM_BlobCacheGetShared(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    cache.set(kKey, sizeof(kKey), value.data(), value.size());
+    std::shared_ptr<const void> shared;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(kKey, sizeof(kKey), &shared));
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_BlobCacheGetShared)->Apply(ValueSizes);
+
+// Measures the lookup cost with many small entries in the cache.
+void BM_BlobCacheGetManyEntries(benchmark::State& state) {
+    const size_t numEntries = state.range(0);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    for (uint32_t i = 0; i < numEntries; i++) {
+        cache.set(&i, sizeof(i), "value", 5);
+    }
+    uint32_t key = 0;
+    std::shared_ptr<const void> value;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.get(&key, sizeof(key), &value));
+        key = (key + 1) % numEntries;
+    }
+}
+BENCHMARK(BM_BlobCacheGetManyEntries)->RangeMultiplier(16)->Range(16, 64 * 1024);
+
+// Measures serializing a cache holding one entry, which is what NNCache did on
+// every save before it appended records to the cache file.
+void BM_BlobCacheFlatten(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    cache.set(kKey, sizeof(kKey), value.data(), value.size());
+    std::vector<uint8_t> flattened(cache.getFlattenedSize());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.flatten(flattened.data(), flattened.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_BlobCacheFlatten)->Apply(ValueSizes);
+
+// Measures deserializing a cache holding one entry, which copies the value.
+// This is what NNCache did on every load before it mapped the cache file.
+void BM_BlobCacheUnflatten(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    BlobCache cache(kMaxKeySize, kMaxValueSize, kMaxTotalSize, BlobCache::defaultPolicy());
+    cache.set(kKey, sizeof(kKey), value.data(), value.size());
+    std::vector<uint8_t> flattened(cache.getFlattenedSize());
+    cache.flatten(flattened.data(), flattened.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.unflatten(flattened.data(), flattened.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_BlobCacheUnflatten)->Apply(ValueSizes);
+
+// Measures inserting into a full cache of small entries, so that every set
+// evicts an entry, with the Select policy given by the first argument and the
+// number of entries given by the second.
+void BM_BlobCacheSetWithEviction(benchmark::State& state) {
+    const BlobCache::Policy policy(static_cast<BlobCache::Select>(state.range(0)),
+                                   BlobCache::Capacity::FIT);
+    const uint32_t numEntries = state.range(1);
+    const size_t entrySize = sizeof(uint32_t) + 4;
+    BlobCache cache(kMaxKeySize, kMaxValueSize, numEntries * entrySize, policy);
+    uint32_t key = 0;
+    for (; key < numEntries; key++) {
+        cache.set(&key, sizeof(key), "value", 4);
+    }
+    for (auto _ : state) {
+        cache.set(&key, sizeof(key), "value", 4);
+        key++;
+    }
+}
+BENCHMARK(BM_BlobCacheSetWithEviction)
+        ->ArgNames({"select", "entries"})
+        ->ArgsProduct({{static_cast<int>(BlobCache::Select::RANDOM),
+                        static_cast<int>(BlobCache::Select::LRU),
+                        static_cast<int>(BlobCache::Select::GDSF)},
+                       {1024, 16 * 1024}});
+
+// A TraceRequest is a lookup of a compiled model in a synthetic trace.
+struct TraceRequest {
+    uint32_t model;
+    size_t size;
+    uint64_t cost;
+};
+
+// makeTrace creates a trace of lookups of compiled models.  Model popularity
+// follows a Zipf-like distribution, sizes are log-uniform, and compilation
+// costs grow with size but vary by an order of magnitude between models.
+std::vector<TraceRequest> makeTrace(size_t* workingSetSize) {
+    static const uint32_t kNumModels = 512;
+    static const size_t kNumRequests = 16 * 1024;
+    std::mt19937 randomEngine(kNumModels /* seed */);
+    std::uniform_real_distribution<double> logSize(std::log(1024.0), std::log(1024.0 * 1024));
+    std::uniform_real_distribution<double> logCostFactor(std::log(0.1), std::log(10.0));
+    std::vector<size_t> sizes(kNumModels);
+    std::vector<uint64_t> costs(kNumModels);
+    std::vector<double> popularity(kNumModels);
+    *workingSetSize = 0;
+    for (uint32_t i = 0; i < kNumModels; i++) {
+        sizes[i] = std::exp(logSize(randomEngine));
+        costs[i] = std::sqrt(sizes[i]) * std::exp(logCostFactor(randomEngine));
+        popularity[i] = 1.0 / std::pow(i + 1, 0.9);
+        *workingSetSize += sizeof(i) + sizes[i];
+    }
+    std::shuffle(popularity.begin(), popularity.end(), randomEngine);
+    std::discrete_distribution<uint32_t> pick(popularity.begin(), popularity.end());
+    std::vector<TraceRequest> trace(kNumRequests);
+    for (TraceRequest& request : trace) {
+        request.model = pick(randomEngine);
+        request.size = sizes[request.model];
+        request.cost = costs[request.model];
+    }
+    return trace;
+}
+
+// Replays the synthetic trace against a cache a quarter the size of the
+// working set with the Select policy given by the argument.  Each miss is
+// followed by inserting the model, as a compilation would.  Reports the hit
+// rate, the byte hit rate, and the fraction of the compilation cost saved.
+void BM_BlobCacheReplay(benchmark::State& state) {
+    const BlobCache::Policy policy(static_cast<BlobCache::Select>(state.range(0)),
+                                   BlobCache::Capacity::FIT);
+    size_t workingSetSize;
+    const std::vector<TraceRequest> trace = makeTrace(&workingSetSize);
+    const std::vector<uint8_t> value(1024 * 1024, 0x5a);
+    BlobCache::Statistics statistics;
+    uint64_t totalCost = 0, savedCost = 0;
+    for (auto _ : state) {
+        BlobCache cache(kMaxKeySize, kMaxValueSize, workingSetSize / 4, policy);
+        totalCost = savedCost = 0;
+        std::shared_ptr<const void> found;
+        for (const TraceRequest& request : trace) {
+            totalCost += request.cost;
+            if (cache.get(&request.model, sizeof(request.model), &found)) {
+                savedCost += request.cost;
+            } else {
+                cache.set(&request.model, sizeof(request.model), value.data(), request.size,
+                          request.cost);
+            }
+        }
+        statistics = cache.getStatistics();
+    }
+    state.counters["hit_rate"] = statistics.hitRate();
+    state.counters["byte_hit_rate"] = statistics.byteHitRate();
+    state.counters["cost_saved"] = double(savedCost) / totalCost;
+}
+BENCHMARK(BM_BlobCacheReplay)
+        ->ArgName("select")
+        ->Arg(static_cast<int>(BlobCache::Select::RANDOM))
+        ->Arg(static_cast<int>(BlobCache::Select::LRU))
+        ->Arg(static_cast<int>(BlobCache::Select::GDSF))
+        ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
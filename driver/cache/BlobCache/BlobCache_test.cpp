@@ -20,11 +20,14 @@
 #include <gtest/gtest.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <random>
+#include <string>
 
 namespace android {
 
@@ -60,7 +63,11 @@ INSTANTIATE_TEST_SUITE_P(
                 BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT),
 
                 BlobCache::Policy(BlobCache::Select::RANDOM, BlobCache::Capacity::FIT_HALVE),
-                BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT_HALVE)));
+                BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT_HALVE),
+
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::HALVE),
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::FIT),
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::FIT_HALVE)));
 
 TEST_P(BlobCacheTest, CacheSingleValueSucceeds) {
     unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
@@ -489,6 +496,163 @@ TEST_P(BlobCacheTest, ExceedingTotalLimitRemovesLRUEntries) {
     }
 }
 
+TEST_P(BlobCacheTest, SharedGetReturnsValueWithoutCopying) {
+    mBC->set("abcd", 4, "efgh", 4);
+    sp<const void> value;
+    ASSERT_EQ(size_t(4), mBC->get("abcd", 4, &value));
+    ASSERT_NE(nullptr, value);
+    ASSERT_EQ(0, memcmp("efgh", value.get(), 4));
+
+    sp<const void> sameValue;
+    ASSERT_EQ(size_t(4), mBC->get("abcd", 4, &sameValue));
+    ASSERT_EQ(value.get(), sameValue.get());
+}
+
+TEST_P(BlobCacheTest, SharedGetMissResetsValue) {
+    sp<const void> value = std::make_shared<int>(0);
+    ASSERT_EQ(size_t(0), mBC->get("abcd", 4, &value));
+    ASSERT_EQ(nullptr, value);
+}
+
+TEST_P(BlobCacheTest, SharedGetValueOutlivesEntry) {
+    mBC->set("abcd", 4, "efgh", 4);
+    sp<const void> value;
+    ASSERT_EQ(size_t(4), mBC->get("abcd", 4, &value));
+
+    // Replacing the entry does not affect the value already retrieved.
+    mBC->set("abcd", 4, "ijkl", 4);
+    ASSERT_EQ(0, memcmp("efgh", value.get(), 4));
+
+    // Neither does destroying the cache.
+    mBC.reset();
+    ASSERT_EQ(0, memcmp("efgh", value.get(), 4));
+}
+
+TEST_P(BlobCacheTest, SetInPlaceDoesNotCopy) {
+    static const char data[] = "abcdefgh";
+    auto owner = std::make_shared<int>(0);
+    mBC->setInPlace(owner, data, 4, data + 4, 4);
+    // Both the key and the value refer to the owner.
+    ASSERT_EQ(3, owner.use_count());
+
+    sp<const void> value;
+    ASSERT_EQ(size_t(4), mBC->get("abcd", 4, &value));
+    ASSERT_EQ(static_cast<const void*>(data + 4), value.get());
+
+    // The owner is kept alive by the retrieved value after the cache is gone.
+    mBC.reset();
+    ASSERT_EQ(2, owner.use_count());
+    value.reset();
+    ASSERT_EQ(1, owner.use_count());
+}
+
+TEST_P(BlobCacheTest, SetInPlaceHonorsLimits) {
+    static const char data[] = "abcdefghijklmnop";
+    auto owner = std::make_shared<int>(0);
+    mBC->setInPlace(owner, data, MAX_KEY_SIZE + 1, data, 1);
+    mBC->setInPlace(owner, data, 1, data, MAX_VALUE_SIZE + 1);
+    ASSERT_EQ(1, owner.use_count());
+    ASSERT_EQ(size_t(0), mBC->get(data, 1, NULL, 0));
+}
+
+TEST_P(BlobCacheTest, ForEachVisitsAllEntries) {
+    mBC->set("ab", 2, "cd", 2);
+    mBC->set("ef", 2, "ghi", 3);
+    std::map<std::string, std::string> entries;
+    mBC->forEach([&entries](const void* key, size_t keySize, const void* value,
+                            size_t valueSize) {
+        entries[std::string(static_cast<const char*>(key), keySize)] =
+                std::string(static_cast<const char*>(value), valueSize);
+    });
+    const std::map<std::string, std::string> expected = {{"ab", "cd"}, {"ef", "ghi"}};
+    ASSERT_EQ(expected, entries);
+}
+
+TEST_P(BlobCacheTest, ExceedingTotalLimitKeepsCostlyEntries) {
+    if (GetParam().first != BlobCache::Select::GDSF) return;  // test doesn't apply for this policy
+
+    // Fill up the entire cache with 1 char key/value pairs, one of which is
+    // much more expensive to recreate than the others.
+    static const int maxEntries = MAX_TOTAL_SIZE / 2;
+    static const uint8_t costlyKey = maxEntries / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        mBC->set(&k, 1, "x", 1, k == costlyKey ? 100 : 1);
+    }
+
+    // Insert one more entry, causing a cache overflow.
+    {
+        uint8_t k = maxEntries;
+        mBC->set(&k, 1, "x", 1);
+    }
+
+    uint8_t k = costlyKey;
+    ASSERT_EQ(size_t(1), mBC->get(&k, 1, NULL, 0));
+}
+
+TEST_P(BlobCacheTest, ExceedingTotalLimitKeepsFrequentlyUsedEntries) {
+    if (GetParam().first != BlobCache::Select::GDSF) return;  // test doesn't apply for this policy
+
+    // Fill up the entire cache with 1 char key/value pairs, and access the
+    // first one repeatedly.
+    static const int maxEntries = MAX_TOTAL_SIZE / 2;
+    for (int i = 0; i < maxEntries; i++) {
+        uint8_t k = i;
+        mBC->set(&k, 1, "x", 1);
+    }
+    for (int i = 0; i < 3; i++) {
+        uint8_t k = 0;
+        uint8_t buf[1];
+        mBC->get(&k, 1, buf, 1);
+    }
+
+    // Insert one more entry, causing a cache overflow.
+    {
+        uint8_t k = maxEntries;
+        mBC->set(&k, 1, "x", 1);
+    }
+
+    uint8_t k = 0;
+    ASSERT_EQ(size_t(1), mBC->get(&k, 1, NULL, 0));
+}
+
+TEST_P(BlobCacheTest, ExceedingTotalLimitEvictsLargeEntriesFirst) {
+    if (GetParam().first != BlobCache::Select::GDSF) return;  // test doesn't apply for this policy
+
+    // With equal costs, a large entry frees the most space per unit of cost.
+    mBC->set("a", 1, "xxxxxxx", 7);
+    mBC->set("b", 1, "x", 1);
+    mBC->set("c", 1, "x", 1);
+    mBC->set("d", 1, "xx", 2);
+
+    ASSERT_EQ(size_t(0), mBC->get("a", 1, NULL, 0));
+    ASSERT_EQ(size_t(1), mBC->get("b", 1, NULL, 0));
+    ASSERT_EQ(size_t(1), mBC->get("c", 1, NULL, 0));
+    ASSERT_EQ(size_t(2), mBC->get("d", 1, NULL, 0));
+}
+
+TEST_P(BlobCacheTest, StatisticsCountLookups) {
+    uint8_t buf[4];
+    sp<const void> value;
+    mBC->set("ab", 2, "cd", 2);
+    mBC->get("ab", 2, buf, sizeof(buf));
+    mBC->get("ab", 2, &value);
+    mBC->get("ef", 2, buf, sizeof(buf));
+    mBC->set("ef", 2, "ghij", 4);
+
+    // Neither size queries nor replacements count.
+    mBC->get("ab", 2, NULL, 0);
+    mBC->set("ab", 2, "xy", 2);
+
+    const BlobCache::Statistics& statistics = mBC->getStatistics();
+    ASSERT_EQ(uint64_t(2), statistics.hits);
+    ASSERT_EQ(uint64_t(1), statistics.misses);
+    ASSERT_EQ(uint64_t(4), statistics.hitBytes);
+    ASSERT_EQ(uint64_t(6), statistics.missBytes);
+    ASSERT_DOUBLE_EQ(2.0 / 3.0, statistics.hitRate());
+    ASSERT_DOUBLE_EQ(0.4, statistics.byteHitRate());
+}
+
 class BlobCacheFlattenTest : public BlobCacheTest {
    protected:
     virtual void SetUp() {
@@ -522,7 +686,11 @@ INSTANTIATE_TEST_SUITE_P(
                 BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT),
 
                 BlobCache::Policy(BlobCache::Select::RANDOM, BlobCache::Capacity::FIT_HALVE),
-                BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT_HALVE)));
+                BlobCache::Policy(BlobCache::Select::LRU, BlobCache::Capacity::FIT_HALVE),
+
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::HALVE),
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::FIT),
+                BlobCache::Policy(BlobCache::Select::GDSF, BlobCache::Capacity::FIT_HALVE)));
 
 TEST_P(BlobCacheFlattenTest, FlattenOneValue) {
     unsigned char buf[4] = {0xee, 0xee, 0xee, 0xee};
@@ -535,6 +703,12 @@ TEST_P(BlobCacheFlattenTest, FlattenOneValue) {
     ASSERT_EQ('h', buf[3]);
 }
 
+TEST_P(BlobCacheFlattenTest, UnflattenDoesntCountMisses) {
+    mBC->set("abcd", 4, "efgh", 4);
+    roundTrip();
+    ASSERT_EQ(uint64_t(0), mBC2->getStatistics().missBytes);
+}
+
 TEST_P(BlobCacheFlattenTest, FlattenFullCache) {
     // Fill up the entire cache with 1 char key/value pairs.
     const int maxEntries = MAX_TOTAL_SIZE / 2;
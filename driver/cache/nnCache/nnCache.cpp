@@ -19,23 +19,176 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <log/log.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <vector>
 
 // Cache file header
-static const char* cacheFileMagic = "nn$$";
-static const size_t cacheFileHeaderSize = 8;
+static const char* cacheFileMagic = "nn$2";
+static const size_t maxBuildIdLength = 92;
+
+struct CacheFileHeader {
+    char mMagic[4];
+    uint32_t mBuildIdLength;
+    char mBuildId[maxBuildIdLength];
+};
+
+// Cache file record header.  Each record holds one key/value pair, and is
+// padded to a multiple of recordAlignment bytes.
+struct CacheFileRecordHeader {
+    // mCrc is the CRC of the rest of the record header, the key and the value.
+    uint32_t mCrc;
+    uint32_t mKeySize;
+    uint64_t mValueSize;
+};
+
+static const size_t recordAlignment = 8;
 
 // The time in seconds to wait before saving newly inserted cache entries.
 static const unsigned int deferredSaveDelay = 4;
 
+// The cache file is compacted once it is this many times larger than the
+// records of the live entries.
+static const size_t maxFileSizeFactor = 2;
+
+// Writes to the cache file smaller than this are batched.
+static const size_t writeBufferSize = 64 * 1024;
+
 // ----------------------------------------------------------------------------
 namespace android {
 // ----------------------------------------------------------------------------
 
+static size_t alignRecord(size_t size) {
+    return (size + recordAlignment - 1) & ~(recordAlignment - 1);
+}
+
+static const size_t recordsOffset = alignRecord(sizeof(CacheFileHeader));
+
+static size_t getRecordSize(size_t keySize, size_t valueSize) {
+    return alignRecord(sizeof(CacheFileRecordHeader) + keySize + valueSize);
+}
+
+// crc32c processes eight bytes at a time, using one table per byte position
+// ("slicing-by-8"), as checking the records dominates the cost of loading.
+static uint32_t crc32c(uint32_t crc, const void* data, size_t len) {
+    typedef std::array<std::array<uint32_t, 256>, 8> Tables;
+    static const Tables tables = [] {
+        const uint32_t polyBits = 0x82F63B78;
+        Tables t;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i;
+            for (int j = 0; j < 8; j++) {
+                r = (r & 1) ? (r >> 1) ^ polyBits : r >> 1;
+            }
+            t[0][i] = r;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (size_t k = 1; k < t.size(); k++) {
+                t[k][i] = t[0][t[k - 1][i] & 0xFF] ^ (t[k - 1][i] >> 8);
+            }
+        }
+        return t;
+    }();
+    const uint8_t* buf = static_cast<const uint8_t*>(data);
+    for (; len >= 8; buf += 8, len -= 8) {
+        const uint32_t lo = crc ^ (buf[0] | buf[1] << 8 | buf[2] << 16 | uint32_t(buf[3]) << 24);
+        crc = tables[7][lo & 0xFF] ^ tables[6][(lo >> 8) & 0xFF] ^ tables[5][(lo >> 16) & 0xFF] ^
+              tables[4][lo >> 24] ^ tables[3][buf[4]] ^ tables[2][buf[5]] ^ tables[1][buf[6]] ^
+              tables[0][buf[7]];
+    }
+    for (; len > 0; buf++, len--) {
+        crc = tables[0][(crc ^ *buf) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t getRecordCrc(const CacheFileRecordHeader& header, const void* key,
+                             const void* value) {
+    uint32_t crc = crc32c(0, &header.mKeySize, sizeof(header.mKeySize));
+    crc = crc32c(crc, &header.mValueSize, sizeof(header.mValueSize));
+    crc = crc32c(crc, key, header.mKeySize);
+    return crc32c(crc, value, header.mValueSize);
+}
+
+static CacheFileHeader makeFileHeader() {
+    CacheFileHeader header = {};
+    memcpy(header.mMagic, cacheFileMagic, 4);
+    const std::string buildId = BlobCache::getBuildId();
+    header.mBuildIdLength = std::min(buildId.size(), maxBuildIdLength);
+    memcpy(header.mBuildId, buildId.data(), header.mBuildIdLength);
+    return header;
+}
+
+// RecordWriter writes cache file records to a file descriptor, batching small
+// writes.
+class RecordWriter {
+   public:
+    explicit RecordWriter(int fd) : mFd(fd) {}
+
+    void write(const void* data, size_t size) {
+        if (mBuffer.size() + size > writeBufferSize) {
+            flush();
+        }
+        if (size >= writeBufferSize) {
+            writeFully(data, size);
+        } else {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            mBuffer.insert(mBuffer.end(), bytes, bytes + size);
+        }
+    }
+
+    void writeRecord(const void* key, size_t keySize, const void* value, size_t valueSize) {
+        CacheFileRecordHeader header = {};
+        header.mKeySize = keySize;
+        header.mValueSize = valueSize;
+        header.mCrc = getRecordCrc(header, key, value);
+        static const uint8_t padding[recordAlignment] = {};
+        const size_t dataSize = sizeof(header) + keySize + valueSize;
+        write(&header, sizeof(header));
+        write(key, keySize);
+        write(value, valueSize);
+        write(padding, alignRecord(dataSize) - dataSize);
+    }
+
+    // flush writes any buffered data, and returns whether all writes so far
+    // succeeded.
+    bool flush() {
+        if (!mBuffer.empty()) {
+            writeFully(mBuffer.data(), mBuffer.size());
+            mBuffer.clear();
+        }
+        return mOk;
+    }
+
+   private:
+    void writeFully(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        while (mOk && size > 0) {
+            const ssize_t written = ::write(mFd, bytes, size);
+            if (written == -1) {
+                if (errno == EINTR) continue;
+                ALOGE("error writing cache file: %s (%d)", strerror(errno), errno);
+                mOk = false;
+                break;
+            }
+            bytes += written;
+            size -= written;
+        }
+    }
+
+    int mFd;
+    std::vector<uint8_t> mBuffer;
+    bool mOk = true;
+};
+
 //
 // NNCache definition
 //
@@ -45,6 +198,8 @@ NNCache::NNCache()
       mMaxValueSize(0),
       mMaxTotalSize(0),
       mPolicy(defaultPolicy()),
+      mShardCount(1),
+      mFileSize(0),
       mSavePending(false) {}
 
 NNCache::~NNCache() {}
@@ -56,39 +211,52 @@ NNCache* NNCache::get() {
 }
 
 void NNCache::initialize(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize,
-                         Policy policy) {
-    std::lock_guard<std::mutex> lock(mMutex);
+                         Policy policy, size_t shardCount) {
+    std::unique_lock<std::shared_mutex> lock(mStateMutex);
     mInitialized = true;
     mMaxKeySize = maxKeySize;
     mMaxValueSize = maxValueSize;
     mMaxTotalSize = maxTotalSize;
     mPolicy = policy;
+    mShardCount = std::max<size_t>(shardCount, 1);
 }
 
 void NNCache::terminate() {
-    std::lock_guard<std::mutex> lock(mMutex);
+    std::unique_lock<std::shared_mutex> lock(mStateMutex);
     saveBlobCacheLocked();
-    mBlobCache = NULL;
+    mShards.clear();
     mInitialized = false;
 }
 
-void NNCache::setBlob(const void* key, ssize_t keySize, const void* value, ssize_t valueSize) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
+void NNCache::setBlob(const void* key, ssize_t keySize, const void* value, ssize_t valueSize,
+                      uint64_t cost) {
     if (keySize < 0 || valueSize < 0) {
         ALOGW("nnCache::setBlob: negative sizes are not allowed");
         return;
     }
 
+    std::shared_lock<std::shared_mutex> lock = lockShards();
     if (mInitialized) {
-        BlobCache* bc = getBlobCacheLocked();
-        bc->set(key, keySize, value, valueSize);
+        Shard& shard = getShard(key, keySize);
+        {
+            std::lock_guard<std::mutex> shardLock(shard.mutex);
+            shard.blobCache->set(key, keySize, value, valueSize, cost);
+            if (!mFilename.empty()) {
+                // Remember the copy of the value made by the BlobCache for the
+                // next save, rather than copying the value again.
+                std::shared_ptr<const void> stored;
+                if (shard.blobCache->find(key, keySize, &stored) == size_t(valueSize)) {
+                    const uint8_t* keyBytes = static_cast<const uint8_t*>(key);
+                    shard.pending.push_back({std::vector<uint8_t>(keyBytes, keyBytes + keySize),
+                                             std::move(stored), size_t(valueSize)});
+                }
+            }
+        }
 
-        if (!mSavePending) {
-            mSavePending = true;
+        if (!mSavePending.exchange(true)) {
             std::thread deferredSaveThread([this]() {
                 sleep(deferredSaveDelay);
-                std::lock_guard<std::mutex> lock(mMutex);
+                std::unique_lock<std::shared_mutex> lock(mStateMutex);
                 if (mInitialized) {
                     saveBlobCacheLocked();
                 }
@@ -100,133 +268,232 @@ void NNCache::setBlob(const void* key, ssize_t keySize, const void* value, ssize
 }
 
 ssize_t NNCache::getBlob(const void* key, ssize_t keySize, void* value, ssize_t valueSize) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
     if (keySize < 0 || valueSize < 0) {
         ALOGW("nnCache::getBlob: negative sizes are not allowed");
         return 0;
     }
 
+    std::shared_lock<std::shared_mutex> lock = lockShards();
     if (mInitialized) {
-        BlobCache* bc = getBlobCacheLocked();
-        return bc->get(key, keySize, value, valueSize);
+        Shard& shard = getShard(key, keySize);
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        return shard.blobCache->get(key, keySize, value, valueSize);
     }
     return 0;
 }
 
 ssize_t NNCache::getBlob(const void* key, ssize_t keySize, void** value,
                          std::function<void*(size_t)> alloc) {
-    std::lock_guard<std::mutex> lock(mMutex);
+    if (keySize < 0) {
+        ALOGW("nnCache::getBlob: negative sizes are not allowed");
+        return 0;
+    }
 
+    std::shared_lock<std::shared_mutex> lock = lockShards();
+    if (mInitialized) {
+        Shard& shard = getShard(key, keySize);
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        return shard.blobCache->get(key, keySize, value, alloc);
+    }
+    return 0;
+}
+
+ssize_t NNCache::getBlob(const void* key, ssize_t keySize, std::shared_ptr<const void>* value) {
     if (keySize < 0) {
         ALOGW("nnCache::getBlob: negative sizes are not allowed");
+        value->reset();
         return 0;
     }
 
+    std::shared_lock<std::shared_mutex> lock = lockShards();
     if (mInitialized) {
-        BlobCache* bc = getBlobCacheLocked();
-        return bc->get(key, keySize, value, alloc);
+        Shard& shard = getShard(key, keySize);
+        std::lock_guard<std::mutex> shardLock(shard.mutex);
+        return shard.blobCache->get(key, keySize, value);
     }
+    value->reset();
     return 0;
 }
 
-void NNCache::setCacheFilename(const char* filename) {
-    std::lock_guard<std::mutex> lock(mMutex);
-    mFilename = filename;
+NNCache::Statistics NNCache::getStatistics() {
+    Statistics statistics;
+    std::shared_lock<std::shared_mutex> lock(mStateMutex);
+    for (const auto& shard : mShards) {
+        std::lock_guard<std::mutex> shardLock(shard->mutex);
+        const Statistics& shardStatistics = shard->blobCache->getStatistics();
+        statistics.hits += shardStatistics.hits;
+        statistics.misses += shardStatistics.misses;
+        statistics.hitBytes += shardStatistics.hitBytes;
+        statistics.missBytes += shardStatistics.missBytes;
+    }
+    return statistics;
 }
 
-BlobCache* NNCache::getBlobCacheLocked() {
-    if (mBlobCache == nullptr) {
-        mBlobCache.reset(new BlobCache(mMaxKeySize, mMaxValueSize, mMaxTotalSize, mPolicy));
-        loadBlobCacheLocked();
+void NNCache::setCacheFilename(const char* filename) {
+    std::unique_lock<std::shared_mutex> lock(mStateMutex);
+    if (mFilename != filename) {
+        mFilename = filename;
+        mFileSize = 0;
     }
-    return mBlobCache.get();
 }
 
-static uint32_t crc32c(const uint8_t* buf, size_t len) {
-    const uint32_t polyBits = 0x82F63B78;
-    uint32_t r = 0;
-    for (size_t i = 0; i < len; i++) {
-        r ^= buf[i];
-        for (int j = 0; j < 8; j++) {
-            if (r & 1) {
-                r = (r >> 1) ^ polyBits;
-            } else {
-                r >>= 1;
-            }
+std::shared_lock<std::shared_mutex> NNCache::lockShards() {
+    while (true) {
+        std::shared_lock<std::shared_mutex> lock(mStateMutex);
+        if (!mInitialized || !mShards.empty()) {
+            return lock;
         }
+        lock.unlock();
+
+        // The shards must be created with the state locked exclusively.  The
+        // state may change while the lock is not held, so check again.
+        std::unique_lock<std::shared_mutex> exclusiveLock(mStateMutex);
+        if (mInitialized && mShards.empty()) {
+            createShardsLocked();
+        }
+    }
+}
+
+NNCache::Shard& NNCache::getShard(const void* key, size_t keySize) {
+    if (mShards.size() == 1) {
+        return *mShards[0];
+    }
+    const std::string_view keyView(static_cast<const char*>(key), keySize);
+    return *mShards[std::hash<std::string_view>()(keyView) % mShards.size()];
+}
+
+void NNCache::createShardsLocked() {
+    const size_t shardTotalSize = mMaxTotalSize / mShardCount;
+    for (size_t i = 0; i < mShardCount; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->blobCache.reset(new BlobCache(mMaxKeySize, mMaxValueSize, shardTotalSize, mPolicy));
+        mShards.push_back(std::move(shard));
     }
-    return r;
+    loadBlobCacheLocked();
 }
 
 void NNCache::saveBlobCacheLocked() {
-    if (mFilename.length() > 0 && mBlobCache != NULL) {
-        size_t cacheSize = mBlobCache->getFlattenedSize();
-        size_t headerSize = cacheFileHeaderSize;
-        const char* fname = mFilename.c_str();
-
-        // Try to create the file with no permissions so we can write it
-        // without anyone trying to read it.
-        int fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
-        if (fd == -1) {
-            if (errno == EEXIST) {
-                // The file exists, delete it and try again.
-                if (unlink(fname) == -1) {
-                    // No point in retrying if the unlink failed.
-                    ALOGE("error unlinking cache file %s: %s (%d)", fname, strerror(errno), errno);
-                    return;
-                }
-                // Retry now that we've unlinked the file.
-                fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
-            }
-            if (fd == -1) {
-                ALOGE("error creating cache file %s: %s (%d)", fname, strerror(errno), errno);
-                return;
+    if (mFilename.length() > 0 && !mShards.empty()) {
+        size_t liveSize = recordsOffset;
+        size_t pendingSize = 0;
+        for (const auto& shard : mShards) {
+            shard->blobCache->forEach([&liveSize](const void*, size_t keySize, const void*,
+                                                  size_t valueSize) {
+                liveSize += getRecordSize(keySize, valueSize);
+            });
+            for (const PendingEntry& entry : shard->pending) {
+                pendingSize += getRecordSize(entry.key.size(), entry.valueSize);
             }
         }
 
-        size_t fileSize = headerSize + cacheSize;
-
-        uint8_t* buf = new uint8_t[fileSize];
-        if (!buf) {
-            ALOGE("error allocating buffer for cache contents: %s (%d)", strerror(errno), errno);
-            close(fd);
-            unlink(fname);
-            return;
+        if (mFileSize == 0 || mFileSize + pendingSize > liveSize * maxFileSizeFactor) {
+            rewriteCacheFileLocked();
+        } else if (pendingSize > 0 && !appendCacheFileLocked()) {
+            rewriteCacheFileLocked();
         }
+        for (const auto& shard : mShards) {
+            shard->pending.clear();
+        }
+    }
+}
 
-        int err = mBlobCache->flatten(buf + headerSize, cacheSize);
-        if (err < 0) {
-            ALOGE("error writing cache contents: %s (%d)", strerror(-err), -err);
-            delete[] buf;
-            close(fd);
-            unlink(fname);
+void NNCache::rewriteCacheFileLocked() {
+    const char* fname = mFilename.c_str();
+    mFileSize = 0;
+
+    // Try to create the file with no permissions so we can write it
+    // without anyone trying to read it.  The old file is unlinked rather than
+    // truncated, because its contents may still be mapped into memory.
+    int fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
+    if (fd == -1) {
+        if (errno == EEXIST) {
+            // The file exists, delete it and try again.
+            if (unlink(fname) == -1) {
+                // No point in retrying if the unlink failed.
+                ALOGE("error unlinking cache file %s: %s (%d)", fname, strerror(errno), errno);
+                return;
+            }
+            // Retry now that we've unlinked the file.
+            fd = open(fname, O_CREAT | O_EXCL | O_RDWR, 0);
+        }
+        if (fd == -1) {
+            ALOGE("error creating cache file %s: %s (%d)", fname, strerror(errno), errno);
             return;
         }
+    }
+
+    RecordWriter writer(fd);
+    const CacheFileHeader header = makeFileHeader();
+    static const uint8_t padding[recordAlignment] = {};
+    writer.write(&header, sizeof(header));
+    writer.write(padding, recordsOffset - sizeof(header));
+    size_t fileSize = recordsOffset;
+    for (const auto& shard : mShards) {
+        shard->blobCache->forEach([&writer, &fileSize](const void* key, size_t keySize,
+                                                       const void* value, size_t valueSize) {
+            writer.writeRecord(key, keySize, value, valueSize);
+            fileSize += getRecordSize(keySize, valueSize);
+        });
+    }
+    if (!writer.flush()) {
+        close(fd);
+        unlink(fname);
+        return;
+    }
 
-        // Write the file magic and CRC
-        memcpy(buf, cacheFileMagic, 4);
-        uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
-        *crc = crc32c(buf + headerSize, cacheSize);
+    fchmod(fd, S_IRUSR);
+    close(fd);
+    mFileSize = fileSize;
+}
 
-        if (write(fd, buf, fileSize) == -1) {
-            ALOGE("error writing cache file: %s (%d)", strerror(errno), errno);
-            delete[] buf;
-            close(fd);
-            unlink(fname);
-            return;
-        }
+bool NNCache::appendCacheFileLocked() {
+    const char* fname = mFilename.c_str();
 
-        delete[] buf;
+    // The cache file is read-only once written, and is made writable only for
+    // the duration of the append.  Records are only ever appended to it, so
+    // existing memory mappings of the file stay valid.
+    if (chmod(fname, S_IRUSR | S_IWUSR) == -1) {
+        ALOGE("error making cache file %s writable: %s (%d)", fname, strerror(errno), errno);
+        return false;
+    }
+    int fd = open(fname, O_WRONLY | O_APPEND, 0);
+    if (fd == -1) {
+        ALOGE("error opening cache file %s: %s (%d)", fname, strerror(errno), errno);
+        chmod(fname, S_IRUSR);
+        return false;
+    }
+
+    // Only append if the file still is the one last written by this process.
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == -1 || size_t(statBuf.st_size) != mFileSize) {
+        ALOGW("cache file %s changed unexpectedly", fname);
         fchmod(fd, S_IRUSR);
         close(fd);
+        return false;
+    }
+
+    RecordWriter writer(fd);
+    size_t fileSize = mFileSize;
+    for (const auto& shard : mShards) {
+        for (const PendingEntry& entry : shard->pending) {
+            writer.writeRecord(entry.key.data(), entry.key.size(), entry.value.get(),
+                               entry.valueSize);
+            fileSize += getRecordSize(entry.key.size(), entry.valueSize);
+        }
     }
+    const bool written = writer.flush();
+    fchmod(fd, S_IRUSR);
+    close(fd);
+    if (!written) {
+        return false;
+    }
+    mFileSize = fileSize;
+    return true;
 }
 
 void NNCache::loadBlobCacheLocked() {
+    mFileSize = 0;
     if (mFilename.length() > 0) {
-        size_t headerSize = cacheFileHeaderSize;
-
         int fd = open(mFilename.c_str(), O_RDONLY, 0);
         if (fd == -1) {
             if (errno != ENOENT) {
@@ -243,46 +510,64 @@ void NNCache::loadBlobCacheLocked() {
             return;
         }
 
-        // Validity check the size before trying to mmap it.
-        size_t fileSize = statBuf.st_size;
-        if (fileSize > mMaxTotalSize * 2) {
-            ALOGE("cache file is too large: %#" PRIx64, static_cast<off64_t>(statBuf.st_size));
+        const size_t fileSize = statBuf.st_size;
+        if (fileSize < recordsOffset) {
             close(fd);
             return;
         }
 
-        uint8_t* buf =
-                reinterpret_cast<uint8_t*>(mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0));
-        if (buf == MAP_FAILED) {
+        void* mapped = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
             ALOGE("error mmaping cache file: %s (%d)", strerror(errno), errno);
-            close(fd);
             return;
         }
-
-        // Check the file magic and CRC
-        size_t cacheSize = fileSize - headerSize;
-        if (memcmp(buf, cacheFileMagic, 4) != 0) {
+        // The cache entries refer to keys and values within the mapping, and
+        // the mapping is unmapped once the last of them is gone.
+        const std::shared_ptr<const void> mapping(
+                mapped, [fileSize](const void* p) { munmap(const_cast<void*>(p), fileSize); });
+        const uint8_t* buf = static_cast<const uint8_t*>(mapped);
+
+        // Check the file magic and build id.  We treat version mismatches as
+        // an empty cache.
+        const CacheFileHeader* header = reinterpret_cast<const CacheFileHeader*>(buf);
+        const CacheFileHeader expectedHeader = makeFileHeader();
+        if (memcmp(header->mMagic, cacheFileMagic, 4) != 0) {
             ALOGE("cache file has bad mojo");
-            close(fd);
             return;
         }
-        uint32_t* crc = reinterpret_cast<uint32_t*>(buf + 4);
-        if (crc32c(buf + headerSize, cacheSize) != *crc) {
-            ALOGE("cache file failed CRC check");
-            close(fd);
+        if (header->mBuildIdLength != expectedHeader.mBuildIdLength ||
+            memcmp(header->mBuildId, expectedHeader.mBuildId, header->mBuildIdLength) != 0) {
             return;
         }
 
-        int err = mBlobCache->unflatten(buf + headerSize, cacheSize);
-        if (err < 0) {
-            ALOGE("error reading cache contents: %s (%d)", strerror(-err), -err);
-            munmap(buf, fileSize);
-            close(fd);
-            return;
+        // Replay the records in order, so that later records of a key replace
+        // earlier ones.  A record that fails its checks, e.g. because an append
+        // was interrupted, ends the replay.
+        size_t offset = recordsOffset;
+        while (offset + sizeof(CacheFileRecordHeader) <= fileSize) {
+            const CacheFileRecordHeader* record =
+                    reinterpret_cast<const CacheFileRecordHeader*>(buf + offset);
+            if (record->mValueSize > fileSize ||
+                getRecordSize(record->mKeySize, record->mValueSize) > fileSize - offset) {
+                break;
+            }
+            const uint8_t* key = buf + offset + sizeof(CacheFileRecordHeader);
+            const uint8_t* value = key + record->mKeySize;
+            if (getRecordCrc(*record, key, value) != record->mCrc) {
+                break;
+            }
+            getShard(key, record->mKeySize)
+                    .blobCache->setInPlace(mapping, key, record->mKeySize, value,
+                                           record->mValueSize);
+            offset += getRecordSize(record->mKeySize, record->mValueSize);
         }
 
-        munmap(buf, fileSize);
-        close(fd);
+        if (offset == fileSize) {
+            mFileSize = fileSize;
+        } else {
+            ALOGE("cache file has a bad record at offset %zu; ignoring the rest", offset);
+        }
     }
 }
 
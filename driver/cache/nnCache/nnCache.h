@@ -17,10 +17,13 @@
 #ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_CACHE_NN_CACHE_NN_CACHE_H
 #define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_CACHE_NN_CACHE_NN_CACHE_H
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "BlobCache.h"
 
@@ -33,6 +36,7 @@ class NNCache {
     typedef BlobCache::Select Select;
     typedef BlobCache::Capacity Capacity;
     typedef BlobCache::Policy Policy;
+    typedef BlobCache::Statistics Statistics;
 
     static Policy defaultPolicy() { return BlobCache::defaultPolicy(); }
 
@@ -49,8 +53,14 @@ class NNCache {
     // less than or equal to maxKeySize and maxValueSize,
     // respectively. The total combined size of ALL cache entries (key
     // sizes plus value sizes) will not exceed maxTotalSize.
+    //
+    // The entries are spread by key over shardCount shards, each of which
+    // has its own lock and an equal share of maxTotalSize, so that lookups of
+    // different keys from different threads do not contend.  Eviction happens
+    // within a shard, so a single shard gives the exact eviction behavior of
+    // the policy over the whole cache.
     void initialize(size_t maxKeySize, size_t maxValueSize, size_t maxTotalSize,
-                    Policy policy = defaultPolicy());
+                    Policy policy = defaultPolicy(), size_t shardCount = 1);
 
     // terminate puts the NNCache back into the uninitialized state.  When
     // in this state the getBlob and setBlob methods will return without
@@ -58,7 +68,10 @@ class NNCache {
     void terminate();
 
     // setBlob attempts to insert a new key/value blob pair into the cache.
-    void setBlob(const void* key, ssize_t keySize, const void* value, ssize_t valueSize);
+    // cost is the cost of recreating the value, as for BlobCache::set.  It is
+    // not saved to disk, so entries loaded from disk have the default cost.
+    void setBlob(const void* key, ssize_t keySize, const void* value, ssize_t valueSize,
+                 uint64_t cost = 1);
 
     // getBlob attempts to retrieve the value blob associated with a given key
     // blob from cache.
@@ -69,11 +82,23 @@ class NNCache {
     ssize_t getBlob(const void* key, size_t keySize, T** value,
                     std::function<void*(size_t)> alloc) {
         void* valueVoid;
-        const ssize_t size = getBlob(key, keySize, &valueVoid, alloc);
+        const ssize_t size = getBlob(key, static_cast<ssize_t>(keySize), &valueVoid, alloc);
         *value = static_cast<T*>(valueVoid);
         return size;
     }
 
+    // getBlob attempts to retrieve the value blob associated with a given key
+    // blob from cache without copying it.  On a hit, *value is set to point to
+    // the value and the size of the value is returned.  The value remains
+    // valid for as long as *value refers to it, even if the entry is evicted
+    // or the cache is terminated.  Values loaded from the cache file point
+    // directly into a read-only memory mapping of the file.
+    ssize_t getBlob(const void* key, ssize_t keySize, std::shared_ptr<const void>* value);
+
+    // getStatistics returns the lookup statistics of the cache since it was
+    // initialized.
+    Statistics getStatistics();
+
     // setCacheFilename sets the name of the file that should be used to store
     // cache contents from one program invocation to another.
     void setCacheFilename(const char* filename);
@@ -87,18 +112,59 @@ class NNCache {
     NNCache(const NNCache&) = delete;
     void operator=(const NNCache&) = delete;
 
-    // getBlobCacheLocked returns the BlobCache object being used to store the
-    // key/value blob pairs.  If the BlobCache object has not yet been created,
-    // this will do so, loading the serialized cache contents from disk if
-    // possible.
-    BlobCache* getBlobCacheLocked();
-
-    // saveBlobCache attempts to save the current contents of mBlobCache to
-    // disk.
+    // PendingEntry is an entry that has been inserted into the cache since
+    // the cache file was last written.
+    struct PendingEntry {
+        std::vector<uint8_t> key;
+        std::shared_ptr<const void> value;
+        size_t valueSize;
+    };
+
+    // Shard is one of the independently locked parts of the cache.
+    struct Shard {
+        // mutex must be locked whenever blobCache or pending are accessed.
+        std::mutex mutex;
+
+        // blobCache is the cache in which the key/value blob pairs of this
+        // shard are stored.
+        std::unique_ptr<BlobCache> blobCache;
+
+        // pending holds the entries to be appended to the cache file on the
+        // next save, in insertion order.
+        std::vector<PendingEntry> pending;
+    };
+
+    // lockShards returns a shared lock of mStateMutex.  If the NNCache is
+    // initialized, the shards have been created and loaded from disk while
+    // the lock is held; this is done on first use.
+    std::shared_lock<std::shared_mutex> lockShards();
+
+    // getShard returns the shard that holds the given key.  mStateMutex must
+    // be locked, and the shards must have been created.
+    Shard& getShard(const void* key, size_t keySize);
+
+    // createShardsLocked creates the shards and loads the serialized cache
+    // contents from disk into them if possible.  mStateMutex must be locked
+    // exclusively.
+    void createShardsLocked();
+
+    // saveBlobCacheLocked attempts to save the entries inserted since the
+    // last save to disk, by appending them to the cache file.  The cache file
+    // is rewritten with just the live entries instead if it is not known to
+    // be valid or if it has grown too large.  mStateMutex must be locked
+    // exclusively.
     void saveBlobCacheLocked();
 
-    // loadBlobCache attempts to load the saved cache contents from disk into
-    // mBlobCache.
+    // rewriteCacheFileLocked writes all entries of the cache to a new cache
+    // file.  mStateMutex must be locked exclusively.
+    void rewriteCacheFileLocked();
+
+    // appendCacheFileLocked appends the pending entries to the cache file.
+    // mStateMutex must be locked exclusively.
+    bool appendCacheFileLocked();
+
+    // loadBlobCacheLocked attempts to load the saved cache contents from disk
+    // into the shards.  mStateMutex must be locked exclusively.
     void loadBlobCacheLocked();
 
     // mInitialized indicates whether the NNCache is in the initialized
@@ -122,10 +188,13 @@ class NNCache {
     // mPolicy is the policy for cleaning the cache.
     Policy mPolicy;
 
-    // mBlobCache is the cache in which the key/value blob pairs are stored.  It
-    // is initially NULL, and will be initialized by getBlobCacheLocked the
-    // first time it's needed.
-    std::unique_ptr<BlobCache> mBlobCache;
+    // mShardCount is the number of shards the cache is split into.
+    size_t mShardCount;
+
+    // mShards holds the shards in which the key/value blob pairs are stored.
+    // It is initially empty, and will be filled by lockShards the first time
+    // it's needed.
+    std::vector<std::unique_ptr<Shard>> mShards;
 
     // mFilename is the name of the file for storing cache contents in between
     // program invocations.  It is initialized to an empty string at
@@ -134,16 +203,23 @@ class NNCache {
     // from disk.
     std::string mFilename;
 
+    // mFileSize is the size of the cache file, if the file is known to
+    // consist only of valid records so that new records can be appended to
+    // it.  Otherwise it is 0, and the next save rewrites the file.
+    size_t mFileSize;
+
     // mSavePending indicates whether or not a deferred save operation is
     // pending.  Each time a key/value pair is inserted into the cache via
     // setBlob, a deferred save is initiated if one is not already pending.
     // This will wait some amount of time and then trigger a save of the cache
     // contents to disk.
-    bool mSavePending;
+    std::atomic<bool> mSavePending;
 
-    // mMutex is the mutex used to prevent concurrent access to the member
-    // variables. It must be locked whenever the member variables are accessed.
-    mutable std::mutex mMutex;
+    // mStateMutex guards all member variables other than the contents of the
+    // shards and mSavePending.  Lookups and insertions lock it shared, and
+    // lock the mutex of the shard of the key in addition; everything else
+    // locks it exclusively.
+    mutable std::shared_mutex mStateMutex;
 
     // sCache is the singleton NNCache object.
     static NNCache sCache;
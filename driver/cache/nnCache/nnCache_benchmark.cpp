@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <android-base/file.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "nnCache.h"
+
+namespace android {
+namespace {
+
+const size_t kMaxKeySize = 64;
+const size_t kMaxValueSize = 64 * 1024 * 1024;
+const size_t kMaxTotalSize = 256 * 1024 * 1024;
+
+const char kKey[] = "benchmark-key";
+
+// Value sizes range from a small blob to a large compiled model.
+void ValueSizes(benchmark::internal::Benchmark* b) {
+    b->RangeMultiplier(16)->Range(4 * 1024, 16 * 1024 * 1024);
+}
+
+// Measures loading a cache file holding one entry, and looking up the entry.
+void BM_NNCacheLoadAndGet(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    TemporaryFile file;
+    NNCache* cache = NNCache::get();
+    cache->setCacheFilename(file.path);
+    cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+    cache->setBlob(kKey, sizeof(kKey), value.data(), value.size());
+    cache->terminate();
+
+    for (auto _ : state) {
+        cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+        std::shared_ptr<const void> loaded;
+        benchmark::DoNotOptimize(cache->getBlob(kKey, sizeof(kKey), &loaded));
+        state.PauseTiming();
+        cache->terminate();
+        state.ResumeTiming();
+    }
+    cache->setCacheFilename("");
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_NNCacheLoadAndGet)->Apply(ValueSizes);
+
+// Measures saving a cache file that already holds an entry of the given
+// size after a small entry has been added.
+void BM_NNCacheSaveNewEntry(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    TemporaryFile file;
+    NNCache* cache = NNCache::get();
+    cache->setCacheFilename(file.path);
+    cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+    cache->setBlob(kKey, sizeof(kKey), value.data(), value.size());
+    cache->terminate();
+
+    uint32_t key = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+        cache->setBlob(&key, sizeof(key), "value", 5);
+        key++;
+        state.ResumeTiming();
+        cache->terminate();
+    }
+    cache->setCacheFilename("");
+}
+BENCHMARK(BM_NNCacheSaveNewEntry)->Apply(ValueSizes);
+
+void BM_NNCacheGetCopy(benchmark::State& state) {
+    std::vector<uint8_t> value(state.range(0), 0x5a);
+    NNCache* cache = NNCache::get();
+    cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+    cache->setBlob(kKey, sizeof(kKey), value.data(), value.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+                cache->getBlob(kKey, sizeof(kKey), value.data(), ssize_t(value.size())));
+    }
+    cache->terminate();
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_NNCacheGetCopy)->Apply(ValueSizes);
+
+void BM_NNCacheGetShared(benchmark::State& state) {
+    const std::vector<uint8_t> value(state.range(0), 0x5a);
+    NNCache* cache = NNCache::get();
+    cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize);
+    cache->setBlob(kKey, sizeof(kKey), value.data(), value.size());
+    std::shared_ptr<const void> shared;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache->getBlob(kKey, sizeof(kKey), &shared));
+    }
+    cache->terminate();
+    state.SetBytesProcessed(state.iterations() * value.size());
+}
+BENCHMARK(BM_NNCacheGetShared)->Apply(ValueSizes);
+
+// Measures concurrent lookups of different keys, with the shard count given by
+// the argument.  The cache is set up before the benchmark threads start, so
+// that no thread looks up a key before it is inserted.
+const uint32_t kNumConcurrentEntries = 1024;
+
+void SetUpConcurrentGet(const benchmark::State& state) {
+    NNCache* cache = NNCache::get();
+    cache->initialize(kMaxKeySize, kMaxValueSize, kMaxTotalSize, NNCache::defaultPolicy(),
+                      state.range(0));
+    for (uint32_t i = 0; i < kNumConcurrentEntries; i++) {
+        cache->setBlob(&i, sizeof(i), "value", 5);
+    }
+}
+
+void TearDownConcurrentGet(const benchmark::State&) {
+    NNCache::get()->terminate();
+}
+
+void BM_NNCacheConcurrentGet(benchmark::State& state) {
+    NNCache* cache = NNCache::get();
+    uint32_t key = state.thread_index();
+    std::shared_ptr<const void> value;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache->getBlob(&key, sizeof(key), &value));
+        key = (key + state.threads()) % kNumConcurrentEntries;
+    }
+}
+BENCHMARK(BM_NNCacheConcurrentGet)
+        ->Setup(SetUpConcurrentGet)
+        ->Teardown(TearDownConcurrentGet)
+        ->Arg(1)
+        ->Arg(16)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+
+}  // namespace
+}  // namespace android
+
+BENCHMARK_MAIN();
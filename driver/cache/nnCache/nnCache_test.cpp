@@ -24,9 +24,13 @@
 #include <log/log.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
 #include <memory>
+#include <thread>
+#include <vector>
 
 // Cache size limits.
 static const size_t maxKeySize = 12 * 1024;
@@ -56,7 +60,11 @@ INSTANTIATE_TEST_SUITE_P(
                           NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::FIT),
 
                           NNCache::Policy(NNCache::Select::RANDOM, NNCache::Capacity::FIT_HALVE),
-                          NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::FIT_HALVE)));
+                          NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::FIT_HALVE),
+
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::HALVE),
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::FIT),
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::FIT_HALVE)));
 
 TEST_P(NNCacheTest, UninitializedCacheAlwaysMisses) {
     uint8_t buf[4] = {0xee, 0xee, 0xee, 0xee};
@@ -172,6 +180,59 @@ TEST_P(NNCacheTest, ExceedingTotalLimitFitsBigEntry) {
     }
 }
 
+TEST_P(NNCacheTest, SharedGetBlobOutlivesTerminate) {
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    std::shared_ptr<const void> value;
+    ASSERT_EQ(4, mCache->getBlob("abcd", 4, &value));
+    mCache->terminate();
+    ASSERT_EQ(0, memcmp("efgh", value.get(), 4));
+    ASSERT_EQ(0, mCache->getBlob("abcd", 4, &value));
+    ASSERT_EQ(nullptr, value);
+}
+
+TEST_P(NNCacheTest, ShardedCacheAlwaysHits) {
+    static const size_t shardCount = 4;
+    static const int threadCount = 4;
+    static const int entriesPerThread = 64;
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam(), shardCount);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([this, t]() {
+            for (int i = 0; i < entriesPerThread; i++) {
+                const int entry = t * entriesPerThread + i;
+                mCache->setBlob(&entry, sizeof(entry), &i, sizeof(i));
+            }
+            for (int i = 0; i < entriesPerThread; i++) {
+                const int entry = t * entriesPerThread + i;
+                int value = -1;
+                EXPECT_EQ(ssize_t(sizeof(value)),
+                          mCache->getBlob(&entry, sizeof(entry), &value, sizeof(value)));
+                EXPECT_EQ(i, value);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+TEST_P(NNCacheTest, StatisticsCountLookupsOfAllShards) {
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam(), 4);
+    uint8_t buf[4];
+    for (int i = 0; i < 8; i++) {
+        mCache->setBlob(&i, sizeof(i), "efgh", 4);
+        mCache->getBlob(&i, sizeof(i), buf, sizeof(buf));
+    }
+    mCache->getBlob("abcd", 4, buf, sizeof(buf));
+
+    const NNCache::Statistics statistics = mCache->getStatistics();
+    ASSERT_EQ(uint64_t(8), statistics.hits);
+    ASSERT_EQ(uint64_t(1), statistics.misses);
+    ASSERT_EQ(uint64_t(32), statistics.hitBytes);
+}
+
 class NNCacheSerializationTest : public NNCacheTest {
    protected:
     virtual void SetUp() {
@@ -272,4 +333,105 @@ TEST_P(NNCacheSerializationTest, ReinitializedCacheContainsValuesSizeConstrained
     }
 }
 
+TEST_P(NNCacheSerializationTest, StatisticsDontCountSavedEntries) {
+    mCache->setCacheFilename(&mTempFile->path[0]);
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    ASSERT_EQ(uint64_t(0), mCache->getStatistics().hits);
+    mCache->terminate();
+
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    yesStringBlob("abcd", "efgh");
+    const NNCache::Statistics statistics = mCache->getStatistics();
+    ASSERT_EQ(uint64_t(1), statistics.hits);
+    ASSERT_EQ(uint64_t(0), statistics.missBytes);
+}
+
+TEST_P(NNCacheSerializationTest, ReinitializedCacheSharesValues) {
+    mCache->setCacheFilename(&mTempFile->path[0]);
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    mCache->terminate();
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+
+    // The value loaded from the cache file stays valid after the cache is
+    // terminated and the file is rewritten.
+    std::shared_ptr<const void> value;
+    ASSERT_EQ(4, mCache->getBlob("abcd", 4, &value));
+    mCache->terminate();
+    ASSERT_EQ(0, memcmp("efgh", value.get(), 4));
+}
+
+TEST_P(NNCacheSerializationTest, ReinitializedCacheContainsAppendedValues) {
+    mCache->setCacheFilename(&mTempFile->path[0]);
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    mCache->setBlob("ijkl", 4, "mnop", 4);
+    mCache->terminate();
+
+    // The new value of abcd and the new entry qrst are appended to the file.
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "uvwx", 4);
+    mCache->setBlob("qrst", 4, "yz", 2);
+    mCache->terminate();
+
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    yesStringBlob("abcd", "uvwx");
+    yesStringBlob("ijkl", "mnop");
+    yesStringBlob("qrst", "yz");
+}
+
+TEST_P(NNCacheSerializationTest, ReinitializedCacheContainsValuesWithShards) {
+    mCache->setCacheFilename(&mTempFile->path[0]);
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    mCache->setBlob("ijkl", 4, "mnop", 4);
+    mCache->terminate();
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam(), 4);
+    yesStringBlob("abcd", "efgh");
+    yesStringBlob("ijkl", "mnop");
+}
+
+TEST_P(NNCacheSerializationTest, TruncatedCacheFileKeepsCompleteRecords) {
+    mCache->setCacheFilename(&mTempFile->path[0]);
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("abcd", 4, "efgh", 4);
+    mCache->terminate();
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    mCache->setBlob("ijkl", 4, "mnop", 4);
+    mCache->terminate();
+
+    // Simulate an interrupted append of the second record.
+    struct stat statBuf;
+    ASSERT_EQ(0, stat(mTempFile->path, &statBuf));
+    ASSERT_EQ(0, chmod(mTempFile->path, S_IRUSR | S_IWUSR));
+    ASSERT_EQ(0, truncate(mTempFile->path, statBuf.st_size - 1));
+
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    yesStringBlob("abcd", "efgh");
+    noStringBlob("ijkl");
+
+    // The cache file is rewritten without the bad record on the next save.
+    mCache->setBlob("qrst", 4, "uvwx", 4);
+    mCache->terminate();
+    mCache->initialize(maxKeySize, maxValueSize, maxTotalSize, GetParam());
+    yesStringBlob("abcd", "efgh");
+    yesStringBlob("qrst", "uvwx");
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        Policy, NNCacheSerializationTest,
+        ::testing::Values(NNCache::Policy(NNCache::Select::RANDOM, NNCache::Capacity::HALVE),
+                          NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::HALVE),
+
+                          NNCache::Policy(NNCache::Select::RANDOM, NNCache::Capacity::FIT),
+                          NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::FIT),
+
+                          NNCache::Policy(NNCache::Select::RANDOM, NNCache::Capacity::FIT_HALVE),
+                          NNCache::Policy(NNCache::Select::LRU, NNCache::Capacity::FIT_HALVE),
+
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::HALVE),
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::FIT),
+                          NNCache::Policy(NNCache::Select::GDSF, NNCache::Capacity::FIT_HALVE)));
+
 }  // namespace android
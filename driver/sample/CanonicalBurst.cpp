@@ -16,7 +16,6 @@
 
 #include "CanonicalBurst.h"
 
-#include <DefaultExecution.h>
 #include <android-base/logging.h>
 #include <nnapi/IBurst.h>
 #include <nnapi/IPreparedModel.h>
@@ -52,8 +51,7 @@ GeneralResult<SharedExecution> Burst::createReusableExecution(
         const nn::OptionalDuration& loopTimeoutDuration,
         const std::vector<TokenValuePair>& /*hints*/,
         const std::vector<ExtensionNameAndPrefix>& /*extensionNameToPrefix*/) const {
-    return std::make_shared<DefaultExecution>(kPreparedModel, request, measure,
-                                              loopTimeoutDuration);
+    return kPreparedModel->createReusableExecution(request, measure, loopTimeoutDuration, {}, {});
 }
 
 }  // namespace android::nn::sample
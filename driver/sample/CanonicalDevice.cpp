@@ -17,6 +17,7 @@
 #include "CanonicalDevice.h"
 
 #include <Tracing.h>
+#include <ValidatedModelCache.h>
 #include <android-base/logging.h>
 #include <nnapi/IBuffer.h>
 #include <nnapi/IDevice.h>
@@ -138,8 +139,8 @@ GeneralResult<void> Device::wait() const {
 GeneralResult<std::vector<bool>> Device::getSupportedOperations(const Model& model) const {
     VLOG(DRIVER) << "sample::Device::getSupportedOperations";
 
-    // Validate arguments.
-    if (const auto result = validate(model); !result.ok()) {
+    // Validate arguments. An in-process client has usually validated the model already.
+    if (const auto result = ValidatedModelCache::get()->validate(model); !result.ok()) {
         return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
     }
 
@@ -166,8 +167,8 @@ GeneralResult<SharedPreparedModel> Device::prepareModel(
         logModelToInfo(model);
     }
 
-    // Validate arguments.
-    if (const auto result = validate(model); !result.ok()) {
+    // Validate arguments. An in-process client has usually validated the model already.
+    if (const auto result = ValidatedModelCache::get()->validate(model); !result.ok()) {
         return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << "Invalid Model: " << result.error();
     }
     if (const auto result = validate(preference); !result.ok()) {
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CanonicalExecution.h"
+
+#include <android-base/logging.h>
+#include <nnapi/IExecution.h>
+#include <nnapi/Result.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace android::nn::sample {
+
+Execution::Execution(std::shared_ptr<const PreparedModel> preparedModel, Request request,
+                     RequestPools pools, bool hasSpecifiedOutputs, MeasureTiming measure,
+                     OptionalDuration loopTimeoutDuration)
+    : kPreparedModel(std::move(preparedModel)),
+      kRequest(std::move(request)),
+      kPools(std::move(pools)),
+      kHasSpecifiedOutputs(hasSpecifiedOutputs),
+      kMeasure(measure),
+      kLoopTimeoutDuration(loopTimeoutDuration) {
+    CHECK(kPreparedModel != nullptr);
+}
+
+ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> Execution::compute(
+        const OptionalTimePoint& deadline) const {
+    return kPreparedModel->executeWithPools(kRequest, &kPools, kMeasure, deadline,
+                                            kLoopTimeoutDuration);
+}
+
+GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> Execution::computeFenced(
+        const std::vector<SyncFence>& waitFor, const OptionalTimePoint& deadline,
+        const OptionalDuration& timeoutDurationAfterFence) const {
+    if (!kHasSpecifiedOutputs) {
+        return NN_ERROR(ErrorStatus::INVALID_ARGUMENT)
+               << "sample::Execution::computeFenced called with unspecified output dimensions";
+    }
+    return kPreparedModel->executeFencedWithPools(kRequest, &kPools, waitFor, kMeasure, deadline,
+                                                  kLoopTimeoutDuration, timeoutDurationAfterFence);
+}
+
+}  // namespace android::nn::sample
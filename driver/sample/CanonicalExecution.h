@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_SAMPLE_CANONICAL_EXECUTION_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_SAMPLE_CANONICAL_EXECUTION_H
+
+#include <nnapi/IExecution.h>
+#include <nnapi/Result.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "CanonicalPreparedModel.h"
+
+namespace android::nn::sample {
+
+// Reusable execution of nn::sample::PreparedModel. The request is validated against the model and
+// its memory pools are mapped when the execution is created, so that every computation only
+// validates the device memories of the request, whose state may have changed, before it runs.
+class Execution final : public IExecution {
+   public:
+    Execution(std::shared_ptr<const PreparedModel> preparedModel, Request request,
+              RequestPools pools, bool hasSpecifiedOutputs, MeasureTiming measure,
+              OptionalDuration loopTimeoutDuration);
+
+    ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> compute(
+            const OptionalTimePoint& deadline) const override;
+
+    GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> computeFenced(
+            const std::vector<SyncFence>& waitFor, const OptionalTimePoint& deadline,
+            const OptionalDuration& timeoutDurationAfterFence) const override;
+
+   private:
+    const std::shared_ptr<const PreparedModel> kPreparedModel;
+    const Request kRequest;
+    const RequestPools kPools;
+    // Whether the request specifies the dimensions of every output, as required by
+    // computeFenced().
+    const bool kHasSpecifiedOutputs;
+    const MeasureTiming kMeasure;
+    const OptionalDuration kLoopTimeoutDuration;
+};
+
+}  // namespace android::nn::sample
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_SAMPLE_CANONICAL_EXECUTION_H
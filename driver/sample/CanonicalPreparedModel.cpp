@@ -16,7 +16,6 @@
 
 #include "CanonicalPreparedModel.h"
 
-#include <DefaultExecution.h>
 #include <Tracing.h>
 #include <nnapi/IPreparedModel.h>
 #include <nnapi/Result.h>
@@ -25,48 +24,58 @@
 #include <nnapi/Validation.h>
 
 #include <memory>
+#include <optional>
 #include <tuple>
 #include <utility>
 #include <vector>
 
 #include "CanonicalBurst.h"
 #include "CanonicalDevice.h"
+#include "CanonicalExecution.h"
 
 namespace android::nn::sample {
 namespace {
 
-GeneralResult<std::pair<std::vector<RunTimePoolInfo>, std::vector<std::shared_ptr<ManagedBuffer>>>>
-createRunTimePoolInfos(const Request& request, const BufferTracker& bufferTracker,
-                       const PreparedModel& preparedModel) {
-    std::vector<RunTimePoolInfo> requestPoolInfos;
-    std::vector<std::shared_ptr<ManagedBuffer>> bufferWrappers;
-    requestPoolInfos.reserve(request.pools.size());
-    bufferWrappers.reserve(request.pools.size());
-    for (uint32_t i = 0; i < request.pools.size(); ++i) {
-        auto& pool = request.pools[i];
+// Maps the memory pools of the request. Device memories are looked up but not validated.
+GeneralResult<RequestPools> mapRequestPools(const Request& request,
+                                            const BufferTracker& bufferTracker) {
+    RequestPools pools;
+    pools.poolInfos.reserve(request.pools.size());
+    pools.bufferWrappers.reserve(request.pools.size());
+    for (const auto& pool : request.pools) {
         if (const auto* maybeMemory = std::get_if<SharedMemory>(&pool)) {
             auto buffer = RunTimePoolInfo::createFromMemory(*maybeMemory);
             if (!buffer.has_value()) {
                 return NN_ERROR(ErrorStatus::GENERAL_FAILURE)
                        << "createRuntimeMemoriesFromMemoryPools -- could not map pools";
             }
-            requestPoolInfos.push_back(std::move(*buffer));
-            bufferWrappers.push_back(nullptr);
+            pools.poolInfos.push_back(std::move(*buffer));
+            pools.bufferWrappers.push_back(nullptr);
         } else if (const auto* maybeToken = std::get_if<Request::MemoryDomainToken>(&pool)) {
             auto bufferWrapper = bufferTracker.get(*maybeToken);
             if (bufferWrapper == nullptr) {
                 return NN_ERROR(ErrorStatus::INVALID_ARGUMENT);
             }
-            const auto validationStatus =
-                    bufferWrapper->validateRequest(i, request, &preparedModel);
-            if (validationStatus != ErrorStatus::NONE) {
-                return NN_ERROR(validationStatus);
-            }
-            requestPoolInfos.push_back(bufferWrapper->createRunTimePoolInfo());
-            bufferWrappers.push_back(std::move(bufferWrapper));
+            pools.poolInfos.push_back(bufferWrapper->createRunTimePoolInfo());
+            pools.bufferWrappers.push_back(std::move(bufferWrapper));
+        }
+    }
+    return pools;
+}
+
+// Validates the device memories of the request against their current state, which may change
+// between executions.
+GeneralResult<void> validateDeviceMemories(const Request& request, const RequestPools& pools,
+                                           const PreparedModel& preparedModel) {
+    for (uint32_t i = 0; i < pools.bufferWrappers.size(); ++i) {
+        if (pools.bufferWrappers[i] == nullptr) continue;
+        const auto validationStatus =
+                pools.bufferWrappers[i]->validateRequest(i, request, &preparedModel);
+        if (validationStatus != ErrorStatus::NONE) {
+            return NN_ERROR(validationStatus);
         }
     }
-    return std::make_pair(std::move(requestPoolInfos), std::move(bufferWrappers));
+    return {};
 }
 
 ErrorStatus updateDeviceMemories(ErrorStatus status, const Request& request,
@@ -122,7 +131,10 @@ PreparedModel::PreparedModel(Model model, ExecutionPreference preference, Priori
       kExecutionPriority(priority),
       kOperationResolver(*operationResolver),
       kBufferTracker(std::move(bufferTracker)),
-      kPoolInfos(std::move(poolInfos)) {
+      kPoolInfos(std::move(poolInfos)),
+      kPackedWeights(CpuPackedWeights::create(kModel, kPoolInfos)),
+      kStaticShapes(CpuStaticShapes::create(kModel, kPoolInfos, operationResolver)),
+      kKernelTable(CpuKernelTable::create(kModel, operationResolver)) {
     CHECK(operationResolver != nullptr);
     CHECK(kBufferTracker != nullptr);
 }
@@ -131,14 +143,22 @@ ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> PreparedModel::exec
         const Request& request, MeasureTiming measure, const OptionalTimePoint& deadline,
         const OptionalDuration& loopTimeoutDuration, const std::vector<TokenValuePair>& /*hints*/,
         const std::vector<ExtensionNameAndPrefix>& /*extensionNameToPrefix*/) const {
+    return executeWithPools(request, /*pools=*/nullptr, measure, deadline, loopTimeoutDuration);
+}
+
+ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> PreparedModel::executeWithPools(
+        const Request& request, const RequestPools* pools, MeasureTiming measure,
+        const OptionalTimePoint& deadline, const OptionalDuration& loopTimeoutDuration) const {
     NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_EXECUTION, "sample::PreparedModel::execute");
     VLOG(DRIVER) << "sample::PreparedModel::execute(" << SHOW_IF_DEBUG(request) << ")";
 
     TimePoint driverStart, driverEnd, deviceStart, deviceEnd;
     if (measure == MeasureTiming::YES) driverStart = Clock::now();
 
-    if (const auto result = validateRequestForModel(request, kModel); !result.ok()) {
-        return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
+    if (pools == nullptr) {
+        if (const auto result = validateRequestForModel(request, kModel); !result.ok()) {
+            return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
+        }
     }
     if (hasDeadlinePassed(deadline)) {
         return NN_ERROR(ErrorStatus::MISSED_DEADLINE_PERSISTENT);
@@ -146,11 +166,20 @@ ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> PreparedModel::exec
 
     NNTRACE_FULL_SWITCH(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_INPUTS_AND_OUTPUTS,
                         "sample::Device::execute");
-    const auto [requestPoolInfos, bufferWrappers] =
-            NN_TRY(createRunTimePoolInfos(request, *kBufferTracker, *this));
+    std::optional<RequestPools> mappedPools;
+    if (pools == nullptr) {
+        mappedPools = NN_TRY(mapRequestPools(request, *kBufferTracker));
+        pools = &*mappedPools;
+    }
+    NN_TRY(validateDeviceMemories(request, *pools, *this));
+    const auto& [requestPoolInfos, bufferWrappers] = *pools;
 
     NNTRACE_FULL_SWITCH(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_EXECUTION, "sample::Device::execute");
     auto executor = CpuExecutor(&kOperationResolver);
+    executor.setSubgraphCache(kSubgraphCache);
+    executor.setPackedWeights(kPackedWeights);
+    executor.setStaticShapes(kStaticShapes);
+    executor.setKernelTable(kKernelTable);
     if (loopTimeoutDuration.has_value()) {
         executor.setLoopTimeout(loopTimeoutDuration->count());
     }
@@ -192,6 +221,16 @@ GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> PreparedModel::ex
         const OptionalDuration& timeoutDurationAfterFence,
         const std::vector<TokenValuePair>& /*hints*/,
         const std::vector<ExtensionNameAndPrefix>& /*extensionNameToPrefix*/) const {
+    return executeFencedWithPools(request, /*pools=*/nullptr, waitFor, measure, deadline,
+                                  loopTimeoutDuration, timeoutDurationAfterFence);
+}
+
+GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>>
+PreparedModel::executeFencedWithPools(const Request& request, const RequestPools* pools,
+                                      const std::vector<SyncFence>& waitFor, MeasureTiming measure,
+                                      const OptionalTimePoint& deadline,
+                                      const OptionalDuration& loopTimeoutDuration,
+                                      const OptionalDuration& timeoutDurationAfterFence) const {
     NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_EXECUTION,
                  "sample::PreparedModel::executeFenced");
     VLOG(DRIVER) << "executeFenced(" << SHOW_IF_DEBUG(request) << ")";
@@ -199,10 +238,12 @@ GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> PreparedModel::ex
     TimePoint driverStart, driverEnd, deviceStart, deviceEnd;
     if (measure == MeasureTiming::YES) driverStart = Clock::now();
 
-    if (const auto result =
-                validateRequestForModel(request, kModel, /*allowUnspecifiedOutput=*/false);
-        !result.ok()) {
-        return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
+    if (pools == nullptr) {
+        if (const auto result =
+                    validateRequestForModel(request, kModel, /*allowUnspecifiedOutput=*/false);
+            !result.ok()) {
+            return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
+        }
     }
     if (std::any_of(waitFor.begin(), waitFor.end(),
                     [](const SyncFence& syncFence) { return !syncFence.getSharedHandle(); })) {
@@ -234,12 +275,21 @@ GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> PreparedModel::ex
 
     NNTRACE_FULL_SWITCH(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_INPUTS_AND_OUTPUTS,
                         "sample::PreparedModel::executeFenced");
-    const auto [requestPoolInfos, bufferWrappers] =
-            NN_TRY(createRunTimePoolInfos(request, *kBufferTracker, *this));
+    std::optional<RequestPools> mappedPools;
+    if (pools == nullptr) {
+        mappedPools = NN_TRY(mapRequestPools(request, *kBufferTracker));
+        pools = &*mappedPools;
+    }
+    NN_TRY(validateDeviceMemories(request, *pools, *this));
+    const auto& [requestPoolInfos, bufferWrappers] = *pools;
 
     NNTRACE_FULL_SWITCH(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_EXECUTION,
                         "sample::PreparedModel::executeFenced");
     auto executor = CpuExecutor(&kOperationResolver);
+    executor.setSubgraphCache(kSubgraphCache);
+    executor.setPackedWeights(kPackedWeights);
+    executor.setStaticShapes(kStaticShapes);
+    executor.setKernelTable(kKernelTable);
     if (loopTimeoutDuration.has_value()) {
         executor.setLoopTimeout(loopTimeoutDuration->count());
     }
@@ -289,8 +339,19 @@ GeneralResult<SharedExecution> PreparedModel::createReusableExecution(
         const std::vector<ExtensionNameAndPrefix>& /*extensionNameToPrefix*/) const {
     NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_EXECUTION,
                  "sample::PreparedModel::createReusableExecution");
-    return std::make_shared<DefaultExecution>(shared_from_this(), request, measure,
-                                              loopTimeoutDuration);
+    VLOG(DRIVER) << "sample::PreparedModel::createReusableExecution(" << SHOW_IF_DEBUG(request)
+                 << ")";
+
+    // The request does not change between computations, so it is validated and its pools are
+    // mapped once here.
+    if (const auto result = validateRequestForModel(request, kModel); !result.ok()) {
+        return NN_ERROR(ErrorStatus::INVALID_ARGUMENT) << result.error();
+    }
+    const bool hasSpecifiedOutputs =
+            validateRequestForModel(request, kModel, /*allowUnspecifiedOutput=*/false).ok();
+    RequestPools pools = NN_TRY(mapRequestPools(request, *kBufferTracker));
+    return std::make_shared<const Execution>(shared_from_this(), request, std::move(pools),
+                                             hasSpecifiedOutputs, measure, loopTimeoutDuration);
 }
 
 GeneralResult<SharedBurst> PreparedModel::configureExecutionBurst() const {
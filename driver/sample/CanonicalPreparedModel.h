@@ -19,6 +19,9 @@
 
 #include <BufferTracker.h>
 #include <CpuExecutor.h>
+#include <CpuKernelTable.h>
+#include <CpuPackedWeights.h>
+#include <CpuStaticShapes.h>
 #include <nnapi/IExecution.h>
 #include <nnapi/IPreparedModel.h>
 #include <nnapi/Result.h>
@@ -31,6 +34,13 @@
 
 namespace android::nn::sample {
 
+// The memory pools of a request, mapped for the CPU executor. The entries of bufferWrappers are
+// the device memories of the request, or nullptr for the other pools.
+struct RequestPools {
+    std::vector<RunTimePoolInfo> poolInfos;
+    std::vector<std::shared_ptr<ManagedBuffer>> bufferWrappers;
+};
+
 class PreparedModel final : public IPreparedModel,
                             public std::enable_shared_from_this<PreparedModel> {
    public:
@@ -58,6 +68,17 @@ class PreparedModel final : public IPreparedModel,
 
     GeneralResult<SharedBurst> configureExecutionBurst() const override;
 
+    // Same as execute() and executeFenced(). If pools is not nullptr, the request was validated
+    // against the model when its pools were mapped, and only its device memories are validated.
+    ExecutionResult<std::pair<std::vector<OutputShape>, Timing>> executeWithPools(
+            const Request& request, const RequestPools* pools, MeasureTiming measure,
+            const OptionalTimePoint& deadline, const OptionalDuration& loopTimeoutDuration) const;
+    GeneralResult<std::pair<SyncFence, ExecuteFencedInfoCallback>> executeFencedWithPools(
+            const Request& request, const RequestPools* pools,
+            const std::vector<SyncFence>& waitFor, MeasureTiming measure,
+            const OptionalTimePoint& deadline, const OptionalDuration& loopTimeoutDuration,
+            const OptionalDuration& timeoutDurationAfterFence) const;
+
     std::any getUnderlyingResource() const override;
 
    private:
@@ -67,6 +88,15 @@ class PreparedModel final : public IPreparedModel,
     const IOperationResolver& kOperationResolver;
     const std::shared_ptr<BufferTracker> kBufferTracker;
     const std::vector<RunTimePoolInfo> kPoolInfos;
+    // Shared by all executions, so that subgraph runtime info is computed only once.
+    const std::shared_ptr<CpuExecutorSubgraphCache> kSubgraphCache =
+            std::make_shared<CpuExecutorSubgraphCache>();
+    // Kernel-ready copies of the constants of kModel, packed once when the model is prepared.
+    const std::shared_ptr<const CpuPackedWeights> kPackedWeights;
+    // The operations of kModel whose output shapes are inferred once when the model is prepared.
+    const std::shared_ptr<const CpuStaticShapes> kStaticShapes;
+    // The kernels of the operations of kModel, resolved once when the model is prepared.
+    const std::shared_ptr<const CpuKernelTable> kKernelTable;
 };
 
 }  // namespace android::nn::sample
@@ -303,6 +303,12 @@ ndk::ScopedAStatus SampleBuffer::copyFrom(const aidl_hal::Memory& src,
     return ndk::ScopedAStatus::ok();
 }
 
+SamplePreparedModel::~SamplePreparedModel() {
+    // The pool is shared by all the prepared models of the process, so these are cumulative.
+    VLOG(DRIVER) << "Thread pool stats when destroying a prepared model: "
+                 << getDriverThreadPool()->getStats();
+}
+
 bool SamplePreparedModel::initialize() {
     const auto canonicalPools = convert(mModel.pools);
     if (!canonicalPools.has_value()) {
@@ -114,6 +114,7 @@ class SamplePreparedModel : public aidl_hal::BnPreparedModel {
         (void)kUserId;
         (void)kPriority;
     }
+    ~SamplePreparedModel();
     bool initialize();
     ndk::ScopedAStatus executeSynchronously(const aidl_hal::Request& request, bool measureTiming,
                                             int64_t deadlineNs, int64_t loopTimeoutDurationNs,
@@ -16,6 +16,7 @@
 
 #include "SampleDriverAidlUtils.h"
 
+#include <PriorityThreadPool.h>
 #include <aidl/android/hardware/common/NativeHandle.h>
 #include <android/binder_auto_utils.h>
 #include <android/binder_ibinder.h>
@@ -27,7 +28,6 @@
 
 #include <memory>
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
@@ -134,20 +134,20 @@ ndk::ScopedAStatus prepareModelBase(
         return ndk::ScopedAStatus::ok();
     }
 
-    // asynchronously prepare the model from a new, detached thread
-    std::thread(
-            [driver, preference, userId, priority, callback](aidl_hal::Model&& model) {
-                std::shared_ptr<SamplePreparedModel> preparedModel =
-                        ndk::SharedRefBase::make<SamplePreparedModel>(std::move(model), driver,
-                                                                      preference, userId, priority);
-                if (!preparedModel->initialize()) {
-                    notify(callback, aidl_hal::ErrorStatus::INVALID_ARGUMENT, nullptr);
-                    return;
-                }
-                notify(callback, aidl_hal::ErrorStatus::NONE, preparedModel);
-            },
-            std::move(model))
-            .detach();
+    // asynchronously prepare the model on the thread pool, which needs copyable tasks while the
+    // model owns file descriptors
+    auto sharedModel = std::make_shared<aidl_hal::Model>(std::move(model));
+    getDriverThreadPool()->schedule(convert(priority).value(), [driver, preference, userId,
+                                                                priority, callback, sharedModel] {
+        std::shared_ptr<SamplePreparedModel> preparedModel =
+                ndk::SharedRefBase::make<SamplePreparedModel>(std::move(*sharedModel), driver,
+                                                              preference, userId, priority);
+        if (!preparedModel->initialize()) {
+            notify(callback, aidl_hal::ErrorStatus::INVALID_ARGUMENT, nullptr);
+            return;
+        }
+        notify(callback, aidl_hal::ErrorStatus::NONE, preparedModel);
+    });
 
     return ndk::ScopedAStatus::ok();
 }
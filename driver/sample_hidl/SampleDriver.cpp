@@ -36,7 +36,6 @@
 #include <memory>
 #include <optional>
 #include <set>
-#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -362,6 +361,12 @@ hardware::Return<V1_3::ErrorStatus> SampleBuffer::copyFrom(
     return status;
 }
 
+SamplePreparedModel::~SamplePreparedModel() {
+    // The pool is shared by all the prepared models of the process, so these are cumulative.
+    VLOG(DRIVER) << "Thread pool stats when destroying a prepared model: "
+                 << getDriverThreadPool()->getStats();
+}
+
 bool SamplePreparedModel::initialize() {
     return setRunTimePoolInfosFromCanonicalMemories(&mPoolInfos, uncheckedConvert(mModel.pools));
 }
@@ -529,13 +534,15 @@ V1_3::ErrorStatus executeBase(const V1_3::Request& request, V1_2::MeasureTiming
         return V1_3::ErrorStatus::NONE;
     }
 
-    // This thread is intentionally detached because the sample driver service
-    // is expected to live forever.
-    std::thread([&model, &driver, preparedModel, &poolInfos, request, measure, driverStart,
-                 deadline, loopTimeoutDuration, callback] {
+    // The time spent in the queue of the thread pool is part of timeInDriver, as driverStart is
+    // taken before scheduling.
+    const Priority priority = convert(preparedModel->getPriority()).value();
+    getDriverThreadPool()->schedule(priority, [&model, &driver, preparedModel, &poolInfos,
+                                               request, measure, driverStart, deadline,
+                                               loopTimeoutDuration, callback] {
         asyncExecute(request, measure, driverStart, model, driver, preparedModel, poolInfos,
                      deadline, loopTimeoutDuration, callback);
-    }).detach();
+    });
 
     return V1_3::ErrorStatus::NONE;
 }
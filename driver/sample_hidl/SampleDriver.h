@@ -134,8 +134,8 @@ class SamplePreparedModel : public V1_3::IPreparedModel {
           kUserId(userId),
           kPriority(priority) {
         (void)kUserId;
-        (void)kPriority;
     }
+    ~SamplePreparedModel();
     bool initialize();
     hardware::Return<V1_0::ErrorStatus> execute(
             const V1_0::Request& request, const sp<V1_0::IExecutionCallback>& callback) override;
@@ -168,6 +168,7 @@ class SamplePreparedModel : public V1_3::IPreparedModel {
                                          const V1_3::OptionalTimeoutDuration& duration,
                                          executeFenced_cb callback) override;
     const V1_3::Model* getModel() const { return &mModel; }
+    V1_3::Priority getPriority() const { return kPriority; }
 
    protected:
     V1_3::Model mModel;
@@ -18,20 +18,29 @@
 
 #include <CpuExecutor.h>
 #include <HalInterfaces.h>
+#include <TokenHasher.h>
+#include <Tracing.h>
 #include <Utils.h>
 #include <ValidateHal.h>
+#include <android-base/file.h>
 #include <android-base/logging.h>
+#include <android-base/unique_fd.h>
 #include <hidl/LegacySupport.h>
 #include <hwbinder/IPCThreadState.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <xnnpack.h>
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
-#include <thread>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -53,7 +62,8 @@ namespace {
         }                                            \
     } while (0)
 
-const size_t kNumOfWorkerThreads = 1;
+// Passing 0 to pthreadpool_create creates one worker thread per logical processor.
+const size_t kNumOfWorkerThreads = 0;
 static const V1_2::Timing kNoTiming = {.timeOnDevice = UINT64_MAX, .timeInDriver = UINT64_MAX};
 
 bool isScalarType(OperandType type) {
@@ -69,6 +79,28 @@ bool isScalarType(OperandType type) {
     }
 }
 
+// Reads a FLOAT32 or FLOAT16 scalar operand.
+float getFloatScalarData(const RunTimeOperandInfo& info) {
+    if (info.type == OperandType::FLOAT16) {
+        return static_cast<float>(getScalarData<_Float16>(info));
+    }
+    return getScalarData<float>(info);
+}
+
+std::vector<float> widenFloat16(const RunTimeOperandInfo& operand) {
+    const auto* data = reinterpret_cast<const _Float16*>(operand.buffer);
+    return std::vector<float>(data, data + getNumberOfElements(operand.shape()));
+}
+
+// A FLOAT16 subgraph input or output. XNNPACK reads and writes it through a FLOAT32 staging
+// buffer that is converted from or to the request buffer on every invocation.
+struct Fp16External {
+    uint32_t id;
+    bool isInput;
+    bool isOutput;
+    std::vector<float> staging;
+};
+
 void updateForArguments(const std::vector<uint32_t>& indexes,
                         const hardware::hidl_vec<V1_0::RequestArgument>& arguments,
                         const std::vector<RunTimePoolInfo>& requestPoolInfos,
@@ -149,6 +181,305 @@ std::vector<RunTimeOperandInfo> initializeRunTimeInfo(
     return operands;
 }
 
+// The XNNPACK driver uses one model cache file and one data cache file. The model cache file
+// holds a CacheHeader followed by the serialized main subgraph (operand metadata, operations and
+// input/output indexes). The data cache file holds the values of all constant operands, so that it
+// can be memory mapped as the only model pool when the model is prepared from cache.
+constexpr uint32_t kNumModelCacheFiles = 1;
+constexpr uint32_t kNumDataCacheFiles = 1;
+constexpr uint32_t kCacheMagic = 0x504e4e58;  // "XNNP"
+constexpr uint32_t kCacheVersion = 3;
+constexpr size_t kCacheDataAlignment = 64;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t metadataSize;
+    uint64_t dataSize;
+    // SHA-256 of the cache token, the metadata and the data size. The data itself is not hashed,
+    // so that preparing from cache does not have to read the constant values. A corrupted value
+    // can only produce wrong results, because the model is validated after it is loaded.
+    uint8_t checksum[ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN];
+};
+
+template <typename T>
+void appendToCache(std::vector<uint8_t>* buffer, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer->insert(buffer->end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void appendToCache(std::vector<uint8_t>* buffer, const hardware::hidl_vec<T>& values) {
+    appendToCache(buffer, static_cast<uint32_t>(values.size()));
+    for (const T& value : values) {
+        appendToCache(buffer, value);
+    }
+}
+
+// Bounds-checked reader over the metadata section of a model cache file.
+class CacheReader {
+   public:
+    CacheReader(const uint8_t* data, size_t size) : mData(data), mSize(size) {}
+
+    template <typename T>
+    bool read(T* value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (mSize - mOffset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, mData + mOffset, sizeof(T));
+        mOffset += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool read(hardware::hidl_vec<T>* values) {
+        uint32_t count = 0;
+        if (!read(&count) || (mSize - mOffset) / sizeof(T) < count) {
+            return false;
+        }
+        values->resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            read(&(*values)[i]);
+        }
+        return true;
+    }
+
+    bool finished() const { return mOffset == mSize; }
+
+   private:
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mOffset = 0;
+};
+
+bool computeCacheChecksum(const HalCacheToken& token, const std::vector<uint8_t>& metadata,
+                          uint64_t dataSize, uint8_t* checksum) {
+    TokenHasher hasher(token.data());
+    if (!hasher.update(metadata.data(), metadata.size()) ||
+        !hasher.update(&dataSize, sizeof(dataSize)) || !hasher.finish()) {
+        return false;
+    }
+    std::memcpy(checksum, hasher.getCacheToken(), ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN);
+    return true;
+}
+
+int getCacheFd(const hardware::hidl_handle& handle) {
+    const native_handle_t* nativeHandle = handle.getNativeHandle();
+    if (nativeHandle == nullptr || nativeHandle->numFds != 1) {
+        return -1;
+    }
+    return nativeHandle->data[0];
+}
+
+// Writes the main subgraph of the model and the values of its constant operands into the cache
+// files. All constant operands are rewritten as CONSTANT_REFERENCE operands of a single pool that
+// is backed by the data cache file.
+bool saveModelToCache(const V1_3::Model& model, const std::vector<RunTimePoolInfo>& poolInfos,
+                      const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+                      const hardware::hidl_vec<hardware::hidl_handle>& dataCache,
+                      const HalCacheToken& token) {
+    NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_COMPILATION, "saveModelToCache");
+    if (modelCache.size() != kNumModelCacheFiles || dataCache.size() != kNumDataCacheFiles) {
+        return false;
+    }
+    const int modelFd = getCacheFd(modelCache[0]);
+    const int dataFd = getCacheFd(dataCache[0]);
+    if (modelFd < 0 || dataFd < 0 || model.referenced.size() != 0) {
+        return false;
+    }
+
+    std::vector<uint8_t> metadata;
+    std::vector<uint8_t> data;
+    const auto& operands = model.main.operands;
+    appendToCache(&metadata, static_cast<uint32_t>(operands.size()));
+    for (const V1_3::Operand& operand : operands) {
+        const auto extraParamsKind = operand.extraParams.getDiscriminator();
+        if (extraParamsKind != V1_2::Operand::ExtraParams::hidl_discriminator::none &&
+            extraParamsKind != V1_2::Operand::ExtraParams::hidl_discriminator::channelQuant) {
+            return false;
+        }
+        V1_3::OperandLifeTime lifetime = operand.lifetime;
+        V1_0::DataLocation location = operand.location;
+        const uint8_t* values = nullptr;
+        if (lifetime == V1_3::OperandLifeTime::CONSTANT_COPY) {
+            values = model.operandValues.data() + location.offset;
+        } else if (lifetime == V1_3::OperandLifeTime::CONSTANT_REFERENCE) {
+            values = poolInfos[location.poolIndex].getBuffer() + location.offset;
+        }
+        if (values != nullptr) {
+            data.resize(roundUp(data.size(), kCacheDataAlignment));
+            // Offsets into the data cache file are stored as uint32_t, and the loader rejects a
+            // data file larger than that.
+            if (data.size() > std::numeric_limits<uint32_t>::max() - location.length) {
+                LOG(ERROR) << "Constant values are too large for the XNNPACK compilation cache";
+                return false;
+            }
+            lifetime = V1_3::OperandLifeTime::CONSTANT_REFERENCE;
+            location = {.poolIndex = 0,
+                        .offset = static_cast<uint32_t>(data.size()),
+                        .length = location.length};
+            data.insert(data.end(), values, values + location.length);
+        }
+        appendToCache(&metadata, operand.type);
+        appendToCache(&metadata, operand.dimensions);
+        appendToCache(&metadata, operand.numberOfConsumers);
+        appendToCache(&metadata, operand.scale);
+        appendToCache(&metadata, operand.zeroPoint);
+        appendToCache(&metadata, lifetime);
+        appendToCache(&metadata, location.poolIndex);
+        appendToCache(&metadata, location.offset);
+        appendToCache(&metadata, location.length);
+        appendToCache(&metadata, extraParamsKind);
+        if (extraParamsKind == V1_2::Operand::ExtraParams::hidl_discriminator::channelQuant) {
+            appendToCache(&metadata, operand.extraParams.channelQuant().channelDim);
+            appendToCache(&metadata, operand.extraParams.channelQuant().scales);
+        }
+    }
+    appendToCache(&metadata, static_cast<uint32_t>(model.main.operations.size()));
+    for (const V1_3::Operation& operation : model.main.operations) {
+        appendToCache(&metadata, operation.type);
+        appendToCache(&metadata, operation.inputs);
+        appendToCache(&metadata, operation.outputs);
+    }
+    appendToCache(&metadata, model.main.inputIndexes);
+    appendToCache(&metadata, model.main.outputIndexes);
+    appendToCache(&metadata, static_cast<uint8_t>(model.relaxComputationFloat32toFloat16));
+
+    CacheHeader header = {.magic = kCacheMagic,
+                          .version = kCacheVersion,
+                          .metadataSize = metadata.size(),
+                          .dataSize = data.size()};
+    // The data cache file of a prepared model loaded from cache stays mapped, so a non-empty file
+    // is never truncated or overwritten. The runtime recreates the cache files before asking for
+    // them to be written, so only a stale file supplied by the application is refused here.
+    struct stat modelStat, dataStat;
+    if (fstat(modelFd, &modelStat) != 0 || fstat(dataFd, &dataStat) != 0 ||
+        modelStat.st_size != 0 || dataStat.st_size != 0) {
+        LOG(ERROR) << "Refusing to overwrite non-empty XNNPACK compilation cache files";
+        return false;
+    }
+    if (!computeCacheChecksum(token, metadata, data.size(), header.checksum)) {
+        LOG(ERROR) << "Failed to compute the XNNPACK compilation cache checksum";
+        return false;
+    }
+    if (!base::WriteFullyAtOffset(dataFd, data.data(), data.size(), 0) ||
+        !base::WriteFullyAtOffset(modelFd, &header, sizeof(header), 0) ||
+        !base::WriteFullyAtOffset(modelFd, metadata.data(), metadata.size(), sizeof(header))) {
+        LOG(ERROR) << "Failed to write XNNPACK compilation cache";
+        return false;
+    }
+    return true;
+}
+
+// Reconstructs the model written by saveModelToCache. The data cache file is not copied: it is
+// referenced by an "mmap_fd" pool and mapped when the prepared model is initialized.
+std::optional<V1_3::Model> loadModelFromCache(
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token) {
+    NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_COMPILATION, "loadModelFromCache");
+    if (modelCache.size() != kNumModelCacheFiles || dataCache.size() != kNumDataCacheFiles) {
+        return std::nullopt;
+    }
+    const int modelFd = getCacheFd(modelCache[0]);
+    const int dataFd = getCacheFd(dataCache[0]);
+    if (modelFd < 0 || dataFd < 0) {
+        return std::nullopt;
+    }
+
+    struct stat modelStat, dataStat;
+    CacheHeader header;
+    if (fstat(modelFd, &modelStat) != 0 || fstat(dataFd, &dataStat) != 0 ||
+        pread(modelFd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        header.magic != kCacheMagic || header.version != kCacheVersion ||
+        header.metadataSize != static_cast<uint64_t>(modelStat.st_size) - sizeof(header) ||
+        header.dataSize != static_cast<uint64_t>(dataStat.st_size) ||
+        header.dataSize > std::numeric_limits<uint32_t>::max()) {
+        LOG(ERROR) << "Invalid XNNPACK compilation cache header";
+        return std::nullopt;
+    }
+    std::vector<uint8_t> metadata(header.metadataSize);
+    uint8_t checksum[ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN];
+    if (pread(modelFd, metadata.data(), metadata.size(), sizeof(header)) !=
+                static_cast<ssize_t>(metadata.size()) ||
+        !computeCacheChecksum(token, metadata, header.dataSize, checksum) ||
+        std::memcmp(checksum, header.checksum, sizeof(checksum)) != 0) {
+        LOG(ERROR) << "XNNPACK compilation cache checksum mismatch";
+        return std::nullopt;
+    }
+
+    V1_3::Model model;
+    CacheReader reader(metadata.data(), metadata.size());
+    uint32_t operandCount = 0;
+    if (!reader.read(&operandCount) || operandCount > metadata.size()) {
+        return std::nullopt;
+    }
+    model.main.operands.resize(operandCount);
+    for (V1_3::Operand& operand : model.main.operands) {
+        if (!reader.read(&operand.type) || !reader.read(&operand.dimensions) ||
+            !reader.read(&operand.numberOfConsumers) || !reader.read(&operand.scale) ||
+            !reader.read(&operand.zeroPoint) || !reader.read(&operand.lifetime) ||
+            !reader.read(&operand.location.poolIndex) || !reader.read(&operand.location.offset) ||
+            !reader.read(&operand.location.length)) {
+            return std::nullopt;
+        }
+        V1_2::Operand::ExtraParams::hidl_discriminator extraParamsKind;
+        if (!reader.read(&extraParamsKind)) {
+            return std::nullopt;
+        }
+        if (extraParamsKind == V1_2::Operand::ExtraParams::hidl_discriminator::channelQuant) {
+            V1_2::SymmPerChannelQuantParams channelQuant;
+            if (!reader.read(&channelQuant.channelDim) || !reader.read(&channelQuant.scales)) {
+                return std::nullopt;
+            }
+            operand.extraParams.channelQuant(std::move(channelQuant));
+        } else if (extraParamsKind != V1_2::Operand::ExtraParams::hidl_discriminator::none) {
+            return std::nullopt;
+        }
+    }
+    uint32_t operationCount = 0;
+    if (!reader.read(&operationCount) || operationCount > metadata.size()) {
+        return std::nullopt;
+    }
+    model.main.operations.resize(operationCount);
+    for (V1_3::Operation& operation : model.main.operations) {
+        if (!reader.read(&operation.type) || !reader.read(&operation.inputs) ||
+            !reader.read(&operation.outputs)) {
+            return std::nullopt;
+        }
+    }
+    uint8_t relaxComputationFloat32toFloat16 = 0;
+    if (!reader.read(&model.main.inputIndexes) || !reader.read(&model.main.outputIndexes) ||
+        !reader.read(&relaxComputationFloat32toFloat16) || !reader.finished()) {
+        return std::nullopt;
+    }
+    model.relaxComputationFloat32toFloat16 = relaxComputationFloat32toFloat16 != 0;
+
+    if (header.dataSize > 0) {
+        base::unique_fd fd(dup(dataFd));
+        native_handle_t* nativeHandle = native_handle_create(/*numFds=*/1, /*numInts=*/3);
+        if (fd.get() < 0 || nativeHandle == nullptr) {
+            return std::nullopt;
+        }
+        nativeHandle->data[0] = fd.release();
+        nativeHandle->data[1] = PROT_READ;
+        nativeHandle->data[2] = 0;  // offset, low 32 bits
+        nativeHandle->data[3] = 0;  // offset, high 32 bits
+        hardware::hidl_handle handle;
+        handle.setTo(nativeHandle, /*shouldOwn=*/true);
+        model.pools = {hardware::hidl_memory("mmap_fd", handle, header.dataSize)};
+    }
+
+    // The checksum only protects against corruption, so the reconstructed model is still
+    // validated before it is handed to XNNPACK.
+    if (!validateModel(model)) {
+        LOG(ERROR) << "XNNPACK compilation cache contains an invalid model";
+        return std::nullopt;
+    }
+    return model;
+}
+
 }  // namespace
 
 class Subgraph {
@@ -157,7 +488,7 @@ class Subgraph {
                             std::vector<RunTimeOperandInfo>& operands,
                             const std::vector<uint32_t>& inputIndexes,
                             const std::vector<uint32_t>& outputIndexes, pthreadpool_t threadpool,
-                            bool useStaticBuffer = false) {
+                            bool allowFp16Inference, bool useStaticBuffer = false) {
         // Convert subgraph inputs and outputs to hash sets for faster lookup.
         const std::unordered_set<uint32_t> inputs(inputIndexes.begin(), inputIndexes.end());
         const std::unordered_set<uint32_t> outputs(outputIndexes.begin(), outputIndexes.end());
@@ -179,12 +510,17 @@ class Subgraph {
         // -1 denotes tensor not used in the subgraph.
         std::vector<int> tensors(operands.size(), -1);
 
+        // Biases of per-channel quantized convolutions, mapped to the input and filter operands
+        // that determine their per-channel scales.
+        std::unordered_map<uint32_t, std::pair<uint32_t, uint32_t>> perChannelBiases;
+
         for (const auto& operation : operations) {
             const std::vector<uint32_t>& ins = operation.inputs;
             const std::vector<uint32_t>& outs = operation.outputs;
             switch (operation.type) {
                 case V1_3::OperationType::MEAN:
                 case V1_3::OperationType::PAD:
+                case V1_3::OperationType::PAD_V2:
                 case V1_3::OperationType::RESHAPE:
                 case V1_3::OperationType::RESIZE_BILINEAR:
                     // Ignore the second input (axes, static padding, or new shape),
@@ -195,6 +531,12 @@ class Subgraph {
                         tensors[t] = t;
                     }
                     break;
+                case V1_3::OperationType::CONV_2D:
+                case V1_3::OperationType::DEPTHWISE_CONV_2D:
+                    if (operands[ins[1]].type == OperandType::TENSOR_QUANT8_SYMM_PER_CHANNEL) {
+                        perChannelBiases[ins[2]] = {ins[0], ins[1]};
+                    }
+                    [[fallthrough]];
                 default:
                     // All other operators: process all inputs
                     for (size_t k = 0; k < ins.size(); k++) {
@@ -212,19 +554,21 @@ class Subgraph {
 
         // XNNPACK Value IDs for NNAPI Operands
         std::vector<uint32_t> xnnpackTensors(operands.size());
+        // Buffers that XNNPACK may reference until the runtime is deleted: constant FLOAT16
+        // values widened to FLOAT32, per-channel scales, and FLOAT32 staging buffers for FLOAT16
+        // subgraph inputs and outputs.
+        std::vector<std::vector<float>> ownedBuffers;
+        std::vector<Fp16External> fp16Externals;
         for (int t : tensors) {
             if (t < 0) continue;
-            if (operands[tensors[t]].type != OperandType::TENSOR_FLOAT32) {
-                LOG(ERROR) << "XNNPACK only support FLOAT32 tensors";
-                return nullptr;
-            }
+            const RunTimeOperandInfo& operand = operands[tensors[t]];
 
             uint32_t flags = 0;
             const void* data = nullptr;
-            if (operands[tensors[t]].lifetime == Operand::LifeTime::CONSTANT_COPY ||
-                operands[tensors[t]].lifetime == Operand::LifeTime::CONSTANT_REFERENCE ||
-                operands[tensors[t]].lifetime == Operand::LifeTime::POINTER) {
-                data = operands[tensors[t]].buffer;
+            if (operand.lifetime == Operand::LifeTime::CONSTANT_COPY ||
+                operand.lifetime == Operand::LifeTime::CONSTANT_REFERENCE ||
+                operand.lifetime == Operand::LifeTime::POINTER) {
+                data = operand.buffer;
             }
             if (inputs.count(t) != 0) {
                 flags |= XNN_VALUE_FLAG_EXTERNAL_INPUT;
@@ -236,14 +580,84 @@ class Subgraph {
                 flags |= XNN_VALUE_FLAG_EXTERNAL_OUTPUT;
             }
 
-            std::vector<size_t> dims(operands[tensors[t]].dimensions.size());
+            std::vector<size_t> dims(operand.dimensions.size());
             for (size_t i = 0; i < dims.size(); i++) {
-                dims[i] = operands[tensors[t]].dimensions[i];
+                dims[i] = operand.dimensions[i];
             }
 
-            const xnn_status status = xnn_define_tensor_value(
-                    subgraph.get(), xnn_datatype_fp32, dims.size(), dims.data(), data,
-                    static_cast<uint32_t>(t), flags, &xnnpackTensors[t]);
+            xnn_status status = xnn_status_success;
+            switch (operand.type) {
+                case OperandType::TENSOR_FLOAT16:
+                    // XNNPACK computes FLOAT16 models in FP32, or in FP16 when the runtime is
+                    // created with FP16 inference allowed and the hardware supports it.
+                    if (data != nullptr) {
+                        ownedBuffers.push_back(widenFloat16(operand));
+                        data = ownedBuffers.back().data();
+                    } else if ((flags & (XNN_VALUE_FLAG_EXTERNAL_INPUT |
+                                         XNN_VALUE_FLAG_EXTERNAL_OUTPUT)) != 0) {
+                        fp16Externals.push_back(
+                                {.id = static_cast<uint32_t>(t),
+                                 .isInput = (flags & XNN_VALUE_FLAG_EXTERNAL_INPUT) != 0,
+                                 .isOutput = (flags & XNN_VALUE_FLAG_EXTERNAL_OUTPUT) != 0,
+                                 .staging = std::vector<float>(
+                                         getNumberOfElements(operand.shape()))});
+                    }
+                    [[fallthrough]];
+                case OperandType::TENSOR_FLOAT32:
+                    status = xnn_define_tensor_value(subgraph.get(), xnn_datatype_fp32, dims.size(),
+                                                     dims.data(), data, static_cast<uint32_t>(t),
+                                                     flags, &xnnpackTensors[t]);
+                    break;
+                case OperandType::TENSOR_QUANT8_ASYMM:
+                    status = xnn_define_quantized_tensor_value(
+                            subgraph.get(), xnn_datatype_quint8, operand.zeroPoint, operand.scale,
+                            dims.size(), dims.data(), data, static_cast<uint32_t>(t), flags,
+                            &xnnpackTensors[t]);
+                    break;
+                case OperandType::TENSOR_QUANT8_ASYMM_SIGNED:
+                    status = xnn_define_quantized_tensor_value(
+                            subgraph.get(), xnn_datatype_qint8, operand.zeroPoint, operand.scale,
+                            dims.size(), dims.data(), data, static_cast<uint32_t>(t), flags,
+                            &xnnpackTensors[t]);
+                    break;
+                case OperandType::TENSOR_QUANT8_SYMM_PER_CHANNEL: {
+                    const auto& params =
+                            std::get<Operand::SymmPerChannelQuantParams>(operand.extraParams);
+                    ownedBuffers.push_back(params.scales);
+                    status = xnn_define_channelwise_quantized_tensor_value(
+                            subgraph.get(), xnn_datatype_qcint8, ownedBuffers.back().data(),
+                            dims.size(), params.channelDim, dims.data(), data,
+                            static_cast<uint32_t>(t), flags, &xnnpackTensors[t]);
+                    break;
+                }
+                case OperandType::TENSOR_INT32: {
+                    const auto it = perChannelBiases.find(t);
+                    if (it == perChannelBiases.end()) {
+                        status = xnn_define_quantized_tensor_value(
+                                subgraph.get(), xnn_datatype_qint32, /*zero_point=*/0,
+                                operand.scale, dims.size(), dims.data(), data,
+                                static_cast<uint32_t>(t), flags, &xnnpackTensors[t]);
+                        break;
+                    }
+                    const RunTimeOperandInfo& input = operands[it->second.first];
+                    const RunTimeOperandInfo& filter = operands[it->second.second];
+                    std::vector<float> scales =
+                            std::get<Operand::SymmPerChannelQuantParams>(filter.extraParams)
+                                    .scales;
+                    for (float& scale : scales) {
+                        scale *= input.scale;
+                    }
+                    ownedBuffers.push_back(std::move(scales));
+                    status = xnn_define_channelwise_quantized_tensor_value(
+                            subgraph.get(), xnn_datatype_qcint32, ownedBuffers.back().data(),
+                            dims.size(), /*channel_dim=*/0, dims.data(), data,
+                            static_cast<uint32_t>(t), flags, &xnnpackTensors[t]);
+                    break;
+                }
+                default:
+                    LOG(ERROR) << "XNNPACK does not support tensors of type " << operand.type;
+                    return nullptr;
+            }
             if (status != xnn_status_success) {
                 LOG(ERROR) << "XNNPACK xnn_define_tensor_value failed";
                 return nullptr;
@@ -259,13 +673,20 @@ class Subgraph {
             }
         }
 
+        uint32_t runtimeFlags = 0;
+#ifdef XNN_FLAG_HINT_FP16_INFERENCE
+        if (allowFp16Inference) {
+            runtimeFlags |= XNN_FLAG_HINT_FP16_INFERENCE;
+        }
+#endif  // XNN_FLAG_HINT_FP16_INFERENCE
         xnn_runtime_t runtimePtr = nullptr;
-        status = xnn_create_runtime_v2(subgraph.get(), threadpool, /*flags=*/0, &runtimePtr);
+        status = xnn_create_runtime_v2(subgraph.get(), threadpool, runtimeFlags, &runtimePtr);
         if (status != xnn_status_success) {
             LOG(ERROR) << "XNNPACK xnn_create_runtime_v2 FAILED";
             return nullptr;
         }
-        return new Subgraph(runtimePtr, std::move(externals), useStaticBuffer);
+        return new Subgraph(runtimePtr, std::move(externals), std::move(ownedBuffers),
+                            std::move(fp16Externals), useStaticBuffer);
     }
 
     V1_3::ErrorStatus Prepare() { return V1_3::ErrorStatus::NONE; }
@@ -282,6 +703,13 @@ class Subgraph {
                 value.data = operands[t].buffer;
                 externalValues.push_back(value);
             }
+            for (auto& external : mFp16Externals) {
+                auto it = std::find_if(
+                        externalValues.begin(), externalValues.end(),
+                        [&external](const xnn_external_value& v) { return v.id == external.id; });
+                CHECK(it != externalValues.end());
+                it->data = external.staging.data();
+            }
 
             const xnn_status status =
                     xnn_setup_runtime(mRuntime.get(), externalValues.size(), externalValues.data());
@@ -292,11 +720,23 @@ class Subgraph {
             mFirstRun = false;
         }
         VLOG(DRIVER) << "Subgraph::Invoke() finished xnn_setup_runtime";
+        for (auto& external : mFp16Externals) {
+            if (external.isInput) {
+                const auto* input = reinterpret_cast<const _Float16*>(operands[external.id].buffer);
+                std::copy(input, input + external.staging.size(), external.staging.begin());
+            }
+        }
         const xnn_status status = xnn_invoke_runtime(mRuntime.get());
         if (status != xnn_status_success) {
             LOG(ERROR) << "XNNPACK xnn_invoke_runtime FAILED";
             return V1_3::ErrorStatus::GENERAL_FAILURE;
         }
+        for (const auto& external : mFp16Externals) {
+            if (external.isOutput) {
+                auto* output = reinterpret_cast<_Float16*>(operands[external.id].buffer);
+                std::copy(external.staging.begin(), external.staging.end(), output);
+            }
+        }
 
         return V1_3::ErrorStatus::NONE;
     }
@@ -425,13 +865,110 @@ class Subgraph {
         return V1_3::ErrorStatus::NONE;
     }
 
+    // TENSOR_FLOAT16 tensors are represented as FP32 values in the XNNPACK subgraph, so every
+    // operation that supports TENSOR_FLOAT32 also supports TENSOR_FLOAT16.
     static V1_3::ErrorStatus CheckTensorFloatType(OperandType tensor_type) {
-        if (tensor_type != OperandType::TENSOR_FLOAT32) {
+        if (tensor_type != OperandType::TENSOR_FLOAT32 &&
+            tensor_type != OperandType::TENSOR_FLOAT16) {
+            return V1_3::ErrorStatus::INVALID_ARGUMENT;
+        }
+        return V1_3::ErrorStatus::NONE;
+    }
+
+    static bool IsQuant8Type(OperandType tensor_type) {
+        return tensor_type == OperandType::TENSOR_QUANT8_ASYMM ||
+               tensor_type == OperandType::TENSOR_QUANT8_ASYMM_SIGNED;
+    }
+
+    static V1_3::ErrorStatus CheckTensorFloatOrQuant8Type(OperandType tensor_type) {
+        if (IsQuant8Type(tensor_type)) {
+            return V1_3::ErrorStatus::NONE;
+        }
+        return CheckTensorFloatType(tensor_type);
+    }
+
+    // XNNPACK requires the input and output of quantized data movement and min/max operations
+    // (pooling, clamp, pad, reshape) to share quantization parameters.
+    static V1_3::ErrorStatus CheckQuantizationParamsMatch(const RunTimeOperandInfo& input,
+                                                          const RunTimeOperandInfo& output) {
+        if (input.type != output.type) {
+            return V1_3::ErrorStatus::INVALID_ARGUMENT;
+        }
+        if (IsQuant8Type(input.type) &&
+            (input.scale != output.scale || input.zeroPoint != output.zeroPoint)) {
             return V1_3::ErrorStatus::INVALID_ARGUMENT;
         }
         return V1_3::ErrorStatus::NONE;
     }
 
+    // Checks the rescaling ranges supported by the XNNPACK QS8/QU8 ADD, SUB and MUL kernels.
+    static V1_3::ErrorStatus CheckBinaryQuantization(const RunTimeOperandInfo& input1,
+                                                     const RunTimeOperandInfo& input2,
+                                                     const RunTimeOperandInfo& output,
+                                                     bool isMultiply) {
+        if (input1.type != output.type || input2.type != output.type) {
+            return V1_3::ErrorStatus::INVALID_ARGUMENT;
+        }
+        if (!IsQuant8Type(output.type)) {
+            return V1_3::ErrorStatus::NONE;
+        }
+        if (isMultiply) {
+            const float productOutputScale = input1.scale * input2.scale / output.scale;
+            if (productOutputScale < 1.0f / 65536.0f || productOutputScale >= 256.0f) {
+                return V1_3::ErrorStatus::INVALID_ARGUMENT;
+            }
+        } else {
+            for (const float inputScale : {input1.scale, input2.scale}) {
+                const float inputOutputScale = inputScale / output.scale;
+                if (inputOutputScale < 1.0f / 1024.0f || inputOutputScale >= 256.0f) {
+                    return V1_3::ErrorStatus::INVALID_ARGUMENT;
+                }
+            }
+        }
+        return V1_3::ErrorStatus::NONE;
+    }
+
+    // Checks the operand types of CONV_2D, DEPTHWISE_CONV_2D and FULLY_CONNECTED. Quantized
+    // operations map to the XNNPACK QU8 kernels (TENSOR_QUANT8_ASYMM), QS8 kernels
+    // (TENSOR_QUANT8_ASYMM_SIGNED with a symmetric filter), or QC8 kernels
+    // (TENSOR_QUANT8_ASYMM_SIGNED with a TENSOR_QUANT8_SYMM_PER_CHANNEL filter quantized along
+    // perChannelDim).
+    static V1_3::ErrorStatus CheckConvolutionTypes(const RunTimeOperandInfo& input,
+                                                   const RunTimeOperandInfo& filter,
+                                                   const RunTimeOperandInfo& bias,
+                                                   const RunTimeOperandInfo& output,
+                                                   std::optional<uint32_t> perChannelDim) {
+        if (!IsQuant8Type(input.type)) {
+            NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(input.type));
+            NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(filter.type));
+            NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(bias.type));
+            return CheckTensorFloatType(output.type);
+        }
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorType(output.type, input.type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorType(bias.type, OperandType::TENSOR_INT32));
+        std::vector<float> filterScales = {filter.scale};
+        if (filter.type == OperandType::TENSOR_QUANT8_SYMM_PER_CHANNEL) {
+            const auto& params = std::get<Operand::SymmPerChannelQuantParams>(filter.extraParams);
+            if (input.type != OperandType::TENSOR_QUANT8_ASYMM_SIGNED ||
+                !perChannelDim.has_value() || params.channelDim != *perChannelDim) {
+                return V1_3::ErrorStatus::INVALID_ARGUMENT;
+            }
+            filterScales = params.scales;
+        } else {
+            NN_DRIVER_RETURN_IF_ERROR(CheckTensorType(filter.type, input.type));
+            if (filter.type == OperandType::TENSOR_QUANT8_ASYMM_SIGNED && filter.zeroPoint != 0) {
+                return V1_3::ErrorStatus::INVALID_ARGUMENT;
+            }
+        }
+        for (const float filterScale : filterScales) {
+            const float inputOutputScale = input.scale * filterScale / output.scale;
+            if (inputOutputScale < 1.0f / 4294967296.0f || inputOutputScale >= 256.0f) {
+                return V1_3::ErrorStatus::INVALID_ARGUMENT;
+            }
+        }
+        return V1_3::ErrorStatus::NONE;
+    }
+
     static V1_3::ErrorStatus CheckTensorShape(std::vector<uint32_t>& dimensions,
                                               uint32_t min_num_dims, uint32_t max_num_dims) {
         if (min_num_dims == max_num_dims) {
@@ -582,10 +1119,13 @@ class Subgraph {
                                           const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[1]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckBinaryQuantization(operands[ins[0]], operands[ins[1]],
+                                                          operands[outs[0]],
+                                                          /*isMultiply=*/false));
 
         float outputMin = -std::numeric_limits<float>::infinity();
         float outputMax = +std::numeric_limits<float>::infinity();
@@ -613,8 +1153,9 @@ class Subgraph {
                                                     const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(
+                CheckQuantizationParamsMatch(operands[ins[0]], operands[outs[0]]));
         // Make sure all scalar params are constant.
         for (uint32_t i = 1; i < ins.size(); i++) {
             NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[i]].lifetime));
@@ -661,6 +1202,10 @@ class Subgraph {
         }
         NN_DRIVER_RETURN_IF_ERROR(
                 CheckPoolingParams(stride_width, stride_height, filter_width, filter_height));
+        // XNNPACK only provides quantized average pooling in the degenerate 1x1 (clamp) case.
+        if (IsQuant8Type(operands[ins[0]].type) && (filter_width != 1 || filter_height != 1)) {
+            return V1_3::ErrorStatus::INVALID_ARGUMENT;
+        }
 
         float outputMin = -std::numeric_limits<float>::infinity();
         float outputMax = +std::numeric_limits<float>::infinity();
@@ -696,12 +1241,11 @@ class Subgraph {
                                              const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckConvolutionTypes(operands[ins[0]], operands[ins[1]],
+                                                        operands[ins[2]], operands[outs[0]],
+                                                        /*perChannelDim=*/0));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[2]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
         // Make sure all scalar params are constant.
         for (uint32_t i = 3; i < ins.size(); i++) {
             NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[i]].lifetime));
@@ -795,12 +1339,11 @@ class Subgraph {
                                                       const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckConvolutionTypes(operands[ins[0]], operands[ins[1]],
+                                                        operands[ins[2]], operands[outs[0]],
+                                                        /*perChannelDim=*/3));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[2]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
         // Make sure all scalar params are constant.
         for (uint32_t i = 3; i < ins.size(); i++) {
             NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[i]].lifetime));
@@ -926,13 +1469,12 @@ class Subgraph {
                                                      const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckConvolutionTypes(operands[ins[0]], operands[ins[1]],
+                                                        operands[ins[2]], operands[outs[0]],
+                                                        /*perChannelDim=*/std::nullopt));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[2]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[3]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
 
         float outputMin = -std::numeric_limits<float>::infinity();
         float outputMax = +std::numeric_limits<float>::infinity();
@@ -1026,8 +1568,9 @@ class Subgraph {
                                                 const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(
+                CheckQuantizationParamsMatch(operands[ins[0]], operands[outs[0]]));
         // Make sure all scalar params are constant.
         for (uint32_t i = 1; i < ins.size(); i++) {
             NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[i]].lifetime));
@@ -1215,10 +1758,13 @@ class Subgraph {
                                           const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[1]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckBinaryQuantization(operands[ins[0]], operands[ins[1]],
+                                                          operands[outs[0]],
+                                                          /*isMultiply=*/true));
 
         int activation = getScalarData<int32_t>(operands[ins[2]]);
         float outputMin = -std::numeric_limits<float>::infinity();
@@ -1294,11 +1840,12 @@ class Subgraph {
                                           const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
         NN_DRIVER_RETURN_IF_ERROR(
                 CheckTensorShape(operands[ins[0]].dimensions, 1, XNN_MAX_TENSOR_DIMS));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(
+                CheckQuantizationParamsMatch(operands[ins[0]], operands[outs[0]]));
         NN_DRIVER_RETURN_IF_ERROR(
                 CheckTensorShape(operands[outs[0]].dimensions, 1, XNN_MAX_TENSOR_DIMS));
 
@@ -1330,10 +1877,18 @@ class Subgraph {
                                             RunTimeOperandInfo* operands,
                                             const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
-        if (operands[ins[2]].type != OperandType::FLOAT32) {
+        const RunTimeOperandInfo& input = operands[ins[0]];
+        float padding_value = 0.0f;
+        if (operands[ins[2]].type == OperandType::FLOAT32 ||
+            operands[ins[2]].type == OperandType::FLOAT16) {
+            padding_value = getFloatScalarData(operands[ins[2]]);
+        } else if (operands[ins[2]].type == OperandType::INT32 && IsQuant8Type(input.type)) {
+            // XNNPACK quantizes the padding value with the output quantization parameters.
+            padding_value = (getScalarData<int32_t>(operands[ins[2]]) - input.zeroPoint) *
+                            input.scale;
+        } else {
             return V1_3::ErrorStatus::INVALID_ARGUMENT;
         }
-        float padding_value = getScalarData<float>(operands[ins[2]]);
         return VisitPadNode(subgraph, operation, operands, padding_value, xnnpackTensors);
     }
 
@@ -1343,11 +1898,12 @@ class Subgraph {
                                               const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
         NN_DRIVER_RETURN_IF_ERROR(
                 CheckTensorShape(operands[ins[0]].dimensions, 0, XNN_MAX_TENSOR_DIMS));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(
+                CheckQuantizationParamsMatch(operands[ins[0]], operands[outs[0]]));
         NN_DRIVER_RETURN_IF_ERROR(
                 CheckTensorShape(operands[outs[0]].dimensions, 0, XNN_MAX_TENSOR_DIMS));
 
@@ -1398,10 +1954,11 @@ class Subgraph {
             // explicitly specify the output dimension.
             new_width = static_cast<size_t>(getScalarData<int32_t>(operands[ins[1]]));
             new_height = static_cast<size_t>(getScalarData<int32_t>(operands[ins[2]]));
-        } else if (operands[ins[1]].type == OperandType::FLOAT32) {
+        } else if (operands[ins[1]].type == OperandType::FLOAT32 ||
+                   operands[ins[1]].type == OperandType::FLOAT16) {
             // specify the output dimension scaling factor.
-            float width_scale = getScalarData<float>(operands[ins[1]]);
-            float height_scale = getScalarData<float>(operands[ins[2]]);
+            float width_scale = getFloatScalarData(operands[ins[1]]);
+            float height_scale = getFloatScalarData(operands[ins[2]]);
             if (width_scale <= 0 || height_scale <= 0) {
                 return V1_3::ErrorStatus::INVALID_ARGUMENT;
             }
@@ -1446,8 +2003,9 @@ class Subgraph {
                                            const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(
+                CheckQuantizationParamsMatch(operands[ins[0]], operands[outs[0]]));
 
         if (subgraph != nullptr) {
             const xnn_status status =
@@ -1489,10 +2047,13 @@ class Subgraph {
                                           const std::vector<uint32_t>& xnnpackTensors) {
         const hardware::hidl_vec<uint32_t>& ins = operation.inputs;
         const hardware::hidl_vec<uint32_t>& outs = operation.outputs;
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[0]].type));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[ins[1]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[ins[1]].type));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[2]].lifetime));
-        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatOrQuant8Type(operands[outs[0]].type));
+        NN_DRIVER_RETURN_IF_ERROR(CheckBinaryQuantization(operands[ins[0]], operands[ins[1]],
+                                                          operands[outs[0]],
+                                                          /*isMultiply=*/false));
 
         float outputMin = -std::numeric_limits<float>::infinity();
         float outputMax = +std::numeric_limits<float>::infinity();
@@ -1524,7 +2085,7 @@ class Subgraph {
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorStaticAllocation(operands[ins[1]].lifetime));
         NN_DRIVER_RETURN_IF_ERROR(CheckTensorFloatType(operands[outs[0]].type));
 
-        float beta = getScalarData<float>(operands[ins[1]]);
+        float beta = getFloatScalarData(operands[ins[1]]);
         if (beta != 1.0f) {
             LOG(ERROR) << "XNNPACK VisitSoftmaxNode FAILED, unsupported beta value: " << beta;
             return V1_3::ErrorStatus::INVALID_ARGUMENT;
@@ -1552,11 +2113,17 @@ class Subgraph {
 
    private:
     Subgraph(xnn_runtime_t runtime, std::unordered_set<uint32_t>&& externals,
-             bool useStaticBuffer = false)
-        : mRuntime(runtime, &xnn_delete_runtime),
+             std::vector<std::vector<float>>&& ownedBuffers,
+             std::vector<Fp16External>&& fp16Externals, bool useStaticBuffer = false)
+        : mOwnedBuffers(std::move(ownedBuffers)),
+          mFp16Externals(std::move(fp16Externals)),
+          mRuntime(runtime, &xnn_delete_runtime),
           mExternals(externals),
           mUseStaticBuffer(useStaticBuffer) {}
 
+    // Buffers referenced by mRuntime. Declared first so that they outlive it.
+    std::vector<std::vector<float>> mOwnedBuffers;
+    std::vector<Fp16External> mFp16Externals;
     // XNNPACK Runtime (subgraph + workspace) with smart-pointer for lifetime
     // management.
     std::unique_ptr<xnn_runtime, decltype(&xnn_delete_runtime)> mRuntime{nullptr,
@@ -1568,17 +2135,18 @@ class Subgraph {
 
 class SamplePreparedModelXNNPACK : public SamplePreparedModel {
    public:
+    // The threadpool is owned by the driver and shared by all of its prepared models.
     SamplePreparedModelXNNPACK(const V1_3::Model& model, const SampleDriver* driver,
                                V1_1::ExecutionPreference preference, uid_t userId,
-                               V1_3::Priority priority)
+                               V1_3::Priority priority, pthreadpool_t threadpool)
         : SamplePreparedModel(model, driver, preference, userId, priority),
           mSubgraph(nullptr),
-          mThreadpool(nullptr) {}
-    ~SamplePreparedModelXNNPACK() {
-        delete mSubgraph;
-        pthreadpool_destroy(mThreadpool);
-    };
+          mThreadpool(threadpool) {}
+    ~SamplePreparedModelXNNPACK() { delete mSubgraph; };
     bool initialize();
+    bool saveToCache(const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+                     const hardware::hidl_vec<hardware::hidl_handle>& dataCache,
+                     const HalCacheToken& token) const;
     hardware::Return<V1_0::ErrorStatus> execute(
             const V1_0::Request& request, const sp<V1_0::IExecutionCallback>& callback) override;
     hardware::Return<V1_0::ErrorStatus> execute_1_2(
@@ -1613,7 +2181,7 @@ class SamplePreparedModelXNNPACK : public SamplePreparedModel {
    private:
     Subgraph* mSubgraph;
     std::vector<RunTimeOperandInfo> mOperands;
-    pthreadpool* mThreadpool;
+    pthreadpool_t mThreadpool;
 };
 
 hardware::Return<void> SamplePreparedModelXNNPACK::configureExecutionBurst(
@@ -1628,18 +2196,29 @@ hardware::Return<void> SamplePreparedModelXNNPACK::configureExecutionBurst(
 
 bool SamplePreparedModelXNNPACK::initialize() {
     auto status = SamplePreparedModel::initialize();
-    mThreadpool = pthreadpool_create(kNumOfWorkerThreads);
-    if (mThreadpool == nullptr) {
-        VLOG(DRIVER) << "SamplePreparedModelXNNPACK::initialize failed to create pthreadpool, "
-                        "fallback to single threaded execution";
-    }
     const V1_3::Model* model = getModel();
     mOperands = initializeRunTimeInfo(model->main, mPoolInfos, &model->operandValues);
+    // FLOAT16 models and models that allow relaxed FLOAT32 computation tolerate FP16 precision.
+    const bool allowFp16Inference =
+            model->relaxComputationFloat32toFloat16 ||
+            std::any_of(mOperands.begin(), mOperands.end(), [](const RunTimeOperandInfo& operand) {
+                return operand.type == OperandType::TENSOR_FLOAT16;
+            });
     mSubgraph = Subgraph::Create(model->main.operations, mOperands, model->main.inputIndexes,
-                                 model->main.outputIndexes, mThreadpool);
+                                 model->main.outputIndexes, mThreadpool, allowFp16Inference);
     return status;
 }
 
+bool SamplePreparedModelXNNPACK::saveToCache(
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache,
+        const HalCacheToken& token) const {
+    if (mSubgraph == nullptr) {
+        return false;
+    }
+    return saveModelToCache(mModel, mPoolInfos, modelCache, dataCache, token);
+}
+
 template <typename T_IExecutionCallback>
 void asyncExecuteXNNPACK(Subgraph* subgraph, RunTimeOperandInfo* operands,
                          const V1_3::Request& request, V1_2::MeasureTiming measure,
@@ -1666,7 +2245,7 @@ void asyncExecuteXNNPACK(Subgraph* subgraph, RunTimeOperandInfo* operands,
 template <typename T_IExecutionCallback>
 V1_3::ErrorStatus executeXNNPACKBase(Subgraph* subgraph, RunTimeOperandInfo* operands,
                                      const V1_3::Request& request, V1_2::MeasureTiming measure,
-                                     const V1_3::Model& model,
+                                     const V1_3::Model& model, V1_3::Priority priority,
                                      const V1_3::OptionalTimePoint& halDeadline,
                                      const V1_3::OptionalTimeoutDuration& loopTimeoutDuration,
                                      const sp<T_IExecutionCallback>& callback) {
@@ -1686,13 +2265,12 @@ V1_3::ErrorStatus executeXNNPACKBase(Subgraph* subgraph, RunTimeOperandInfo* ope
         return V1_3::ErrorStatus::NONE;
     }
 
-    // This thread is intentionally detached because the sample driver service
-    // is expected to live forever.
-    std::thread([&subgraph, &operands, &model, request, measure, deadline, loopTimeoutDuration,
-                 callback] {
+    getDriverThreadPool()->schedule(convert(priority).value(), [subgraph, operands, &model,
+                                                                request, measure, deadline,
+                                                                loopTimeoutDuration, callback] {
         asyncExecuteXNNPACK(subgraph, operands, request, measure, model, deadline,
                             loopTimeoutDuration, callback);
-    }).detach();
+    });
 
     return V1_3::ErrorStatus::NONE;
 }
@@ -1702,7 +2280,7 @@ hardware::Return<V1_0::ErrorStatus> SamplePreparedModelXNNPACK::execute(
     const V1_3::Model* model = getModel();
     const V1_3::ErrorStatus status =
             executeXNNPACKBase(mSubgraph, mOperands.data(), convertToV1_3(request),
-                               V1_2::MeasureTiming::NO, *model, {}, {}, callback);
+                               V1_2::MeasureTiming::NO, *model, kPriority, {}, {}, callback);
     return convertToV1_0(status);
 }
 
@@ -1710,8 +2288,9 @@ hardware::Return<V1_0::ErrorStatus> SamplePreparedModelXNNPACK::execute_1_2(
         const V1_0::Request& request, V1_2::MeasureTiming measure,
         const sp<V1_2::IExecutionCallback>& callback) {
     const V1_3::Model* model = getModel();
-    const V1_3::ErrorStatus status = executeXNNPACKBase(
-            mSubgraph, mOperands.data(), convertToV1_3(request), measure, *model, {}, {}, callback);
+    const V1_3::ErrorStatus status =
+            executeXNNPACKBase(mSubgraph, mOperands.data(), convertToV1_3(request), measure,
+                               *model, kPriority, {}, {}, callback);
     return convertToV1_0(status);
 }
 
@@ -1721,8 +2300,8 @@ hardware::Return<V1_3::ErrorStatus> SamplePreparedModelXNNPACK::execute_1_3(
         const V1_3::OptionalTimeoutDuration& loopTimeoutDuration,
         const sp<V1_3::IExecutionCallback>& callback) {
     const V1_3::Model* model = getModel();
-    return executeXNNPACKBase(mSubgraph, mOperands.data(), request, measure, *model, deadline,
-                              loopTimeoutDuration, callback);
+    return executeXNNPACKBase(mSubgraph, mOperands.data(), request, measure, *model, kPriority,
+                              deadline, loopTimeoutDuration, callback);
 }
 
 static std::tuple<V1_3::ErrorStatus, hardware::hidl_vec<V1_2::OutputShape>, V1_2::Timing>
@@ -1835,8 +2414,16 @@ hardware::Return<void> SamplePreparedModelXNNPACK::executeFenced(
 
 class SampleDriverFloatXNNPACK : public SampleDriverPartial {
    public:
-    SampleDriverFloatXNNPACK(const std::string& name) : SampleDriverPartial(name.c_str()) {}
+    SampleDriverFloatXNNPACK(const std::string& name)
+        : SampleDriverPartial(name.c_str()),
+          mThreadpool(pthreadpool_create(kNumOfWorkerThreads), &pthreadpool_destroy) {
+        if (mThreadpool == nullptr) {
+            LOG(WARNING) << "SampleDriverFloatXNNPACK failed to create pthreadpool, "
+                            "fallback to single threaded execution";
+        }
+    }
     hardware::Return<void> getCapabilities_1_3(getCapabilities_1_3_cb cb) override;
+    hardware::Return<void> getNumberOfCacheFilesNeeded(getNumberOfCacheFilesNeeded_cb cb) override;
     hardware::Return<V1_0::ErrorStatus> prepareModel(
             const V1_0::Model& model, const sp<V1_0::IPreparedModelCallback>& callback) override;
     hardware::Return<V1_0::ErrorStatus> prepareModel_1_1(
@@ -1853,20 +2440,38 @@ class SampleDriverFloatXNNPACK : public SampleDriverPartial {
             const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
             const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
             const sp<V1_3::IPreparedModelCallback>& callback) override;
+    hardware::Return<V1_0::ErrorStatus> prepareModelFromCache(
+            const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+            const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
+            const sp<V1_2::IPreparedModelCallback>& callback) override;
+    hardware::Return<V1_3::ErrorStatus> prepareModelFromCache_1_3(
+            const V1_3::OptionalTimePoint& deadline,
+            const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+            const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
+            const sp<V1_3::IPreparedModelCallback>& callback) override;
     hardware::Return<void> allocate(
             const V1_3::BufferDesc& desc,
             const hardware::hidl_vec<sp<V1_3::IPreparedModel>>& preparedModels,
             const hardware::hidl_vec<V1_3::BufferRole>& inputRoles,
             const hardware::hidl_vec<V1_3::BufferRole>& outputRoles, allocate_cb cb) override;
 
+    // A single threadpool sized to the machine is shared by all prepared models of the driver.
+    // Concurrent executions are serialized by pthreadpool.
+    pthreadpool_t getThreadpool() const { return mThreadpool.get(); }
+
    private:
     std::vector<bool> getSupportedOperationsImpl(const V1_3::Model& model) const override;
+
+    std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> mThreadpool;
 };
 
 template <typename T_Model, typename T_IPreparedModelCallback>
-V1_3::ErrorStatus prepareModelXNNPACK(const T_Model& model, const SampleDriver* driver,
+V1_3::ErrorStatus prepareModelXNNPACK(const T_Model& model, const SampleDriverFloatXNNPACK* driver,
                                       V1_1::ExecutionPreference preference, V1_3::Priority priority,
                                       const V1_3::OptionalTimePoint& deadline,
+                                      const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+                                      const hardware::hidl_vec<hardware::hidl_handle>& dataCache,
+                                      const HalCacheToken& token,
                                       const sp<T_IPreparedModelCallback>& callback) {
     const uid_t userId = hardware::IPCThreadState::self()->getCallingUid();
     if (callback.get() == nullptr) {
@@ -1883,16 +2488,72 @@ V1_3::ErrorStatus prepareModelXNNPACK(const T_Model& model, const SampleDriver*
         return V1_3::ErrorStatus::INVALID_ARGUMENT;
     }
 
-    // asynchronously prepare the model from a new, detached thread
-    std::thread([model, driver, preference, userId, priority, callback] {
-        sp<SamplePreparedModelXNNPACK> preparedModel = new SamplePreparedModelXNNPACK(
-                convertToV1_3(model), driver, preference, userId, priority);
+    // asynchronously prepare the model on the thread pool
+    getDriverThreadPool()->schedule(convert(priority).value(), [model, driver, preference,
+                                                                userId, priority, modelCache,
+                                                                dataCache, token, callback] {
+        NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_COMPILATION, "prepareModelXNNPACK");
+        sp<SamplePreparedModelXNNPACK> preparedModel =
+                new SamplePreparedModelXNNPACK(convertToV1_3(model), driver, preference, userId,
+                                               priority, driver->getThreadpool());
         if (!preparedModel->initialize()) {
             notify(callback, V1_3::ErrorStatus::INVALID_ARGUMENT, nullptr);
             return;
         }
+        // Failing to write the cache is not an error: the model is simply prepared again from
+        // scratch next time.
+        if (modelCache.size() != 0 || dataCache.size() != 0) {
+            if (!preparedModel->saveToCache(modelCache, dataCache, token)) {
+                VLOG(DRIVER) << "prepareModelXNNPACK: model not saved to cache";
+            }
+        }
         notify(callback, V1_3::ErrorStatus::NONE, preparedModel);
-    }).detach();
+    });
+
+    return V1_3::ErrorStatus::NONE;
+}
+
+template <typename T_IPreparedModelCallback>
+V1_3::ErrorStatus prepareModelFromCacheXNNPACK(
+        const SampleDriverFloatXNNPACK* driver, const V1_3::OptionalTimePoint& halDeadline,
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
+        const sp<T_IPreparedModelCallback>& callback) {
+    const uid_t userId = hardware::IPCThreadState::self()->getCallingUid();
+    if (callback.get() == nullptr) {
+        LOG(ERROR) << "invalid callback passed to prepareModelFromCacheXNNPACK";
+        return V1_3::ErrorStatus::INVALID_ARGUMENT;
+    }
+    if (modelCache.size() != kNumModelCacheFiles || dataCache.size() != kNumDataCacheFiles) {
+        notify(callback, V1_3::ErrorStatus::INVALID_ARGUMENT, nullptr);
+        return V1_3::ErrorStatus::INVALID_ARGUMENT;
+    }
+    const auto deadline = makeDeadline(halDeadline);
+    if (hasDeadlinePassed(deadline)) {
+        notify(callback, V1_3::ErrorStatus::MISSED_DEADLINE_PERSISTENT, nullptr);
+        return V1_3::ErrorStatus::NONE;
+    }
+
+    // asynchronously prepare the model on the thread pool
+    getDriverThreadPool()->schedule(convert(kDefaultPriority13).value(), [driver, userId,
+                                                                          modelCache, dataCache,
+                                                                          token, callback] {
+        NNTRACE_FULL(NNTRACE_LAYER_DRIVER, NNTRACE_PHASE_COMPILATION,
+                     "prepareModelFromCacheXNNPACK");
+        std::optional<V1_3::Model> model = loadModelFromCache(modelCache, dataCache, token);
+        if (!model.has_value()) {
+            notify(callback, V1_3::ErrorStatus::GENERAL_FAILURE, nullptr);
+            return;
+        }
+        sp<SamplePreparedModelXNNPACK> preparedModel = new SamplePreparedModelXNNPACK(
+                std::move(model).value(), driver, V1_1::ExecutionPreference::FAST_SINGLE_ANSWER,
+                userId, kDefaultPriority13, driver->getThreadpool());
+        if (!preparedModel->initialize()) {
+            notify(callback, V1_3::ErrorStatus::GENERAL_FAILURE, nullptr);
+            return;
+        }
+        notify(callback, V1_3::ErrorStatus::NONE, preparedModel);
+    });
 
     return V1_3::ErrorStatus::NONE;
 }
@@ -1901,25 +2562,26 @@ hardware::Return<V1_0::ErrorStatus> SampleDriverFloatXNNPACK::prepareModel(
         const V1_0::Model& model, const sp<V1_0::IPreparedModelCallback>& callback) {
     const V1_3::ErrorStatus status =
             prepareModelXNNPACK(model, this, V1_1::ExecutionPreference::FAST_SINGLE_ANSWER,
-                                kDefaultPriority13, {}, callback);
+                                kDefaultPriority13, {}, {}, {}, {}, callback);
     return convertToV1_0(status);
 }
 
 hardware::Return<V1_0::ErrorStatus> SampleDriverFloatXNNPACK::prepareModel_1_1(
         const V1_1::Model& model, V1_1::ExecutionPreference preference,
         const sp<V1_0::IPreparedModelCallback>& callback) {
-    const V1_3::ErrorStatus status =
-            prepareModelXNNPACK(model, this, preference, kDefaultPriority13, {}, callback);
+    const V1_3::ErrorStatus status = prepareModelXNNPACK(
+            model, this, preference, kDefaultPriority13, {}, {}, {}, {}, callback);
     return convertToV1_0(status);
 }
 
 hardware::Return<V1_0::ErrorStatus> SampleDriverFloatXNNPACK::prepareModel_1_2(
         const V1_2::Model& model, V1_1::ExecutionPreference preference,
-        const hardware::hidl_vec<hardware::hidl_handle>&,
-        const hardware::hidl_vec<hardware::hidl_handle>&, const HalCacheToken&,
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
         const sp<V1_2::IPreparedModelCallback>& callback) {
     const V1_3::ErrorStatus status =
-            prepareModelXNNPACK(model, this, preference, kDefaultPriority13, {}, callback);
+            prepareModelXNNPACK(model, this, preference, kDefaultPriority13, {}, modelCache,
+                                dataCache, token, callback);
     return convertToV1_0(status);
 }
 
@@ -1929,7 +2591,31 @@ hardware::Return<V1_3::ErrorStatus> SampleDriverFloatXNNPACK::prepareModel_1_3(
         const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
         const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
         const sp<V1_3::IPreparedModelCallback>& callback) {
-    return prepareModelXNNPACK(model, this, preference, priority, deadline, callback);
+    return prepareModelXNNPACK(model, this, preference, priority, deadline, modelCache, dataCache,
+                               token, callback);
+}
+
+hardware::Return<V1_0::ErrorStatus> SampleDriverFloatXNNPACK::prepareModelFromCache(
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
+        const sp<V1_2::IPreparedModelCallback>& callback) {
+    const V1_3::ErrorStatus status =
+            prepareModelFromCacheXNNPACK(this, {}, modelCache, dataCache, token, callback);
+    return convertToV1_0(status);
+}
+
+hardware::Return<V1_3::ErrorStatus> SampleDriverFloatXNNPACK::prepareModelFromCache_1_3(
+        const V1_3::OptionalTimePoint& deadline,
+        const hardware::hidl_vec<hardware::hidl_handle>& modelCache,
+        const hardware::hidl_vec<hardware::hidl_handle>& dataCache, const HalCacheToken& token,
+        const sp<V1_3::IPreparedModelCallback>& callback) {
+    return prepareModelFromCacheXNNPACK(this, deadline, modelCache, dataCache, token, callback);
+}
+
+hardware::Return<void> SampleDriverFloatXNNPACK::getNumberOfCacheFilesNeeded(
+        getNumberOfCacheFilesNeeded_cb cb) {
+    cb(V1_0::ErrorStatus::NONE, kNumModelCacheFiles, kNumDataCacheFiles);
+    return hardware::Void();
 }
 
 hardware::Return<void> SampleDriverFloatXNNPACK::getCapabilities_1_3(getCapabilities_1_3_cb cb) {
@@ -1946,6 +2632,14 @@ hardware::Return<void> SampleDriverFloatXNNPACK::getCapabilities_1_3(getCapabili
            {.execTime = 0.8f, .powerUsage = 1.2f});
     update(&capabilities.operandPerformance, V1_3::OperandType::FLOAT32,
            {.execTime = 0.8f, .powerUsage = 1.2f});
+    update(&capabilities.operandPerformance, V1_3::OperandType::TENSOR_FLOAT16,
+           {.execTime = 0.8f, .powerUsage = 1.2f});
+    update(&capabilities.operandPerformance, V1_3::OperandType::FLOAT16,
+           {.execTime = 0.8f, .powerUsage = 1.2f});
+    update(&capabilities.operandPerformance, V1_3::OperandType::TENSOR_QUANT8_ASYMM,
+           {.execTime = 0.8f, .powerUsage = 1.2f});
+    update(&capabilities.operandPerformance, V1_3::OperandType::TENSOR_QUANT8_ASYMM_SIGNED,
+           {.execTime = 0.8f, .powerUsage = 1.2f});
 
     cb(V1_3::ErrorStatus::NONE, capabilities);
     return hardware::Void();
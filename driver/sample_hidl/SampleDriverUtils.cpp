@@ -20,6 +20,7 @@
 #include <hidl/HidlTransportSupport.h>
 
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -18,10 +18,11 @@
 #define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_DRIVER_SAMPLE_SAMPLE_DRIVER_UTILS_H
 
 #include <HalInterfaces.h>
+#include <PriorityThreadPool.h>
 #include <hwbinder/IPCThreadState.h>
+#include <nnapi/hal/1.3/Conversions.h>
 
 #include <string>
-#include <thread>
 #include <utility>
 #include <vector>
 
@@ -83,8 +84,10 @@ V1_3::ErrorStatus prepareModelBase(const T_Model& model, const SampleDriver* dri
         return V1_3::ErrorStatus::NONE;
     }
 
-    // asynchronously prepare the model from a new, detached thread
-    std::thread([model, driver, preference, userId, priority, callback] {
+    // asynchronously prepare the model on the thread pool
+    const Priority canonicalPriority = convert(priority).value();
+    getDriverThreadPool()->schedule(canonicalPriority, [model, driver, preference, userId,
+                                                        priority, callback] {
         sp<SamplePreparedModel> preparedModel =
                 new SamplePreparedModel(convertToV1_3(model), driver, preference, userId, priority);
         if (!preparedModel->initialize()) {
@@ -92,7 +95,7 @@ V1_3::ErrorStatus prepareModelBase(const T_Model& model, const SampleDriver* dri
             return;
         }
         notify(callback, V1_3::ErrorStatus::NONE, preparedModel);
-    }).detach();
+    });
 
     return V1_3::ErrorStatus::NONE;
 }
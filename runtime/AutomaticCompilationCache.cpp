@@ -0,0 +1,250 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "AutomaticCompilationCache"
+
+#include "AutomaticCompilationCache.h"
+
+#include <LegacyUtils.h>
+#include <android-base/logging.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "ModelArchHasher.h"
+#include "ModelBuilder.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr size_t kEntryNameLength = kByteSizeOfCacheToken * 2;
+
+std::string withTrailingSlash(const std::string& dir) {
+    return (dir.empty() || dir.back() == '/') ? dir : dir + '/';
+}
+
+std::string toEntryName(const CacheToken& token) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    std::string name(kEntryNameLength, '0');
+    for (size_t i = 0; i < token.size(); ++i) {
+        name[i * 2] = kHexDigits[token[i] >> 4];
+        name[i * 2 + 1] = kHexDigits[token[i] & 0x0F];
+    }
+    return name;
+}
+
+// Whether a directory within the cache directory was created by acquireEntry(). Anything else in
+// the cache directory is left alone.
+bool isEntryName(const std::string& name) {
+    return name.size() == kEntryNameLength &&
+           std::all_of(name.begin(), name.end(),
+                       [](char c) { return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'); });
+}
+
+// Returns the total size of the cache files in an entry directory.
+uint64_t getEntryBytes(const fs::path& entry) {
+    uint64_t bytes = 0;
+    std::error_code ec;
+    for (fs::directory_iterator it(entry, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code sizeError;
+        const uintmax_t size = it->file_size(sizeError);
+        if (!sizeError) {
+            bytes += size;
+        }
+    }
+    return bytes;
+}
+
+// Reads the state of a cache directory that changes when an entry is added to or removed from it.
+bool getDirectoryState(const std::string& dir, int64_t* modifiedNs, uint64_t* links) {
+    struct stat st;
+    if (stat(dir.c_str(), &st) != 0) {
+        return false;
+    }
+    *modifiedNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+    *links = st.st_nlink;
+    return true;
+}
+
+}  // namespace
+
+AutomaticCompilationCache* AutomaticCompilationCache::get() {
+    static AutomaticCompilationCache cache;
+    return &cache;
+}
+
+std::optional<CacheToken> AutomaticCompilationCache::makeToken(const ModelBuilder& model) {
+    const uint8_t* contentHash = model.getModelContentHash();
+    if (contentHash == nullptr) {
+        return std::nullopt;
+    }
+    static_assert(BYTE_SIZE_OF_MODEL_ARCH_HASH == kByteSizeOfCacheToken);
+    CacheToken token;
+    std::copy(contentHash, contentHash + token.size(), token.begin());
+    return token;
+}
+
+std::optional<std::string> AutomaticCompilationCache::acquireEntry(const std::string& cacheDir,
+                                                                   const CacheToken& token) {
+    const std::string dir = withTrailingSlash(cacheDir);
+    const std::string entryDir = dir + toEntryName(token) + '/';
+    std::lock_guard<std::mutex> lock(mMutex);
+    // An existing index is brought up to date before this process changes the directory, so that
+    // the changes of other processes are still noticed.
+    DirectoryIndex* index = mIndexes.count(dir) > 0 ? getIndexLocked(dir) : nullptr;
+    std::error_code ec;
+    fs::create_directories(entryDir, ec);
+    if (ec) {
+        LOG(ERROR) << "Unable to create automatic compilation cache entry " << entryDir << ": "
+                   << ec.message();
+        return std::nullopt;
+    }
+    // The modification time of the entry directory records when the entry was last used.
+    const fs::file_time_type now = fs::file_time_type::clock::now();
+    fs::last_write_time(entryDir, now, ec);
+    if (index != nullptr) {
+        index->entries[entryDir].lastUsed = now;
+        if (!getDirectoryState(dir, &index->modifiedNs, &index->links)) {
+            mIndexes.erase(dir);
+        }
+    }
+    ++mEntriesInUse[entryDir];
+    return entryDir;
+}
+
+void AutomaticCompilationCache::releaseEntry(const std::string& cacheDir,
+                                             const std::string& entryDir, uint64_t maxBytes) {
+    const std::string dir = withTrailingSlash(cacheDir);
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto inUse = mEntriesInUse.find(entryDir);
+    CHECK(inUse != mEntriesInUse.end());
+    if (--inUse->second == 0) {
+        mEntriesInUse.erase(inUse);
+    }
+    DirectoryIndex* index = getIndexLocked(dir);
+    if (index == nullptr) {
+        return;
+    }
+    // The compilation may have written cache files into the entry, so it is measured again.
+    const auto [it, inserted] = index->entries.try_emplace(entryDir);
+    index->totalBytes -= it->second.bytes;
+    std::error_code ec;
+    const fs::file_time_type lastUsed = fs::last_write_time(entryDir, ec);
+    if (ec) {
+        index->entries.erase(it);
+    } else {
+        it->second = {.bytes = getEntryBytes(entryDir), .lastUsed = lastUsed};
+        index->totalBytes += it->second.bytes;
+    }
+    trimLocked(dir, index, maxBytes);
+}
+
+AutomaticCompilationCache::DirectoryIndex* AutomaticCompilationCache::getIndexLocked(
+        const std::string& cacheDir) {
+    int64_t modifiedNs = 0;
+    uint64_t links = 0;
+    if (!getDirectoryState(cacheDir, &modifiedNs, &links)) {
+        mIndexes.erase(cacheDir);
+        return nullptr;
+    }
+    const auto it = mIndexes.find(cacheDir);
+    if (it != mIndexes.end() && it->second.modifiedNs == modifiedNs &&
+        it->second.links == links) {
+        return &it->second;
+    }
+
+    VLOG(COMPILATION) << "Scanning automatic compilation cache directory " << cacheDir;
+    DirectoryIndex index = {.modifiedNs = modifiedNs, .links = links};
+    std::error_code ec;
+    for (fs::directory_iterator dirIt(cacheDir, ec), end; !ec && dirIt != end;
+         dirIt.increment(ec)) {
+        std::error_code entryError;
+        const std::string name = dirIt->path().filename();
+        if (!isEntryName(name) || !dirIt->is_directory(entryError)) {
+            continue;
+        }
+        const fs::file_time_type lastUsed = dirIt->last_write_time(entryError);
+        if (entryError) {
+            continue;
+        }
+        const uint64_t bytes = getEntryBytes(dirIt->path());
+        index.entries[cacheDir + name + '/'] = {.bytes = bytes, .lastUsed = lastUsed};
+        index.totalBytes += bytes;
+    }
+    if (ec) {
+        LOG(WARNING) << "Unable to scan automatic compilation cache directory " << cacheDir << ": "
+                     << ec.message();
+        mIndexes.erase(cacheDir);
+        return nullptr;
+    }
+    return &(mIndexes[cacheDir] = std::move(index));
+}
+
+void AutomaticCompilationCache::trimLocked(const std::string& cacheDir, DirectoryIndex* index,
+                                           uint64_t maxBytes) {
+    if (index->totalBytes <= maxBytes) {
+        return;
+    }
+    using EntryIterator = std::map<std::string, IndexedEntry>::iterator;
+    std::vector<EntryIterator> candidates;
+    for (auto it = index->entries.begin(); it != index->entries.end(); ++it) {
+        if (mEntriesInUse.count(it->first) == 0) {
+            candidates.push_back(it);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), [](EntryIterator a, EntryIterator b) {
+        return a->second.lastUsed < b->second.lastUsed;
+    });
+    bool isConsistent = true;
+    for (EntryIterator it : candidates) {
+        if (index->totalBytes <= maxBytes) {
+            break;
+        }
+        std::error_code removeError;
+        const uintmax_t removed = fs::remove_all(it->first, removeError);
+        if (removeError) {
+            LOG(WARNING) << "Unable to remove automatic compilation cache entry " << it->first
+                         << ": " << removeError.message();
+            continue;
+        }
+        if (removed == 0) {
+            // Another process removed the entry without the index noticing.
+            isConsistent = false;
+        } else {
+            VLOG(COMPILATION) << "Evicted automatic compilation cache entry " << it->first << " ("
+                              << it->second.bytes << " bytes)";
+        }
+        index->totalBytes -= it->second.bytes;
+        index->entries.erase(it);
+    }
+    if (!isConsistent || !getDirectoryState(cacheDir, &index->modifiedNs, &index->links)) {
+        mIndexes.erase(cacheDir);
+    }
+}
+
+}  // namespace nn
+}  // namespace android
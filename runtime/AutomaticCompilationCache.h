@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_AUTOMATIC_COMPILATION_CACHE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_AUTOMATIC_COMPILATION_CACHE_H
+
+#include <android-base/thread_annotations.h>
+#include <nnapi/Types.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace android {
+namespace nn {
+
+class ModelBuilder;
+
+// Manages compilation caching for compilations whose application did not call
+// ANeuralNetworksCompilation_setCaching. The cache token is derived from the content of the model,
+// and the cache files of each model are kept in their own entry directory within the cache
+// directory configured by DeviceManager::setAutomaticCaching(). When the cache files occupy more
+// than the configured number of bytes, the least recently used entries are removed.
+//
+// Entries are only shared with other processes through the file system. Entries that are in use by
+// an ongoing compilation in this process are never removed.
+//
+// The size and the last use of the entries of each cache directory are kept in memory, and updated
+// as entries are used, released and removed, so that releasing an entry only measures that entry.
+// The cache directory is scanned again when its modification time or link count shows that
+// another process added or removed entries, or when an entry to be removed is already gone.
+class AutomaticCompilationCache {
+   public:
+    // Returns the singleton cache.
+    static AutomaticCompilationCache* get();
+
+    // Returns a token identifying the content of the model: its content hash, which covers its
+    // arch hash, the values of its constant operands, whether its FLOAT32 computation may be
+    // relaxed to FLOAT16, and its extension prefixes. Returns std::nullopt if the model cannot be
+    // hashed.
+    static std::optional<CacheToken> makeToken(const ModelBuilder& model);
+
+    // Returns the entry directory for the token within cacheDir, ending with '/'. The directory is
+    // created if needed and marked as most recently used. The entry stays in use until release()
+    // is called with the returned directory. Returns std::nullopt if the directory cannot be
+    // created.
+    std::optional<std::string> acquireEntry(const std::string& cacheDir, const CacheToken& token);
+
+    // Releases an entry returned by acquireEntry(), then removes the least recently used entries
+    // that are not in use until the entries of cacheDir occupy at most maxBytes.
+    void releaseEntry(const std::string& cacheDir, const std::string& entryDir, uint64_t maxBytes);
+
+   private:
+    struct IndexedEntry {
+        uint64_t bytes = 0;
+        std::filesystem::file_time_type lastUsed;
+    };
+
+    // The entries of a cache directory, by entry directory.
+    struct DirectoryIndex {
+        std::map<std::string, IndexedEntry> entries;
+        uint64_t totalBytes = 0;
+        // The state of the cache directory when the index was last brought up to date.
+        int64_t modifiedNs = 0;
+        uint64_t links = 0;
+    };
+
+    // Returns the index of cacheDir, scanning the directory if there is no index yet or if the
+    // directory changed since. Returns nullptr if the directory cannot be scanned.
+    DirectoryIndex* getIndexLocked(const std::string& cacheDir) REQUIRES(mMutex);
+    void trimLocked(const std::string& cacheDir, DirectoryIndex* index, uint64_t maxBytes)
+            REQUIRES(mMutex);
+
+    std::mutex mMutex;
+    // Number of ongoing compilations using each entry directory.
+    std::map<std::string, uint32_t> mEntriesInUse GUARDED_BY(mMutex);
+    // By cache directory, ending with '/'.
+    std::map<std::string, DirectoryIndex> mIndexes GUARDED_BY(mMutex);
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_AUTOMATIC_COMPILATION_CACHE_H
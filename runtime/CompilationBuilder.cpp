@@ -19,6 +19,7 @@
 #include "CompilationBuilder.h"
 
 #include <LegacyUtils.h>
+#include <android-base/scopeguard.h>
 #include <nnapi/IBurst.h>
 #include <nnapi/SharedMemory.h>
 #include <nnapi/Types.h>
@@ -26,10 +27,12 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "AutomaticCompilationCache.h"
 #include "BurstBuilder.h"
 #include "ExecutionBuilder.h"
 #include "ExecutionPlan.h"
@@ -65,9 +68,20 @@ int CompilationBuilder::finish() {
     const auto deadline = makeDeadline(mTimeoutDuration);
 
     mFinished = true;
+    std::optional<std::string> automaticCacheEntry;
     if (mIsCacheInfoProvided) {
         mPlan.setCaching(&mCacheInfo, mToken);
-    }
+    } else if (!DeviceManager::get()->getAutomaticCacheDir().empty()) {
+        automaticCacheEntry = setAutomaticCaching();
+    }
+    const auto releaseAutomaticCacheEntry = base::make_scope_guard([&automaticCacheEntry] {
+        if (automaticCacheEntry.has_value()) {
+            const DeviceManager* manager = DeviceManager::get();
+            AutomaticCompilationCache::get()->releaseEntry(manager->getAutomaticCacheDir(),
+                                                           *automaticCacheEntry,
+                                                           manager->getAutomaticCacheMaxBytes());
+        }
+    });
     if (mPartitioning) {
         int n = mModel->partitionTheWork(mDevices, mPreference, mPriority, deadline, &mPlan,
                                          mMetadata, mFailPartitioning);
@@ -107,6 +121,24 @@ int CompilationBuilder::finish() {
     return mPlan.finish(mPreference, mPriority, deadline, mMetadata, ANEURALNETWORKS_NO_ERROR);
 }
 
+std::optional<std::string> CompilationBuilder::setAutomaticCaching() {
+    const std::optional<CacheToken> token = AutomaticCompilationCache::makeToken(*mModel);
+    if (!token.has_value()) {
+        LOG(WARNING) << "Unable to compute the automatic compilation cache token";
+        return std::nullopt;
+    }
+    std::optional<std::string> entryDir = AutomaticCompilationCache::get()->acquireEntry(
+            DeviceManager::get()->getAutomaticCacheDir(), *token);
+    if (!entryDir.has_value()) {
+        return std::nullopt;
+    }
+    VLOG(COMPILATION) << "CompilationBuilder::finish using automatic cache entry " << *entryDir;
+    mCacheInfo.variant = *entryDir;
+    std::copy(token->begin(), token->end(), mToken);
+    mPlan.setCaching(&mCacheInfo, mToken);
+    return entryDir;
+}
+
 int CompilationBuilder::setPreference(int32_t preference) {
     if (mFinished) {
         LOG(ERROR) << "ANeuralNetworksCompilation_setPreference can't modify after compilation "
@@ -103,6 +103,12 @@ class CompilationBuilder {
     const std::optional<TelemetryInfo>& getTelemetryInfo() const { return mTelemetryInfo; }
 
    private:
+    // Sets up compilation caching in an entry of the automatic compilation cache, with a token
+    // derived from the content of the model. Returns the entry directory, which the caller must
+    // release once the compilation is finished, or std::nullopt if automatic caching cannot be
+    // used for this compilation.
+    std::optional<std::string> setAutomaticCaching();
+
     const ModelBuilder* mModel;
 
     ExecutionPlan mPlan;
@@ -0,0 +1,394 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "CpuModelCache"
+
+#include "CpuModelCache.h"
+
+#include <CpuExecutor.h>
+#include <CpuPackedWeights.h>
+#include <LegacyUtils.h>
+#include <TokenHasher.h>
+#include <Tracing.h>
+#include <android-base/file.h>
+#include <android-base/logging.h>
+#include <nnapi/SharedMemory.h>
+#include <nnapi/TypeUtils.h>
+#include <nnapi/Types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "Manager.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+constexpr uint32_t kCacheMagic = 0x55504e4e;  // "NNPU"
+constexpr uint32_t kCacheVersion = 2;
+constexpr size_t kCacheDataAlignment = 64;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t metadataSize;
+    uint64_t dataSize;
+    // SHA-256 of the cache token, the metadata and the data size. The data itself is not hashed,
+    // so that preparing from cache does not have to read the constant values. A corrupted value
+    // can only produce wrong results, because the model is validated after it is loaded.
+    uint8_t checksum[kByteSizeOfCacheToken];
+};
+
+constexpr PackedLayout kPackedLayouts[] = {
+        PackedLayout::UINT8_FROM_INT8,
+        PackedLayout::FLOAT32_FROM_FLOAT16,
+        PackedLayout::TRANSPOSED_ROWS_COLUMNS,
+};
+
+// A copy of the values of a constant operand packed when the model was prepared, stored in the
+// data section after the constant values.
+struct PackedCopy {
+    PackedLayout layout;
+    uint32_t offset;
+    uint32_t size;
+};
+
+class CacheWriter {
+   public:
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+        mBuffer.insert(mBuffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& values) {
+        write(static_cast<uint32_t>(values.size()));
+        for (const T& value : values) {
+            write(value);
+        }
+    }
+
+    const std::vector<uint8_t>& buffer() const { return mBuffer; }
+
+   private:
+    std::vector<uint8_t> mBuffer;
+};
+
+// Bounds-checked reader over the metadata section of a model cache file.
+class CacheReader {
+   public:
+    explicit CacheReader(const std::vector<uint8_t>& buffer) : mBuffer(buffer) {}
+
+    template <typename T>
+    bool read(T* value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (mBuffer.size() - mOffset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(value, mBuffer.data() + mOffset, sizeof(T));
+        mOffset += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool read(std::vector<T>* values) {
+        uint32_t count = 0;
+        if (!read(&count) || (mBuffer.size() - mOffset) / sizeof(T) < count) {
+            return false;
+        }
+        values->resize(count);
+        for (T& value : *values) {
+            read(&value);
+        }
+        return true;
+    }
+
+    bool finished() const { return mOffset == mBuffer.size(); }
+
+   private:
+    const std::vector<uint8_t>& mBuffer;
+    size_t mOffset = 0;
+};
+
+// Appends size bytes to data at the next aligned offset and returns that offset.
+Result<uint32_t> appendData(const uint8_t* bytes, size_t size, std::vector<uint8_t>* data) {
+    data->resize(roundUp(data->size(), kCacheDataAlignment));
+    if (data->size() > std::numeric_limits<uint32_t>::max() - size) {
+        return NN_ERROR() << "Constant values are too large to be cached";
+    }
+    const auto offset = static_cast<uint32_t>(data->size());
+    data->insert(data->end(), bytes, bytes + size);
+    return offset;
+}
+
+// Serializes the subgraph into metadata. The values of constant operands are appended to data and
+// the operands are rewritten as CONSTANT_REFERENCE operands of pool 0. The copies of the values
+// in packedWeights, if any, are appended to data as well.
+Result<void> writeSubgraph(const Model& model, const Model::Subgraph& subgraph,
+                           const std::vector<RunTimePoolInfo>& poolInfos,
+                           const CpuPackedWeights* packedWeights, CacheWriter* metadata,
+                           std::vector<uint8_t>* data) {
+    metadata->write(static_cast<uint32_t>(subgraph.operands.size()));
+    for (const Operand& operand : subgraph.operands) {
+        if (std::holds_alternative<Operand::ExtensionParams>(operand.extraParams)) {
+            return NN_ERROR() << "Operands with extension parameters cannot be cached";
+        }
+        Operand::LifeTime lifetime = operand.lifetime;
+        DataLocation location = {.poolIndex = operand.location.poolIndex,
+                                 .offset = operand.location.offset,
+                                 .length = operand.location.length};
+        std::vector<PackedCopy> packedCopies;
+        if (const uint8_t* values = getConstantOperandData(model, operand, poolInfos)) {
+            lifetime = Operand::LifeTime::CONSTANT_REFERENCE;
+            location = {.poolIndex = 0,
+                        .offset = NN_TRY(appendData(values, location.length, data)),
+                        .length = location.length};
+            for (const auto layout : kPackedLayouts) {
+                const void* packed =
+                        packedWeights == nullptr
+                                ? nullptr
+                                : packedWeights->lookup(values, operand.location.length,
+                                                        operand.dimensions, layout);
+                const auto size = CpuPackedWeights::getPackedSize(
+                        operand.type, operand.dimensions, operand.location.length, layout);
+                if (packed == nullptr || !size.has_value()) {
+                    continue;
+                }
+                const uint32_t offset =
+                        NN_TRY(appendData(static_cast<const uint8_t*>(packed), *size, data));
+                packedCopies.push_back(
+                        {.layout = layout, .offset = offset, .size = static_cast<uint32_t>(*size)});
+            }
+        }
+        metadata->write(operand.type);
+        metadata->write(operand.dimensions);
+        metadata->write(operand.scale);
+        metadata->write(operand.zeroPoint);
+        metadata->write(lifetime);
+        metadata->write(location.poolIndex);
+        metadata->write(location.offset);
+        metadata->write(location.length);
+        const auto* channelQuant =
+                std::get_if<Operand::SymmPerChannelQuantParams>(&operand.extraParams);
+        metadata->write(static_cast<uint8_t>(channelQuant != nullptr));
+        if (channelQuant != nullptr) {
+            metadata->write(channelQuant->scales);
+            metadata->write(channelQuant->channelDim);
+        }
+        metadata->write(packedCopies);
+    }
+    metadata->write(static_cast<uint32_t>(subgraph.operations.size()));
+    for (const Operation& operation : subgraph.operations) {
+        metadata->write(operation.type);
+        metadata->write(operation.inputs);
+        metadata->write(operation.outputs);
+    }
+    metadata->write(subgraph.inputIndexes);
+    metadata->write(subgraph.outputIndexes);
+    return {};
+}
+
+// Deserializes a subgraph written by writeSubgraph. The packed copies of its constants are
+// appended to packedCopies.
+bool readSubgraph(CacheReader* reader, Model::Subgraph* subgraph,
+                  std::vector<CpuPackedWeights::CachedCopy>* packedCopies) {
+    uint32_t operandCount = 0;
+    if (!reader->read(&operandCount)) {
+        return false;
+    }
+    subgraph->operands.reserve(std::min<uint32_t>(operandCount, 1024));
+    for (uint32_t i = 0; i < operandCount; ++i) {
+        Operand operand;
+        uint8_t hasChannelQuant = 0;
+        if (!reader->read(&operand.type) || !reader->read(&operand.dimensions) ||
+            !reader->read(&operand.scale) || !reader->read(&operand.zeroPoint) ||
+            !reader->read(&operand.lifetime) || !reader->read(&operand.location.poolIndex) ||
+            !reader->read(&operand.location.offset) || !reader->read(&operand.location.length) ||
+            !reader->read(&hasChannelQuant)) {
+            return false;
+        }
+        if (hasChannelQuant != 0) {
+            Operand::SymmPerChannelQuantParams channelQuant;
+            if (!reader->read(&channelQuant.scales) || !reader->read(&channelQuant.channelDim)) {
+                return false;
+            }
+            operand.extraParams = std::move(channelQuant);
+        }
+        std::vector<PackedCopy> copies;
+        if (!reader->read(&copies)) {
+            return false;
+        }
+        for (const PackedCopy& copy : copies) {
+            packedCopies->push_back({.type = operand.type,
+                                     .constantOffset = operand.location.offset,
+                                     .constantLength = operand.location.length,
+                                     .dimensions = operand.dimensions,
+                                     .layout = copy.layout,
+                                     .packedOffset = copy.offset,
+                                     .packedSize = copy.size});
+        }
+        subgraph->operands.push_back(std::move(operand));
+    }
+    uint32_t operationCount = 0;
+    if (!reader->read(&operationCount)) {
+        return false;
+    }
+    subgraph->operations.reserve(std::min<uint32_t>(operationCount, 1024));
+    for (uint32_t i = 0; i < operationCount; ++i) {
+        Operation operation;
+        if (!reader->read(&operation.type) || !reader->read(&operation.inputs) ||
+            !reader->read(&operation.outputs)) {
+            return false;
+        }
+        subgraph->operations.push_back(std::move(operation));
+    }
+    return reader->read(&subgraph->inputIndexes) && reader->read(&subgraph->outputIndexes);
+}
+
+bool computeChecksum(const CacheToken& token, const std::vector<uint8_t>& metadata,
+                     uint64_t dataSize, uint8_t* checksum) {
+    TokenHasher hasher(token.data());
+    if (!hasher.update(metadata.data(), metadata.size()) ||
+        !hasher.update(&dataSize, sizeof(dataSize)) || !hasher.finish()) {
+        return false;
+    }
+    std::memcpy(checksum, hasher.getCacheToken(), kByteSizeOfCacheToken);
+    return true;
+}
+
+Result<std::pair<int, int>> getCacheFds(const CacheHandles& cache) {
+    if (cache.modelCache.size() != kNumberOfCpuModelCacheFiles ||
+        cache.dataCache.size() != kNumberOfCpuDataCacheFiles) {
+        return NN_ERROR() << "Unexpected number of cache files";
+    }
+    const SharedHandle& modelCache = cache.modelCache.front();
+    const SharedHandle& dataCache = cache.dataCache.front();
+    if (modelCache == nullptr || !modelCache->ok() || dataCache == nullptr || !dataCache->ok()) {
+        return NN_ERROR() << "Invalid cache file handle";
+    }
+    return std::make_pair(modelCache->get(), dataCache->get());
+}
+
+}  // namespace
+
+Result<void> saveCpuModelToCache(const Model& model, const std::vector<RunTimePoolInfo>& poolInfos,
+                                 const CpuPackedWeights* packedWeights, const CacheHandles& cache,
+                                 const CacheToken& token) {
+    NNTRACE_RT(NNTRACE_PHASE_COMPILATION, "saveCpuModelToCache");
+    const auto [modelFd, dataFd] = NN_TRY(getCacheFds(cache));
+    if (!model.extensionNameToPrefix.empty()) {
+        return NN_ERROR() << "Models with extensions cannot be cached";
+    }
+
+    CacheWriter metadata;
+    std::vector<uint8_t> data;
+    NN_TRY(writeSubgraph(model, model.main, poolInfos, packedWeights, &metadata, &data));
+    metadata.write(static_cast<uint32_t>(model.referenced.size()));
+    for (const Model::Subgraph& subgraph : model.referenced) {
+        NN_TRY(writeSubgraph(model, subgraph, poolInfos, packedWeights, &metadata, &data));
+    }
+    metadata.write(static_cast<uint8_t>(model.relaxComputationFloat32toFloat16));
+
+    CacheHeader header = {.magic = kCacheMagic,
+                          .version = kCacheVersion,
+                          .metadataSize = metadata.buffer().size(),
+                          .dataSize = data.size()};
+    if (!computeChecksum(token, metadata.buffer(), data.size(), header.checksum)) {
+        return NN_ERROR() << "Failed to compute the cache checksum";
+    }
+    // A non-empty cache file may still be mapped by a prepared model loaded from it, so it is
+    // never truncated or overwritten. The runtime recreates the cache files it owns before they
+    // are written, so only a stale file supplied by the application is refused here.
+    struct stat modelStat, dataStat;
+    if (fstat(modelFd, &modelStat) != 0 || fstat(dataFd, &dataStat) != 0) {
+        return NN_ERROR() << "Failed to stat the cache files";
+    }
+    if (modelStat.st_size != 0 || dataStat.st_size != 0) {
+        return NN_ERROR() << "Refusing to overwrite non-empty cache files";
+    }
+    if (!base::WriteFullyAtOffset(dataFd, data.data(), data.size(), 0) ||
+        !base::WriteFullyAtOffset(modelFd, &header, sizeof(header), 0) ||
+        !base::WriteFullyAtOffset(modelFd, metadata.buffer().data(), metadata.buffer().size(),
+                                  sizeof(header))) {
+        return NN_ERROR() << "Failed to write the cache files";
+    }
+    return {};
+}
+
+Result<CpuCachedModel> loadCpuModelFromCache(const CacheHandles& cache, const CacheToken& token) {
+    NNTRACE_RT(NNTRACE_PHASE_COMPILATION, "loadCpuModelFromCache");
+    const auto [modelFd, dataFd] = NN_TRY(getCacheFds(cache));
+
+    struct stat modelStat, dataStat;
+    CacheHeader header;
+    if (fstat(modelFd, &modelStat) != 0 || fstat(dataFd, &dataStat) != 0 ||
+        static_cast<uint64_t>(modelStat.st_size) < sizeof(header) ||
+        pread(modelFd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        header.magic != kCacheMagic || header.version != kCacheVersion ||
+        header.metadataSize != static_cast<uint64_t>(modelStat.st_size) - sizeof(header) ||
+        header.dataSize != static_cast<uint64_t>(dataStat.st_size) ||
+        header.dataSize > std::numeric_limits<uint32_t>::max()) {
+        return NN_ERROR() << "Invalid cache header";
+    }
+    std::vector<uint8_t> metadata(header.metadataSize);
+    uint8_t checksum[kByteSizeOfCacheToken];
+    if (pread(modelFd, metadata.data(), metadata.size(), sizeof(header)) !=
+                static_cast<ssize_t>(metadata.size()) ||
+        !computeChecksum(token, metadata, header.dataSize, checksum) ||
+        std::memcmp(checksum, header.checksum, sizeof(checksum)) != 0) {
+        return NN_ERROR() << "Cache checksum mismatch";
+    }
+
+    CpuCachedModel cached;
+    Model& model = cached.model;
+    CacheReader reader(metadata);
+    uint32_t referencedCount = 0;
+    uint8_t relaxComputationFloat32toFloat16 = 0;
+    if (!readSubgraph(&reader, &model.main, &cached.packedWeights) ||
+        !reader.read(&referencedCount) || referencedCount > metadata.size()) {
+        return NN_ERROR() << "Malformed cache metadata";
+    }
+    model.referenced.resize(referencedCount);
+    for (Model::Subgraph& subgraph : model.referenced) {
+        if (!readSubgraph(&reader, &subgraph, &cached.packedWeights)) {
+            return NN_ERROR() << "Malformed cache metadata";
+        }
+    }
+    if (!reader.read(&relaxComputationFloat32toFloat16) || !reader.finished()) {
+        return NN_ERROR() << "Malformed cache metadata";
+    }
+    model.relaxComputationFloat32toFloat16 = relaxComputationFloat32toFloat16 != 0;
+
+    if (header.dataSize > 0) {
+        model.pools = {NN_TRY(createSharedMemoryFromFd(header.dataSize, PROT_READ, dataFd, 0))};
+    }
+    return cached;
+}
+
+}  // namespace nn
+}  // namespace android
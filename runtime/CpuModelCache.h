@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_CPU_MODEL_CACHE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_CPU_MODEL_CACHE_H
+
+#include <CpuExecutor.h>
+#include <CpuPackedWeights.h>
+#include <nnapi/Result.h>
+#include <nnapi/Types.h>
+
+#include <vector>
+
+namespace android {
+namespace nn {
+
+struct CacheHandles;
+
+// The compilation cache of the nnapi-reference CPU device consists of one model cache file and one
+// data cache file. The model cache file holds a header followed by the serialized subgraphs. The
+// data cache file holds the values of all constant operands, followed by the copies of them that
+// were packed when the model was prepared, so that it can be memory mapped as the only pool of the
+// model when the model is prepared from cache.
+constexpr uint32_t kNumberOfCpuModelCacheFiles = 1;
+constexpr uint32_t kNumberOfCpuDataCacheFiles = 1;
+
+// Writes the model into the cache files. poolInfos must be the mapped pools of the model, and
+// packedWeights, if not null, the packed weights created for them. Returns an error if the model
+// cannot be cached, e.g. because it uses extensions, or if a cache file is not empty: an existing
+// cache file may still be mapped by a prepared model and is never rewritten.
+Result<void> saveCpuModelToCache(const Model& model, const std::vector<RunTimePoolInfo>& poolInfos,
+                                 const CpuPackedWeights* packedWeights, const CacheHandles& cache,
+                                 const CacheToken& token);
+
+struct CpuCachedModel {
+    Model model;
+    // The packed copies of the constants of the model, for CpuPackedWeights::createFromCache.
+    std::vector<CpuPackedWeights::CachedCopy> packedWeights;
+};
+
+// Reconstructs the model written by saveCpuModelToCache. Constant values are not read: every
+// constant operand, and every packed copy, refers to a memory mapping of the data cache file. The
+// cache files are not trusted, so the caller must validate the returned model before using it.
+Result<CpuCachedModel> loadCpuModelFromCache(const CacheHandles& cache, const CacheToken& token);
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_CPU_MODEL_CACHE_H
@@ -73,14 +73,15 @@ class SyncFenceEvent : public IEvent {
     // Close the fd the event owns.
     ~SyncFenceEvent() { close(mSyncFenceFd); }
 
-    // Use syncWait to wait for the sync fence until the status change.
-    // In case of syncWait error, query the dispatch callback for detailed error status.
+    // Use syncWaitWithStatus to wait for the sync fence until the status change.
+    // In case of syncWaitWithStatus error, including a fence signaled with an error, query the
+    // dispatch callback for detailed error status.
     // This method maps to the NDK ANeuralNetworksEvent_wait, which must be thread-safe.
     ErrorStatus wait() const override {
         std::lock_guard<std::mutex> lock(mMutex);
         if (mFinished) return mError;
 
-        if (mSyncFenceFd > 0 && syncWait(mSyncFenceFd, -1) != FenceState::SIGNALED) {
+        if (mSyncFenceFd > 0 && syncWaitWithStatus(mSyncFenceFd, -1) != FenceState::SIGNALED) {
             mError = ErrorStatus::GENERAL_FAILURE;
             // If there is a callback available, use the callback to get the error code.
             if (kFencedExecutionCallback != nullptr) {
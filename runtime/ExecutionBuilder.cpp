@@ -34,7 +34,6 @@
 #include <mutex>
 #include <optional>
 #include <string>
-#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -872,7 +871,7 @@ std::tuple<int, std::vector<OutputShape>, Timing> CompoundExecutionBuilder::comp
 static bool waitForSyncFences(const std::vector<int>& waitFor) {
     for (int syncFd : waitFor) {
         if (syncFd > 0) {
-            auto r = syncWait(syncFd, -1);
+            auto r = syncWaitWithStatus(syncFd, -1);
             if (r != FenceState::SIGNALED) {
                 VLOG(EXECUTION) << "syncWait failed, fd: " << syncFd;
                 return false;
@@ -1100,10 +1099,6 @@ int ExecutionBuilder::compute(std::shared_ptr<ExecutionCallback>* synchronizatio
         // asynchronous thread -- take the asynchronous thread logic out of
         // CpuExecution::compute() and use it to wrap the plan-based-path.
 
-        // TODO: use a thread pool
-        // TODO(mikie): this could have NNTRACE so we could measure the overhead
-        //              of spinning up a new thread.
-
         // Prepare the callback for asynchronous execution.
         // std::shared_ptr<ExecutionCallback> object is returned when the
         // execution has been successfully launched, otherwise a
@@ -1123,9 +1118,17 @@ int ExecutionBuilder::compute(std::shared_ptr<ExecutionCallback>* synchronizatio
             VLOG(EXECUTION) << "ExecutionBuilder::compute (asynchronous API, non-threaded)";
             asyncStartCompute();
         } else {
+            // The execution is dropped if its deadline passes while it waits for the scheduler.
+            // Once the scheduler has 256 executions queued, schedule() blocks the application
+            // thread in startCompute until a worker takes one of them, so that a flood of
+            // asynchronous executions applies backpressure instead of growing the queue forever.
             VLOG(EXECUTION) << "ExecutionBuilder::compute (asynchronous API)";
-            std::thread asyncExecution(asyncStartCompute);
-            executionCallback->bindThread(std::move(asyncExecution));
+            const auto missedDeadline = [executionCallback] {
+                executionCallback->notify(ErrorStatus::MISSED_DEADLINE_TRANSIENT, {}, {});
+            };
+            DeviceManager::get()->getAsyncExecutionScheduler()->schedule(
+                    convertToCanonicalPriority(mCompilation->mPriority), deadline,
+                    asyncStartCompute, missedDeadline);
         }
         *synchronizationCallback = executionCallback;
         return ANEURALNETWORKS_NO_ERROR;
@@ -34,21 +34,6 @@ void ExecutionCallback::notify(ErrorStatus status, const std::vector<OutputShape
 void ExecutionCallback::wait() const {
     std::unique_lock<std::mutex> lock(mMutex);
     mCondition.wait(lock, [this] { return mNotified; });
-
-    /*
-     * Note that we cannot call std::thread::join from ExecutionCallback's
-     * destructor: ExecutionCallback is intended to be reference counted, and it
-     * is possible that the reference count drops to zero in the bound thread,
-     * causing the bound thread to call this destructor. If a thread tries to
-     * join itself, it throws an exception, producing a message like the
-     * following:
-     *
-     *     terminating with uncaught exception of type std::__1::system_error:
-     *     thread::join failed: Resource deadlock would occur
-     */
-    if (mThread.joinable()) {
-        mThread.join();
-    }
 }
 
 ErrorStatus ExecutionCallback::getStatus() const {
@@ -66,26 +51,6 @@ Timing ExecutionCallback::getTiming() const {
     return mTiming;
 }
 
-bool ExecutionCallback::bindThread(std::thread asyncThread) {
-    std::lock_guard<std::mutex> lock(mMutex);
-
-    // Ensure ExecutionCallback object does not already have a thread bound
-    if (mThread.joinable()) {
-        LOG(ERROR) << "ExecutionCallback::bindThread -- a thread has already been bound to this "
-                      "callback object";
-        return false;
-    }
-
-    // Ensure the new thread is valid
-    if (!asyncThread.joinable()) {
-        LOG(ERROR) << "ExecutionCallback::bindThread -- the new thread is not joinable";
-        return false;
-    }
-
-    mThread = std::move(asyncThread);
-    return true;
-}
-
 void ExecutionCallback::setOnFinish(const ExecutionFinish& finish) {
     std::lock_guard<std::mutex> hold(mMutex);
 
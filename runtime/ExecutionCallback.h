@@ -23,7 +23,6 @@
 #include <condition_variable>
 #include <functional>
 #include <mutex>
-#include <thread>
 #include <vector>
 
 namespace android::nn {
@@ -153,29 +152,6 @@ class ExecutionCallback {
      */
     Timing getTiming() const;
 
-    /**
-     * ExecutionCallback::bindThread binds a thread to the ExecutionCallback
-     * object. The bound thread is later joined by ExecutionCallback::wait or
-     * ExecutionCallback::get*.
-     *
-     * Once a thread is bound with ExecutionCallback::bindThread, the client
-     * code must ensure that ExecutionCallback::wait or ExecutionCallback::get*
-     * has been called before the ExecutionCallback object is destroyed.
-     *
-     * The bound thread must not call any ExecutionCallback method with the
-     * exception of ExecutionCallback::notify*, which it must call when the
-     * thread has finished its computation.
-     *
-     * ExecutionCallback::bindThread can be called at most once on a given
-     * callback object.
-     *
-     * @param asyncThread Thread to be bound to the callback object. The thread
-     *     object must represent a thread of execution -- i.e.,
-     *     std::thread::joinable() must be true.
-     * @return bool True if successful, false if thread was not properly bound.
-     */
-    bool bindThread(std::thread asyncThread);
-
     /**
      * ExecutionCallback::setOnFinish binds a callback to the ExecutionCallback
      * object that will be executed during one of the ExecutionCallback::notify*
@@ -211,7 +187,6 @@ class ExecutionCallback {
     // members
     mutable std::mutex mMutex;
     mutable std::condition_variable mCondition;
-    mutable std::thread mThread GUARDED_BY(mMutex);
     ExecutionFinish mOnFinish GUARDED_BY(mMutex);
     bool mNotified GUARDED_BY(mMutex) = false;
     ErrorStatus mErrorStatus = ErrorStatus::GENERAL_FAILURE;
@@ -33,6 +33,8 @@
 #include <sys/types.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
@@ -40,6 +42,7 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_set>
 #include <utility>
@@ -51,6 +54,7 @@
 #include "ExecutionCallback.h"
 #include "Manager.h"
 #include "ModelBuilder.h"
+#include "PreparedModelCache.h"
 #include "TypeManager.h"
 
 namespace android {
@@ -122,6 +126,20 @@ int compile(const Device& device, const ModelBuilder& model, int executionPrefer
         std::copy(tokenPtr, tokenPtr + cacheToken->size(), cacheToken->begin());
     }
 
+    // Share the prepared model of an identical compilation in this process if there is one.
+    std::optional<PreparedModelCache::Key> dedupKey;
+    if (DeviceManager::get()->deduplicatePreparedModels()) {
+        dedupKey = PreparedModelCache::makeKey(model, device, executionPreference,
+                                               compilationPriority, metaData);
+        if (dedupKey.has_value()) {
+            if (auto cached = PreparedModelCache::get()->lookup(*dedupKey)) {
+                VLOG(COMPILATION) << "compile: reusing prepared model on " << device.getName();
+                *preparedModel = std::move(cached);
+                return ANEURALNETWORKS_NO_ERROR;
+            }
+        }
+    }
+
     const ModelFactory makeModel = [&model] { return model.makeModel(); };
     const ExecutionPreference preference = static_cast<ExecutionPreference>(executionPreference);
     const Priority priority = convertToCanonicalPriority(compilationPriority);
@@ -131,6 +149,9 @@ int compile(const Device& device, const ModelBuilder& model, int executionPrefer
             device.prepareModel(makeModel, preference, priority, deadline, cacheInfo, cacheToken,
                                 metaData, extensionNameAndPrefix);
     *preparedModel = returnedPreparedModel;
+    if (n == ANEURALNETWORKS_NO_ERROR && dedupKey.has_value() && returnedPreparedModel != nullptr) {
+        PreparedModelCache::get()->insert(*dedupKey, returnedPreparedModel);
+    }
     return n;
 }
 
@@ -305,6 +326,60 @@ class StepRoleAnalyzer {
 
 }  // namespace
 
+// The maximum number of step models compiled at the same time by one call to
+// compileConcurrently.
+constexpr uint32_t kMaxConcurrentStepCompilations = 4;
+
+int compileConcurrently(uint32_t count, const std::function<int(uint32_t)>& compileStep,
+                        Priority priority) {
+    if (count <= 1) {
+        return count == 0 ? ANEURALNETWORKS_NO_ERROR : compileStep(0);
+    }
+    std::atomic<uint32_t> nextIndex = 0;
+    std::atomic<uint32_t> firstFailedIndex = count;
+    std::vector<int> results(count, ANEURALNETWORKS_NO_ERROR);
+    auto worker = [count, &compileStep, &nextIndex, &firstFailedIndex, &results] {
+        // Indices are handed out in increasing order, so once an index is past the first failure
+        // every later one is too.
+        for (uint32_t i = nextIndex++; i < count && i < firstFailedIndex; i = nextIndex++) {
+            results[i] = compileStep(i);
+            if (results[i] != ANEURALNETWORKS_NO_ERROR) {
+                uint32_t current = firstFailedIndex;
+                while (i < current && !firstFailedIndex.compare_exchange_weak(current, i)) {
+                }
+            }
+        }
+    };
+    const uint32_t hardwareConcurrency = std::max(1u, std::thread::hardware_concurrency());
+    const uint32_t helperCount =
+            std::min({count, hardwareConcurrency, kMaxConcurrentStepCompilations}) - 1;
+    // The helpers run on the scheduler shared by all compilations, so that concurrent compilations
+    // do not multiply the number of threads. A helper that only starts once the calling thread has
+    // compiled every step finds no index left and returns at once.
+    std::mutex mutex;
+    std::condition_variable helpersDone;
+    uint32_t runningHelpers = helperCount;
+    PriorityThreadPool* scheduler = DeviceManager::get()->getCompilationScheduler();
+    for (uint32_t i = 0; i < helperCount; ++i) {
+        scheduler->schedule(priority, [&worker, &mutex, &helpersDone, &runningHelpers] {
+            worker();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--runningHelpers == 0) {
+                helpersDone.notify_all();
+            }
+        });
+    }
+    // The calling thread compiles too rather than idling until the helpers are done.
+    worker();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        helpersDone.wait(lock, [&runningHelpers] { return runningHelpers == 0; });
+    }
+    const auto failed = std::find_if(results.begin(), results.end(),
+                                     [](int n) { return n != ANEURALNETWORKS_NO_ERROR; });
+    return failed != results.end() ? *failed : ANEURALNETWORKS_NO_ERROR;
+}
+
 void DynamicTemporaries::vlogDump(const char* context) const {
     if (empty()) {
         return;
@@ -781,8 +856,7 @@ static bool hasUnknownSize(const Operand& operand) {
     return false;
 }
 
-int ExecutionStep::finishStepModel(const ModelBuilder* mainModel, bool* hasOutputOfUnknownSize,
-                                   int32_t executionPreference, int32_t priority) {
+int ExecutionStep::finishStepModel(const ModelBuilder* mainModel, bool* hasOutputOfUnknownSize) {
     CHECK(mDevice != nullptr);
 
     for (const auto& stepModelOutput : mTempsAsStepModelOutputs) {
@@ -868,10 +942,11 @@ int ExecutionStep::finishStepModel(const ModelBuilder* mainModel, bool* hasOutpu
                    [](auto& e) { return e.second; });
     NN_RETURN_IF_ERROR(mStepModel.identifyInputsAndOutputs(inputs.size(), inputs.data(),
                                                            outputs.size(), outputs.data()));
-    NN_RETURN_IF_ERROR(mStepModel.finish());
+    return mStepModel.finish();
+}
 
-    // TODO: Move compilation elsewhere?
-    VLOG(COMPILATION) << "ExecutionStep::finishStepModel, compilation on " << mDevice->getName();
+int ExecutionStep::compileStepModel(int32_t executionPreference, int32_t priority) {
+    VLOG(COMPILATION) << "ExecutionStep::compileStepModel, compilation on " << mDevice->getName();
     return compile(*mDevice, mStepModel, executionPreference, priority, {}, *mPlan->getCacheInfo(),
                    &mToken, {}, &mPreparedStepModel);
 }
@@ -933,12 +1008,16 @@ int ExecutionPlan::CompoundBody::finish(const SourceModels* sourceModels,
         return false;
     };
 
+    // Step models are finished in order, and then compiled concurrently. If a step model fails to
+    // finish, the steps before it are still compiled, so that the error reported is the one of the
+    // first step that fails either way.
+    std::vector<ExecutionStep*> stepsToCompile;
+    int finishResult = ANEURALNETWORKS_NO_ERROR;
     findTempsAsStepModelOutputs();
     for (const auto& logicalStep : mSteps) {
         if (ExecutionStep* step = logicalStep->tryExecutionStep()) {
             bool stepHasDynamicTemporaries = false;
-            int n = step->finishStepModel(mainModel, &stepHasDynamicTemporaries,
-                                          executionPreference, priority);
+            int n = step->finishStepModel(mainModel, &stepHasDynamicTemporaries);
             if (stepHasDynamicTemporaries) {
                 mHasDynamicTemporaries = true;
                 if (!isCompliantVersion(kHalVersionV1_2ToApi.canonical,
@@ -960,8 +1039,10 @@ int ExecutionPlan::CompoundBody::finish(const SourceModels* sourceModels,
             if (n != ANEURALNETWORKS_NO_ERROR) {
                 VLOG(COMPILATION)
                         << "ExecutionPlan::CompoundBody::finish -- finishStepModel failed";
-                return n;
+                finishResult = n;
+                break;
             }
+            stepsToCompile.push_back(step);
         } else if (IfStep* step = logicalStep->tryIfStep()) {
             // The partitioner does not support dynamic temporaries (b/132458982).
             CHECK(!containsUnknownSize(step->outerInputOperands));
@@ -984,6 +1065,21 @@ int ExecutionPlan::CompoundBody::finish(const SourceModels* sourceModels,
         }
     }
 
+    NNTRACE_RT(NNTRACE_PHASE_COMPILATION, "ExecutionPlan::CompoundBody::finish: compile steps");
+    const int compileResult = compileConcurrently(
+            stepsToCompile.size(),
+            [&stepsToCompile, executionPreference, priority](uint32_t i) {
+                return stepsToCompile[i]->compileStepModel(executionPreference, priority);
+            },
+            convertToCanonicalPriority(priority));
+    if (compileResult != ANEURALNETWORKS_NO_ERROR) {
+        VLOG(COMPILATION) << "ExecutionPlan::CompoundBody::finish -- compileStepModel failed";
+        return compileResult;
+    }
+    if (finishResult != ANEURALNETWORKS_NO_ERROR) {
+        return finishResult;
+    }
+
     if (simulateFailureResultCode != ANEURALNETWORKS_NO_ERROR) {
         VLOG(COMPILATION) << "ExecutionPlan::CompoundeBody::finish: simulating failure, ResultCode "
                           << simulateFailureResultCode;
@@ -1693,12 +1789,42 @@ void ExecutionPlan::Controller::setOutput(const SourceOperandIndex& outerOperand
     }
 }
 
+bool ExecutionPlan::Controller::aliasTemporary(const SourceOperandIndex& innerOperand,
+                                               const SourceOperandIndex& outerOperand) {
+    // Only a TEMPORARY_VARIABLE outer operand can be aliased. Operands of
+    // other lifetimes are managed by the client, or are the outputs of an
+    // enclosing IF or WHILE, which relies on their location being stable.
+    const Operand& sourceOperand = mExecutionBuilder->getSourceOperand(outerOperand);
+    if (sourceOperand.lifetime != Operand::LifeTime::TEMPORARY_VARIABLE) {
+        return false;
+    }
+    const auto innerIt = mSourceOperandToLocationOfTemporary.find(innerOperand);
+    const auto outerIt = mSourceOperandToLocationOfTemporary.find(outerOperand);
+    if (innerIt == mSourceOperandToLocationOfTemporary.end() ||
+        outerIt == mSourceOperandToLocationOfTemporary.end()) {
+        return false;
+    }
+    const StaticTemporaryLocation& innerLocation = innerIt->second;
+    const StaticTemporaryLocation& outerLocation = outerIt->second;
+    const auto memoryPreference =
+            mPlan->compound()->getMemoryPreferenceOfSourceOperand(outerOperand);
+    if (innerLocation.paddedLength < outerLocation.paddedLength ||
+        innerLocation.offset % memoryPreference.alignment != 0) {
+        return false;
+    }
+    // The inner location is only overwritten when the WHILE runs again, which
+    // happens after the last use of the outer operand by the enclosing model.
+    VLOG(EXECUTION) << "aliasing " << toString(outerOperand) << " to " << toString(innerOperand);
+    outerIt->second = innerLocation;
+    return true;
+}
+
 int ExecutionPlan::Controller::waitForLastStepSyncFence() const {
     if (mLastStepSyncFd == -1) {
         return ANEURALNETWORKS_NO_ERROR;
     }
     VLOG(EXECUTION) << "wait for mLastStepSyncFd " << mLastStepSyncFd;
-    auto r = syncWait(mLastStepSyncFd, -1);
+    auto r = syncWaitWithStatus(mLastStepSyncFd, -1);
     int n = ANEURALNETWORKS_NO_ERROR;
     if (r != FenceState::SIGNALED) {
         LOG(ERROR) << "syncWait failed, fd: " << mLastStepSyncFd;
@@ -1821,7 +1947,8 @@ int ExecutionPlan::nextCompound(const WhileStep* step, std::shared_ptr<Controlle
         for (uint32_t i = 0, n = step->bodyInputOperands.size(); i < n; ++i) {
             controller->setInput(step->condInputOperands[i], step->bodyInputOperands[i]);
         }
-        if (state.iteration != 0) {
+        if (state.bodyOutputLocations.empty() && !step->bodyOutputOperands.empty()) {
+            state.bodyOutputLocations.reserve(step->bodyOutputOperands.size());
             for (const SourceOperandIndex& outputOperand : step->bodyOutputOperands) {
 #ifdef NN_DEBUGGABLE
                 CHECK_EQ(controller->mSourceOperandToInputIndex.count(outputOperand), 0u);
@@ -1829,8 +1956,14 @@ int ExecutionPlan::nextCompound(const WhileStep* step, std::shared_ptr<Controlle
                 CHECK_EQ(controller->mSourceOperandToLocationOfTemporary.count(outputOperand), 1u);
                 CHECK_EQ(controller->mSourceOperandToLocationOfTemporary2.count(outputOperand), 1u);
 #endif
-                std::swap(controller->mSourceOperandToLocationOfTemporary[outputOperand],
-                          controller->mSourceOperandToLocationOfTemporary2[outputOperand]);
+                state.bodyOutputLocations.emplace_back(
+                        &controller->mSourceOperandToLocationOfTemporary[outputOperand],
+                        &controller->mSourceOperandToLocationOfTemporary2[outputOperand]);
+            }
+        }
+        if (state.iteration != 0) {
+            for (const auto& [location, location2] : state.bodyOutputLocations) {
+                std::swap(*location, *location2);
             }
         }
     } else {
@@ -1838,8 +1971,7 @@ int ExecutionPlan::nextCompound(const WhileStep* step, std::shared_ptr<Controlle
                         << ": exiting loop";
         controller->mNextStepIndex = step->exitStepIndex;
 
-        // Copy body outputs to outer outputs.
-        // TODO: Use outer outputs instead of tmp2 to avoid copying?
+        // Hand body outputs over to outer outputs.
         CHECK_LE(step->outerOutputOperands.size(), step->bodyOutputOperands.size());
         for (uint32_t i = 0, n = step->outerOutputOperands.size(); i < n; ++i) {
             // condInputOperands[i] points to a body output operand from the
@@ -1847,6 +1979,9 @@ int ExecutionPlan::nextCompound(const WhileStep* step, std::shared_ptr<Controlle
             // WHILE operation input operand otherwise.
             const SourceOperandIndex& innerOperand = step->condInputOperands[i];
             const SourceOperandIndex& outerOperand = step->outerOutputOperands[i];
+            if (state.iteration != 0 && controller->aliasTemporary(innerOperand, outerOperand)) {
+                continue;
+            }
             std::optional<Buffer> outerBuffer = getBuffer(controller, outerOperand);
             if (outerBuffer == std::nullopt) {
                 // This should never happen.
@@ -2028,6 +2163,10 @@ const uint8_t* ExecutionPlan::forTest_simpleGetCacheToken() const {
     return simple()->mToken.getCacheToken();
 }
 
+std::shared_ptr<RuntimePreparedModel> ExecutionPlan::forTest_simpleGetPreparedModel() const {
+    return simple()->mPreparedModel;
+}
+
 void ExecutionPlan::SimpleBody::dump() const {
     VLOG(COMPILATION) << "SIMPLE for " << mDevice->getName();
 }
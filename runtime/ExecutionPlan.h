@@ -274,13 +274,16 @@ class ExecutionStep {
     // If this step has a step model output of unknown size, sets
     // *hasOutputOfUnknownSize to true; otherwise, leaves it
     // unchanged.
-    int finishStepModel(const ModelBuilder* mainModel, bool* hasOutputOfUnknownSize,
-                        int32_t executionPreference, int32_t priority);
+    int finishStepModel(const ModelBuilder* mainModel, bool* hasOutputOfUnknownSize);
+
+    // Compiles the step model for the step's device. Must be called after
+    // finishStepModel(). Steps may be compiled concurrently with each other.
+    int compileStepModel(int32_t executionPreference, int32_t priority);
 
     const ModelBuilder* getStepModel() const { return &mStepModel; }
     std::shared_ptr<Device> getDevice() const { return mDevice; }
 
-    // only available after calling finishStepModel()
+    // only available after calling compileStepModel()
     std::shared_ptr<RuntimePreparedModel> getPreparedStepModel() const {
         return mPreparedStepModel;
     }
@@ -545,6 +548,14 @@ struct WhileState {
     uint64_t iteration = kOutsideLoop;
     // Time point when the loop started executing.
     TimePoint startTime;
+    // For each body output operand, the entries of
+    // ExecutionPlan::Controller::mSourceOperandToLocationOfTemporary and
+    // ExecutionPlan::Controller::mSourceOperandToLocationOfTemporary2 that are
+    // swapped to implement double buffering. Populated when the body is first
+    // evaluated so that later iterations do not need to look them up. Map
+    // entries for body output operands are never erased, so the pointers
+    // remain valid for the lifetime of the controller.
+    std::vector<std::pair<StaticTemporaryLocation*, StaticTemporaryLocation*>> bodyOutputLocations;
 };
 
 struct ConstantCopyLocation {
@@ -620,6 +631,11 @@ class ExecutionPlan {
                       const SourceOperandIndex& innerOperand);
         void setOutput(const SourceOperandIndex& outerOperand,
                        const SourceOperandIndex& innerOperand);
+        // Sets the location of outerOperand to be the same as the location of innerOperand
+        // instead of copying the data, if outerOperand is a static TEMPORARY_VARIABLE and
+        // innerOperand's location is compatible with it. Returns whether outerOperand was aliased.
+        bool aliasTemporary(const SourceOperandIndex& innerOperand,
+                            const SourceOperandIndex& outerOperand);
 
         // Wait for mLastStepSyncFd to signal.
         // No-op if mLastStepSyncFd is -1 which the mLastStepSyncFd is initialized to.
@@ -627,7 +643,7 @@ class ExecutionPlan {
         // does not generate a sync fence.
         int waitForLastStepSyncFence() const;
 
-        [[maybe_unused]] const ExecutionPlan* mPlan;
+        const ExecutionPlan* mPlan;
         ExecutionBuilder* mExecutionBuilder;
         const BurstBuilder* mBurstBuilder;
         // Map from source operand index to an offset into mTemporaries used
@@ -777,6 +793,7 @@ class ExecutionPlan {
     //     model not contain any control flow operations.
     std::set<uint32_t> forTest_flatGetDynamicTemporaries() const;
     const uint8_t* forTest_simpleGetCacheToken() const;
+    std::shared_ptr<RuntimePreparedModel> forTest_simpleGetPreparedModel() const;
     bool forTest_hasStepModelWithNoInputsOrNoOutputs() const;
 
    private:
@@ -1002,6 +1019,15 @@ class ExecutionPlan {
     SourceModels mSourceModels;
 };
 
+// Calls compileStep(i) for every i in [0, count), on the calling thread and on a bounded number
+// of helpers from DeviceManager::getCompilationScheduler(), and returns the result of the lowest
+// index that failed, or ANEURALNETWORKS_NO_ERROR if none failed. Once an index has failed, higher
+// indices are no longer started because they cannot change the outcome. Lower indices still run,
+// so the reported error does not depend on scheduling. Used by ExecutionPlan to compile the step
+// models of a compound plan.
+int compileConcurrently(uint32_t count, const std::function<int(uint32_t)>& compileStep,
+                        Priority priority);
+
 inline std::ostream& operator<<(std::ostream& out, ExecutionPlan::Kind kind) {
     const int intKind = static_cast<int>(kind);
     if (kind < ExecutionPlan::Kind::ERROR || kind > ExecutionPlan::Kind::COMPOUND) {
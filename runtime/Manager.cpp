@@ -18,11 +18,18 @@
 
 #include "Manager.h"
 
+#include <ConstantFolding.h>
 #include <CpuExecutor.h>
+#include <CpuFusionPlan.h>
+#include <CpuKernelTable.h>
+#include <CpuPackedWeights.h>
+#include <CpuStaticShapes.h>
 #include <LegacyUtils.h>
 #include <MetaModel.h>
 #include <Tracing.h>
+#include <ValidatedModelCache.h>
 #include <android-base/properties.h>
+#include <android-base/thread_annotations.h>
 #include <nnapi/IBurst.h>
 #include <nnapi/IDevice.h>
 #include <nnapi/IExecution.h>
@@ -31,23 +38,30 @@
 #include <nnapi/TypeUtils.h>
 #include <nnapi/Types.h>
 #include <nnapi/Validation.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+#include "CpuModelCache.h"
 #include "ExecutionCallback.h"
 #include "Memory.h"
 #include "ModelArgumentInfo.h"
 #include "ServerFlag.h"
+#include "SwSyncTimeline.h"
 #include "TypeManager.h"
 
 #ifndef NN_COMPATIBILITY_LIBRARY_BUILD
@@ -397,10 +411,21 @@ std::vector<bool> DriverDevice::getSupportedOperations(const MetaModel& metaMode
 }
 
 // Opens a cache file for reading and writing and returns a shared handle.
+// When recreate is true the file is about to be rewritten, so any existing file is unlinked and a
+// new one is created in its place. A prepared model of the CPU device that still maps the old
+// file keeps its inode, instead of seeing the file truncated or overwritten under it. Drivers
+// manage the contents of their own cache files, so their files are opened in place.
 static GeneralResult<SharedHandle> createCacheHandle(const std::string& filename,
-                                                     bool createIfNotExist) {
-    auto fd = base::unique_fd(open(filename.c_str(), createIfNotExist ? (O_RDWR | O_CREAT) : O_RDWR,
-                                   S_IRUSR | S_IWUSR));
+                                                     bool createIfNotExist, bool recreate) {
+    CHECK(createIfNotExist || !recreate);
+    if (recreate && unlink(filename.c_str()) != 0 && errno != ENOENT) {
+        return NN_ERROR(ErrorStatus::GENERAL_FAILURE)
+               << "Failed to remove stale cache file " << filename;
+    }
+    const int flags = recreate           ? (O_RDWR | O_CREAT | O_EXCL)
+                      : createIfNotExist ? (O_RDWR | O_CREAT)
+                                         : O_RDWR;
+    auto fd = base::unique_fd(open(filename.c_str(), flags, S_IRUSR | S_IWUSR));
     if (!fd.ok()) {
         return NN_ERROR(ErrorStatus::GENERAL_FAILURE)
                << "Failed to " << (createIfNotExist ? "open or create" : "open") << " cache file "
@@ -412,23 +437,25 @@ static GeneralResult<SharedHandle> createCacheHandle(const std::string& filename
 // Opens a list of cache files and returns a vector of shared handles. The files
 // are always opened with both read and write permissions.
 static GeneralResult<std::vector<SharedHandle>> createCacheHandleVec(
-        uint32_t numCacheFiles, const std::string& baseFilename, bool createIfNotExist) {
+        uint32_t numCacheFiles, const std::string& baseFilename, bool createIfNotExist,
+        bool recreate) {
     CHECK(numCacheFiles <= kMaxNumberOfCacheFiles);
     std::vector<SharedHandle> handles;
     handles.reserve(numCacheFiles);
     for (uint32_t i = 0; i < numCacheFiles; i++) {
         std::string filename = baseFilename + std::to_string(i);
         VLOG(COMPILATION) << "Cache " << i << ": " << filename;
-        handles.push_back(NN_TRY(createCacheHandle(filename, createIfNotExist)));
+        handles.push_back(NN_TRY(createCacheHandle(filename, createIfNotExist, recreate)));
     }
     return handles;
 }
 
 // Maps a token to cache file names and returns a pair of vectors of shared
-// handles to the opened files.
+// handles to the opened files. See createCacheHandle for recreate.
 static GeneralResult<CacheHandles> getCacheHandles(
         const CacheInfo& cacheInfo, const CacheToken& token,
-        const std::pair<uint32_t, uint32_t>& numCacheFiles, bool createIfNotExist) {
+        const std::pair<uint32_t, uint32_t>& numCacheFiles, bool createIfNotExist,
+        bool recreate = false) {
     if (const auto* cacheHandles = std::get_if<CacheHandles>(&cacheInfo.variant)) {
         if (cacheHandles->modelCache.size() != numCacheFiles.first) {
             return NN_ERROR(ErrorStatus::GENERAL_FAILURE)
@@ -457,12 +484,12 @@ static GeneralResult<CacheHandles> getCacheHandles(
     const uint32_t cacheTypeIdentifierIndex = cacheDir.size() + kByteSizeOfCacheToken * 2;
 
     cacheFileName[cacheTypeIdentifierIndex] = '1';
-    std::vector<SharedHandle> modelCache =
-            NN_TRY(createCacheHandleVec(numCacheFiles.first, cacheFileName, createIfNotExist));
+    std::vector<SharedHandle> modelCache = NN_TRY(
+            createCacheHandleVec(numCacheFiles.first, cacheFileName, createIfNotExist, recreate));
 
     cacheFileName[cacheTypeIdentifierIndex] = '2';
-    std::vector<SharedHandle> dataCache =
-            NN_TRY(createCacheHandleVec(numCacheFiles.second, cacheFileName, createIfNotExist));
+    std::vector<SharedHandle> dataCache = NN_TRY(
+            createCacheHandleVec(numCacheFiles.second, cacheFileName, createIfNotExist, recreate));
 
     return CacheHandles{
             .modelCache = std::move(modelCache),
@@ -853,6 +880,8 @@ static Capabilities createCpuCapabilities() {
     return makeCapabilities(kPerf, kPerf, kPerf);
 }
 
+class CpuPreparedModel;
+
 // A special abstracted device for the CPU. Only one instance of this class will exist.
 // Use get() to retrieve it.
 class CpuDevice : public Device {
@@ -884,9 +913,9 @@ class CpuDevice : public Device {
     Capabilities::PerformanceInfo getIfPerformance() const override { return kPerformance; }
     Capabilities::PerformanceInfo getWhilePerformance() const override { return kPerformance; }
     std::pair<uint32_t, uint32_t> getNumberOfCacheFilesNeeded() const override {
-        return {/*numModelCache=*/0, /*numDataCache=*/0};
+        return {kNumberOfCpuModelCacheFiles, kNumberOfCpuDataCacheFiles};
     }
-    bool isCachingSupported() const override { return false; }
+    bool isCachingSupported() const override { return true; }
     int wait() const override { return ANEURALNETWORKS_NO_ERROR; }
 
     std::pair<int, std::shared_ptr<RuntimePreparedModel>> prepareModel(
@@ -901,6 +930,15 @@ class CpuDevice : public Device {
 
    private:
     CpuDevice() = default;
+
+    // Prepares the model from the cache files of the token, if they hold a valid cache entry.
+    Result<std::shared_ptr<RuntimePreparedModel>> prepareModelFromCache(
+            const CacheInfo& cacheInfo, const CacheToken& token, Priority priority) const;
+
+    // Writes the prepared model into the cache files of the token.
+    Result<void> saveToCache(const CpuPreparedModel& preparedModel, const CacheInfo& cacheInfo,
+                             const CacheToken& token) const;
+
     const Version kVersion = getRuntimeFeatureLevelVersion();
     const std::string kName = "nnapi-reference";
 #ifndef NN_COMPATIBILITY_LIBRARY_BUILD
@@ -916,12 +954,17 @@ class CpuDevice : public Device {
 };
 
 // A special abstracted RuntimePreparedModel for the CPU, constructed by CpuDevice.
-class CpuPreparedModel : public RuntimePreparedModel {
+class CpuPreparedModel : public RuntimePreparedModel,
+                         public std::enable_shared_from_this<CpuPreparedModel> {
    public:
     // Factory method for CpuPreparedModel. Returns ANEURALNETWORKS_NO_ERROR and
     // a prepared model object if successfully created. Returns an error code
-    // and nullptr otherwise.
-    static std::pair<int, std::shared_ptr<RuntimePreparedModel>> create(Model model);
+    // and nullptr otherwise. If cachedPackedWeights is provided, the constants are not packed
+    // again: the packed weights refer to the given copies in the pools of the model instead.
+    static std::pair<int, std::shared_ptr<RuntimePreparedModel>> create(
+            Model model, Priority priority,
+            const std::optional<std::vector<CpuPackedWeights::CachedCopy>>& cachedPackedWeights =
+                    std::nullopt);
 
     const Device* getDevice() const override { return CpuDevice::get().get(); }
     SharedPreparedModel getInterface() const override { return nullptr; }
@@ -957,11 +1000,36 @@ class CpuPreparedModel : public RuntimePreparedModel {
     }
 
     // Prefer to use CpuPreparedModel::create.
-    CpuPreparedModel(Model model, std::vector<RunTimePoolInfo> poolInfos)
-        : mModel(std::move(model)), mModelPoolInfos(std::move(poolInfos)) {}
+    CpuPreparedModel(
+            Model model, std::vector<RunTimePoolInfo> poolInfos, Priority priority,
+            const std::optional<std::vector<CpuPackedWeights::CachedCopy>>& cachedPackedWeights)
+        : mModel(std::move(model)),
+          mModelPoolInfos(std::move(poolInfos)),
+          kPriority(priority),
+          mPackedWeights(cachedPackedWeights.has_value()
+                                 ? CpuPackedWeights::createFromCache(mModel, mModelPoolInfos,
+                                                                     *cachedPackedWeights)
+                                 : CpuPackedWeights::create(mModel, mModelPoolInfos)),
+          mFusionPlan(DeviceManager::get()->fuseCpuOperations() ? CpuFusionPlan::create(mModel)
+                                                                 : nullptr),
+          mStaticShapes(CpuStaticShapes::create(mModel, mModelPoolInfos)),
+          mKernelTable(CpuKernelTable::create(mModel)),
+          mSubgraphCache(std::make_shared<CpuExecutorSubgraphCache>()) {}
 
     const Model& getModel() const { return mModel; }
     const std::vector<RunTimePoolInfo>& getModelPoolInfos() const { return mModelPoolInfos; }
+    Priority getPriority() const { return kPriority; }
+    const std::shared_ptr<const CpuPackedWeights>& getPackedWeights() const {
+        return mPackedWeights;
+    }
+    const std::shared_ptr<const CpuFusionPlan>& getFusionPlan() const { return mFusionPlan; }
+    const std::shared_ptr<const CpuStaticShapes>& getStaticShapes() const {
+        return mStaticShapes;
+    }
+    const std::shared_ptr<const CpuKernelTable>& getKernelTable() const { return mKernelTable; }
+    const std::shared_ptr<CpuExecutorSubgraphCache>& getSubgraphCache() const {
+        return mSubgraphCache;
+    }
 
    private:
     // TFLite kernels prefers 64 bytes for padding and alignment.
@@ -970,6 +1038,19 @@ class CpuPreparedModel : public RuntimePreparedModel {
 
     const Model mModel;
     const std::vector<RunTimePoolInfo> mModelPoolInfos;
+    // The priority the model was prepared with, which its executions are scheduled with.
+    const Priority kPriority;
+    // Packed from the constants of mModel once, and shared by all executions.
+    const std::shared_ptr<const CpuPackedWeights> mPackedWeights;
+    // Found in mModel once if CPU operation fusion is enabled, and shared by all executions.
+    const std::shared_ptr<const CpuFusionPlan> mFusionPlan;
+    // Inferred from mModel once, and shared by all executions.
+    const std::shared_ptr<const CpuStaticShapes> mStaticShapes;
+    // Resolved from mModel once, and shared by all executions.
+    const std::shared_ptr<const CpuKernelTable> mKernelTable;
+    // Filled with the initial runtime info of each subgraph of mModel, and shared by all
+    // executions.
+    const std::shared_ptr<CpuExecutorSubgraphCache> mSubgraphCache;
 };
 
 class CpuExecution : public RuntimeExecution {
@@ -1010,9 +1091,19 @@ std::vector<bool> CpuDevice::getSupportedOperations(const MetaModel& metaModel)
     return result;
 }
 
+template <typename Type>
+static Result<Version> validateObject(const Type& object) {
+    return validate(object);
+}
+
+// The model has usually been validated by an earlier compilation of it.
+static Result<Version> validateObject(const Model& model) {
+    return ValidatedModelCache::get()->validate(model);
+}
+
 template <typename Type>
 static Result<void> validateAndCheckCompliance(const Type& object) {
-    const auto version = NN_TRY(validate(object));
+    const auto version = NN_TRY(validateObject(object));
     if (!isCompliantVersion(version, DeviceManager::get()->getRuntimeVersion())) {
         return NN_ERROR() << "Object than is newer what is allowed. Version needed: " << version
                           << ", current runtime version supported: "
@@ -1023,18 +1114,10 @@ static Result<void> validateAndCheckCompliance(const Type& object) {
 
 std::pair<int, std::shared_ptr<RuntimePreparedModel>> CpuDevice::prepareModel(
         const ModelFactory& makeModel, ExecutionPreference preference, Priority priority,
-        const OptionalTimePoint& deadline, const CacheInfo& /*cacheInfo*/,
+        const OptionalTimePoint& deadline, const CacheInfo& cacheInfo,
         const std::optional<CacheToken>& maybeToken,
         const std::vector<TokenValuePair>& /*metaData*/,
         const std::vector<ExtensionNameAndPrefix>& /*extensionNameAndPrefix*/) const {
-    CHECK(!maybeToken.has_value())
-            << "Should never call prepareModel with cache information on CpuDevice";
-
-    const Model model = makeModel();
-    if (auto result = validateAndCheckCompliance(model); !result.ok()) {
-        LOG(ERROR) << "Invalid Model: " << result.error();
-        return {ANEURALNETWORKS_OP_FAILED, nullptr};
-    }
     if (auto result = validateAndCheckCompliance(preference); !result.ok()) {
         LOG(ERROR) << "Invalid ExecutionPreference: " << result.error();
         return {ANEURALNETWORKS_OP_FAILED, nullptr};
@@ -1043,11 +1126,70 @@ std::pair<int, std::shared_ptr<RuntimePreparedModel>> CpuDevice::prepareModel(
         LOG(ERROR) << "Invalid Priority: " << result.error();
         return {ANEURALNETWORKS_OP_FAILED, nullptr};
     }
+
+    // Attempt to prepare the model from cache if token is present.
+    if (maybeToken.has_value()) {
+        auto result = prepareModelFromCache(cacheInfo, *maybeToken, priority);
+        if (result.has_value()) {
+            VLOG(COMPILATION) << "CpuDevice::prepareModel: prepared model from cache";
+            return {ANEURALNETWORKS_NO_ERROR, std::move(result).value()};
+        }
+        VLOG(COMPILATION) << "CpuDevice::prepareModel: unable to prepare model from cache: "
+                          << result.error();
+    }
+
+    const Model model = makeModel();
+    if (auto result = validateAndCheckCompliance(model); !result.ok()) {
+        LOG(ERROR) << "Invalid Model: " << result.error();
+        return {ANEURALNETWORKS_OP_FAILED, nullptr};
+    }
     if (hasDeadlinePassed(deadline)) {
         return {ANEURALNETWORKS_MISSED_DEADLINE_PERSISTENT, nullptr};
     }
 
-    return CpuPreparedModel::create(model);
+    auto [n, preparedModel] = CpuPreparedModel::create(model, priority);
+    if (n == ANEURALNETWORKS_NO_ERROR && maybeToken.has_value()) {
+        const auto* cpuPreparedModel = static_cast<const CpuPreparedModel*>(preparedModel.get());
+        auto result = saveToCache(*cpuPreparedModel, cacheInfo, *maybeToken);
+        if (!result.ok()) {
+            LOG(WARNING) << "CpuDevice::prepareModel: unable to save model to cache: "
+                         << result.error();
+        }
+    }
+    return {n, std::move(preparedModel)};
+}
+
+Result<std::shared_ptr<RuntimePreparedModel>> CpuDevice::prepareModelFromCache(
+        const CacheInfo& cacheInfo, const CacheToken& token, Priority priority) const {
+    auto cache = getCacheHandles(cacheInfo, token, getNumberOfCacheFilesNeeded(),
+                                 /*createIfNotExist=*/false);
+    if (!cache.has_value()) {
+        return NN_ERROR() << cache.error().message;
+    }
+    // The warm path saves the work that is proportional to the size of the weights: constant
+    // values are memory mapped rather than copied, and the copies packed by the cold path are
+    // reused rather than packed again. Validation, constant folding, the fusion plan, the static
+    // shapes and the kernel table are still recomputed, in time proportional to the number of
+    // operations.
+    CpuCachedModel cached = NN_TRY(loadCpuModelFromCache(cache.value(), token));
+    NN_TRY(validateAndCheckCompliance(cached.model));
+    auto [n, preparedModel] =
+            CpuPreparedModel::create(std::move(cached.model), priority, cached.packedWeights);
+    if (n != ANEURALNETWORKS_NO_ERROR) {
+        return NN_ERROR() << "Unable to map the data cache file";
+    }
+    return preparedModel;
+}
+
+Result<void> CpuDevice::saveToCache(const CpuPreparedModel& preparedModel,
+                                    const CacheInfo& cacheInfo, const CacheToken& token) const {
+    auto cache = getCacheHandles(cacheInfo, token, getNumberOfCacheFilesNeeded(),
+                                 /*createIfNotExist=*/true, /*recreate=*/true);
+    if (!cache.has_value()) {
+        return NN_ERROR() << cache.error().message;
+    }
+    return saveCpuModelToCache(preparedModel.getModel(), preparedModel.getModelPoolInfos(),
+                               preparedModel.getPackedWeights().get(), cache.value(), token);
 }
 
 std::pair<int, std::unique_ptr<RuntimeMemory>> CpuDevice::allocate(const MemoryDescriptor& desc,
@@ -1060,67 +1202,47 @@ std::pair<int, std::unique_ptr<RuntimeMemory>> CpuDevice::allocate(const MemoryD
     return MemoryAshmem::create(size);
 }
 
-std::pair<int, std::shared_ptr<RuntimePreparedModel>> CpuPreparedModel::create(Model model) {
+std::pair<int, std::shared_ptr<RuntimePreparedModel>> CpuPreparedModel::create(
+        Model model, Priority priority,
+        const std::optional<std::vector<CpuPackedWeights::CachedCopy>>& cachedPackedWeights) {
+    if (DeviceManager::get()->foldCpuConstants()) {
+        foldConstantOperations(&model);
+    }
+
     std::vector<RunTimePoolInfo> poolInfos;
     if (!setRunTimePoolInfosFromCanonicalMemories(&poolInfos, model.pools)) {
         return {ANEURALNETWORKS_UNMAPPABLE, nullptr};
     }
 
-    std::shared_ptr<RuntimePreparedModel> preparedModel =
-            std::make_shared<CpuPreparedModel>(std::move(model), std::move(poolInfos));
+    std::shared_ptr<RuntimePreparedModel> preparedModel = std::make_shared<CpuPreparedModel>(
+            std::move(model), std::move(poolInfos), priority, cachedPackedWeights);
     return {ANEURALNETWORKS_NO_ERROR, std::move(preparedModel)};
 }
 
 static std::tuple<int, std::vector<OutputShape>, Timing> computeOnCpu(
-        const Model& model, const Request& request,
-        const std::vector<RunTimePoolInfo>& modelPoolInfos,
+        const CpuPreparedModel& preparedModel, const Request& request,
         const std::vector<RunTimePoolInfo>& requestPoolInfos, const OptionalTimePoint& deadline,
         const OptionalDuration& loopTimeoutDuration) {
     NNTRACE_RT(NNTRACE_PHASE_EXECUTION, "computeOnCpu");
     CpuExecutor executor;
+    executor.setPackedWeights(preparedModel.getPackedWeights());
+    executor.setFusionPlan(preparedModel.getFusionPlan());
+    executor.setStaticShapes(preparedModel.getStaticShapes());
+    executor.setKernelTable(preparedModel.getKernelTable());
+    executor.setSubgraphCache(preparedModel.getSubgraphCache());
+    executor.setProfiler(DeviceManager::get()->getCpuExecutorProfiler());
     if (loopTimeoutDuration.has_value()) {
         executor.setLoopTimeout(loopTimeoutDuration->count());
     }
     if (deadline.has_value()) {
         executor.setDeadline(*deadline);
     }
-    int err = executor.run(model, request, modelPoolInfos, requestPoolInfos);
+    int err = executor.run(preparedModel.getModel(), request, preparedModel.getModelPoolInfos(),
+                           requestPoolInfos);
     const auto& outputShapes = executor.getOutputShapes();
     return {err, outputShapes, {}};
 }
 
-std::tuple<int, int, ExecuteFencedInfoCallback, Timing> CpuPreparedModel::executeFenced(
-        const std::vector<ModelArgumentInfo>& inputs, const std::vector<ModelArgumentInfo>& outputs,
-        const std::vector<const RuntimeMemory*>& memories, const std::vector<int>& waitFor,
-        MeasureTiming measure, const OptionalTimePoint& deadline,
-        const OptionalDuration& loopTimeoutDuration, const OptionalDuration& duration,
-        const std::vector<TokenValuePair>& /*metaData*/) const {
-    VLOG(EXECUTION)
-            << "CpuPreparedModel::executeFenced wait for sync fences to signal before execution";
-    for (int syncFd : waitFor) {
-        if (syncFd > 0) {
-            auto r = syncWait(syncFd, -1);
-            if (r != FenceState::SIGNALED) {
-                LOG(ERROR) << "sync wait failed, fd: " << syncFd;
-                return {ANEURALNETWORKS_OP_FAILED, -1, nullptr, {}};
-            }
-        }
-    }
-
-    // Update deadline if the timeout duration is closer than the deadline.
-    auto closestDeadline = deadline;
-    if (duration.has_value()) {
-        const auto timeoutDurationDeadline = makeDeadline(*duration);
-        if (!closestDeadline.has_value() || *closestDeadline > timeoutDurationDeadline) {
-            closestDeadline = timeoutDurationDeadline;
-        }
-    }
-
-    const auto [result, outputShapes, timing] = execute(inputs, outputs, memories, nullptr, measure,
-                                                        closestDeadline, loopTimeoutDuration, {});
-    return {result, -1, nullptr, timing};
-}
-
 static std::tuple<int, Request, std::vector<RunTimePoolInfo>> createCpuRequest(
         const std::vector<ModelArgumentInfo>& inputs, const std::vector<ModelArgumentInfo>& outputs,
         const std::vector<const RuntimeMemory*>& memories) {
@@ -1159,6 +1281,155 @@ static std::tuple<int, Request, std::vector<RunTimePoolInfo>> createCpuRequest(
     return {ANEURALNETWORKS_NO_ERROR, std::move(request), std::move(requestPoolInfos)};
 }
 
+// The outcome of a fenced CPU execution, recorded by the worker before it signals the fence.
+struct CpuFencedExecutionResult {
+    std::mutex mutex;
+    int n GUARDED_BY(mutex) = ANEURALNETWORKS_OP_FAILED;
+    Timing timing GUARDED_BY(mutex);
+};
+
+// Starts a fenced execution on the NNAPI CPU reference implementation.
+//
+// The execution runs on a worker thread, which first waits for the fences in waitFor, and the
+// returned sync fence signals once it completes, so that the caller does not block on either.
+// The fence signals with an error if the execution fails, and the returned callback then
+// reports the error code. The worker owns everything it uses, as the caller may not wait for it.
+//
+// If sync fences cannot be created in this process, the execution runs synchronously and no sync
+// fence is returned.
+static std::tuple<int, int, ExecuteFencedInfoCallback, Timing> computeFencedOnCpu(
+        std::shared_ptr<const CpuPreparedModel> preparedModel, Request request,
+        std::vector<RunTimePoolInfo> requestPoolInfos, const std::vector<int>& waitFor,
+        const OptionalTimePoint& deadline, const OptionalDuration& loopTimeoutDuration,
+        const OptionalDuration& duration) {
+    // Update deadline if the timeout duration is closer than the deadline, once the fences in
+    // waitFor have signaled.
+    auto getClosestDeadline = [deadline, duration] {
+        auto closestDeadline = deadline;
+        if (duration.has_value()) {
+            const auto timeoutDurationDeadline = makeDeadline(*duration);
+            if (!closestDeadline.has_value() || *closestDeadline > timeoutDurationDeadline) {
+                closestDeadline = timeoutDurationDeadline;
+            }
+        }
+        return closestDeadline;
+    };
+    auto compute = [](const CpuPreparedModel& preparedModel, const Request& request,
+                      const std::vector<RunTimePoolInfo>& requestPoolInfos,
+                      const OptionalTimePoint& closestDeadline,
+                      const OptionalDuration& loopTimeoutDuration) {
+        if (hasDeadlinePassed(closestDeadline)) {
+            return std::tuple<int, std::vector<OutputShape>, Timing>(
+                    ANEURALNETWORKS_MISSED_DEADLINE_PERSISTENT, {}, {});
+        }
+        return computeOnCpu(preparedModel, request, requestPoolInfos, closestDeadline,
+                            loopTimeoutDuration);
+    };
+
+    std::unique_ptr<SwSyncTimeline> timeline = SwSyncTimeline::create();
+    base::unique_fd syncFence = timeline ? timeline->createFence(1) : base::unique_fd();
+    if (!syncFence.ok()) {
+        VLOG(EXECUTION) << "computeFencedOnCpu wait for sync fences to signal before execution";
+        for (int syncFd : waitFor) {
+            if (syncFd > 0) {
+                auto r = syncWaitWithStatus(syncFd, -1);
+                if (r != FenceState::SIGNALED) {
+                    LOG(ERROR) << "sync wait failed, fd: " << syncFd;
+                    return {ANEURALNETWORKS_OP_FAILED, -1, nullptr, {}};
+                }
+            }
+        }
+        const auto [n, outputShapes, timing] = compute(
+                *preparedModel, request, requestPoolInfos, getClosestDeadline(),
+                loopTimeoutDuration);
+        return {n, -1, nullptr, timing};
+    }
+
+    // The caller may close the fences in waitFor as soon as this function returns.
+    std::vector<base::unique_fd> dependencies;
+    dependencies.reserve(waitFor.size());
+    for (int syncFd : waitFor) {
+        if (syncFd > 0) {
+            base::unique_fd dependency(dup(syncFd));
+            if (!dependency.ok()) {
+                PLOG(ERROR) << "computeFencedOnCpu failed to dup fd: " << syncFd;
+                return {ANEURALNETWORKS_OP_FAILED, -1, nullptr, {}};
+            }
+            dependencies.push_back(std::move(dependency));
+        }
+    }
+
+    auto result = std::make_shared<CpuFencedExecutionResult>();
+    std::thread([timeline = std::move(timeline), dependencies = std::move(dependencies),
+                 preparedModel = std::move(preparedModel), request = std::move(request),
+                 requestPoolInfos = std::move(requestPoolInfos), loopTimeoutDuration,
+                 getClosestDeadline, compute, result] {
+        NNTRACE_RT(NNTRACE_PHASE_EXECUTION, "computeFencedOnCpu");
+        for (const base::unique_fd& dependency : dependencies) {
+            if (syncWaitWithStatus(dependency.get(), -1) != FenceState::SIGNALED) {
+                LOG(ERROR) << "sync wait failed, fd: " << dependency.get();
+                // Destroying the timeline signals the fence with an error.
+                return;
+            }
+        }
+        const auto [n, outputShapes, timing] = compute(
+                *preparedModel, request, requestPoolInfos, getClosestDeadline(),
+                loopTimeoutDuration);
+        {
+            std::lock_guard<std::mutex> guard(result->mutex);
+            result->n = n;
+            result->timing = timing;
+        }
+        if (n == ANEURALNETWORKS_NO_ERROR) {
+            timeline->advance(1);
+        }
+    }).detach();
+
+    ExecuteFencedInfoCallback callback =
+            [result]() -> GeneralResult<std::pair<Timing, Timing>> {
+        std::lock_guard<std::mutex> guard(result->mutex);
+        if (result->n != ANEURALNETWORKS_NO_ERROR) {
+            return NN_ERROR(convertResultCodeToErrorStatus(result->n))
+                   << "CPU fenced execution failed";
+        }
+        return std::make_pair(result->timing, result->timing);
+    };
+    VLOG(EXECUTION) << "computeFencedOnCpu started, fd: " << syncFence.get();
+    return {ANEURALNETWORKS_NO_ERROR, syncFence.release(), std::move(callback), {}};
+}
+
+std::tuple<int, int, ExecuteFencedInfoCallback, Timing> CpuPreparedModel::executeFenced(
+        const std::vector<ModelArgumentInfo>& inputs, const std::vector<ModelArgumentInfo>& outputs,
+        const std::vector<const RuntimeMemory*>& memories, const std::vector<int>& waitFor,
+        MeasureTiming /*measure*/, const OptionalTimePoint& deadline,
+        const OptionalDuration& loopTimeoutDuration, const OptionalDuration& duration,
+        const std::vector<TokenValuePair>& /*metaData*/) const {
+    auto [nCreateRequest, request, requestPoolInfos] = createCpuRequest(inputs, outputs, memories);
+    if (nCreateRequest != ANEURALNETWORKS_NO_ERROR) {
+        return {nCreateRequest, -1, nullptr, {}};
+    }
+    return computeFencedOnCpu(shared_from_this(), std::move(request), std::move(requestPoolInfos),
+                              waitFor, deadline, loopTimeoutDuration, duration);
+}
+
+// Runs compute on DeviceManager::getCpuExecutionScheduler() and waits for its result. Returns
+// ANEURALNETWORKS_MISSED_DEADLINE_TRANSIENT without running it if the deadline passes before the
+// scheduler gets to it.
+static std::tuple<int, std::vector<OutputShape>, Timing> computeOnCpuScheduler(
+        Priority priority, const OptionalTimePoint& deadline,
+        const std::function<std::tuple<int, std::vector<OutputShape>, Timing>()>& compute) {
+    NNTRACE_RT(NNTRACE_PHASE_EXECUTION, "computeOnCpuScheduler");
+    using ComputeResult = std::tuple<int, std::vector<OutputShape>, Timing>;
+    auto result = std::make_shared<std::promise<ComputeResult>>();
+    std::future<ComputeResult> future = result->get_future();
+    DeviceManager::get()->getCpuExecutionScheduler()->schedule(
+            priority, deadline, [result, &compute] { result->set_value(compute()); },
+            [result] {
+                result->set_value({ANEURALNETWORKS_MISSED_DEADLINE_TRANSIENT, {}, {}});
+            });
+    return future.get();
+}
+
 // Perform computation on NNAPI CPU reference implementation.
 //
 // Contrary to DriverPreparedModel::execute, the NNAPI CPU reference executor lives in the
@@ -1186,19 +1457,12 @@ std::tuple<int, std::vector<OutputShape>, Timing> CpuPreparedModel::execute(
     }
 
     if (!DeviceManager::get()->syncExecCpu()) {
-        // TODO: use a thread pool
-        // TODO(mikie): this could have NNTRACE so we could measure the overhead
-        //              of spinning up a new thread.
-        std::tuple<int, std::vector<OutputShape>, Timing> result = {};
-        std::thread([this, &request, &requestPoolInfos, &deadline, &loopTimeoutDuration, &result] {
-            result = computeOnCpu(mModel, request, mModelPoolInfos, requestPoolInfos, deadline,
-                                  loopTimeoutDuration);
-        }).join();
-        return result;
-    }
-
-    return computeOnCpu(mModel, request, mModelPoolInfos, requestPoolInfos, deadline,
-                        loopTimeoutDuration);
+        return computeOnCpuScheduler(kPriority, deadline, [&] {
+            return computeOnCpu(*this, request, requestPoolInfos, deadline, loopTimeoutDuration);
+        });
+    }
+
+    return computeOnCpu(*this, request, requestPoolInfos, deadline, loopTimeoutDuration);
 }
 
 std::pair<int, std::shared_ptr<RuntimeExecution>> CpuPreparedModel::createReusableExecution(
@@ -1222,48 +1486,21 @@ std::tuple<int, std::vector<OutputShape>, Timing> CpuExecution::compute(
     }
 
     if (!DeviceManager::get()->syncExecCpu()) {
-        // TODO: use a thread pool
-        // TODO(mikie): this could have NNTRACE so we could measure the overhead
-        //              of spinning up a new thread.
-        std::tuple<int, std::vector<OutputShape>, Timing> result = {};
-        std::thread([this, &deadline, &result] {
-            result = computeOnCpu(kPreparedModel.getModel(), kRequest,
-                                  kPreparedModel.getModelPoolInfos(), kRequestPoolInfos, deadline,
-                                  kLoopTimeoutDuration);
-        }).join();
-        return result;
-    }
-
-    return computeOnCpu(kPreparedModel.getModel(), kRequest, kPreparedModel.getModelPoolInfos(),
-                        kRequestPoolInfos, deadline, kLoopTimeoutDuration);
+        return computeOnCpuScheduler(kPreparedModel.getPriority(), deadline, [&] {
+            return computeOnCpu(kPreparedModel, kRequest, kRequestPoolInfos, deadline,
+                                kLoopTimeoutDuration);
+        });
+    }
+
+    return computeOnCpu(kPreparedModel, kRequest, kRequestPoolInfos, deadline,
+                        kLoopTimeoutDuration);
 }
 
 std::tuple<int, int, ExecuteFencedInfoCallback, Timing> CpuExecution::computeFenced(
         const std::vector<int>& waitFor, const OptionalTimePoint& deadline,
         const OptionalDuration& duration) const {
-    VLOG(EXECUTION)
-            << "CpuExecution::computeFenced wait for sync fences to signal before execution";
-    for (int syncFd : waitFor) {
-        if (syncFd > 0) {
-            auto r = syncWait(syncFd, -1);
-            if (r != FenceState::SIGNALED) {
-                LOG(ERROR) << "sync wait failed, fd: " << syncFd;
-                return {ANEURALNETWORKS_OP_FAILED, -1, nullptr, {}};
-            }
-        }
-    }
-
-    // Update deadline if the timeout duration is closer than the deadline.
-    auto closestDeadline = deadline;
-    if (duration.has_value()) {
-        const auto timeoutDurationDeadline = makeDeadline(*duration);
-        if (!closestDeadline.has_value() || *closestDeadline > timeoutDurationDeadline) {
-            closestDeadline = timeoutDurationDeadline;
-        }
-    }
-
-    const auto [result, outputShapes, timing] = compute(nullptr, closestDeadline);
-    return {result, -1, nullptr, timing};
+    return computeFencedOnCpu(kPreparedModel.shared_from_this(), kRequest, kRequestPoolInfos,
+                              waitFor, deadline, kLoopTimeoutDuration, duration);
 }
 
 int64_t DeviceManager::getRuntimeFeatureLevel() const {
@@ -1275,6 +1512,33 @@ DeviceManager* DeviceManager::get() {
     return &manager;
 }
 
+// The schedulers are never destroyed, so that the process can exit while executions still run.
+
+PriorityThreadPool* DeviceManager::getAsyncExecutionScheduler() const {
+    // Most asynchronous executions wait for a driver rather than keep a core busy.
+    constexpr uint32_t kThreadsPerCore = 2;
+    constexpr uint32_t kMaxQueuedExecutions = 256;
+    static PriorityThreadPool* const scheduler = new PriorityThreadPool(
+            kThreadsPerCore * std::thread::hardware_concurrency(), kMaxQueuedExecutions);
+    return scheduler;
+}
+
+PriorityThreadPool* DeviceManager::getCpuExecutionScheduler() const {
+    constexpr uint32_t kMaxQueuedExecutions = 64;
+    static PriorityThreadPool* const scheduler =
+            new PriorityThreadPool(std::thread::hardware_concurrency(), kMaxQueuedExecutions);
+    return scheduler;
+}
+
+PriorityThreadPool* DeviceManager::getCompilationScheduler() const {
+    // Most step models are compiled by a driver rather than on a core of this process.
+    constexpr uint32_t kThreadsPerCore = 2;
+    constexpr uint32_t kMaxQueuedCompilations = 64;
+    static PriorityThreadPool* const scheduler = new PriorityThreadPool(
+            kThreadsPerCore * std::thread::hardware_concurrency(), kMaxQueuedCompilations);
+    return scheduler;
+}
+
 std::shared_ptr<Device> DeviceManager::getCpuDevice() {
     return CpuDevice::get();
 }
@@ -1367,6 +1631,15 @@ DeviceManager::DeviceManager() {
     mDebugNNCpuOnly = (getProp("debug.nn.cpuonly") != 0);
     mSyncExecCpu = (getProp("debug.nn.syncexec-cpu", 1) != 0);
     mSyncExecRuntime = (getProp("debug.nn.syncexec-runtime") != 0);
+    mDeduplicatePreparedModels = (getProp("debug.nn.dedup-prepared-models") != 0);
+    mFoldCpuConstants = (getProp("debug.nn.cpu-constant-folding") != 0);
+    mFuseCpuOperations = (getProp("debug.nn.cpu-operation-fusion") != 0);
+    mAutomaticCacheDir = base::GetProperty("debug.nn.auto-cache-dir", "");
+    constexpr uint64_t kBytesPerMegabyte = 1024 * 1024;
+    mAutomaticCacheMaxBytes =
+            getProp("debug.nn.auto-cache-max-mb",
+                    static_cast<uint32_t>(kAutomaticCacheMaxBytesDefault / kBytesPerMegabyte)) *
+            kBytesPerMegabyte;
 #endif  // NN_DEBUGGABLE
 }
 
@@ -17,7 +17,9 @@
 #ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_MANAGER_H
 #define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_MANAGER_H
 
+#include <CpuExecutorProfiler.h>
 #include <LegacyUtils.h>
+#include <PriorityThreadPool.h>
 #include <android-base/macros.h>
 #include <nnapi/IBurst.h>
 #include <nnapi/IDevice.h>
@@ -25,6 +27,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <unordered_set>
@@ -205,6 +208,56 @@ class DeviceManager {
 
     bool strictSlicing() const { return mStrictSlicing; }
 
+    // Whether compilations of the same model for the same device and settings share one prepared
+    // model. See PreparedModelCache.
+    bool deduplicatePreparedModels() const { return mDeduplicatePreparedModels; }
+    void setDeduplicatePreparedModels(bool deduplicate) {
+        mDeduplicatePreparedModels = deduplicate;
+    }
+
+    // Whether models prepared for the CPU device have their constant operations folded and their
+    // dead operations removed. See foldConstantOperations.
+    bool foldCpuConstants() const { return mFoldCpuConstants; }
+    void setFoldCpuConstants(bool fold) { mFoldCpuConstants = fold; }
+
+    // Whether models prepared for the CPU device run their chains of elementwise operations as
+    // single fused loops. See CpuFusionPlan.
+    bool fuseCpuOperations() const { return mFuseCpuOperations; }
+    void setFuseCpuOperations(bool fuse) { mFuseCpuOperations = fuse; }
+
+    // The profiler of the CpuExecutors that run models on the CPU device, or nullptr if CPU
+    // executions are not profiled, which is the default. See CpuExecutorProfiler.
+    std::shared_ptr<CpuExecutorProfiler> getCpuExecutorProfiler() const {
+        std::lock_guard<std::mutex> lock(mCpuExecutorProfilerMutex);
+        return mCpuExecutorProfiler;
+    }
+    void setCpuExecutorProfiler(std::shared_ptr<CpuExecutorProfiler> profiler) {
+        std::lock_guard<std::mutex> lock(mCpuExecutorProfilerMutex);
+        mCpuExecutorProfiler = std::move(profiler);
+    }
+
+    // Runs the asynchronous executions started by ExecutionBuilder::compute on a bounded number of
+    // threads, by priority and then earliest deadline. Its statistics count the executions that
+    // missed their deadline. See PriorityThreadPool.
+    PriorityThreadPool* getAsyncExecutionScheduler() const;
+
+    // Runs the executions of the CPU device like getAsyncExecutionScheduler() when syncExecCpu()
+    // is false. The CPU device otherwise runs them on the calling thread.
+    PriorityThreadPool* getCpuExecutionScheduler() const;
+
+    // Runs the helpers that compileConcurrently uses to compile the step models of a partitioned
+    // compilation, so that concurrent compilations share a bounded number of threads.
+    PriorityThreadPool* getCompilationScheduler() const;
+
+    // Directory of the automatic compilation cache and the number of bytes the cache may occupy.
+    // An empty directory disables automatic caching. See AutomaticCompilationCache.
+    const std::string& getAutomaticCacheDir() const { return mAutomaticCacheDir; }
+    uint64_t getAutomaticCacheMaxBytes() const { return mAutomaticCacheMaxBytes; }
+    void setAutomaticCaching(std::string cacheDir, uint64_t maxBytes) {
+        mAutomaticCacheDir = std::move(cacheDir);
+        mAutomaticCacheMaxBytes = maxBytes;
+    }
+
     // Returns the singleton manager.
     static DeviceManager* get();
 
@@ -273,6 +326,26 @@ class DeviceManager {
     uint32_t mPartitioning = kPartitioningDefault;
 
     bool mStrictSlicing = false;
+
+    // Set by setDeduplicatePreparedModels(), or derived from system property
+    // debug.nn.dedup-prepared-models.
+    bool mDeduplicatePreparedModels = false;
+
+    // Set by setFoldCpuConstants(), or derived from system property debug.nn.cpu-constant-folding.
+    bool mFoldCpuConstants = false;
+
+    // Set by setFuseCpuOperations(), or derived from system property debug.nn.cpu-operation-fusion.
+    bool mFuseCpuOperations = false;
+
+    // Set by setCpuExecutorProfiler().
+    mutable std::mutex mCpuExecutorProfilerMutex;
+    std::shared_ptr<CpuExecutorProfiler> mCpuExecutorProfiler;
+
+    // Set by setAutomaticCaching(), or derived from system properties debug.nn.auto-cache-dir and
+    // debug.nn.auto-cache-max-mb.
+    static const uint64_t kAutomaticCacheMaxBytesDefault = 256 * 1024 * 1024;
+    std::string mAutomaticCacheDir;
+    uint64_t mAutomaticCacheMaxBytes = kAutomaticCacheMaxBytesDefault;
 };
 
 std::vector<SharedDevice> getDevices();
@@ -18,10 +18,14 @@
 
 #include "ModelArchHasher.h"
 
+#include <CpuExecutor.h>
 #include <android-base/logging.h>
 #include <nnapi/Types.h>
 #include <openssl/sha.h>
 
+#include <variant>
+#include <vector>
+
 namespace android::nn {
 
 namespace {
@@ -30,7 +34,47 @@ bool update(SHA256_CTX* hasher, const void* bytes, size_t length) {
     return SHA256_Update(hasher, bytes, length) != 0;
 }
 
-bool updateSubgraph(SHA256_CTX* hasher, const Model::Subgraph& subgraph) {
+// Hashes the number of elements that follow, so that the boundaries between consecutive vectors
+// are part of the hash.
+bool updateSize(SHA256_CTX* hasher, size_t size) {
+    return update(hasher, static_cast<const void*>(&size), sizeof(size));
+}
+
+// Hashes the extra params by value. The variant itself holds heap pointers, which would make the
+// hash differ between two copies of the same model.
+bool updateExtraParams(SHA256_CTX* hasher, const Operand::ExtraParams& extraParams) {
+    const size_t index = extraParams.index();
+    bool success = update(hasher, static_cast<const void*>(&index), sizeof(index));
+    if (const auto* params = std::get_if<Operand::SymmPerChannelQuantParams>(&extraParams)) {
+        success &= updateSize(hasher, params->scales.size());
+        success &= update(hasher, static_cast<const void*>(params->scales.data()),
+                          sizeof(decltype(params->scales)::value_type) * params->scales.size());
+        success &= update(hasher, static_cast<const void*>(&params->channelDim),
+                          sizeof(params->channelDim));
+    } else if (const auto* params = std::get_if<Operand::ExtensionParams>(&extraParams)) {
+        success &= updateSize(hasher, params->size());
+        success &= update(hasher, static_cast<const void*>(params->data()), params->size());
+    }
+    return success;
+}
+
+bool updateSubgraphWeights(SHA256_CTX* hasher, const Model& model, const Model::Subgraph& subgraph,
+                           const std::vector<RunTimePoolInfo>& poolInfos) {
+    bool success = true;
+    for (auto& operand : subgraph.operands) {
+        if (const uint8_t* data = getConstantOperandData(model, operand, poolInfos)) {
+            success &= update(hasher, static_cast<const void*>(&operand.location.length),
+                              sizeof(operand.location.length));
+            success &= update(hasher, static_cast<const void*>(data), operand.location.length);
+        }
+    }
+    return success;
+}
+
+// Hashes the structure of the subgraph for calcModelArchHash. The model arch hash is reported by
+// telemetry, so this must not change: models hashed by different versions of the runtime would no
+// longer be recognized as the same architecture.
+bool updateSubgraphArch(SHA256_CTX* hasher, const Model::Subgraph& subgraph) {
     bool success = true;
     for (auto& operand : subgraph.operands) {
         success &= update(hasher, static_cast<const void*>(&operand.type), sizeof(operand.type));
@@ -65,6 +109,54 @@ bool updateSubgraph(SHA256_CTX* hasher, const Model::Subgraph& subgraph) {
     return success;
 }
 
+// Hashes the structure of the subgraph for calcModelContentHash. Unlike updateSubgraphArch, the
+// boundaries between vectors, the extra params by value and the subgraphs referenced by control
+// flow operands are all part of the hash, so that structurally different models do not collide.
+bool updateSubgraphStructure(SHA256_CTX* hasher, const Model::Subgraph& subgraph) {
+    bool success = updateSize(hasher, subgraph.operands.size());
+    for (auto& operand : subgraph.operands) {
+        success &= update(hasher, static_cast<const void*>(&operand.type), sizeof(operand.type));
+        success &= updateSize(hasher, operand.dimensions.size());
+        success &= update(
+                hasher, static_cast<const void*>(operand.dimensions.data()),
+                sizeof(decltype(operand.dimensions)::value_type) * operand.dimensions.size());
+        success &= update(hasher, static_cast<const void*>(&operand.scale), sizeof(operand.scale));
+        success &= update(hasher, static_cast<const void*>(&operand.zeroPoint),
+                          sizeof(operand.zeroPoint));
+        success &= update(hasher, static_cast<const void*>(&operand.lifetime),
+                          sizeof(operand.lifetime));
+        success &= updateExtraParams(hasher, operand.extraParams);
+        // The subgraph referenced by a control flow operand is part of the architecture.
+        if (operand.lifetime == Operand::LifeTime::SUBGRAPH) {
+            success &= update(hasher, static_cast<const void*>(&operand.location.offset),
+                              sizeof(operand.location.offset));
+        }
+    }
+
+    success &= updateSize(hasher, subgraph.operations.size());
+    for (auto& operation : subgraph.operations) {
+        success &=
+                update(hasher, static_cast<const void*>(&operation.type), sizeof(operation.type));
+        success &= updateSize(hasher, operation.inputs.size());
+        success &= update(hasher, static_cast<const void*>(operation.inputs.data()),
+                          sizeof(decltype(operation.inputs)::value_type) * operation.inputs.size());
+        success &= updateSize(hasher, operation.outputs.size());
+        success &=
+                update(hasher, static_cast<const void*>(operation.outputs.data()),
+                       sizeof(decltype(operation.outputs)::value_type) * operation.outputs.size());
+    }
+
+    success &= updateSize(hasher, subgraph.inputIndexes.size());
+    success &= update(
+            hasher, static_cast<const void*>(subgraph.inputIndexes.data()),
+            sizeof(decltype(subgraph.inputIndexes)::value_type) * subgraph.inputIndexes.size());
+    success &= updateSize(hasher, subgraph.outputIndexes.size());
+    success &= update(
+            hasher, static_cast<const void*>(subgraph.outputIndexes.data()),
+            sizeof(decltype(subgraph.outputIndexes)::value_type) * subgraph.outputIndexes.size());
+    return success;
+}
+
 }  // namespace
 
 bool calcModelArchHash(const Model& model, uint8_t* data) {
@@ -74,9 +166,49 @@ bool calcModelArchHash(const Model& model, uint8_t* data) {
     }
 
     bool success = true;
-    success &= updateSubgraph(&mHasher, model.main);
+    success &= updateSubgraphArch(&mHasher, model.main);
     for (auto& subgraph : model.referenced) {
-        success &= updateSubgraph(&mHasher, subgraph);
+        success &= updateSubgraphArch(&mHasher, subgraph);
+    }
+    if (!success) {
+        return false;
+    }
+
+    if (SHA256_Final(data, &mHasher) == 0) {
+        return false;
+    }
+    return true;
+}
+
+bool calcModelContentHash(const Model& model, uint8_t* data) {
+    std::vector<RunTimePoolInfo> poolInfos;
+    if (!setRunTimePoolInfosFromCanonicalMemories(&poolInfos, model.pools)) {
+        LOG(ERROR) << "calcModelContentHash: unable to map model memory pools";
+        return false;
+    }
+
+    SHA256_CTX mHasher;
+    if (SHA256_Init(&mHasher) == 0) {
+        return false;
+    }
+
+    bool success = updateSubgraphStructure(&mHasher, model.main);
+    success &= updateSize(&mHasher, model.referenced.size());
+    for (auto& subgraph : model.referenced) {
+        success &= updateSubgraphStructure(&mHasher, subgraph);
+    }
+    success &= updateSubgraphWeights(&mHasher, model, model.main, poolInfos);
+    for (auto& subgraph : model.referenced) {
+        success &= updateSubgraphWeights(&mHasher, model, subgraph, poolInfos);
+    }
+    const uint8_t relaxComputationFloat32toFloat16 = model.relaxComputationFloat32toFloat16;
+    success &= update(&mHasher, static_cast<const void*>(&relaxComputationFloat32toFloat16),
+                      sizeof(relaxComputationFloat32toFloat16));
+    success &= updateSize(&mHasher, model.extensionNameToPrefix.size());
+    for (auto& [name, prefix] : model.extensionNameToPrefix) {
+        success &= updateSize(&mHasher, name.size());
+        success &= update(&mHasher, static_cast<const void*>(name.data()), name.size());
+        success &= update(&mHasher, static_cast<const void*>(&prefix), sizeof(prefix));
     }
     if (!success) {
         return false;
@@ -25,6 +25,12 @@ namespace android::nn {
 // Weights do not affect this hash.
 bool calcModelArchHash(const Model& model, uint8_t* data);
 
+// Generated hash from the operations and operands of the canonical model, the values of all its
+// constant operands, whether its FLOAT32 computation may be relaxed to FLOAT16, and its extension
+// prefixes. It identifies the content of a model, e.g. to find an earlier compilation of the same
+// model. It is independent of calcModelArchHash, which telemetry reports and so does not change.
+bool calcModelContentHash(const Model& model, uint8_t* data);
+
 static const int BYTE_SIZE_OF_MODEL_ARCH_HASH = 32;
 
 }  // namespace android::nn
@@ -27,6 +27,7 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <utility>
 #include <vector>
@@ -1020,6 +1021,14 @@ const uint8_t* ModelBuilder::getModelArchHash() const {
     return mModelArchHash;
 }
 
+const uint8_t* ModelBuilder::getModelContentHash() const {
+    CHECK(mCompletedModel) << "Calling getModelContentHash on non completed model";
+    std::call_once(mModelContentHashOnce, [this] {
+        mHasModelContentHash = calcModelContentHash(makeModel(), mModelContentHash);
+    });
+    return mHasModelContentHash ? mModelContentHash : nullptr;
+}
+
 #undef NN_VALIDATE_NULL_OR_SIZED
 
 }  // namespace nn
@@ -23,6 +23,7 @@
 #include <LegacyUtils.h>
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "Memory.h"
@@ -136,6 +137,11 @@ class ModelBuilder {
 
     const uint8_t* getModelArchHash() const;
 
+    // Returns the content hash of the finished model (see calcModelContentHash), or nullptr if it
+    // cannot be computed. It reads every constant value, so it is computed once, by the first
+    // call, and shared by all the compilations of the model.
+    const uint8_t* getModelContentHash() const;
+
    private:
     // TODO(b/132322449): move partitionTheWork, findBestDeviceForEachOperation,
     // getPerformance, supportedByControlFlowInterpreter,
@@ -255,6 +261,11 @@ class ModelBuilder {
     // Model architecture hash, used for telemetry.
     uint8_t mModelArchHash[BYTE_SIZE_OF_MODEL_ARCH_HASH];
 
+    // Model content hash, computed by the first call to getModelContentHash().
+    mutable std::once_flag mModelContentHashOnce;
+    mutable bool mHasModelContentHash = false;
+    mutable uint8_t mModelContentHash[BYTE_SIZE_OF_MODEL_ARCH_HASH];
+
     class ModelMaker;
 };
 
@@ -1632,7 +1632,7 @@ int ANeuralNetworksExecution_startComputeWithDependencies(
                   << " because of boundary operands of unknown size";
         for (int syncFenceFd : waitForList) {
             if (syncFenceFd > 0) {
-                auto w = syncWait(syncFenceFd, -1);
+                auto w = syncWaitWithStatus(syncFenceFd, -1);
                 if (w != FenceState::SIGNALED) {
                     VLOG(EXECUTION) << "syncWait failed, fd: " << syncFenceFd;
                     *event = nullptr;
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "PreparedModelCache"
+
+#include "PreparedModelCache.h"
+
+#include <LegacyUtils.h>
+#include <TokenHasher.h>
+#include <android-base/logging.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+
+namespace android {
+namespace nn {
+
+namespace {
+
+template <typename T>
+bool update(TokenHasher* hasher, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return hasher->update(&value, sizeof(value));
+}
+
+template <typename T>
+bool update(TokenHasher* hasher, const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return update(hasher, values.size()) &&
+           hasher->update(values.data(), values.size() * sizeof(T));
+}
+
+bool updateFromString(TokenHasher* hasher, const std::string& s) {
+    return update(hasher, s.size()) && hasher->update(s.data(), s.size());
+}
+
+}  // namespace
+
+PreparedModelCache* PreparedModelCache::get() {
+    static PreparedModelCache cache;
+    return &cache;
+}
+
+std::optional<PreparedModelCache::Key> PreparedModelCache::makeKey(
+        const ModelBuilder& model, const Device& device, int32_t executionPreference,
+        int32_t priority, const std::vector<TokenValuePair>& metaData) {
+    const uint8_t* contentHash = model.getModelContentHash();
+    if (contentHash == nullptr) {
+        VLOG(COMPILATION) << "PreparedModelCache::makeKey: unable to hash the model";
+        return std::nullopt;
+    }
+
+    TokenHasher hasher(contentHash);
+    bool success = updateFromString(&hasher, device.getName()) &&
+                   updateFromString(&hasher, device.getVersionString()) &&
+                   update(&hasher, executionPreference) && update(&hasher, priority) &&
+                   update(&hasher, metaData.size());
+    for (const auto& [token, value] : metaData) {
+        success &= update(&hasher, token) && update(&hasher, value);
+    }
+    if (!success || !hasher.finish()) {
+        return std::nullopt;
+    }
+
+    Key key;
+    const uint8_t* digest = hasher.getCacheToken();
+    std::copy(digest, digest + key.size(), key.begin());
+    return key;
+}
+
+std::shared_ptr<RuntimePreparedModel> PreparedModelCache::lookup(const Key& key) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const auto it = mEntries.find(key);
+    if (it == mEntries.end()) {
+        return nullptr;
+    }
+    auto preparedModel = it->second.lock();
+    if (preparedModel == nullptr) {
+        mEntries.erase(it);
+    }
+    return preparedModel;
+}
+
+void PreparedModelCache::insert(const Key& key,
+                                const std::shared_ptr<RuntimePreparedModel>& preparedModel) {
+    CHECK(preparedModel != nullptr);
+    std::lock_guard<std::mutex> lock(mMutex);
+    // Drop the entries of prepared models that have been released since the last insertion, so
+    // that the cache does not grow with every distinct model ever compiled.
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        it = it->second.expired() ? mEntries.erase(it) : std::next(it);
+    }
+    mEntries.insert_or_assign(key, preparedModel);
+}
+
+}  // namespace nn
+}  // namespace android
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_PREPARED_MODEL_CACHE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_PREPARED_MODEL_CACHE_H
+
+#include <android-base/thread_annotations.h>
+#include <nnapi/Types.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace android {
+namespace nn {
+
+class Device;
+class ModelBuilder;
+class RuntimePreparedModel;
+
+// An in-process cache of prepared models keyed by model content. When the same model is compiled
+// more than once in a process for the same device and with the same settings, the later
+// compilations share the prepared model of the first one instead of preparing the model again.
+//
+// Entries are held weakly, so a prepared model is released as soon as the last compilation using
+// it is destroyed. The cache is disabled unless DeviceManager::deduplicatePreparedModels() is
+// true.
+class PreparedModelCache {
+   public:
+    using Key = CacheToken;
+
+    // Returns the singleton cache.
+    static PreparedModelCache* get();
+
+    // Computes the key of the model prepared for the device with the given settings. The key is
+    // derived from the content hash of the model, which is shared with the other compilations of
+    // the model. Returns std::nullopt if the model cannot be keyed, e.g. because a memory pool
+    // cannot be mapped.
+    static std::optional<Key> makeKey(const ModelBuilder& model, const Device& device,
+                                      int32_t executionPreference, int32_t priority,
+                                      const std::vector<TokenValuePair>& metaData);
+
+    // Returns the prepared model cached for the key, or nullptr if there is none.
+    std::shared_ptr<RuntimePreparedModel> lookup(const Key& key);
+
+    // Caches the prepared model for the key, replacing any previous entry.
+    void insert(const Key& key, const std::shared_ptr<RuntimePreparedModel>& preparedModel);
+
+   private:
+    std::mutex mMutex;
+    std::map<Key, std::weak_ptr<RuntimePreparedModel>> mEntries GUARDED_BY(mMutex);
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_PREPARED_MODEL_CACHE_H
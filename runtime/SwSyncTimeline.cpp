@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SwSyncTimeline"
+
+#include "SwSyncTimeline.h"
+
+#include <LegacyUtils.h>
+#include <android-base/logging.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace android {
+namespace nn {
+namespace {
+
+std::atomic<bool> gAvailable = true;
+
+#ifdef __ANDROID__
+// The sw_sync interface is not part of the kernel UAPI headers. These definitions match the ones
+// of drivers/dma-buf/sw_sync.c, which libsync also duplicates.
+struct sw_sync_create_fence_data {
+    uint32_t value;
+    char name[32];
+    int32_t fence;
+};
+
+constexpr char kSwSyncIocMagic = 'W';
+constexpr unsigned long kSwSyncIocCreateFence =
+        _IOWR(kSwSyncIocMagic, 0, struct sw_sync_create_fence_data);
+constexpr unsigned long kSwSyncIocInc = _IOW(kSwSyncIocMagic, 1, uint32_t);
+
+// The driver lives in debugfs on recent kernels, and was a device node on older ones.
+constexpr const char* kSwSyncPaths[] = {"/sys/kernel/debug/sync/sw_sync", "/dev/sw_sync"};
+#endif  // __ANDROID__
+
+}  // namespace
+
+std::unique_ptr<SwSyncTimeline> SwSyncTimeline::create() {
+    if (!gAvailable) {
+        return nullptr;
+    }
+#ifdef __ANDROID__
+    for (const char* path : kSwSyncPaths) {
+        base::unique_fd fd(open(path, O_RDWR | O_CLOEXEC));
+        if (fd.ok()) {
+            return std::unique_ptr<SwSyncTimeline>(new SwSyncTimeline(std::move(fd)));
+        }
+    }
+    VLOG(EXECUTION) << "SwSyncTimeline::create: sw_sync is not available";
+#endif  // __ANDROID__
+    return nullptr;
+}
+
+base::unique_fd SwSyncTimeline::createFence([[maybe_unused]] uint32_t value) const {
+#ifdef __ANDROID__
+    struct sw_sync_create_fence_data data = {.value = value, .name = {}, .fence = -1};
+    std::strncpy(data.name, "nnapi_cpu", sizeof(data.name) - 1);
+    if (ioctl(mFd.get(), kSwSyncIocCreateFence, &data) != 0) {
+        PLOG(ERROR) << "SwSyncTimeline::createFence failed";
+        return {};
+    }
+    return base::unique_fd(data.fence);
+#else   // __ANDROID__
+    return {};
+#endif  // __ANDROID__
+}
+
+bool SwSyncTimeline::advance([[maybe_unused]] uint32_t count) {
+#ifdef __ANDROID__
+    if (ioctl(mFd.get(), kSwSyncIocInc, &count) != 0) {
+        PLOG(ERROR) << "SwSyncTimeline::advance failed";
+        return false;
+    }
+    return true;
+#else   // __ANDROID__
+    return false;
+#endif  // __ANDROID__
+}
+
+void SwSyncTimeline::forTest_setAvailable(bool available) {
+    gAvailable = available;
+}
+
+}  // namespace nn
+}  // namespace android
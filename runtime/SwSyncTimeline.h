@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_SW_SYNC_TIMELINE_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_SW_SYNC_TIMELINE_H
+
+#include <android-base/unique_fd.h>
+
+#include <memory>
+
+namespace android {
+namespace nn {
+
+// A timeline of the kernel sw_sync driver. The fences created on it are sync files like the ones
+// created by the drivers, so they can be returned to the application or passed to another device.
+// A fence signals once the timeline has been advanced to its value. Destroying the timeline
+// signals the fences it has not reached yet with an error.
+//
+// The sw_sync driver (CONFIG_SW_SYNC) is not accessible on every device, so the users of this
+// class must handle create() failing.
+class SwSyncTimeline {
+   public:
+    // Opens a new timeline at value 0. Returns nullptr if the sw_sync driver is not available.
+    static std::unique_ptr<SwSyncTimeline> create();
+
+    // Returns a fence that signals once the timeline reaches value, or an invalid fd on failure.
+    base::unique_fd createFence(uint32_t value) const;
+
+    // Advances the timeline by count. Returns false on failure.
+    bool advance(uint32_t count);
+
+    // Makes create() return nullptr while available is false, as if the sw_sync driver was not
+    // available, so that tests can exercise the fallbacks of its users.
+    static void forTest_setAvailable(bool available);
+
+   private:
+    explicit SwSyncTimeline(base::unique_fd fd) : mFd(std::move(fd)) {}
+
+    base::unique_fd mFd;
+};
+
+}  // namespace nn
+}  // namespace android
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_SW_SYNC_TIMELINE_H
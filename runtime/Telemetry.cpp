@@ -20,13 +20,17 @@
 
 #include <algorithm>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "Manager.h"
 #include "NeuralNetworks.h"
+#include "TelemetryHistogram.h"
 #include "Tracing.h"
 
 #if defined(__ANDROID__) && !defined(NN_COMPATIBILITY_LIBRARY_BUILD)
@@ -42,6 +46,22 @@ std::function<void(const DiagnosticCompilationInfo*)> gCompilationCallback;
 std::function<void(const DiagnosticExecutionInfo*)> gExecutionCallback;
 std::atomic_bool gLoggingCallbacksSet = false;
 
+// Local timing histograms, keyed by device id and the name of the timing.
+std::atomic_bool gLocalHistogramsEnabled = false;
+std::mutex gLocalHistogramsMutex;
+std::map<std::pair<std::string, std::string>, TimingHistogram> gLocalHistograms;
+
+void recordLocalTiming(const std::string& deviceId, const char* name, uint64_t timeNanos,
+                       uint64_t nanosPerUnit) {
+    if (timeNanos == kNoTimeReported) {
+        return;
+    }
+    const auto time = static_cast<int64_t>(
+            std::min<uint64_t>(timeNanos / nanosPerUnit, std::numeric_limits<int64_t>::max()));
+    std::lock_guard<std::mutex> lock(gLocalHistogramsMutex);
+    gLocalHistograms[{deviceId, name}].record(time);
+}
+
 // Convert list of Device object into a single string with all
 // identifiers, sorted by name in form of "name1=version1,name2=version2,..."
 std::string makeDeviceId(const std::vector<std::shared_ptr<Device>>& devices) {
@@ -156,7 +176,9 @@ void onCompilationFinish(CompilationBuilder* c, int resultCode) {
     }
 
     const bool loggingCallbacksSet = gLoggingCallbacksSet;
-    if (!loggingCallbacksSet && !DeviceManager::get()->isPlatformTelemetryEnabled()) {
+    const bool localHistogramsEnabled = gLocalHistogramsEnabled;
+    if (!loggingCallbacksSet && !localHistogramsEnabled &&
+        !DeviceManager::get()->isPlatformTelemetryEnabled()) {
         return;
     }
 
@@ -183,6 +205,11 @@ void onCompilationFinish(CompilationBuilder* c, int resultCode) {
     if (loggingCallbacksSet) {
         gCompilationCallback(&info);
     }
+
+    if (localHistogramsEnabled && resultCode == ANEURALNETWORKS_NO_ERROR) {
+        recordLocalTiming(info.deviceId, "compilationTimeMillis", info.compilationTimeNanos,
+                          1'000'000);
+    }
 }
 
 void onExecutionFinish(ExecutionBuilder* e, ExecutionMode executionMode, int resultCode) {
@@ -195,7 +222,9 @@ void onExecutionFinish(ExecutionBuilder* e, ExecutionMode executionMode, int res
     }
 
     const bool loggingCallbacksSet = gLoggingCallbacksSet;
-    if (!loggingCallbacksSet && !DeviceManager::get()->isPlatformTelemetryEnabled()) {
+    const bool localHistogramsEnabled = gLocalHistogramsEnabled;
+    if (!loggingCallbacksSet && !localHistogramsEnabled &&
+        !DeviceManager::get()->isPlatformTelemetryEnabled()) {
         return;
     }
 
@@ -240,6 +269,14 @@ void onExecutionFinish(ExecutionBuilder* e, ExecutionMode executionMode, int res
     if (loggingCallbacksSet) {
         gExecutionCallback(&info);
     }
+
+    if (localHistogramsEnabled && resultCode == ANEURALNETWORKS_NO_ERROR) {
+        recordLocalTiming(info.deviceId, "durationRuntimeMicros", info.durationRuntimeNanos,
+                          1'000);
+        recordLocalTiming(info.deviceId, "durationDriverMicros", info.durationDriverNanos, 1'000);
+        recordLocalTiming(info.deviceId, "durationHardwareMicros", info.durationHardwareNanos,
+                          1'000);
+    }
 }
 
 void registerTelemetryCallbacks(std::function<void(const DiagnosticCompilationInfo*)> compilation,
@@ -253,4 +290,22 @@ void clearTelemetryCallbacks() {
     gLoggingCallbacksSet = false;
 }
 
+void enableLocalTimingHistograms(bool enable) {
+    gLocalHistogramsEnabled = enable;
+    if (!enable) {
+        std::lock_guard<std::mutex> lock(gLocalHistogramsMutex);
+        gLocalHistograms.clear();
+    }
+}
+
+std::string dumpLocalTimingHistograms() {
+    std::lock_guard<std::mutex> lock(gLocalHistogramsMutex);
+    std::ostringstream oss;
+    for (const auto& [key, histogram] : gLocalHistograms) {
+        const auto& [deviceId, name] = key;
+        oss << deviceId << " " << name << " " << toString(histogram) << "\n";
+    }
+    return oss.str();
+}
+
 }  // namespace android::nn::telemetry
@@ -108,6 +108,16 @@ void registerTelemetryCallbacks(std::function<void(const DiagnosticCompilationIn
                                 std::function<void(const DiagnosticExecutionInfo*)> execution);
 void clearTelemetryCallbacks();
 
+// Local timing histograms aggregate the timings of all compilations and executions of the process
+// per device id, independently of statsd. This allows percentiles to be inspected on builds without
+// statsd, e.g. on host. Recording is disabled by default; disabling it discards recorded timings.
+void enableLocalTimingHistograms(bool enable);
+
+// Returns one line per device id and kind of timing that has been recorded, with the number of
+// recorded timings and their estimated percentiles, e.g.
+// "nnapi-reference=1 durationRuntimeMicros count=10 p50=40 p95=52 p99=60".
+std::string dumpLocalTimingHistograms();
+
 }  // namespace android::nn::telemetry
 
 #endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_TELEMETRY_H
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "TelemetryHistogram"
+
+#include "TelemetryHistogram.h"
+
+#include <android-base/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace android::nn::telemetry {
+
+void TimingHistogram::record(int64_t value) {
+    const uint32_t index = getBucketIndex(value);
+    const auto it = std::lower_bound(
+            mBuckets.begin(), mBuckets.end(), index,
+            [](const Bucket& bucket, uint32_t index) { return bucket.index < index; });
+    if (it != mBuckets.end() && it->index == index) {
+        ++it->count;
+    } else {
+        mBuckets.insert(it, {.index = index, .count = 1});
+    }
+    ++mCount;
+}
+
+void TimingHistogram::merge(const TimingHistogram& other) {
+    if (other.empty()) {
+        return;
+    }
+    if (empty()) {
+        *this = other;
+        return;
+    }
+    std::vector<Bucket> merged;
+    merged.reserve(std::min<size_t>(mBuckets.size() + other.mBuckets.size(), kBucketCount));
+    auto lhs = mBuckets.begin();
+    auto rhs = other.mBuckets.begin();
+    while (lhs != mBuckets.end() || rhs != other.mBuckets.end()) {
+        if (rhs == other.mBuckets.end() || (lhs != mBuckets.end() && lhs->index < rhs->index)) {
+            merged.push_back(*lhs++);
+        } else if (lhs == mBuckets.end() || rhs->index < lhs->index) {
+            merged.push_back(*rhs++);
+        } else {
+            merged.push_back({.index = lhs->index, .count = lhs->count + rhs->count});
+            ++lhs;
+            ++rhs;
+        }
+    }
+    mBuckets = std::move(merged);
+    mCount += other.mCount;
+}
+
+int64_t TimingHistogram::getQuantile(double quantile) const {
+    CHECK(!empty());
+    CHECK_GE(quantile, 0.0);
+    CHECK_LE(quantile, 1.0);
+
+    // Nearest-rank method: the estimate is the value of the ceil(quantile * count)-th smallest
+    // recorded value.
+    const int64_t rank =
+            std::max<int64_t>(1, static_cast<int64_t>(std::ceil(quantile * mCount)));
+    int64_t seen = 0;
+    for (const Bucket& bucket : mBuckets) {
+        seen += bucket.count;
+        if (seen >= rank) {
+            const int64_t lower = getBucketLowerBound(bucket.index);
+            const int64_t upper = getBucketUpperBound(bucket.index);
+            return lower + (upper - lower) / 2;
+        }
+    }
+    return getBucketUpperBound(mBuckets.back().index);
+}
+
+uint32_t TimingHistogram::getBucketIndex(int64_t value) {
+    CHECK_GE(value, 0);
+    if (value < static_cast<int64_t>(kSubBucketCount)) {
+        return static_cast<uint32_t>(value);
+    }
+    const uint32_t exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    const uint32_t shift = exponent - kSubBucketBits;
+    const uint32_t subBucket = static_cast<uint32_t>(value >> shift) & (kSubBucketCount - 1);
+    return (shift + 1) * kSubBucketCount + subBucket;
+}
+
+int64_t TimingHistogram::getBucketLowerBound(uint32_t index) {
+    CHECK_LT(index, kBucketCount);
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const uint32_t shift = index / kSubBucketCount - 1;
+    const uint64_t subBucket = index % kSubBucketCount;
+    return static_cast<int64_t>((kSubBucketCount + subBucket) << shift);
+}
+
+int64_t TimingHistogram::getBucketUpperBound(uint32_t index) {
+    CHECK_LT(index, kBucketCount);
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    const uint32_t shift = index / kSubBucketCount - 1;
+    return getBucketLowerBound(index) + static_cast<int64_t>((uint64_t{1} << shift) - 1);
+}
+
+bool operator==(const TimingHistogram& lhs, const TimingHistogram& rhs) {
+    const auto& lhsBuckets = lhs.getBuckets();
+    const auto& rhsBuckets = rhs.getBuckets();
+    return lhs.count() == rhs.count() &&
+           std::equal(lhsBuckets.begin(), lhsBuckets.end(), rhsBuckets.begin(), rhsBuckets.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.index == b.index && a.count == b.count;
+                      });
+}
+
+std::string toString(const TimingHistogram& histogram) {
+    std::ostringstream oss;
+    oss << "count=" << histogram.count();
+    if (!histogram.empty()) {
+        oss << " p50=" << histogram.getQuantile(0.50) << " p95=" << histogram.getQuantile(0.95)
+            << " p99=" << histogram.getQuantile(0.99);
+    }
+    return oss.str();
+}
+
+}  // namespace android::nn::telemetry
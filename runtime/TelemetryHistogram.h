@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_TELEMETRY_HISTOGRAM_H
+#define ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_TELEMETRY_HISTOGRAM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace android::nn::telemetry {
+
+// TimingHistogram records the distribution of non-negative timings, so that quantiles such as the
+// median or the 99th percentile can be estimated from aggregated telemetry. Histograms of the same
+// kind of timing can be merged without losing accuracy.
+//
+// Values below kSubBucketCount have a bucket each. Every larger power of two range [2^e, 2^(e+1))
+// is split into kSubBucketCount buckets of equal width. The width of a bucket is at most
+// 1/kSubBucketCount of its lower bound, so estimating a value by the middle of its bucket is within
+// 1/(2 * kSubBucketCount) = 6.25% of the recorded value. Only non-empty buckets are stored, and
+// there are at most kBucketCount of them regardless of how many values are recorded.
+class TimingHistogram {
+   public:
+    static constexpr uint32_t kSubBucketBits = 3;
+    static constexpr uint32_t kSubBucketCount = 1u << kSubBucketBits;
+    static constexpr uint32_t kBucketCount = (63 - kSubBucketBits + 1) * kSubBucketCount;
+
+    struct Bucket {
+        uint32_t index;
+        int64_t count;
+    };
+
+    // Precondition: value >= 0
+    void record(int64_t value);
+
+    void merge(const TimingHistogram& other);
+
+    bool empty() const { return mCount == 0; }
+    int64_t count() const { return mCount; }
+
+    // Returns the non-empty buckets, sorted by index.
+    const std::vector<Bucket>& getBuckets() const { return mBuckets; }
+
+    // Estimates the value below which the given fraction of the recorded values fall, e.g. 0.99
+    // for the 99th percentile.
+    // Precondition: !empty()
+    // Precondition: 0 <= quantile <= 1
+    int64_t getQuantile(double quantile) const;
+
+    // Precondition: value >= 0
+    static uint32_t getBucketIndex(int64_t value);
+
+    // Returns the smallest and the largest value of a bucket.
+    // Precondition: index < kBucketCount
+    static int64_t getBucketLowerBound(uint32_t index);
+    static int64_t getBucketUpperBound(uint32_t index);
+
+   private:
+    std::vector<Bucket> mBuckets;
+    int64_t mCount = 0;
+};
+
+bool operator==(const TimingHistogram& lhs, const TimingHistogram& rhs);
+
+// Returns a summary of the histogram for logging, e.g. "count=10 p50=4 p95=9 p99=10".
+std::string toString(const TimingHistogram& histogram);
+
+}  // namespace android::nn::telemetry
+
+#endif  // ANDROID_PACKAGES_MODULES_NEURALNETWORKS_RUNTIME_TELEMETRY_HISTOGRAM_H
@@ -67,13 +67,15 @@ AtomValue::AccumulatedTiming accumulatedTimingFrom(int64_t timing) {
     if (timing == kNoTimeReportedStatsd) {
         return {};
     }
-    return {
+    AtomValue::AccumulatedTiming accumulatedTiming = {
             .sumTime = timing,
             .minTime = timing,
             .maxTime = timing,
             .sumSquaredTime = timing * timing,
             .count = 1,
     };
+    accumulatedTiming.histogram.record(timing);
+    return accumulatedTiming;
 }
 
 void combineAccumulatedTiming(AtomValue::AccumulatedTiming* accumulatedTime,
@@ -86,6 +88,7 @@ void combineAccumulatedTiming(AtomValue::AccumulatedTiming* accumulatedTime,
     accumulatedTime->maxTime = std::max(accumulatedTime->maxTime, timing.maxTime);
     accumulatedTime->sumSquaredTime += timing.sumSquaredTime;
     accumulatedTime->count += timing.count;
+    accumulatedTime->histogram.merge(timing.histogram);
 }
 
 stats::BytesField makeBytesField(const ModelArchHash& modelArchHash) {
@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "Telemetry.h"
+#include "TelemetryHistogram.h"
 
 namespace android::nn::telemetry {
 
@@ -78,6 +79,7 @@ struct AtomValue {
     // * variance = sumSquaredTime / count - average * average
     // * standard deviation = sqrt(variance)
     // * sample standard deviation = sqrt(variance * count / (count - 1))
+    // * percentiles are estimated from histogram
     struct AccumulatedTiming {
         int64_t sumTime = kSumTimeDefault;
         int64_t minTime = kMinTimeDefault;
@@ -85,6 +87,7 @@ struct AtomValue {
         // Sum of each squared timing, e.g.: t1^2 + t2^2 + ... + tn^2
         int64_t sumSquaredTime = kSumTimeDefault;
         int32_t count = 0;
+        TimingHistogram histogram;
     };
     AccumulatedTiming compilationTimeMillis;
     AccumulatedTiming durationRuntimeMicros;
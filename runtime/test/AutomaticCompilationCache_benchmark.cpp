@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+#include "TmpDirectoryUtils.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+constexpr uint32_t kUnits = 256;
+
+// A chain of layerCount FULLY_CONNECTED layers of kUnits units, each with its own weights.
+void createModel(WrapperModel* model, uint32_t layerCount) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, kUnits});
+    WrapperOperandType weightsType(WrapperType::TENSOR_FLOAT32, {kUnits, kUnits});
+    WrapperOperandType biasType(WrapperType::TENSOR_FLOAT32, {kUnits});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const std::vector<float> weights(kUnits * kUnits, 0.01f);
+    const std::vector<float> bias(kUnits, 0.0f);
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    uint32_t previous = input;
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        const uint32_t weightsOperand = model->addOperand(&weightsType);
+        model->setOperandValue(weightsOperand, weights.data(), weights.size() * sizeof(float));
+        const uint32_t biasOperand = model->addOperand(&biasType);
+        model->setOperandValue(biasOperand, bias.data(), bias.size() * sizeof(float));
+        const uint32_t output = model->addOperand(&tensorType);
+        model->addOperation(ANEURALNETWORKS_FULLY_CONNECTED,
+                            {previous, weightsOperand, biasOperand, none}, {output});
+        previous = output;
+    }
+    model->identifyInputsAndOutputs({input}, {previous});
+    model->finish();
+}
+
+// Measures the compilation of the model on the CPU device. If state.range(1) is non-zero,
+// automatic compilation caching is enabled and the cache holds the model, so every compilation is
+// a warm start that prepares the model from the cache files.
+void BM_CompileOnCpu(benchmark::State& state) {
+    DeviceManager* manager = DeviceManager::get();
+    const bool wasCpuOnly = manager->getUseCpuOnly();
+    const std::string oldCacheDir = manager->getAutomaticCacheDir();
+    const uint64_t oldCacheMaxBytes = manager->getAutomaticCacheMaxBytes();
+    manager->setUseCpuOnly(true);
+
+    const bool warm = state.range(1) != 0;
+    std::string cacheDir;
+    if (warm) {
+        char cacheDirTemp[] = NN_TMP_DIR "/AutomaticCompilationCacheBenchmark-XXXXXX";
+        if (mkdtemp(cacheDirTemp) == nullptr) {
+            state.SkipWithError("unable to create the cache directory");
+            return;
+        }
+        cacheDir = cacheDirTemp;
+        manager->setAutomaticCaching(cacheDir, 1024 * 1024 * 1024);
+    }
+
+    WrapperModel model;
+    createModel(&model, state.range(0));
+    if (warm) {
+        // Populates the cache.
+        WrapperCompilation compilation(&model);
+        if (compilation.finish() != WrapperResult::NO_ERROR) {
+            state.SkipWithError("compilation failed");
+        }
+    }
+    for (auto _ : state) {
+        WrapperCompilation compilation(&model);
+        if (compilation.finish() != WrapperResult::NO_ERROR) {
+            state.SkipWithError("compilation failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    manager->setAutomaticCaching(oldCacheDir, oldCacheMaxBytes);
+    manager->setUseCpuOnly(wasCpuOnly);
+    if (warm) {
+        std::filesystem::remove_all(cacheDir);
+    }
+}
+BENCHMARK(BM_CompileOnCpu)->ArgNames({"layers", "warm"})->ArgsProduct({{4, 32}, {0, 1}});
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "TestNeuralNetworksWrapper.h"
+#include "TmpDirectoryUtils.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+constexpr std::string_view kCpuDeviceName = "nnapi-reference";
+constexpr std::string_view kXNNPACKDeviceName = "nnapi-sample_float_xnnpack";
+constexpr uint32_t kUnits = 256;
+
+// Values of the "cache" benchmark argument.
+enum class CacheMode { NONE = 0, COLD = 1, WARM = 2 };
+
+const ANeuralNetworksDevice* findDevice(std::string_view deviceName) {
+    uint32_t numDevices = 0;
+    if (ANeuralNetworks_getDeviceCount(&numDevices) != ANEURALNETWORKS_NO_ERROR) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < numDevices; ++i) {
+        ANeuralNetworksDevice* device = nullptr;
+        const char* name = nullptr;
+        if (ANeuralNetworks_getDevice(i, &device) == ANEURALNETWORKS_NO_ERROR &&
+            ANeuralNetworksDevice_getName(device, &name) == ANEURALNETWORKS_NO_ERROR &&
+            deviceName == name) {
+            return device;
+        }
+    }
+    return nullptr;
+}
+
+// A chain of layerCount FULLY_CONNECTED layers of kUnits units, each with its own weights.
+void createFullyConnectedModel(WrapperModel* model, uint32_t layerCount) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, kUnits});
+    WrapperOperandType weightsType(WrapperType::TENSOR_FLOAT32, {kUnits, kUnits});
+    WrapperOperandType biasType(WrapperType::TENSOR_FLOAT32, {kUnits});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const std::vector<float> weights(kUnits * kUnits, 0.01f);
+    const std::vector<float> bias(kUnits, 0.0f);
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    uint32_t previous = input;
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        const uint32_t weightsOperand = model->addOperand(&weightsType);
+        model->setOperandValue(weightsOperand, weights.data(), weights.size() * sizeof(float));
+        const uint32_t biasOperand = model->addOperand(&biasType);
+        model->setOperandValue(biasOperand, bias.data(), bias.size() * sizeof(float));
+        const uint32_t output = model->addOperand(&tensorType);
+        model->addOperation(ANEURALNETWORKS_FULLY_CONNECTED,
+                            {previous, weightsOperand, biasOperand, none}, {output});
+        previous = output;
+    }
+    model->identifyInputsAndOutputs({input}, {previous});
+    model->finish();
+}
+
+// A chain of layerCount BATCH_MATMUL layers of kUnits units, each with its own constant
+// right-hand side. The CPU device packs every right-hand side when it prepares the model.
+void createBatchMatmulModel(WrapperModel* model, uint32_t layerCount) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, kUnits});
+    WrapperOperandType weightsType(WrapperType::TENSOR_FLOAT32, {kUnits, kUnits});
+    WrapperOperandType boolType(WrapperType::BOOL, {});
+    const std::vector<float> weights(kUnits * kUnits, 0.01f);
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t adjoint = model->addConstantOperand(&boolType, false);
+    uint32_t previous = input;
+    for (uint32_t i = 0; i < layerCount; ++i) {
+        const uint32_t weightsOperand = model->addOperand(&weightsType);
+        model->setOperandValue(weightsOperand, weights.data(), weights.size() * sizeof(float));
+        const uint32_t output = model->addOperand(&tensorType);
+        model->addOperation(ANEURALNETWORKS_BATCH_MATMUL,
+                            {previous, weightsOperand, adjoint, adjoint}, {output});
+        previous = output;
+    }
+    model->identifyInputsAndOutputs({input}, {previous});
+    model->finish();
+}
+
+// Compiles the model for the device, with caching into cacheDir under token unless cacheDir is
+// empty.
+bool compile(const WrapperModel& model, const ANeuralNetworksDevice* device,
+             const std::string& cacheDir, const std::vector<uint8_t>& token) {
+    auto [result, compilation] = WrapperCompilation::createForDevice(&model, device);
+    if (result != WrapperResult::NO_ERROR) {
+        return false;
+    }
+    if (!cacheDir.empty() && compilation.setCaching(cacheDir, token) != WrapperResult::NO_ERROR) {
+        return false;
+    }
+    return compilation.finish() == WrapperResult::NO_ERROR;
+}
+
+// Measures the compilation of the model created by createModel on the device. With
+// CacheMode::NONE the compilation does not use caching. With CacheMode::COLD every compilation uses
+// a new token, so the device prepares the model and also writes the cache files. With
+// CacheMode::WARM the cache holds the model, so every compilation prepares it from the cache files.
+void benchmarkCompilation(benchmark::State& state, const ANeuralNetworksDevice* device,
+                          void (*createModel)(WrapperModel*, uint32_t)) {
+    const auto mode = static_cast<CacheMode>(state.range(1));
+    std::string cacheDir;
+    if (mode != CacheMode::NONE) {
+        char cacheDirTemp[] = NN_TMP_DIR "/CompilationCacheBenchmark-XXXXXX";
+        if (mkdtemp(cacheDirTemp) == nullptr) {
+            state.SkipWithError("unable to create the cache directory");
+            return;
+        }
+        cacheDir = cacheDirTemp;
+    }
+
+    WrapperModel model;
+    createModel(&model, state.range(0));
+    std::vector<uint8_t> token(ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN, 0);
+    uint64_t tokenCount = 0;
+    if (mode == CacheMode::WARM && !compile(model, device, cacheDir, token)) {
+        state.SkipWithError("compilation failed");
+    }
+    for (auto _ : state) {
+        if (mode == CacheMode::COLD) {
+            ++tokenCount;
+            for (size_t i = 0; i < sizeof(tokenCount); ++i) {
+                token[i] = static_cast<uint8_t>(tokenCount >> (8 * i));
+            }
+        }
+        if (!compile(model, device, cacheDir, token)) {
+            state.SkipWithError("compilation failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    if (mode != CacheMode::NONE) {
+        std::filesystem::remove_all(cacheDir);
+    }
+}
+
+// On the CPU device, a warm compilation maps the constants and the packed right-hand sides from
+// the data cache file, but still validates the model and recomputes its per-operation state.
+void BM_CompileOnCpu(benchmark::State& state) {
+    const ANeuralNetworksDevice* device = findDevice(kCpuDeviceName);
+    if (device == nullptr) {
+        state.SkipWithError("the CPU device is not available");
+        return;
+    }
+    benchmarkCompilation(state, device, createBatchMatmulModel);
+}
+BENCHMARK(BM_CompileOnCpu)->ArgNames({"layers", "cache"})->ArgsProduct({{4, 32}, {0, 1, 2}});
+
+// Runs against the XNNPACK sample driver service, and is skipped on devices that do not have it.
+void BM_CompileOnXNNPACK(benchmark::State& state) {
+    const ANeuralNetworksDevice* device = findDevice(kXNNPACKDeviceName);
+    if (device == nullptr) {
+        state.SkipWithError("the XNNPACK sample driver is not available");
+        return;
+    }
+    benchmarkCompilation(state, device, createFullyConnectedModel);
+}
+BENCHMARK(BM_CompileOnXNNPACK)->ArgNames({"layers", "cache"})->ArgsProduct({{4, 32}, {0, 1, 2}});
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
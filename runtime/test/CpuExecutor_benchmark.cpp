@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuExecutor.h>
+#include <CpuKernelTable.h>
+#include <CpuStaticShapes.h>
+#include <benchmark/benchmark.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperType = test_wrapper::Type;
+
+// Small enough that the time of an execution is spent dispatching the operations rather than
+// computing them.
+constexpr uint32_t kElementCount = 4;
+
+// A chain of ADDs of a constant to tensors of kElementCount elements.
+void createAddChainModel(WrapperModel* model, uint32_t operationCount) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {kElementCount});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    static const float kOne[kElementCount] = {1, 1, 1, 1};
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t one = model->addOperand(&tensorType);
+    model->setOperandValue(one, kOne, sizeof(kOne));
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    uint32_t previous = input;
+    for (uint32_t i = 0; i < operationCount; ++i) {
+        const uint32_t sum = model->addOperand(&tensorType);
+        model->addOperation(ANEURALNETWORKS_ADD, {previous, one, none}, {sum});
+        previous = sum;
+    }
+    model->identifyInputsAndOutputs({input}, {previous});
+    model->finish();
+}
+
+// A decoder-like loop that adds a constant to a state of kElementCount elements, once per step:
+//
+// i = 0
+// while i < steps:
+//     i = i + 1
+//     state = state + 1
+void createWhileLoopModel(WrapperModel* condition, WrapperModel* body, WrapperModel* model) {
+    WrapperOperandType counterType(WrapperType::TENSOR_FLOAT32, {1});
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {kElementCount});
+    WrapperOperandType boolType(WrapperType::TENSOR_BOOL8, {1});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    static const float kOne[kElementCount] = {1, 1, 1, 1};
+    {
+        const uint32_t i = condition->addOperand(&counterType);
+        const uint32_t state = condition->addOperand(&tensorType);
+        const uint32_t steps = condition->addOperand(&counterType);
+        const uint32_t out = condition->addOperand(&boolType);
+        condition->addOperation(ANEURALNETWORKS_LESS, {i, steps}, {out});
+        condition->identifyInputsAndOutputs({i, state, steps}, {out});
+        condition->finish();
+    }
+    {
+        const uint32_t i = body->addOperand(&counterType);
+        const uint32_t state = body->addOperand(&tensorType);
+        const uint32_t steps = body->addOperand(&counterType);
+        const uint32_t one = body->addConstantOperand(&counterType, 1.0f);
+        const uint32_t ones = body->addOperand(&tensorType);
+        body->setOperandValue(ones, kOne, sizeof(kOne));
+        const uint32_t none = body->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+        const uint32_t iOut = body->addOperand(&counterType);
+        const uint32_t stateOut = body->addOperand(&tensorType);
+        body->addOperation(ANEURALNETWORKS_ADD, {i, one, none}, {iOut});
+        body->addOperation(ANEURALNETWORKS_ADD, {state, ones, none}, {stateOut});
+        body->identifyInputsAndOutputs({i, state, steps}, {iOut, stateOut});
+        body->finish();
+    }
+    const uint32_t iInit = model->addConstantOperand(&counterType, 0.0f);
+    const uint32_t state = model->addOperand(&tensorType);
+    const uint32_t steps = model->addOperand(&counterType);
+    const uint32_t conditionOperand = model->addModelOperand(condition);
+    const uint32_t bodyOperand = model->addModelOperand(body);
+    const uint32_t iOut = model->addOperand(&counterType);
+    const uint32_t stateOut = model->addOperand(&tensorType);
+    model->addOperation(ANEURALNETWORKS_WHILE,
+                        {conditionOperand, bodyOperand, iInit, state, steps}, {iOut, stateOut});
+    model->identifyInputsAndOutputs({state, steps}, {iOut, stateOut});
+    model->finish();
+}
+
+Request::Argument makeArgument(std::variant<const void*, void*> pointer, uint32_t length) {
+    Request::Argument argument;
+    argument.lifetime = Request::Argument::LifeTime::POINTER;
+    argument.location.pointer = pointer;
+    argument.location.length = length;
+    return argument;
+}
+
+// Measures CpuExecutor::run() on a chain of state.range(0) ADDs, with the kernels and shapes
+// resolved when the model was prepared if state.range(1) is nonzero.
+void BM_AddChain(benchmark::State& state) {
+    WrapperModel wrapperModel;
+    createAddChainModel(&wrapperModel, state.range(0));
+    const Model model =
+            reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    std::vector<RunTimePoolInfo> modelPoolInfos;
+    if (!setRunTimePoolInfosFromCanonicalMemories(&modelPoolInfos, model.pools)) {
+        state.SkipWithError("failed to map the model pools");
+        return;
+    }
+    const bool prepared = state.range(1) != 0;
+    const auto kernelTable = prepared ? CpuKernelTable::create(model) : nullptr;
+    const auto staticShapes = prepared ? CpuStaticShapes::create(model, modelPoolInfos) : nullptr;
+
+    const std::vector<float> input(kElementCount, 0.5f);
+    std::vector<float> output(kElementCount);
+    Request request;
+    request.inputs = {makeArgument(input.data(), sizeof(float) * kElementCount)};
+    request.outputs = {makeArgument(output.data(), sizeof(float) * kElementCount)};
+    for (auto _ : state) {
+        CpuExecutor executor;
+        executor.setKernelTable(kernelTable);
+        executor.setStaticShapes(staticShapes);
+        if (executor.run(model, request, modelPoolInfos, {}) != ANEURALNETWORKS_NO_ERROR) {
+            state.SkipWithError("execution failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddChain)->ArgNames({"ops", "prepared"})->ArgsProduct({{16, 256}, {0, 1}});
+
+// Measures CpuExecutor::run() on a WHILE loop of state.range(0) steps, with the initial runtime
+// info of the subgraphs shared across executions like a prepared model does if state.range(1) is
+// nonzero, or recomputed by every execution otherwise.
+void BM_WhileLoop(benchmark::State& state) {
+    WrapperModel condition, body, wrapperModel;
+    createWhileLoopModel(&condition, &body, &wrapperModel);
+    const Model model =
+            reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    std::vector<RunTimePoolInfo> modelPoolInfos;
+    if (!setRunTimePoolInfosFromCanonicalMemories(&modelPoolInfos, model.pools)) {
+        state.SkipWithError("failed to map the model pools");
+        return;
+    }
+    const auto subgraphCache =
+            state.range(1) != 0 ? std::make_shared<CpuExecutorSubgraphCache>() : nullptr;
+
+    const std::vector<float> input(kElementCount, 0.5f);
+    const float steps = state.range(0);
+    float counter = 0.0f;
+    std::vector<float> output(kElementCount);
+    Request request;
+    request.inputs = {makeArgument(input.data(), sizeof(float) * kElementCount),
+                      makeArgument(&steps, sizeof(steps))};
+    request.outputs = {makeArgument(&counter, sizeof(counter)),
+                       makeArgument(output.data(), sizeof(float) * kElementCount)};
+    for (auto _ : state) {
+        CpuExecutor executor;
+        executor.setSubgraphCache(subgraphCache);
+        if (executor.run(model, request, modelPoolInfos, {}) != ANEURALNETWORKS_NO_ERROR) {
+            state.SkipWithError("execution failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_WhileLoop)->ArgNames({"steps", "shared"})->ArgsProduct({{1, 64}, {0, 1}});
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// The size of an activation map in the middle of MobileNet or EfficientNet.
+constexpr uint32_t kSize = 56;
+constexpr uint32_t kChannels = 32;
+constexpr uint32_t kElementCount = kSize * kSize * kChannels;
+
+uint32_t addConstantTensor(WrapperModel* model, const std::vector<uint32_t>& dimensions,
+                           const std::vector<float>& values) {
+    WrapperOperandType type(WrapperType::TENSOR_FLOAT32, dimensions);
+    const uint32_t operand = model->addOperand(&type);
+    model->setOperandValue(operand, values.data(), values.size() * sizeof(float));
+    return operand;
+}
+
+// A 1x1 CONV_2D followed by a batch normalization that was not folded into it, that is MUL and
+// ADD of per-channel constants, and RELU6, as in a MobileNet block.
+void createConvBlockModel(WrapperModel* model) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, kSize, kSize, kChannels});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t filter = addConstantTensor(model, {kChannels, 1, 1, kChannels},
+                                              std::vector<float>(kChannels * kChannels, 0.01f));
+    const uint32_t bias = addConstantTensor(model, {kChannels}, std::vector<float>(kChannels));
+    const uint32_t scale =
+            addConstantTensor(model, {kChannels}, std::vector<float>(kChannels, 1.5f));
+    const uint32_t shift =
+            addConstantTensor(model, {kChannels}, std::vector<float>(kChannels, -0.25f));
+    const uint32_t padding = model->addConstantOperand(&scalarType, ANEURALNETWORKS_PADDING_SAME);
+    const uint32_t stride = model->addConstantOperand(&scalarType, 1);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t conv = model->addOperand(&tensorType);
+    const uint32_t scaled = model->addOperand(&tensorType);
+    const uint32_t shifted = model->addOperand(&tensorType);
+    const uint32_t output = model->addOperand(&tensorType);
+    model->addOperation(ANEURALNETWORKS_CONV_2D,
+                        {input, filter, bias, padding, stride, stride, none}, {conv});
+    model->addOperation(ANEURALNETWORKS_MUL, {conv, scale, none}, {scaled});
+    model->addOperation(ANEURALNETWORKS_ADD, {scaled, shift, none}, {shifted});
+    model->addOperation(ANEURALNETWORKS_RELU6, {shifted}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    model->finish();
+}
+
+// LOGISTIC followed by MUL with its input, the swish activation of EfficientNet.
+void createSwishModel(WrapperModel* model) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, kSize, kSize, kChannels});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t gate = model->addOperand(&tensorType);
+    const uint32_t output = model->addOperand(&tensorType);
+    model->addOperation(ANEURALNETWORKS_LOGISTIC, {input}, {gate});
+    model->addOperation(ANEURALNETWORKS_MUL, {input, gate, none}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    model->finish();
+}
+
+// Measures executions of the model on the CPU device, with operation fusion enabled if the
+// argument is nonzero.
+void runModel(benchmark::State& state, const WrapperModel& model) {
+    DeviceManager* manager = DeviceManager::get();
+    const bool wasCpuOnly = manager->getUseCpuOnly();
+    const bool wasFusingCpuOperations = manager->fuseCpuOperations();
+    manager->setUseCpuOnly(true);
+    manager->setFuseCpuOperations(state.range(0) != 0);
+
+    WrapperCompilation compilation(&model);
+    if (compilation.finish() != WrapperResult::NO_ERROR) {
+        state.SkipWithError("compilation failed");
+    }
+    const std::vector<float> input(kElementCount, 0.5f);
+    std::vector<float> output(kElementCount);
+    for (auto _ : state) {
+        WrapperExecution execution(&compilation);
+        execution.setInput(0, input.data(), input.size() * sizeof(float));
+        execution.setOutput(0, output.data(), output.size() * sizeof(float));
+        if (execution.compute() != WrapperResult::NO_ERROR) {
+            state.SkipWithError("execution failed");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * kElementCount * sizeof(float));
+
+    manager->setFuseCpuOperations(wasFusingCpuOperations);
+    manager->setUseCpuOnly(wasCpuOnly);
+}
+
+void BM_ConvBlock(benchmark::State& state) {
+    WrapperModel model;
+    createConvBlockModel(&model);
+    runModel(state, model);
+}
+BENCHMARK(BM_ConvBlock)->ArgName("fused")->Arg(0)->Arg(1);
+
+void BM_Swish(benchmark::State& state) {
+    WrapperModel model;
+    createSwishModel(&model);
+    runModel(state, model);
+}
+BENCHMARK(BM_Swish)->ArgName("fused")->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
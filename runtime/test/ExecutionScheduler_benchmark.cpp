@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+// Load test of the scheduling of asynchronous executions. Each iteration starts a burst of
+// executions whose priorities are mixed, more than the scheduler has threads, and waits for all of
+// them. The counters report the latency of each priority and how many executions missed their
+// deadline.
+
+#include <PriorityThreadPool.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperEvent = test_wrapper::Event;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperExecutePriority = test_wrapper::ExecutePriority;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// A chain of ADDs over a tensor large enough that an execution takes a noticeable time on the CPU.
+constexpr uint32_t kElementCount = 64 * 1024;
+constexpr uint32_t kAddCount = 8;
+// Executions started by each iteration, for each priority.
+constexpr uint32_t kExecutionsPerPriority = 32;
+
+constexpr std::array<WrapperExecutePriority, 3> kPriorities = {
+        WrapperExecutePriority::LOW, WrapperExecutePriority::MEDIUM, WrapperExecutePriority::HIGH};
+constexpr std::array<const char*, 3> kPriorityNames = {"low", "medium", "high"};
+
+void createAddChainModel(WrapperModel* model) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {kElementCount});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    uint32_t last = input;
+    for (uint32_t i = 0; i < kAddCount; i++) {
+        const uint32_t output = model->addOperand(&tensorType);
+        model->addOperation(ANEURALNETWORKS_ADD, {last, input, none}, {output});
+        last = output;
+    }
+    model->identifyInputsAndOutputs({input}, {last});
+    model->finish();
+}
+
+// An execution of the burst, with its buffers.
+struct PendingExecution {
+    explicit PendingExecution(const WrapperCompilation* compilation)
+        : execution(compilation), input(kElementCount, 1.0f), output(kElementCount) {}
+
+    WrapperExecution execution;
+    WrapperEvent event;
+    std::vector<float> input;
+    std::vector<float> output;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+// Arguments: the timeout of each execution in milliseconds, or 0 for none.
+void BM_MixedPriorityBurst(benchmark::State& state) {
+    const uint64_t timeoutMs = state.range(0);
+
+    WrapperModel model;
+    createAddChainModel(&model);
+    const auto* cpuDevice =
+            reinterpret_cast<const ANeuralNetworksDevice*>(DeviceManager::getCpuDevice().get());
+    std::vector<WrapperCompilation> compilations;
+    for (const WrapperExecutePriority priority : kPriorities) {
+        auto [result, compilation] = WrapperCompilation::createForDevice(&model, cpuDevice);
+        if (result != WrapperResult::NO_ERROR ||
+            compilation.setPriority(priority) != WrapperResult::NO_ERROR ||
+            compilation.finish() != WrapperResult::NO_ERROR) {
+            state.SkipWithError("compilation failed");
+            return;
+        }
+        compilations.push_back(std::move(compilation));
+    }
+
+    PriorityThreadPool* scheduler = DeviceManager::get()->getAsyncExecutionScheduler();
+    const PriorityThreadPool::Stats statsBefore = scheduler->getStats();
+    std::array<double, 3> totalLatencyMs{};
+    std::array<double, 3> maxLatencyMs{};
+    std::array<uint64_t, 3> completedExecutions{};
+    uint64_t failedExecutions = 0;
+
+    for (auto _ : state) {
+        // Interleave the priorities, so that the order of submission does not favor any of them.
+        std::vector<std::unique_ptr<PendingExecution>> pending;
+        for (uint32_t i = 0; i < kExecutionsPerPriority * kPriorities.size(); i++) {
+            auto& entry = pending.emplace_back(
+                    std::make_unique<PendingExecution>(&compilations[i % kPriorities.size()]));
+            entry->execution.setInput(0, entry->input.data(), kElementCount * sizeof(float));
+            entry->execution.setOutput(0, entry->output.data(), kElementCount * sizeof(float));
+            if (timeoutMs > 0) {
+                ANeuralNetworksExecution_setTimeout(entry->execution.getHandle(),
+                                                    timeoutMs * 1'000'000);
+            }
+        }
+        for (size_t i = 0; i < pending.size(); i++) {
+            pending[i]->startTime = std::chrono::steady_clock::now();
+            if (pending[i]->execution.startCompute(&pending[i]->event) !=
+                WrapperResult::NO_ERROR) {
+                // The started executions write to the buffers of pending, so they must finish
+                // before it is destroyed.
+                for (size_t j = 0; j < i; j++) {
+                    pending[j]->event.wait();
+                }
+                state.SkipWithError("failed to start an execution");
+                return;
+            }
+        }
+
+        // One waiter for each priority, so that the latency of a priority is not inflated by
+        // waiting for the executions of another.
+        std::array<uint64_t, 3> failed{};
+        std::vector<std::thread> waiters;
+        for (size_t p = 0; p < kPriorities.size(); p++) {
+            waiters.emplace_back([&, p] {
+                for (size_t i = p; i < pending.size(); i += kPriorities.size()) {
+                    if (pending[i]->event.wait() != WrapperResult::NO_ERROR) {
+                        failed[p]++;
+                        continue;
+                    }
+                    const double latencyMs = std::chrono::duration<double, std::milli>(
+                                                     std::chrono::steady_clock::now() -
+                                                     pending[i]->startTime)
+                                                     .count();
+                    completedExecutions[p]++;
+                    totalLatencyMs[p] += latencyMs;
+                    maxLatencyMs[p] = std::max(maxLatencyMs[p], latencyMs);
+                }
+            });
+        }
+        for (auto& waiter : waiters) {
+            waiter.join();
+        }
+        for (const uint64_t count : failed) {
+            failedExecutions += count;
+        }
+    }
+
+    const PriorityThreadPool::Stats statsAfter = scheduler->getStats();
+    for (size_t p = 0; p < kPriorities.size(); p++) {
+        const std::string name = kPriorityNames[p];
+        state.counters[name + "_mean_ms"] =
+                completedExecutions[p] > 0 ? totalLatencyMs[p] / completedExecutions[p] : 0;
+        state.counters[name + "_max_ms"] = maxLatencyMs[p];
+    }
+    state.counters["failed"] = failedExecutions;
+    state.counters["dropped"] = statsAfter.droppedTasks - statsBefore.droppedTasks;
+    state.counters["late"] = statsAfter.lateTasks - statsBefore.lateTasks;
+    state.counters["max_queue_ms"] =
+            std::chrono::duration<double, std::milli>(statsAfter.maxQueueTime).count();
+}
+BENCHMARK(BM_MixedPriorityBurst)->Arg(0)->Arg(5)->Arg(50)->UseRealTime();
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ValidatedModelCache.h>
+#include <benchmark/benchmark.h>
+#include <nnapi/Types.h>
+#include <nnapi/Validation.h>
+
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// A chain of operationCount operations alternating between ADD and MUL of a constant, each with
+// its own constant, on [1, 8, 8, 16] tensors.
+void createLargeModel(WrapperModel* model, uint32_t operationCount) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, 8, 8, 16});
+    WrapperOperandType constantType(WrapperType::TENSOR_FLOAT32, {16});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const std::vector<float> values(16, 1.0f);
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    uint32_t previous = input;
+    for (uint32_t i = 0; i < operationCount; ++i) {
+        const uint32_t constant = model->addOperand(&constantType);
+        model->setOperandValue(constant, values.data(), values.size() * sizeof(float));
+        const uint32_t result = model->addOperand(&tensorType);
+        model->addOperation(i % 2 == 0 ? ANEURALNETWORKS_ADD : ANEURALNETWORKS_MUL,
+                            {previous, constant, none}, {result});
+        previous = result;
+    }
+    model->identifyInputsAndOutputs({input}, {previous});
+    model->finish();
+}
+
+Model makeModel(const WrapperModel& model) {
+    return reinterpret_cast<const ModelBuilder*>(model.getHandle())->makeModel();
+}
+
+// Measures the full validation of the model.
+void BM_Validate(benchmark::State& state) {
+    WrapperModel wrapperModel;
+    createLargeModel(&wrapperModel, state.range(0));
+    const Model model = makeModel(wrapperModel);
+    for (auto _ : state) {
+        if (!validate(model).ok()) {
+            state.SkipWithError("validation failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Validate)->ArgName("ops")->Arg(256)->Arg(4096);
+
+// Measures the validation of a copy of a model that was already validated, as done by each stage
+// of a compilation after the first.
+void BM_ValidateCached(benchmark::State& state) {
+    WrapperModel wrapperModel;
+    createLargeModel(&wrapperModel, state.range(0));
+    const Model model = makeModel(wrapperModel);
+    ValidatedModelCache cache;
+    if (!cache.validate(model).ok()) {
+        state.SkipWithError("validation failed");
+    }
+    for (auto _ : state) {
+        if (!cache.validate(model).ok()) {
+            state.SkipWithError("validation failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ValidateCached)->ArgName("ops")->Arg(256)->Arg(4096);
+
+// Measures the compilation of the model on the CPU device. If state.range(1) is zero, the
+// validated models are forgotten before every compilation.
+void BM_CompileOnCpu(benchmark::State& state) {
+    DeviceManager* manager = DeviceManager::get();
+    const bool wasCpuOnly = manager->getUseCpuOnly();
+    manager->setUseCpuOnly(true);
+
+    WrapperModel model;
+    createLargeModel(&model, state.range(0));
+    const bool memoized = state.range(1) != 0;
+    for (auto _ : state) {
+        if (!memoized) {
+            state.PauseTiming();
+            ValidatedModelCache::get()->clear();
+            state.ResumeTiming();
+        }
+        WrapperCompilation compilation(&model);
+        if (compilation.finish() != WrapperResult::NO_ERROR) {
+            state.SkipWithError("compilation failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+
+    manager->setUseCpuOnly(wasCpuOnly);
+}
+BENCHMARK(BM_CompileOnCpu)
+        ->ArgNames({"ops", "memoized"})
+        ->ArgsProduct({{256, 4096}, {0, 1}});
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CanonicalDevice.h>
+#include <benchmark/benchmark.h>
+#include <nnapi/IExecution.h>
+#include <nnapi/IPreparedModel.h>
+#include <nnapi/SharedMemory.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <vector>
+
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperType = test_wrapper::Type;
+
+// A single ADD of two elements, so that the time of an execution is spent in its overhead.
+constexpr uint32_t kElementCount = 2;
+constexpr uint32_t kTensorSize = kElementCount * sizeof(float);
+
+void createTrivialModel(WrapperModel* model) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {kElementCount});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t bias = model->addOperand(&tensorType);
+    const float kBias[kElementCount] = {1, 2};
+    model->setOperandValue(bias, kBias, sizeof(kBias));
+    const uint32_t none = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = model->addOperand(&tensorType);
+    model->addOperation(ANEURALNETWORKS_ADD, {input, bias, none}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    model->finish();
+}
+
+Request::Argument makeArgument(uint32_t offset) {
+    Request::Argument argument;
+    argument.lifetime = Request::Argument::LifeTime::POOL;
+    argument.location.poolIndex = 0;
+    argument.location.offset = offset;
+    argument.location.length = kTensorSize;
+    return argument;
+}
+
+// Prepares the trivial model on the sample driver, and a request whose input and output are in
+// one shared memory pool. Returns nullptr on failure.
+SharedPreparedModel prepareTrivialModel(Request* request) {
+    WrapperModel wrapperModel;
+    createTrivialModel(&wrapperModel);
+    const Model model =
+            reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    const sample::Device device("sample-benchmark");
+    auto preparedModel = device.prepareModel(model, ExecutionPreference::FAST_SINGLE_ANSWER,
+                                             Priority::MEDIUM, {}, {}, {}, {}, {}, {});
+    auto memory = createSharedMemory(2 * kTensorSize);
+    if (!preparedModel.ok() || !memory.ok()) {
+        return nullptr;
+    }
+    request->inputs = {makeArgument(0)};
+    request->outputs = {makeArgument(kTensorSize)};
+    request->pools = {std::move(memory).value()};
+    return std::move(preparedModel).value();
+}
+
+// Measures IPreparedModel::execute(), which validates the request and maps its pools every time.
+void BM_Execute(benchmark::State& state) {
+    Request request;
+    const SharedPreparedModel preparedModel = prepareTrivialModel(&request);
+    if (preparedModel == nullptr) {
+        state.SkipWithError("preparation failed");
+        return;
+    }
+    for (auto _ : state) {
+        if (!preparedModel->execute(request, MeasureTiming::NO, {}, {}, {}, {}).ok()) {
+            state.SkipWithError("execution failed");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_Execute);
+
+// Measures IExecution::compute() of a reusable execution, which validated the request and mapped
+// its pools when it was created.
+void BM_ReusableCompute(benchmark::State& state) {
+    Request request;
+    const SharedPreparedModel preparedModel = prepareTrivialModel(&request);
+    if (preparedModel == nullptr) {
+        state.SkipWithError("preparation failed");
+        return;
+    }
+    const auto execution =
+            preparedModel->createReusableExecution(request, MeasureTiming::NO, {}, {}, {});
+    if (!execution.ok()) {
+        state.SkipWithError("creation of the reusable execution failed");
+        return;
+    }
+    for (auto _ : state) {
+        if (!execution.value()->compute({}).ok()) {
+            state.SkipWithError("execution failed");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_ReusableCompute);
+
+}  // namespace
+}  // namespace android::nn
+
+BENCHMARK_MAIN();
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "AutomaticCompilationCache.h"
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+#include "TmpDirectoryUtils.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+constexpr uint64_t kEntryBytes = 100;
+
+class AutomaticCompilationCacheTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char cacheDirTemp[] = NN_TMP_DIR "/AutomaticCompilationCacheTest-XXXXXX";
+        char* cacheDir = mkdtemp(cacheDirTemp);
+        ASSERT_NE(cacheDir, nullptr);
+        mCacheDir = std::string(cacheDir) + "/";
+
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        mOldCacheDir = manager->getAutomaticCacheDir();
+        mOldCacheMaxBytes = manager->getAutomaticCacheMaxBytes();
+        manager->setUseCpuOnly(true);
+    }
+
+    void TearDown() override {
+        DeviceManager* manager = DeviceManager::get();
+        manager->setUseCpuOnly(mWasCpuOnly);
+        manager->setAutomaticCaching(mOldCacheDir, mOldCacheMaxBytes);
+        if (!::testing::Test::HasFailure()) {
+            std::filesystem::remove_all(mCacheDir);
+        }
+    }
+
+    // Creates the model output = input + addend, where addend is a constant.
+    static void createModel(float addend, WrapperModel* model, bool relaxed = false) {
+        WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1});
+        WrapperOperandType scalarType(WrapperType::INT32, {});
+        const float addendValue[] = {addend};
+        const int32_t activation = ANEURALNETWORKS_FUSED_NONE;
+        uint32_t input = model->addOperand(&tensorType);
+        uint32_t constant = model->addOperand(&tensorType);
+        uint32_t act = model->addOperand(&scalarType);
+        uint32_t output = model->addOperand(&tensorType);
+        model->setOperandValue(constant, addendValue, sizeof(addendValue));
+        model->setOperandValue(act, &activation, sizeof(activation));
+        model->addOperation(ANEURALNETWORKS_ADD, {input, constant, act}, {output});
+        model->identifyInputsAndOutputs({input}, {output});
+        model->relaxComputationFloat32toFloat16(relaxed);
+        ASSERT_TRUE(model->isValid());
+        ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+    }
+
+    static std::optional<CacheToken> makeToken(const WrapperModel& model) {
+        return AutomaticCompilationCache::makeToken(
+                *reinterpret_cast<const ModelBuilder*>(model.getHandle()));
+    }
+
+    static CacheToken makeTestToken(uint8_t value) {
+        CacheToken token;
+        token.fill(value);
+        return token;
+    }
+
+    static std::string toEntryName(const CacheToken& token) {
+        std::ostringstream name;
+        for (uint8_t byte : token) {
+            name << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+        }
+        return name.str();
+    }
+
+    // Acquires the entry of the token, fills it with kEntryBytes of cache files and marks it as
+    // last used at the given time.
+    std::string fillEntry(const CacheToken& token, std::filesystem::file_time_type lastUsed) {
+        std::optional<std::string> entryDir =
+                AutomaticCompilationCache::get()->acquireEntry(mCacheDir, token);
+        EXPECT_TRUE(entryDir.has_value());
+        if (!entryDir.has_value()) {
+            return "";
+        }
+        std::ofstream(*entryDir + "cache") << std::string(kEntryBytes, 'x');
+        std::filesystem::last_write_time(*entryDir, lastUsed);
+        return *entryDir;
+    }
+
+    bool entryExists(const CacheToken& token) const {
+        return std::filesystem::exists(mCacheDir + toEntryName(token));
+    }
+
+    std::string mCacheDir;
+
+   private:
+    bool mWasCpuOnly = false;
+    std::string mOldCacheDir;
+    uint64_t mOldCacheMaxBytes = 0;
+};
+
+TEST_F(AutomaticCompilationCacheTest, TokenDependsOnContent) {
+    WrapperModel model1, model2, model3;
+    createModel(1.0f, &model1);
+    createModel(1.0f, &model2);
+    createModel(2.0f, &model3);
+
+    const auto token1 = makeToken(model1);
+    const auto token2 = makeToken(model2);
+    const auto token3 = makeToken(model3);
+    ASSERT_TRUE(token1.has_value());
+    ASSERT_TRUE(token2.has_value());
+    ASSERT_TRUE(token3.has_value());
+    EXPECT_EQ(*token1, *token2);
+    EXPECT_NE(*token1, *token3);
+}
+
+TEST_F(AutomaticCompilationCacheTest, TokenDependsOnRelaxedComputation) {
+    WrapperModel model, relaxedModel;
+    createModel(1.0f, &model);
+    createModel(1.0f, &relaxedModel, /*relaxed=*/true);
+
+    const auto token = makeToken(model);
+    const auto relaxedToken = makeToken(relaxedModel);
+    ASSERT_TRUE(token.has_value());
+    ASSERT_TRUE(relaxedToken.has_value());
+    EXPECT_NE(*token, *relaxedToken);
+}
+
+TEST_F(AutomaticCompilationCacheTest, CompilationUsesContentToken) {
+    // The budget leaves room for the cache files written by the CPU device.
+    DeviceManager::get()->setAutomaticCaching(mCacheDir, 1024 * 1024);
+
+    WrapperModel model;
+    createModel(1.0f, &model);
+    const auto token = makeToken(model);
+    ASSERT_TRUE(token.has_value());
+
+    WrapperCompilation compilation(&model);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    EXPECT_TRUE(entryExists(*token));
+}
+
+TEST_F(AutomaticCompilationCacheTest, EvictsLeastRecentlyUsedEntries) {
+    AutomaticCompilationCache* cache = AutomaticCompilationCache::get();
+    const auto now = std::filesystem::file_time_type::clock::now();
+    const CacheToken oldest = makeTestToken(1);
+    const CacheToken middle = makeTestToken(2);
+    const CacheToken newest = makeTestToken(3);
+
+    const std::string oldestDir = fillEntry(oldest, now - std::chrono::hours(2));
+    cache->releaseEntry(mCacheDir, oldestDir, 3 * kEntryBytes);
+    const std::string middleDir = fillEntry(middle, now - std::chrono::hours(1));
+    cache->releaseEntry(mCacheDir, middleDir, 3 * kEntryBytes);
+    const std::string newestDir = fillEntry(newest, now);
+    cache->releaseEntry(mCacheDir, newestDir, 3 * kEntryBytes);
+    EXPECT_TRUE(entryExists(oldest));
+    EXPECT_TRUE(entryExists(middle));
+    EXPECT_TRUE(entryExists(newest));
+
+    // Using the oldest entry again makes the middle entry the least recently used.
+    const auto oldestAgain = cache->acquireEntry(mCacheDir, oldest);
+    ASSERT_TRUE(oldestAgain.has_value());
+    cache->releaseEntry(mCacheDir, *oldestAgain, 2 * kEntryBytes);
+    EXPECT_TRUE(entryExists(oldest));
+    EXPECT_FALSE(entryExists(middle));
+    EXPECT_TRUE(entryExists(newest));
+}
+
+TEST_F(AutomaticCompilationCacheTest, CountsEntriesAddedByOtherProcesses) {
+    AutomaticCompilationCache* cache = AutomaticCompilationCache::get();
+    const auto now = std::filesystem::file_time_type::clock::now();
+    const CacheToken oldest = makeTestToken(1);
+    const CacheToken external = makeTestToken(2);
+    const CacheToken newest = makeTestToken(3);
+
+    const std::string oldestDir = fillEntry(oldest, now - std::chrono::hours(2));
+    cache->releaseEntry(mCacheDir, oldestDir, 3 * kEntryBytes);
+
+    // Another process adds an entry, which the cache of this process has not seen being created.
+    const std::string externalDir = mCacheDir + toEntryName(external) + "/";
+    ASSERT_TRUE(std::filesystem::create_directory(externalDir));
+    std::ofstream(externalDir + "cache") << std::string(kEntryBytes, 'x');
+    std::filesystem::last_write_time(externalDir, now - std::chrono::hours(1));
+
+    // The external entry counts towards the budget, so the oldest entry is removed.
+    const std::string newestDir = fillEntry(newest, now);
+    cache->releaseEntry(mCacheDir, newestDir, 2 * kEntryBytes);
+    EXPECT_FALSE(entryExists(oldest));
+    EXPECT_TRUE(entryExists(external));
+    EXPECT_TRUE(entryExists(newest));
+}
+
+TEST_F(AutomaticCompilationCacheTest, DoesNotEvictEntriesInUse) {
+    AutomaticCompilationCache* cache = AutomaticCompilationCache::get();
+    const auto now = std::filesystem::file_time_type::clock::now();
+    const CacheToken inUse = makeTestToken(1), released = makeTestToken(2);
+
+    const std::string inUseDir = fillEntry(inUse, now - std::chrono::hours(1));
+    const std::string releasedDir = fillEntry(released, now);
+    cache->releaseEntry(mCacheDir, releasedDir, 0);
+    EXPECT_TRUE(entryExists(inUse));
+    EXPECT_FALSE(entryExists(released));
+
+    cache->releaseEntry(mCacheDir, inUseDir, 0);
+    EXPECT_FALSE(entryExists(inUse));
+}
+
+}  // namespace
+}  // namespace android::nn
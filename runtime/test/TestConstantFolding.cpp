@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ConstantFolding.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+#include <nnapi/Validation.h>
+
+#include <utility>
+#include <vector>
+
+#include "GeneratedTestUtils.h"
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn::constant_folding_test {
+
+using namespace test_helper;
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperResult = test_wrapper::Result;
+
+// Turns the model inputs into constants, so that every operation that does not write a model
+// output can be folded. Omitted inputs remain inputs.
+TestModel convertInputsToConstants(const TestModel& testModel) {
+    TestModel converted(testModel.copy());
+    std::vector<uint32_t> inputIndexes;
+    for (uint32_t index : converted.main.inputIndexes) {
+        TestOperand& operand = converted.main.operands[index];
+        if (operand.data.size() > 0) {
+            operand.lifetime = TestOperandLifeTime::CONSTANT_COPY;
+        } else {
+            inputIndexes.push_back(index);
+        }
+    }
+    converted.main.inputIndexes = std::move(inputIndexes);
+    return converted;
+}
+
+// Tag for the constant folding tests, which run the generated models on the CPU with constant
+// folding enabled.
+class GeneratedConstantFoldingTest : public generated_tests::GeneratedTestBase {
+   protected:
+    void SetUp() override {
+        GeneratedTestBase::SetUp();
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        mWasFoldingCpuConstants = manager->foldCpuConstants();
+        manager->setUseCpuOnly(true);
+        manager->setFoldCpuConstants(true);
+    }
+
+    void TearDown() override {
+        DeviceManager* manager = DeviceManager::get();
+        manager->setFoldCpuConstants(mWasFoldingCpuConstants);
+        manager->setUseCpuOnly(mWasCpuOnly);
+        GeneratedTestBase::TearDown();
+    }
+
+    // Verifies that folding keeps the canonical model valid with the same inputs and outputs,
+    // and that the folded model computes the expected results.
+    static void execute(const TestModel& testModel) {
+        generated_tests::GeneratedModel wrapperModel;
+        generated_tests::createModel(testModel, &wrapperModel);
+        ASSERT_TRUE(wrapperModel.isValid());
+        ASSERT_EQ(wrapperModel.finish(), WrapperResult::NO_ERROR);
+
+        Model model =
+                reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+        const auto inputCount = model.main.inputIndexes.size();
+        const auto outputCount = model.main.outputIndexes.size();
+        foldConstantOperations(&model);
+        const auto validation = validate(model);
+        ASSERT_TRUE(validation.ok()) << validation.error();
+        EXPECT_EQ(model.main.inputIndexes.size(), inputCount);
+        EXPECT_EQ(model.main.outputIndexes.size(), outputCount);
+
+        WrapperCompilation compilation(&wrapperModel);
+        ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+        WrapperExecution execution(&compilation);
+        std::vector<TestBuffer> outputs;
+        generated_tests::createRequest(testModel, &execution, &outputs);
+        ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        checkResults(testModel, outputs);
+    }
+
+   private:
+    bool mWasCpuOnly = false;
+    bool mWasFoldingCpuConstants = false;
+};
+
+TEST_P(GeneratedConstantFoldingTest, Test) {
+    execute(testModel);
+}
+
+TEST_P(GeneratedConstantFoldingTest, ConstantInputs) {
+    execute(convertInputsToConstants(testModel));
+}
+
+INSTANTIATE_GENERATED_TEST(GeneratedConstantFoldingTest,
+                           [](const TestModel& testModel) { return !testModel.expectFailure; });
+
+}  // namespace android::nn::constant_folding_test
@@ -20,6 +20,10 @@
 #include <android-base/logging.h>
 #include <gtest/gtest.h>
 
+#include <memory>
+#include <tuple>
+#include <vector>
+
 #include "TestNeuralNetworksWrapper.h"
 
 namespace android::nn {
@@ -102,6 +106,267 @@ TEST_F(ControlFlowTest, InfiniteLoop) {
             << "result = " << static_cast<int>(result);
 }
 
+// Model: the body output has an unknown shape, and its size changes on every iteration.
+//
+// i = 0
+// length = initialLength
+// prefix = values
+// while i < n:
+//     i = i + 1
+//     length = length + step
+//     prefix = values[0:length]
+class ResizingLoopTest : public ControlFlowTest {
+   protected:
+    static constexpr uint32_t kValueCount = 6;
+
+    void SetUp() override {
+        OperandType int32Type(Type::TENSOR_INT32, {1});
+        OperandType boolType(Type::TENSOR_BOOL8, {1});
+        OperandType activationType(Type::INT32, {});
+        OperandType valuesType(Type::TENSOR_FLOAT32, {kValueCount});
+        OperandType prefixType(Type::TENSOR_FLOAT32, {0});
+
+        {
+            uint32_t i = mConditionModel.addOperand(&int32Type);
+            uint32_t length = mConditionModel.addOperand(&int32Type);
+            uint32_t prefix = mConditionModel.addOperand(&prefixType);
+            uint32_t n = mConditionModel.addOperand(&int32Type);
+            uint32_t step = mConditionModel.addOperand(&int32Type);
+            uint32_t values = mConditionModel.addOperand(&valuesType);
+            uint32_t out = mConditionModel.addOperand(&boolType);
+            mConditionModel.addOperation(ANEURALNETWORKS_LESS, {i, n}, {out});
+            mConditionModel.identifyInputsAndOutputs({i, length, prefix, n, step, values}, {out});
+            ASSERT_EQ(mConditionModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mConditionModel.isValid());
+        }
+        {
+            uint32_t i = mBodyModel.addOperand(&int32Type);
+            uint32_t length = mBodyModel.addOperand(&int32Type);
+            uint32_t prefix = mBodyModel.addOperand(&prefixType);
+            uint32_t n = mBodyModel.addOperand(&int32Type);
+            uint32_t step = mBodyModel.addOperand(&int32Type);
+            uint32_t values = mBodyModel.addOperand(&valuesType);
+            uint32_t one = mBodyModel.addConstantOperand(&int32Type, 1);
+            uint32_t begin = mBodyModel.addConstantOperand(&int32Type, 0);
+            uint32_t noActivation = mBodyModel.addConstantOperand(&activationType, kNoActivation);
+            uint32_t iOut = mBodyModel.addOperand(&int32Type);
+            uint32_t lengthOut = mBodyModel.addOperand(&int32Type);
+            uint32_t prefixOut = mBodyModel.addOperand(&prefixType);
+            mBodyModel.addOperation(ANEURALNETWORKS_ADD, {i, one, noActivation}, {iOut});
+            mBodyModel.addOperation(ANEURALNETWORKS_ADD, {length, step, noActivation},
+                                    {lengthOut});
+            mBodyModel.addOperation(ANEURALNETWORKS_SLICE, {values, begin, lengthOut},
+                                    {prefixOut});
+            mBodyModel.identifyInputsAndOutputs({i, length, prefix, n, step, values},
+                                                {iOut, lengthOut, prefixOut});
+            ASSERT_EQ(mBodyModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mBodyModel.isValid());
+        }
+
+        uint32_t iInit = mModel.addConstantOperand(&int32Type, 0);
+        uint32_t initialLength = mModel.addOperand(&int32Type);
+        uint32_t n = mModel.addOperand(&int32Type);
+        uint32_t step = mModel.addOperand(&int32Type);
+        uint32_t values = mModel.addOperand(&valuesType);
+        uint32_t conditionOperand = mModel.addModelOperand(&mConditionModel);
+        uint32_t bodyOperand = mModel.addModelOperand(&mBodyModel);
+        uint32_t iOut = mModel.addOperand(&int32Type);
+        uint32_t lengthOut = mModel.addOperand(&int32Type);
+        uint32_t prefixOut = mModel.addOperand(&prefixType);
+        mModel.addOperation(ANEURALNETWORKS_WHILE,
+                            {conditionOperand, bodyOperand, iInit, initialLength, values, n, step,
+                             values},
+                            {iOut, lengthOut, prefixOut});
+        mModel.identifyInputsAndOutputs({initialLength, n, step, values}, {prefixOut});
+        ASSERT_EQ(mModel.finish(), Result::NO_ERROR);
+        ASSERT_TRUE(mModel.isValid());
+
+        mCompilation = std::make_unique<Compilation>(&mModel);
+        ASSERT_EQ(mCompilation->finish(), Result::NO_ERROR);
+    }
+
+    // Runs the loop and returns the final prefix of kValues.
+    std::vector<float> run(int32_t initialLength, int32_t n, int32_t step) {
+        std::vector<float> output(kValueCount);
+        Execution execution(mCompilation.get());
+        EXPECT_EQ(execution.setInput(0, &initialLength), Result::NO_ERROR);
+        EXPECT_EQ(execution.setInput(1, &n), Result::NO_ERROR);
+        EXPECT_EQ(execution.setInput(2, &step), Result::NO_ERROR);
+        EXPECT_EQ(execution.setInput(3, kValues, sizeof(kValues)), Result::NO_ERROR);
+        EXPECT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  Result::NO_ERROR);
+        EXPECT_EQ(execution.compute(), Result::NO_ERROR);
+        std::vector<uint32_t> dimensions;
+        EXPECT_EQ(execution.getOutputOperandDimensions(0, &dimensions), Result::NO_ERROR);
+        EXPECT_EQ(dimensions.size(), 1u);
+        output.resize(dimensions.empty() ? 0 : dimensions[0]);
+        return output;
+    }
+
+    static constexpr float kValues[kValueCount] = {1, 2, 3, 4, 5, 6};
+
+    Model mConditionModel;
+    Model mBodyModel;
+    Model mModel;
+    std::unique_ptr<Compilation> mCompilation;
+};
+
+TEST_F(ResizingLoopTest, BodyOutputGrows) {
+    // The prefix grows from 2 to 6 elements, beyond the capacity of the first iteration.
+    EXPECT_EQ(run(/*initialLength=*/0, /*n=*/3, /*step=*/2),
+              (std::vector<float>{1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(run(/*initialLength=*/1, /*n=*/1, /*step=*/1), (std::vector<float>{1, 2}));
+}
+
+TEST_F(ResizingLoopTest, BodyOutputShrinks) {
+    // The prefix shrinks from 5 to 1 element within the capacity of the first iteration.
+    EXPECT_EQ(run(/*initialLength=*/6, /*n=*/5, /*step=*/-1), (std::vector<float>{1}));
+}
+
+TEST_F(ResizingLoopTest, BodyOutputBecomesZeroSized) {
+    EXPECT_EQ(run(/*initialLength=*/6, /*n=*/3, /*step=*/-2), std::vector<float>{});
+    // The prefix is zero-sized after the first iteration, and grows again in the second one.
+    EXPECT_EQ(run(/*initialLength=*/-3, /*n=*/2, /*step=*/3), (std::vector<float>{1, 2, 3}));
+}
+
+TEST_F(ResizingLoopTest, ZeroIterations) {
+    // The dynamic output takes the shape of the initial value.
+    EXPECT_EQ(run(/*initialLength=*/1, /*n=*/0, /*step=*/1),
+              (std::vector<float>{1, 2, 3, 4, 5, 6}));
+}
+
+// Runs a loop whose body output grows by one row on every iteration, and is produced by an
+// operation that supports both the NHWC and the NCHW layout. The parameters are the operation
+// type and whether it uses the NCHW layout.
+class LayoutResizingLoopTest
+    : public ::testing::TestWithParam<std::tuple<ANeuralNetworksOperationType, bool>> {
+   protected:
+    void SetUp() override {
+        OperandType int32Type(Type::TENSOR_INT32, {1});
+        OperandType boolType(Type::TENSOR_BOOL8, {1});
+        OperandType tensorType(Type::TENSOR_FLOAT32, {0, 0, 0, 0});
+        OperandType inputType(Type::TENSOR_FLOAT32, {1, 1, 1, 1});
+
+        {
+            uint32_t i = mConditionModel.addOperand(&int32Type);
+            uint32_t x = mConditionModel.addOperand(&tensorType);
+            uint32_t n = mConditionModel.addOperand(&int32Type);
+            uint32_t out = mConditionModel.addOperand(&boolType);
+            mConditionModel.addOperation(ANEURALNETWORKS_LESS, {i, n}, {out});
+            mConditionModel.identifyInputsAndOutputs({i, x, n}, {out});
+            ASSERT_EQ(mConditionModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mConditionModel.isValid());
+        }
+        {
+            OperandType activationType(Type::INT32, {});
+            uint32_t i = mBodyModel.addOperand(&int32Type);
+            uint32_t x = mBodyModel.addOperand(&tensorType);
+            uint32_t n = mBodyModel.addOperand(&int32Type);
+            uint32_t one = mBodyModel.addConstantOperand(&int32Type, 1);
+            uint32_t noActivation = mBodyModel.addConstantOperand(&activationType, kNoActivation);
+            uint32_t iOut = mBodyModel.addOperand(&int32Type);
+            uint32_t xOut = mBodyModel.addOperand(&tensorType);
+            mBodyModel.addOperation(ANEURALNETWORKS_ADD, {i, one, noActivation}, {iOut});
+            addPaddingOperation(x, xOut);
+            mBodyModel.identifyInputsAndOutputs({i, x, n}, {iOut, xOut});
+            ASSERT_EQ(mBodyModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mBodyModel.isValid());
+        }
+
+        uint32_t iInit = mModel.addConstantOperand(&int32Type, 0);
+        uint32_t x = mModel.addOperand(&inputType);
+        uint32_t n = mModel.addOperand(&int32Type);
+        uint32_t conditionOperand = mModel.addModelOperand(&mConditionModel);
+        uint32_t bodyOperand = mModel.addModelOperand(&mBodyModel);
+        uint32_t iOut = mModel.addOperand(&int32Type);
+        uint32_t xOut = mModel.addOperand(&tensorType);
+        mModel.addOperation(ANEURALNETWORKS_WHILE, {conditionOperand, bodyOperand, iInit, x, n},
+                            {iOut, xOut});
+        mModel.identifyInputsAndOutputs({x, n}, {xOut});
+        ASSERT_EQ(mModel.finish(), Result::NO_ERROR);
+        ASSERT_TRUE(mModel.isValid());
+
+        mCompilation = std::make_unique<Compilation>(&mModel);
+        ASSERT_EQ(mCompilation->finish(), Result::NO_ERROR);
+    }
+
+    // Adds an operation that appends a row of zeros to the height of x.
+    void addPaddingOperation(uint32_t x, uint32_t xOut) {
+        const auto [operationType, useNchw] = GetParam();
+        OperandType scalarType(Type::INT32, {});
+        OperandType layoutType(Type::BOOL, {});
+        OperandType filterType(Type::TENSOR_FLOAT32, {1, 1, 1, 1});
+        OperandType biasType(Type::TENSOR_FLOAT32, {1});
+        const uint32_t layout = mBodyModel.addConstantOperand(&layoutType, useNchw);
+        if (operationType == ANEURALNETWORKS_SPACE_TO_BATCH_ND) {
+            OperandType blockShapeType(Type::TENSOR_INT32, {2});
+            OperandType paddingsType(Type::TENSOR_INT32, {2, 2});
+            const int32_t blockShapeValue[] = {1, 1};
+            const int32_t paddingsValue[] = {0, 1, 0, 0};
+            const uint32_t blockShape =
+                    mBodyModel.addConstantOperand(&blockShapeType, blockShapeValue);
+            const uint32_t paddings = mBodyModel.addConstantOperand(&paddingsType, paddingsValue);
+            mBodyModel.addOperation(operationType, {x, blockShape, paddings, layout}, {xOut});
+            return;
+        }
+        // A 1x1 identity convolution with one row of padding at the bottom.
+        const uint32_t filter = mBodyModel.addConstantOperand(&filterType, 1.0f);
+        const uint32_t bias = mBodyModel.addConstantOperand(&biasType, 0.0f);
+        const uint32_t zero = mBodyModel.addConstantOperand(&scalarType, 0);
+        const uint32_t one = mBodyModel.addConstantOperand(&scalarType, 1);
+        const uint32_t noActivation = mBodyModel.addConstantOperand(&scalarType, kNoActivation);
+        std::vector<uint32_t> inputs = {x, filter, bias, zero, zero, zero, one, one, one};
+        if (operationType == ANEURALNETWORKS_GROUPED_CONV_2D) {
+            // One group.
+            inputs.push_back(one);
+        }
+        inputs.push_back(noActivation);
+        inputs.push_back(layout);
+        mBodyModel.addOperation(operationType, inputs, {xOut});
+    }
+
+    // Runs the loop for n iterations, and checks that the input value is followed by n zeros.
+    void run(int32_t n) {
+        SCOPED_TRACE(n);
+        const float input = 7;
+        std::vector<float> output(n + 1, -1);
+        Execution execution(mCompilation.get());
+        ASSERT_EQ(execution.setInput(0, &input, sizeof(input)), Result::NO_ERROR);
+        ASSERT_EQ(execution.setInput(1, &n), Result::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  Result::NO_ERROR);
+        ASSERT_EQ(execution.compute(), Result::NO_ERROR);
+        std::vector<uint32_t> dimensions;
+        ASSERT_EQ(execution.getOutputOperandDimensions(0, &dimensions), Result::NO_ERROR);
+        const uint32_t height = n + 1;
+        const bool useNchw = std::get<1>(GetParam());
+        EXPECT_EQ(dimensions, useNchw ? (std::vector<uint32_t>{1, 1, height, 1})
+                                      : (std::vector<uint32_t>{1, height, 1, 1}));
+        std::vector<float> expected(n + 1, 0);
+        expected[0] = input;
+        EXPECT_EQ(output, expected);
+    }
+
+    Model mConditionModel;
+    Model mBodyModel;
+    Model mModel;
+    std::unique_ptr<Compilation> mCompilation;
+};
+
+TEST_P(LayoutResizingLoopTest, BodyOutputGrows) {
+    // The output outgrows the capacity of the first iteration on every later one.
+    run(/*n=*/4);
+    run(/*n=*/1);
+    run(/*n=*/0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+        ControlFlowTest, LayoutResizingLoopTest,
+        ::testing::Combine(::testing::Values(ANEURALNETWORKS_CONV_2D,
+                                             ANEURALNETWORKS_GROUPED_CONV_2D,
+                                             ANEURALNETWORKS_SPACE_TO_BATCH_ND),
+                           ::testing::Bool()));
+
 TEST_F(ControlFlowTest, GetLoopTimeouts) {
     uint64_t defaultTimeout = ANeuralNetworks_getDefaultLoopTimeout();
     uint64_t maximumTimeout = ANeuralNetworks_getMaximumLoopTimeout();
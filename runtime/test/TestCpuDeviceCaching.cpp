@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuExecutor.h>
+#include <CpuPackedWeights.h>
+#include <android-base/file.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+#include <nnapi/Validation.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CpuModelCache.h"
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+#include "TmpDirectoryUtils.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+const std::vector<uint8_t> kToken(ANEURALNETWORKS_BYTE_SIZE_OF_CACHE_TOKEN, 0x5A);
+
+class CpuDeviceCachingTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        char cacheDirTemp[] = NN_TMP_DIR "/CpuDeviceCachingTest-XXXXXX";
+        char* cacheDir = mkdtemp(cacheDirTemp);
+        ASSERT_NE(cacheDir, nullptr);
+        mCacheDir = cacheDir;
+
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        manager->setUseCpuOnly(true);
+    }
+
+    void TearDown() override {
+        DeviceManager::get()->setUseCpuOnly(mWasCpuOnly);
+        if (!::testing::Test::HasFailure()) {
+            std::filesystem::remove_all(mCacheDir);
+        }
+    }
+
+    // Creates the model output = input + addend, where addend is a constant.
+    static void createModel(float addend, WrapperModel* model) {
+        WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1});
+        WrapperOperandType scalarType(WrapperType::INT32, {});
+        const float addendValue[] = {addend};
+        const int32_t activation = ANEURALNETWORKS_FUSED_NONE;
+        uint32_t input = model->addOperand(&tensorType);
+        uint32_t constant = model->addOperand(&tensorType);
+        uint32_t act = model->addOperand(&scalarType);
+        uint32_t output = model->addOperand(&tensorType);
+        model->setOperandValue(constant, addendValue, sizeof(addendValue));
+        model->setOperandValue(act, &activation, sizeof(activation));
+        model->addOperation(ANEURALNETWORKS_ADD, {input, constant, act}, {output});
+        model->identifyInputsAndOutputs({input}, {output});
+        ASSERT_TRUE(model->isValid());
+        ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+    }
+
+    // Creates the model output = lhs x rhs, where lhs is [1, 2, 3] and rhs is the constant
+    // [1, 3, 2] {1, 2, 3, 4, 5, 6}, whose transposed copy is packed when the model is prepared.
+    static void createBatchMatmulModel(WrapperModel* model) {
+        static const float kRhs[] = {1, 2, 3, 4, 5, 6};
+        WrapperOperandType lhsType(WrapperType::TENSOR_FLOAT32, {1, 2, 3});
+        WrapperOperandType rhsType(WrapperType::TENSOR_FLOAT32, {1, 3, 2});
+        WrapperOperandType outputType(WrapperType::TENSOR_FLOAT32, {1, 2, 2});
+        WrapperOperandType boolType(WrapperType::BOOL, {});
+        const uint32_t lhs = model->addOperand(&lhsType);
+        const uint32_t rhs = model->addOperand(&rhsType);
+        model->setOperandValue(rhs, kRhs, sizeof(kRhs));
+        const uint32_t adjX = model->addConstantOperand(&boolType, false);
+        const uint32_t adjY = model->addConstantOperand(&boolType, false);
+        const uint32_t output = model->addOperand(&outputType);
+        model->addOperation(ANEURALNETWORKS_BATCH_MATMUL, {lhs, rhs, adjX, adjY}, {output});
+        model->identifyInputsAndOutputs({lhs}, {output});
+        ASSERT_TRUE(model->isValid());
+        ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+    }
+
+    // Compiles the model with the cache token and returns input + addend computed by it.
+    float compileAndCompute(const WrapperModel& model, float input) {
+        WrapperCompilation compilation(&model);
+        EXPECT_EQ(compilation.setCaching(mCacheDir, kToken), WrapperResult::NO_ERROR);
+        EXPECT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+        return compute(&compilation, input);
+    }
+
+    static float compute(WrapperCompilation* compilation, float input) {
+        WrapperExecution execution(compilation);
+        float output = 0.0f;
+        EXPECT_EQ(execution.setInput(0, &input), WrapperResult::NO_ERROR);
+        EXPECT_EQ(execution.setOutput(0, &output), WrapperResult::NO_ERROR);
+        EXPECT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        return output;
+    }
+
+    std::vector<float> compileAndComputeBatchMatmul(const WrapperModel& model) {
+        const std::vector<float> lhs = {1, 2, 3, 4, 5, 6};
+        std::vector<float> output(4);
+        WrapperCompilation compilation(&model);
+        EXPECT_EQ(compilation.setCaching(mCacheDir, kToken), WrapperResult::NO_ERROR);
+        EXPECT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+        WrapperExecution execution(&compilation);
+        EXPECT_EQ(execution.setInput(0, lhs.data(), lhs.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        EXPECT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        EXPECT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        return output;
+    }
+
+    std::vector<std::filesystem::path> getCacheFiles() const {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(mCacheDir)) {
+            files.push_back(entry.path());
+        }
+        return files;
+    }
+
+    std::string mCacheDir;
+
+   private:
+    bool mWasCpuOnly = false;
+};
+
+TEST_F(CpuDeviceCachingTest, PreparesModelFromCache) {
+    WrapperModel model;
+    createModel(1.0f, &model);
+    EXPECT_EQ(compileAndCompute(model, 2.0f), 3.0f);
+    EXPECT_EQ(getCacheFiles().size(), 2u);
+
+    // The application guarantees that a token identifies a single model, so a model with
+    // different weights compiled with the same token is prepared from the cache of the first one.
+    WrapperModel otherModel;
+    createModel(10.0f, &otherModel);
+    EXPECT_EQ(compileAndCompute(otherModel, 2.0f), 3.0f);
+}
+
+TEST_F(CpuDeviceCachingTest, RecompilesWhenCacheIsCorrupted) {
+    WrapperModel model;
+    createModel(1.0f, &model);
+    EXPECT_EQ(compileAndCompute(model, 2.0f), 3.0f);
+
+    const auto files = getCacheFiles();
+    ASSERT_EQ(files.size(), 2u);
+    for (const auto& file : files) {
+        std::filesystem::resize_file(file, std::filesystem::file_size(file) / 2);
+    }
+
+    WrapperModel otherModel;
+    createModel(10.0f, &otherModel);
+    EXPECT_EQ(compileAndCompute(otherModel, 2.0f), 12.0f);
+}
+
+TEST_F(CpuDeviceCachingTest, RewritingCacheKeepsModelPreparedFromCache) {
+    WrapperModel model;
+    createModel(1.0f, &model);
+    EXPECT_EQ(compileAndCompute(model, 2.0f), 3.0f);
+
+    // This compilation maps the data cache file.
+    WrapperCompilation cachedCompilation(&model);
+    ASSERT_EQ(cachedCompilation.setCaching(mCacheDir, kToken), WrapperResult::NO_ERROR);
+    ASSERT_EQ(cachedCompilation.finish(), WrapperResult::NO_ERROR);
+
+    // Invalidate the model cache file only, so that the next compilation rewrites both files.
+    // The model cache file name ends with the model cache identifier '1' and the file index.
+    for (const auto& file : getCacheFiles()) {
+        if (file.filename().string().substr(kToken.size() * 2) == "10") {
+            std::filesystem::resize_file(file, 1);
+        }
+    }
+    WrapperModel otherModel;
+    createModel(10.0f, &otherModel);
+    EXPECT_EQ(compileAndCompute(otherModel, 2.0f), 12.0f);
+
+    // The cache files were replaced rather than rewritten in place, so the mapping is intact.
+    EXPECT_EQ(compute(&cachedCompilation, 2.0f), 3.0f);
+    EXPECT_EQ(compileAndCompute(model, 2.0f), 12.0f);
+}
+
+TEST_F(CpuDeviceCachingTest, PreparesModelWithPackedWeightsFromCache) {
+    WrapperModel model;
+    createBatchMatmulModel(&model);
+    const std::vector<float> expected = {22, 28, 49, 64};
+    EXPECT_EQ(compileAndComputeBatchMatmul(model), expected);
+    EXPECT_EQ(compileAndComputeBatchMatmul(model), expected);
+}
+
+TEST_F(CpuDeviceCachingTest, StoresPackedWeightsInDataCacheFile) {
+    WrapperModel wrapperModel;
+    createBatchMatmulModel(&wrapperModel);
+    const Model model =
+            reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    std::vector<RunTimePoolInfo> poolInfos;
+    ASSERT_TRUE(setRunTimePoolInfosFromCanonicalMemories(&poolInfos, model.pools));
+    const auto packedWeights = CpuPackedWeights::create(model, poolInfos);
+    ASSERT_EQ(packedWeights->getPackedCount(), 1u);
+
+    TemporaryFile modelFile, dataFile;
+    const CacheHandles cache = {
+            .modelCache = {std::make_shared<const Handle>(base::unique_fd(dup(modelFile.fd)))},
+            .dataCache = {std::make_shared<const Handle>(base::unique_fd(dup(dataFile.fd)))}};
+    CacheToken token;
+    std::copy(kToken.begin(), kToken.end(), token.begin());
+    const auto saved = saveCpuModelToCache(model, poolInfos, packedWeights.get(), cache, token);
+    ASSERT_TRUE(saved.has_value()) << saved.error();
+
+    auto cached = loadCpuModelFromCache(cache, token);
+    ASSERT_TRUE(cached.has_value()) << cached.error();
+    ASSERT_TRUE(validate(cached->model).has_value());
+    ASSERT_EQ(cached->packedWeights.size(), 1u);
+    EXPECT_EQ(cached->packedWeights[0].layout, PackedLayout::TRANSPOSED_ROWS_COLUMNS);
+    std::vector<RunTimePoolInfo> cachedPoolInfos;
+    ASSERT_TRUE(setRunTimePoolInfosFromCanonicalMemories(&cachedPoolInfos, cached->model.pools));
+    const auto cachedPackedWeights = CpuPackedWeights::createFromCache(
+            cached->model, cachedPoolInfos, cached->packedWeights);
+    ASSERT_EQ(cachedPackedWeights->getPackedCount(), 1u);
+
+    // The packed copy refers to the mapped data cache file and holds the values packed before.
+    const Operand& rhs = model.main.operands[1];
+    const Operand& cachedRhs = cached->model.main.operands[1];
+    const void* packed = packedWeights->lookup(getConstantOperandData(model, rhs, poolInfos),
+                                               rhs.location.length, rhs.dimensions,
+                                               PackedLayout::TRANSPOSED_ROWS_COLUMNS);
+    const auto* cachedPacked = static_cast<const uint8_t*>(cachedPackedWeights->lookup(
+            getConstantOperandData(cached->model, cachedRhs, cachedPoolInfos),
+            cachedRhs.location.length, cachedRhs.dimensions,
+            PackedLayout::TRANSPOSED_ROWS_COLUMNS));
+    ASSERT_NE(packed, nullptr);
+    ASSERT_NE(cachedPacked, nullptr);
+    const uint8_t* pool = cachedPoolInfos[0].getBuffer();
+    EXPECT_GE(cachedPacked, pool);
+    EXPECT_LE(cachedPacked + rhs.location.length, pool + cachedPoolInfos[0].getSize());
+    EXPECT_EQ(std::memcmp(cachedPacked, packed, rhs.location.length), 0);
+}
+
+}  // namespace
+}  // namespace android::nn
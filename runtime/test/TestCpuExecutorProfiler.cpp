@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuExecutorProfiler.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+constexpr uint32_t kTensorSize = 16;
+constexpr uint32_t kTensorBytes = kTensorSize * sizeof(float);
+
+class CpuExecutorProfilerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        manager->setUseCpuOnly(true);
+        manager->setCpuExecutorProfiler(mProfiler);
+    }
+
+    void TearDown() override {
+        DeviceManager* manager = DeviceManager::get();
+        manager->setCpuExecutorProfiler(nullptr);
+        manager->setUseCpuOnly(mWasCpuOnly);
+    }
+
+    // Creates the model output = (input + input) * input, and runs it the given number of times.
+    static void runModel(int runs) {
+        WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {kTensorSize});
+        WrapperOperandType scalarType(WrapperType::INT32, {});
+        WrapperModel model;
+        const uint32_t input = model.addOperand(&tensorType);
+        const uint32_t act = model.addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+        const uint32_t sum = model.addOperand(&tensorType);
+        const uint32_t output = model.addOperand(&tensorType);
+        model.addOperation(ANEURALNETWORKS_ADD, {input, input, act}, {sum});
+        model.addOperation(ANEURALNETWORKS_MUL, {sum, input, act}, {output});
+        model.identifyInputsAndOutputs({input}, {output});
+        ASSERT_TRUE(model.isValid());
+        ASSERT_EQ(model.finish(), WrapperResult::NO_ERROR);
+
+        WrapperCompilation compilation(&model);
+        ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+        const std::vector<float> inputData(kTensorSize, 2.0f);
+        std::vector<float> outputData(kTensorSize);
+        for (int i = 0; i < runs; ++i) {
+            WrapperExecution execution(&compilation);
+            ASSERT_EQ(execution.setInput(0, inputData.data(), kTensorBytes),
+                      WrapperResult::NO_ERROR);
+            ASSERT_EQ(execution.setOutput(0, outputData.data(), kTensorBytes),
+                      WrapperResult::NO_ERROR);
+            ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+            EXPECT_EQ(outputData, std::vector<float>(kTensorSize, 8.0f));
+        }
+    }
+
+    const std::shared_ptr<CpuExecutorProfiler> mProfiler = std::make_shared<CpuExecutorProfiler>();
+
+   private:
+    bool mWasCpuOnly = false;
+};
+
+TEST_F(CpuExecutorProfilerTest, RecordsEveryOperation) {
+    runModel(3);
+
+    const auto operations = mProfiler->getRecordedOperations();
+    ASSERT_EQ(operations.size(), 6u);
+    EXPECT_EQ(operations[0].type, OperationType::ADD);
+    EXPECT_EQ(operations[0].operationIndex, 0u);
+    EXPECT_EQ(operations[1].type, OperationType::MUL);
+    EXPECT_EQ(operations[1].operationIndex, 1u);
+    for (const auto& operation : operations) {
+        EXPECT_EQ(operation.subgraphIndex, 0u);
+        EXPECT_EQ(operation.operationCount, 1u);
+        EXPECT_EQ(operation.bytesRead, 2 * kTensorBytes + sizeof(int32_t));
+        EXPECT_EQ(operation.bytesWritten, kTensorBytes);
+    }
+    // Only the temporary operand written by ADD is allocated by the executor.
+    EXPECT_EQ(operations[0].allocations, 1u);
+    EXPECT_EQ(operations[0].bytesAllocated, kTensorBytes);
+    EXPECT_EQ(operations[1].allocations, 0u);
+}
+
+TEST_F(CpuExecutorProfilerTest, SummarizesPerOperation) {
+    runModel(3);
+
+    const auto summaries = mProfiler->getSummaries();
+    ASSERT_EQ(summaries.size(), 2u);
+    for (const auto& summary : summaries) {
+        EXPECT_EQ(summary.count, 3u);
+        EXPECT_LE(summary.maxDuration, summary.totalDuration);
+    }
+    const std::string table = mProfiler->toSummaryTable();
+    EXPECT_NE(table.find("ADD"), std::string::npos) << table;
+    EXPECT_NE(table.find("MUL"), std::string::npos) << table;
+}
+
+TEST_F(CpuExecutorProfilerTest, ExportsChromeTrace) {
+    runModel(1);
+
+    const std::string trace = mProfiler->toChromeTrace();
+    EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0u) << trace;
+    EXPECT_NE(trace.find("\"name\":\"ADD\""), std::string::npos) << trace;
+    EXPECT_NE(trace.find("\"name\":\"MUL\""), std::string::npos) << trace;
+    EXPECT_NE(trace.find("\"ph\":\"X\""), std::string::npos) << trace;
+}
+
+TEST_F(CpuExecutorProfilerTest, MeasuresFusedChainsAsRunWithoutProfiler) {
+    DeviceManager* manager = DeviceManager::get();
+    const bool wasFusing = manager->fuseCpuOperations();
+    manager->setFuseCpuOperations(true);
+    runModel(2);
+    manager->setFuseCpuOperations(wasFusing);
+
+    // ADD and MUL run as one fused chain, as they do without a profiler, so the intermediate sum
+    // is never allocated.
+    const auto operations = mProfiler->getRecordedOperations();
+    ASSERT_EQ(operations.size(), 2u);
+    for (const auto& operation : operations) {
+        EXPECT_EQ(operation.type, OperationType::ADD);
+        EXPECT_EQ(operation.operationIndex, 0u);
+        EXPECT_EQ(operation.operationCount, 2u);
+        // ADD reads input twice and MUL reads it once more, and each reads the activation.
+        EXPECT_EQ(operation.bytesRead, 3 * kTensorBytes + 2 * sizeof(int32_t));
+        EXPECT_EQ(operation.bytesWritten, kTensorBytes);
+        EXPECT_EQ(operation.allocations, 0u);
+    }
+
+    const auto summaries = mProfiler->getSummaries();
+    ASSERT_EQ(summaries.size(), 1u);
+    EXPECT_EQ(summaries[0].count, 2u);
+    EXPECT_EQ(summaries[0].operationCount, 2u);
+    const std::string table = mProfiler->toSummaryTable();
+    EXPECT_NE(table.find("ADD (2 fused)"), std::string::npos) << table;
+}
+
+TEST_F(CpuExecutorProfilerTest, DropsOperationsBeyondLimit) {
+    auto profiler = std::make_shared<CpuExecutorProfiler>(/*maxRecordedOperations=*/3);
+    DeviceManager::get()->setCpuExecutorProfiler(profiler);
+    runModel(2);
+
+    EXPECT_EQ(profiler->getRecordedOperations().size(), 3u);
+    EXPECT_EQ(profiler->getDroppedOperationCount(), 1u);
+    for (const auto& summary : profiler->getSummaries()) {
+        EXPECT_EQ(summary.count, 2u);
+    }
+
+    profiler->clear();
+    EXPECT_TRUE(profiler->getRecordedOperations().empty());
+    EXPECT_TRUE(profiler->getSummaries().empty());
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <CpuExecutor.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// Doubles every element of x, whose size is only known at execution time, n times:
+//
+// i = 0
+// while i < n:
+//     i = i + 1
+//     x = x + x
+class DoublingLoopModel {
+   public:
+    DoublingLoopModel() {
+        WrapperOperandType counterType(WrapperType::TENSOR_FLOAT32, {1});
+        WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {0});
+        WrapperOperandType boolType(WrapperType::TENSOR_BOOL8, {1});
+        WrapperOperandType scalarType(WrapperType::INT32, {});
+
+        {
+            const uint32_t i = mCondition.addOperand(&counterType);
+            const uint32_t x = mCondition.addOperand(&tensorType);
+            const uint32_t n = mCondition.addOperand(&counterType);
+            const uint32_t out = mCondition.addOperand(&boolType);
+            mCondition.addOperation(ANEURALNETWORKS_LESS, {i, n}, {out});
+            mCondition.identifyInputsAndOutputs({i, x, n}, {out});
+            EXPECT_EQ(mCondition.finish(), WrapperResult::NO_ERROR);
+        }
+        {
+            const uint32_t i = mBody.addOperand(&counterType);
+            const uint32_t x = mBody.addOperand(&tensorType);
+            const uint32_t n = mBody.addOperand(&counterType);
+            const uint32_t one = mBody.addConstantOperand(&counterType, 1.0f);
+            const uint32_t none = mBody.addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+            const uint32_t iOut = mBody.addOperand(&counterType);
+            const uint32_t xOut = mBody.addOperand(&tensorType);
+            mBody.addOperation(ANEURALNETWORKS_ADD, {i, one, none}, {iOut});
+            mBody.addOperation(ANEURALNETWORKS_ADD, {x, x, none}, {xOut});
+            mBody.identifyInputsAndOutputs({i, x, n}, {iOut, xOut});
+            EXPECT_EQ(mBody.finish(), WrapperResult::NO_ERROR);
+        }
+        const uint32_t iInit = mModel.addConstantOperand(&counterType, 0.0f);
+        const uint32_t x = mModel.addOperand(&tensorType);
+        const uint32_t n = mModel.addOperand(&counterType);
+        const uint32_t condition = mModel.addModelOperand(&mCondition);
+        const uint32_t body = mModel.addModelOperand(&mBody);
+        const uint32_t iOut = mModel.addOperand(&counterType);
+        const uint32_t xOut = mModel.addOperand(&tensorType);
+        mModel.addOperation(ANEURALNETWORKS_WHILE, {condition, body, iInit, x, n}, {iOut, xOut});
+        mModel.identifyInputsAndOutputs({x, n}, {iOut, xOut});
+        EXPECT_TRUE(mModel.isValid());
+        EXPECT_EQ(mModel.finish(), WrapperResult::NO_ERROR);
+    }
+
+    Model makeModel() const {
+        return reinterpret_cast<const ModelBuilder*>(mModel.getHandle())->makeModel();
+    }
+
+   private:
+    WrapperModel mCondition;
+    WrapperModel mBody;
+    WrapperModel mModel;
+};
+
+Request::Argument makeArgument(std::variant<const void*, void*> pointer, uint32_t length,
+                               std::vector<uint32_t> dimensions = {}) {
+    Request::Argument argument;
+    argument.lifetime = Request::Argument::LifeTime::POINTER;
+    argument.location.pointer = pointer;
+    argument.location.length = length;
+    argument.dimensions = std::move(dimensions);
+    return argument;
+}
+
+// Runs the model on x with n iterations, and returns the doubled x.
+std::vector<float> run(const Model& model, const std::vector<RunTimePoolInfo>& modelPoolInfos,
+                       const std::shared_ptr<CpuExecutorSubgraphCache>& cache,
+                       const std::vector<float>& x, float n) {
+    const uint32_t count = x.size();
+    const uint32_t size = count * sizeof(float);
+    float counter = 0.0f;
+    std::vector<float> output(count);
+    Request request;
+    request.inputs = {makeArgument(x.data(), size, {count}),
+                      makeArgument(&n, sizeof(n))};
+    request.outputs = {makeArgument(&counter, sizeof(counter)),
+                       makeArgument(output.data(), size)};
+    CpuExecutor executor;
+    executor.setSubgraphCache(cache);
+    EXPECT_EQ(executor.run(model, request, modelPoolInfos, {}), ANEURALNETWORKS_NO_ERROR);
+    EXPECT_EQ(counter, n);
+    const auto& outputShapes = executor.getOutputShapes();
+    EXPECT_EQ(outputShapes.size(), 2u);
+    if (outputShapes.size() == 2) {
+        EXPECT_EQ(outputShapes[1].dimensions, std::vector<uint32_t>{count});
+    }
+    return output;
+}
+
+TEST(CpuExecutorSubgraphCacheTest, SharedCacheHandlesDifferentlyShapedRequests) {
+    const DoublingLoopModel loopModel;
+    const Model model = loopModel.makeModel();
+    std::vector<RunTimePoolInfo> modelPoolInfos;
+    ASSERT_TRUE(setRunTimePoolInfosFromCanonicalMemories(&modelPoolInfos, model.pools));
+
+    // The cache holds the runtime info of the subgraphs before any request is applied, so the
+    // shapes of one request must not leak into the next one.
+    const auto cache = std::make_shared<CpuExecutorSubgraphCache>();
+    EXPECT_EQ(run(model, modelPoolInfos, cache, {1, 2}, 3), (std::vector<float>{8, 16}));
+    EXPECT_EQ(run(model, modelPoolInfos, cache, {1, 2, 3}, 1), (std::vector<float>{2, 4, 6}));
+    EXPECT_EQ(run(model, modelPoolInfos, cache, {5}, 0), (std::vector<float>{5}));
+    EXPECT_EQ(run(model, modelPoolInfos, cache, {1, 2}, 2), (std::vector<float>{4, 8}));
+}
+
+TEST(CpuExecutorSubgraphCacheTest, CacheBoundToAnotherModelIsNotUsed) {
+    const DoublingLoopModel loopModel;
+    const Model model = loopModel.makeModel();
+    const Model otherModel = loopModel.makeModel();
+    std::vector<RunTimePoolInfo> modelPoolInfos;
+    ASSERT_TRUE(setRunTimePoolInfosFromCanonicalMemories(&modelPoolInfos, model.pools));
+    std::vector<RunTimePoolInfo> otherModelPoolInfos;
+    ASSERT_TRUE(setRunTimePoolInfosFromCanonicalMemories(&otherModelPoolInfos, otherModel.pools));
+
+    const auto cache = std::make_shared<CpuExecutorSubgraphCache>();
+    EXPECT_EQ(run(model, modelPoolInfos, cache, {1, 2}, 1), (std::vector<float>{2, 4}));
+    EXPECT_FALSE(cache->bind(otherModel, otherModelPoolInfos));
+    EXPECT_EQ(run(otherModel, otherModelPoolInfos, cache, {3}, 2), (std::vector<float>{12}));
+    EXPECT_EQ(run(otherModel, otherModelPoolInfos, nullptr, {3}, 2), (std::vector<float>{12}));
+}
+
+}  // namespace
+}  // namespace android::nn
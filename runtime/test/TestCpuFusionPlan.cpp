@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuFusionPlan.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// Adds a binary operation of lhs and rhs with the given fused activation, and returns its output.
+uint32_t addBinary(WrapperModel* model, ANeuralNetworksOperationType type, uint32_t lhs,
+                   uint32_t rhs, const WrapperOperandType& outputType, int32_t activation) {
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t activationOperand = model->addConstantOperand(&scalarType, activation);
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(type, {lhs, rhs, activationOperand}, {output});
+    return output;
+}
+
+uint32_t addUnary(WrapperModel* model, ANeuralNetworksOperationType type, uint32_t input,
+                  const WrapperOperandType& outputType) {
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(type, {input}, {output});
+    return output;
+}
+
+uint32_t addConstantTensor(WrapperModel* model, const std::vector<uint32_t>& dimensions,
+                           const std::vector<float>& values) {
+    WrapperOperandType type(WrapperType::TENSOR_FLOAT32, dimensions);
+    const uint32_t operand = model->addOperand(&type);
+    model->setOperandValue(operand, values.data(), values.size() * sizeof(float));
+    return operand;
+}
+
+void finish(WrapperModel* model, uint32_t input, const std::vector<uint32_t>& outputs) {
+    model->identifyInputsAndOutputs({input}, outputs);
+    ASSERT_TRUE(model->isValid());
+    ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+}
+
+std::shared_ptr<const CpuFusionPlan> createPlan(const WrapperModel& wrapperModel, Model* model) {
+    *model = reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    return CpuFusionPlan::create(*model);
+}
+
+template <typename In, typename Out>
+void compute(const WrapperModel& model, const std::vector<In>& input, std::vector<Out>* output) {
+    WrapperCompilation compilation(&model);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    WrapperExecution execution(&compilation);
+    ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(In)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(0, output->data(), output->size() * sizeof(Out)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+}
+
+class CpuFusionPlanTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        mWasFusingCpuOperations = manager->fuseCpuOperations();
+        manager->setUseCpuOnly(true);
+        manager->setFuseCpuOperations(true);
+    }
+
+    void TearDown() override {
+        DeviceManager* manager = DeviceManager::get();
+        manager->setFuseCpuOperations(mWasFusingCpuOperations);
+        manager->setUseCpuOnly(mWasCpuOnly);
+    }
+
+   private:
+    bool mWasCpuOnly = false;
+    bool mWasFusingCpuOperations = false;
+};
+
+TEST_F(CpuFusionPlanTest, FusesAddRelu6) {
+    WrapperModel wrapperModel;
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {2, 3});
+    const uint32_t input = wrapperModel.addOperand(&tensorType);
+    const uint32_t bias = addConstantTensor(&wrapperModel, {3}, {1, 2, 3});
+    const uint32_t sum = addBinary(&wrapperModel, ANEURALNETWORKS_ADD, input, bias, tensorType,
+                                   ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = addUnary(&wrapperModel, ANEURALNETWORKS_RELU6, sum, tensorType);
+    finish(&wrapperModel, input, {output});
+
+    Model model;
+    const auto plan = createPlan(wrapperModel, &model);
+    EXPECT_TRUE(plan->isFor(model));
+    EXPECT_EQ(plan->getFusedChainCount(), 1u);
+    EXPECT_EQ(plan->getFusedOperationCount(), 2u);
+
+    std::vector<float> result(6);
+    compute(wrapperModel, std::vector<float>{-2, 1, 5, 3, 4, 7}, &result);
+    EXPECT_EQ(result, (std::vector<float>{0, 3, 6, 4, 6, 6}));
+}
+
+TEST_F(CpuFusionPlanTest, FusesPerChannelMulAdd) {
+    WrapperModel wrapperModel;
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1, 2, 2, 2});
+    const uint32_t input = wrapperModel.addOperand(&tensorType);
+    const uint32_t scale = addConstantTensor(&wrapperModel, {2}, {2, 0.5});
+    const uint32_t shift = addConstantTensor(&wrapperModel, {1, 2}, {1, -1});
+    const uint32_t product = addBinary(&wrapperModel, ANEURALNETWORKS_MUL, input, scale,
+                                       tensorType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = addBinary(&wrapperModel, ANEURALNETWORKS_ADD, shift, product,
+                                      tensorType, ANEURALNETWORKS_FUSED_RELU);
+    finish(&wrapperModel, input, {output});
+
+    Model model;
+    const auto plan = createPlan(wrapperModel, &model);
+    EXPECT_EQ(plan->getFusedChainCount(), 1u);
+    EXPECT_EQ(plan->getFusedOperationCount(), 2u);
+
+    std::vector<float> result(8);
+    compute(wrapperModel, std::vector<float>{1, 2, 3, 4, -5, 6, 7, 8}, &result);
+    EXPECT_EQ(result, (std::vector<float>{3, 0, 7, 1, 0, 2, 15, 3}));
+}
+
+TEST_F(CpuFusionPlanTest, FusesSwish) {
+    WrapperModel wrapperModel;
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {4});
+    const uint32_t input = wrapperModel.addOperand(&tensorType);
+    const uint32_t gate = addUnary(&wrapperModel, ANEURALNETWORKS_LOGISTIC, input, tensorType);
+    const uint32_t output = addBinary(&wrapperModel, ANEURALNETWORKS_MUL, input, gate,
+                                      tensorType, ANEURALNETWORKS_FUSED_NONE);
+    finish(&wrapperModel, input, {output});
+
+    Model model;
+    const auto plan = createPlan(wrapperModel, &model);
+    EXPECT_EQ(plan->getFusedChainCount(), 1u);
+    EXPECT_EQ(plan->getFusedOperationCount(), 2u);
+
+    std::vector<float> result(4);
+    compute(wrapperModel, std::vector<float>{0, 1, -1, 2}, &result);
+    const std::vector<float> expected = {0, 0.7310586f, -0.2689414f, 1.7615942f};
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR(result[i], expected[i], 1e-5f) << "at index " << i;
+    }
+}
+
+TEST_F(CpuFusionPlanTest, FusesDequantizeAddQuantize) {
+    WrapperModel wrapperModel;
+    WrapperOperandType quantType(WrapperType::TENSOR_QUANT8_ASYMM, {4}, 0.5f, 128);
+    WrapperOperandType floatType(WrapperType::TENSOR_FLOAT32, {4});
+    const uint32_t input = wrapperModel.addOperand(&quantType);
+    const uint32_t dequantized =
+            addUnary(&wrapperModel, ANEURALNETWORKS_DEQUANTIZE, input, floatType);
+    const uint32_t one = addConstantTensor(&wrapperModel, {1}, {1});
+    const uint32_t sum = addBinary(&wrapperModel, ANEURALNETWORKS_ADD, dequantized, one,
+                                   floatType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = addUnary(&wrapperModel, ANEURALNETWORKS_QUANTIZE, sum, quantType);
+    finish(&wrapperModel, input, {output});
+
+    Model model;
+    const auto plan = createPlan(wrapperModel, &model);
+    EXPECT_EQ(plan->getFusedChainCount(), 1u);
+    EXPECT_EQ(plan->getFusedOperationCount(), 3u);
+
+    std::vector<uint8_t> result(4);
+    compute(wrapperModel, std::vector<uint8_t>{128, 130, 100, 255}, &result);
+    EXPECT_EQ(result, (std::vector<uint8_t>{130, 132, 102, 255}));
+}
+
+TEST_F(CpuFusionPlanTest, DoesNotFuseValueReadByOtherOperations) {
+    WrapperModel wrapperModel;
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {3});
+    const uint32_t input = wrapperModel.addOperand(&tensorType);
+    const uint32_t bias = addConstantTensor(&wrapperModel, {3}, {1, 2, 3});
+    const uint32_t sum = addBinary(&wrapperModel, ANEURALNETWORKS_ADD, input, bias, tensorType,
+                                   ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = addUnary(&wrapperModel, ANEURALNETWORKS_RELU, sum, tensorType);
+    finish(&wrapperModel, input, {output, sum});
+
+    Model model;
+    EXPECT_EQ(createPlan(wrapperModel, &model)->getFusedChainCount(), 0u);
+}
+
+// The other input of ADD is broadcast along the last dimension of the value, which the fused loop
+// does not support, so the operations are run one by one.
+TEST_F(CpuFusionPlanTest, FallsBackForInnerBroadcast) {
+    WrapperModel wrapperModel;
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {2, 3});
+    const uint32_t input = wrapperModel.addOperand(&tensorType);
+    const uint32_t bias = addConstantTensor(&wrapperModel, {2, 1}, {10, 20});
+    const uint32_t sum = addBinary(&wrapperModel, ANEURALNETWORKS_ADD, input, bias, tensorType,
+                                   ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = addUnary(&wrapperModel, ANEURALNETWORKS_RELU, sum, tensorType);
+    finish(&wrapperModel, input, {output});
+
+    Model model;
+    EXPECT_EQ(createPlan(wrapperModel, &model)->getFusedChainCount(), 1u);
+
+    std::vector<float> result(6);
+    compute(wrapperModel, std::vector<float>{1, 2, 3, -4, 5, 6}, &result);
+    EXPECT_EQ(result, (std::vector<float>{11, 12, 13, 16, 25, 26}));
+}
+
+}  // namespace
+}  // namespace android::nn
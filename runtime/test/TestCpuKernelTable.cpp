@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuKernelTable.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// input [2, 3] + bias [3], reshaped into output [6]. ADD is registered with the builtin resolver,
+// while RESHAPE is implemented by CpuExecutor.
+void createAddReshapeModel(WrapperModel* model) {
+    static const float kBias[] = {1, 2, 3};
+    static const int32_t kShape[] = {6};
+    WrapperOperandType inputType(WrapperType::TENSOR_FLOAT32, {2, 3});
+    WrapperOperandType biasType(WrapperType::TENSOR_FLOAT32, {3});
+    WrapperOperandType shapeType(WrapperType::TENSOR_INT32, {1});
+    WrapperOperandType outputType(WrapperType::TENSOR_FLOAT32, {6});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&inputType);
+    const uint32_t bias = model->addOperand(&biasType);
+    model->setOperandValue(bias, kBias, sizeof(kBias));
+    const uint32_t activation = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t sum = model->addOperand(&inputType);
+    const uint32_t shape = model->addOperand(&shapeType);
+    model->setOperandValue(shape, kShape, sizeof(kShape));
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(ANEURALNETWORKS_ADD, {input, bias, activation}, {sum});
+    model->addOperation(ANEURALNETWORKS_RESHAPE, {sum, shape}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    ASSERT_TRUE(model->isValid());
+    ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+}
+
+class CpuKernelTableTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        manager->setUseCpuOnly(true);
+    }
+
+    void TearDown() override { DeviceManager::get()->setUseCpuOnly(mWasCpuOnly); }
+
+   private:
+    bool mWasCpuOnly = false;
+};
+
+TEST_F(CpuKernelTableTest, ResolvesRegisteredOperations) {
+    WrapperModel wrapperModel;
+    createAddReshapeModel(&wrapperModel);
+    const Model model =
+            reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    const auto table = CpuKernelTable::create(model);
+    EXPECT_TRUE(table->isFor(model));
+    EXPECT_EQ(table->getRegisteredCount(), 1u);
+
+    const std::vector<CpuKernel>& kernels = table->getKernels(model.main);
+    ASSERT_EQ(kernels.size(), 2u);
+    EXPECT_EQ(kernels[0].registration,
+              BuiltinOperationResolver::get()->findOperation(OperationType::ADD));
+    // The builtin kernels are plain functions, so they are called without std::function.
+    EXPECT_NE(kernels[0].prepareFunction, nullptr);
+    EXPECT_NE(kernels[0].executeFunction, nullptr);
+    EXPECT_EQ(kernels[1].registration, nullptr);
+
+    WrapperCompilation compilation(&wrapperModel);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    const std::vector<float> input = {1, 2, 3, 4, 5, 6};
+    std::vector<float> output(6);
+    // Every execution reuses the kernels resolved when the model was prepared.
+    for (int i = 0; i < 2; ++i) {
+        WrapperExecution execution(&compilation);
+        ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        EXPECT_EQ(output, (std::vector<float>{2, 4, 6, 5, 7, 9}));
+    }
+}
+
+TEST_F(CpuKernelTableTest, UnregisteredOperationHasNoKernel) {
+    const CpuKernel kernel = CpuKernel::create(nullptr);
+    EXPECT_EQ(kernel.registration, nullptr);
+    EXPECT_EQ(kernel.prepareFunction, nullptr);
+    EXPECT_EQ(kernel.executeFunction, nullptr);
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuExecutor.h>
+#include <CpuPackedWeights.h>
+#include <android-base/file.h>
+#include <android/sharedmem.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperMemory = test_wrapper::Memory;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// lhs [1, 2, 3] x rhs [1, 3, 2] = output [1, 2, 2], where rhs is constant.
+void createBatchMatmulModel(WrapperModel* model, bool adjY) {
+    static const float kRhs[] = {1, 2, 3, 4, 5, 6};
+    WrapperOperandType lhsType(WrapperType::TENSOR_FLOAT32, {1, 2, 3});
+    WrapperOperandType rhsType(WrapperType::TENSOR_FLOAT32, adjY ? std::vector<uint32_t>{1, 2, 3}
+                                                                 : std::vector<uint32_t>{1, 3, 2});
+    WrapperOperandType outputType(WrapperType::TENSOR_FLOAT32, {1, 2, 2});
+    WrapperOperandType boolType(WrapperType::BOOL, {});
+    const uint32_t lhs = model->addOperand(&lhsType);
+    const uint32_t rhs = model->addOperand(&rhsType);
+    model->setOperandValue(rhs, kRhs, sizeof(kRhs));
+    const uint32_t adjXOperand = model->addConstantOperand(&boolType, false);
+    const uint32_t adjYOperand = model->addConstantOperand(&boolType, adjY);
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(ANEURALNETWORKS_BATCH_MATMUL, {lhs, rhs, adjXOperand, adjYOperand},
+                        {output});
+    model->identifyInputsAndOutputs({lhs}, {output});
+    ASSERT_TRUE(model->isValid());
+    ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+}
+
+// A 1x1 CONV_2D of input [1, 1, 1, 2] with a constant filter [1, 1, 1, 2] and bias [1].
+void createConvModel(WrapperModel* model, WrapperType type) {
+    const bool isQuant = type == WrapperType::TENSOR_QUANT8_ASYMM_SIGNED;
+    static const int8_t kQuantFilter[] = {2, 5};
+    static const int32_t kQuantBias[] = {1};
+    static const _Float16 kFloat16Filter[] = {2, 5};
+    static const _Float16 kFloat16Bias[] = {1};
+    WrapperOperandType tensorType(type, {1, 1, 1, 2}, isQuant ? 1.0f : 0.0f);
+    WrapperOperandType biasType(isQuant ? WrapperType::TENSOR_INT32 : type, {1},
+                                isQuant ? 1.0f : 0.0f);
+    WrapperOperandType outputType(type, {1, 1, 1, 1}, isQuant ? 1.0f : 0.0f);
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t filter = model->addOperand(&tensorType);
+    const uint32_t bias = model->addOperand(&biasType);
+    if (isQuant) {
+        model->setOperandValue(filter, kQuantFilter, sizeof(kQuantFilter));
+        model->setOperandValue(bias, kQuantBias, sizeof(kQuantBias));
+    } else {
+        model->setOperandValue(filter, kFloat16Filter, sizeof(kFloat16Filter));
+        model->setOperandValue(bias, kFloat16Bias, sizeof(kFloat16Bias));
+    }
+    const uint32_t padding = model->addConstantOperand(&scalarType, ANEURALNETWORKS_PADDING_VALID);
+    const uint32_t stride = model->addConstantOperand(&scalarType, 1);
+    const uint32_t activation = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(ANEURALNETWORKS_CONV_2D,
+                        {input, filter, bias, padding, stride, stride, activation}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    ASSERT_TRUE(model->isValid());
+    ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+}
+
+std::shared_ptr<const CpuPackedWeights> packWeights(const WrapperModel& wrapperModel, Model* model,
+                                                    std::vector<RunTimePoolInfo>* poolInfos) {
+    *model = reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    EXPECT_TRUE(setRunTimePoolInfosFromCanonicalMemories(poolInfos, model->pools));
+    return CpuPackedWeights::create(*model, *poolInfos);
+}
+
+template <typename T>
+void compute(const WrapperModel& model, const std::vector<T>& input, std::vector<T>* output) {
+    WrapperCompilation compilation(&model);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    WrapperExecution execution(&compilation);
+    ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(T)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(0, output->data(), output->size() * sizeof(T)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+}
+
+class CpuPackedWeightsTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        manager->setUseCpuOnly(true);
+    }
+
+    void TearDown() override { DeviceManager::get()->setUseCpuOnly(mWasCpuOnly); }
+
+   private:
+    bool mWasCpuOnly = false;
+};
+
+TEST_F(CpuPackedWeightsTest, PacksBatchMatmulRhs) {
+    WrapperModel wrapperModel;
+    createBatchMatmulModel(&wrapperModel, /*adjY=*/false);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto packedWeights = packWeights(wrapperModel, &model, &poolInfos);
+    EXPECT_TRUE(packedWeights->isFor(model, poolInfos));
+    EXPECT_EQ(packedWeights->getPackedCount(), 1u);
+    EXPECT_EQ(packedWeights->getPackedBytes(), 6 * sizeof(float));
+
+    std::vector<float> output(4);
+    compute(wrapperModel, std::vector<float>{1, 2, 3, 4, 5, 6}, &output);
+    EXPECT_EQ(output, (std::vector<float>{22, 28, 49, 64}));
+}
+
+TEST_F(CpuPackedWeightsTest, DoesNotPackAdjointBatchMatmulRhs) {
+    WrapperModel wrapperModel;
+    createBatchMatmulModel(&wrapperModel, /*adjY=*/true);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    EXPECT_EQ(packWeights(wrapperModel, &model, &poolInfos)->getPackedCount(), 0u);
+
+    std::vector<float> output(4);
+    compute(wrapperModel, std::vector<float>{1, 2, 3, 4, 5, 6}, &output);
+    EXPECT_EQ(output, (std::vector<float>{14, 32, 32, 77}));
+}
+
+TEST_F(CpuPackedWeightsTest, PacksQuant8SignedConvFilter) {
+    WrapperModel wrapperModel;
+    createConvModel(&wrapperModel, WrapperType::TENSOR_QUANT8_ASYMM_SIGNED);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto packedWeights = packWeights(wrapperModel, &model, &poolInfos);
+    EXPECT_EQ(packedWeights->getPackedCount(), 1u);
+    EXPECT_EQ(packedWeights->getPackedBytes(), 2u);
+
+    std::vector<int8_t> output(1);
+    compute(wrapperModel, std::vector<int8_t>{3, -2}, &output);
+    EXPECT_EQ(output[0], 3 * 2 - 2 * 5 + 1);
+}
+
+TEST_F(CpuPackedWeightsTest, PacksFloat16ConvFilterAndBias) {
+    WrapperModel wrapperModel;
+    createConvModel(&wrapperModel, WrapperType::TENSOR_FLOAT16);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto packedWeights = packWeights(wrapperModel, &model, &poolInfos);
+    EXPECT_EQ(packedWeights->getPackedCount(), 2u);
+    EXPECT_EQ(packedWeights->getPackedBytes(), 3 * sizeof(float));
+
+    std::vector<_Float16> output(1);
+    compute(wrapperModel, std::vector<_Float16>{3, -2}, &output);
+    EXPECT_EQ(static_cast<float>(output[0]), 3 * 2 - 2 * 5 + 1);
+}
+
+TEST_F(CpuPackedWeightsTest, PacksAliasedOperandsOfDifferentShapes) {
+    // The same values are the right-hand side [4, 6] of one BATCH_MATMUL, and [6, 4] of another.
+    constexpr uint32_t kRows = 4;
+    constexpr uint32_t kColumns = 6;
+    std::vector<float> rhs(kRows * kColumns);
+    std::iota(rhs.begin(), rhs.end(), 1.0f);
+    const size_t size = rhs.size() * sizeof(float);
+#ifdef __ANDROID__
+    const int fd = ASharedMemory_create("rhs", size);
+#else   // __ANDROID__
+    TemporaryFile tmpFile;
+    const int fd = tmpFile.release();
+    ASSERT_EQ(ftruncate(fd, size), 0);
+#endif  // __ANDROID__
+    ASSERT_GT(fd, -1);
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ASSERT_NE(data, MAP_FAILED);
+    std::memcpy(data, rhs.data(), size);
+    munmap(data, size);
+    WrapperMemory memory(size, PROT_READ, fd, 0);
+    close(fd);
+    ASSERT_TRUE(memory.isValid());
+
+    WrapperModel wrapperModel;
+    WrapperOperandType boolType(WrapperType::BOOL, {});
+    const uint32_t adj = wrapperModel.addConstantOperand(&boolType, false);
+    std::vector<uint32_t> inputs, outputs;
+    for (const auto& [rows, columns] : {std::pair(kRows, kColumns), std::pair(kColumns, kRows)}) {
+        WrapperOperandType lhsType(WrapperType::TENSOR_FLOAT32, {1, rows});
+        WrapperOperandType rhsType(WrapperType::TENSOR_FLOAT32, {rows, columns});
+        WrapperOperandType outputType(WrapperType::TENSOR_FLOAT32, {1, columns});
+        const uint32_t lhsOperand = wrapperModel.addOperand(&lhsType);
+        const uint32_t rhsOperand = wrapperModel.addOperand(&rhsType);
+        wrapperModel.setOperandValueFromMemory(rhsOperand, &memory, 0, size);
+        const uint32_t outputOperand = wrapperModel.addOperand(&outputType);
+        wrapperModel.addOperation(ANEURALNETWORKS_BATCH_MATMUL,
+                                  {lhsOperand, rhsOperand, adj, adj}, {outputOperand});
+        inputs.push_back(lhsOperand);
+        outputs.push_back(outputOperand);
+    }
+    wrapperModel.identifyInputsAndOutputs(inputs, outputs);
+    ASSERT_TRUE(wrapperModel.isValid());
+    ASSERT_EQ(wrapperModel.finish(), WrapperResult::NO_ERROR);
+
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    EXPECT_EQ(packWeights(wrapperModel, &model, &poolInfos)->getPackedCount(), 2u);
+
+    std::vector<float> lhsA(kRows), lhsB(kColumns);
+    std::iota(lhsA.begin(), lhsA.end(), 1.0f);
+    std::iota(lhsB.begin(), lhsB.end(), -2.0f);
+    std::vector<float> outputA(kColumns), outputB(kRows);
+    WrapperCompilation compilation(&wrapperModel);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    WrapperExecution execution(&compilation);
+    ASSERT_EQ(execution.setInput(0, lhsA.data(), lhsA.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setInput(1, lhsB.data(), lhsB.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(0, outputA.data(), outputA.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(1, outputB.data(), outputB.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+
+    // Each output is the row vector times the values read as a matrix of its own shape.
+    auto multiply = [&rhs](const std::vector<float>& lhs, uint32_t columns) {
+        std::vector<float> product(columns, 0.0f);
+        for (uint32_t r = 0; r < lhs.size(); ++r) {
+            for (uint32_t c = 0; c < columns; ++c) {
+                product[c] += lhs[r] * rhs[r * columns + c];
+            }
+        }
+        return product;
+    };
+    EXPECT_EQ(outputA, multiply(lhsA, kColumns));
+    EXPECT_EQ(outputB, multiply(lhsB, kRows));
+}
+
+TEST_F(CpuPackedWeightsTest, IsOnlyForItsModel) {
+    WrapperModel wrapperModel;
+    createBatchMatmulModel(&wrapperModel, /*adjY=*/false);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto packedWeights = packWeights(wrapperModel, &model, &poolInfos);
+    const Model otherModel = model;
+    EXPECT_FALSE(packedWeights->isFor(otherModel, poolInfos));
+}
+
+}  // namespace
+}  // namespace android::nn
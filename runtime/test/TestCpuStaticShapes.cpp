@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <CpuExecutor.h>
+#include <CpuStaticShapes.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+
+#include <memory>
+#include <vector>
+
+#include "Manager.h"
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// input [rows, 3] + bias [3], transposed by perm into output [3, rows]. If permIsInput is true,
+// perm is the second model input instead of a constant.
+void createAddTransposeModel(WrapperModel* model, uint32_t rows, bool permIsInput) {
+    static const float kBias[] = {1, 2, 3};
+    static const int32_t kPerm[] = {1, 0};
+    WrapperOperandType inputType(WrapperType::TENSOR_FLOAT32, {rows, 3});
+    WrapperOperandType biasType(WrapperType::TENSOR_FLOAT32, {3});
+    WrapperOperandType permType(WrapperType::TENSOR_INT32, {2});
+    WrapperOperandType outputType(WrapperType::TENSOR_FLOAT32, {3, rows});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = model->addOperand(&inputType);
+    const uint32_t bias = model->addOperand(&biasType);
+    model->setOperandValue(bias, kBias, sizeof(kBias));
+    const uint32_t activation = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t sum = model->addOperand(&inputType);
+    const uint32_t perm = model->addOperand(&permType);
+    if (!permIsInput) {
+        model->setOperandValue(perm, kPerm, sizeof(kPerm));
+    }
+    const uint32_t output = model->addOperand(&outputType);
+    model->addOperation(ANEURALNETWORKS_ADD, {input, bias, activation}, {sum});
+    model->addOperation(ANEURALNETWORKS_TRANSPOSE, {sum, perm}, {output});
+    if (permIsInput) {
+        model->identifyInputsAndOutputs({input, perm}, {output});
+    } else {
+        model->identifyInputsAndOutputs({input}, {output});
+    }
+    ASSERT_TRUE(model->isValid());
+    ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+}
+
+std::shared_ptr<const CpuStaticShapes> inferShapes(const WrapperModel& wrapperModel, Model* model,
+                                                   std::vector<RunTimePoolInfo>* poolInfos) {
+    *model = reinterpret_cast<const ModelBuilder*>(wrapperModel.getHandle())->makeModel();
+    EXPECT_TRUE(setRunTimePoolInfosFromCanonicalMemories(poolInfos, model->pools));
+    return CpuStaticShapes::create(*model, *poolInfos);
+}
+
+class CpuStaticShapesTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        manager->setUseCpuOnly(true);
+    }
+
+    void TearDown() override { DeviceManager::get()->setUseCpuOnly(mWasCpuOnly); }
+
+   private:
+    bool mWasCpuOnly = false;
+};
+
+TEST_F(CpuStaticShapesTest, InfersFullySpecifiedOperations) {
+    WrapperModel wrapperModel;
+    createAddTransposeModel(&wrapperModel, /*rows=*/2, /*permIsInput=*/false);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto shapes = inferShapes(wrapperModel, &model, &poolInfos);
+    EXPECT_TRUE(shapes->isFor(model));
+    EXPECT_EQ(shapes->getStaticOperationCount(), 2u);
+    EXPECT_TRUE(shapes->isStatic(model.main, 0));
+    EXPECT_TRUE(shapes->isStatic(model.main, 1));
+
+    WrapperCompilation compilation(&wrapperModel);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    const std::vector<float> input = {1, 2, 3, 4, 5, 6};
+    std::vector<float> output(6);
+    // Every execution reuses the shapes inferred when the model was prepared.
+    for (int i = 0; i < 2; ++i) {
+        WrapperExecution execution(&compilation);
+        ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        EXPECT_EQ(output, (std::vector<float>{2, 5, 4, 7, 6, 9}));
+    }
+}
+
+TEST_F(CpuStaticShapesTest, DoesNotInferUnspecifiedDimensions) {
+    WrapperModel wrapperModel;
+    createAddTransposeModel(&wrapperModel, /*rows=*/0, /*permIsInput=*/false);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    EXPECT_EQ(inferShapes(wrapperModel, &model, &poolInfos)->getStaticOperationCount(), 0u);
+
+    WrapperCompilation compilation(&wrapperModel);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    // The shapes are inferred on every execution, so they may differ between executions.
+    for (uint32_t rows : {1u, 2u}) {
+        WrapperOperandType inputType(WrapperType::TENSOR_FLOAT32, {rows, 3});
+        const std::vector<float> input(rows * 3, 1.0f);
+        std::vector<float> output(rows * 3);
+        WrapperExecution execution(&compilation);
+        ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(float),
+                                     &inputType.operandType),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+                  WrapperResult::NO_ERROR);
+        ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+        std::vector<uint32_t> dimensions;
+        ASSERT_EQ(execution.getOutputOperandDimensions(0, &dimensions), WrapperResult::NO_ERROR);
+        EXPECT_EQ(dimensions, (std::vector<uint32_t>{3, rows}));
+    }
+}
+
+// TRANSPOSE reads the permutation in prepare(), so its shapes cannot be inferred if the
+// permutation is a model input.
+TEST_F(CpuStaticShapesTest, DoesNotInferShapesFromInputValues) {
+    WrapperModel wrapperModel;
+    createAddTransposeModel(&wrapperModel, /*rows=*/2, /*permIsInput=*/true);
+    Model model;
+    std::vector<RunTimePoolInfo> poolInfos;
+    const auto shapes = inferShapes(wrapperModel, &model, &poolInfos);
+    EXPECT_EQ(shapes->getStaticOperationCount(), 1u);
+    EXPECT_TRUE(shapes->isStatic(model.main, 0));
+    EXPECT_FALSE(shapes->isStatic(model.main, 1));
+
+    WrapperCompilation compilation(&wrapperModel);
+    ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+    const std::vector<float> input = {1, 2, 3, 4, 5, 6};
+    const std::vector<int32_t> perm = {1, 0};
+    std::vector<float> output(6);
+    WrapperExecution execution(&compilation);
+    ASSERT_EQ(execution.setInput(0, input.data(), input.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setInput(1, perm.data(), perm.size() * sizeof(int32_t)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(0, output.data(), output.size() * sizeof(float)),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(execution.compute(), WrapperResult::NO_ERROR);
+    EXPECT_EQ(output, (std::vector<float>{2, 5, 4, 7, 6, 9}));
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -29,6 +29,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -69,6 +70,7 @@ class GeneratedTests : public GeneratedTestBase {
     bool shouldSkipTest();
 
     std::optional<Compilation> compileModel(const Model& model);
+    std::optional<Compilation> compileModelForDevice(const Model& model);
     void executeInternal(const Compilation& compilation, const TestModel& testModel,
                          bool testReusableExecution);
     void executeWithCompilation(const Compilation& compilation, const TestModel& testModel);
@@ -90,6 +92,9 @@ class GeneratedTests : public GeneratedTestBase {
     bool mTestDeviceMemory = false;
     bool mTestReusableExecution = true;
     Execution::ComputeMode mComputeMode = Execution::getComputeMode();
+    // If set, models are compiled for this device only, and models with operations the device
+    // does not support are skipped.
+    const ANeuralNetworksDevice* mDevice = nullptr;
 };
 
 int GeneratedTests::mVndkVersion = __ANDROID_API_FUTURE__;
@@ -125,8 +130,21 @@ class DeviceMemoryTest : public GeneratedTests {
     DeviceMemoryTest() { mTestDeviceMemory = true; }
 };
 
+#ifndef NNTEST_CTS
+// Runs the FLOAT16 and quantized models on the XNNPACK sample driver alone, so that every
+// operation it claims to support is checked against the expected results. Skipped if the driver
+// is not installed.
+class XnnpackGeneratedTest : public GeneratedTests {
+   protected:
+    void SetUp() override;
+};
+#endif  // NNTEST_CTS
+
 std::optional<Compilation> GeneratedTests::compileModel(const Model& model) {
     NNTRACE_APP(NNTRACE_PHASE_COMPILATION, "compileModel");
+    if (mDevice != nullptr) {
+        return compileModelForDevice(model);
+    }
     if (mTestCompilationCaching) {
         // Compile the model twice with the same token, so that compilation caching will be
         // exercised if supported by the driver.
@@ -152,6 +170,33 @@ std::optional<Compilation> GeneratedTests::compileModel(const Model& model) {
     }
 }
 
+std::optional<Compilation> GeneratedTests::compileModelForDevice(const Model& model) {
+    const size_t operationCount = testModel.main.operations.size();
+    std::unique_ptr<bool[]> supported(new bool[operationCount]);
+    EXPECT_EQ(ANeuralNetworksModel_getSupportedOperationsForDevices(model.getHandle(), &mDevice, 1,
+                                                                     supported.get()),
+              ANEURALNETWORKS_NO_ERROR);
+    if (!std::all_of(supported.get(), supported.get() + operationCount,
+                     [](bool isSupported) { return isSupported; })) {
+        return std::nullopt;
+    }
+
+    // Compile the model twice with the same token if compilation caching is tested, so that the
+    // second compilation is prepared from the cache.
+    const int compilationCount = mTestCompilationCaching ? 2 : 1;
+    std::optional<Compilation> compilation;
+    for (int i = 0; i < compilationCount; i++) {
+        auto [result, newCompilation] = Compilation::createForDevice(&model, mDevice);
+        EXPECT_EQ(result, Result::NO_ERROR);
+        if (mTestCompilationCaching) {
+            EXPECT_EQ(newCompilation.setCaching(mCacheDir, mToken), Result::NO_ERROR);
+        }
+        EXPECT_EQ(newCompilation.finish(), Result::NO_ERROR);
+        compilation = std::move(newCompilation);
+    }
+    return compilation;
+}
+
 static ANeuralNetworksMemory* createDeviceMemoryForInput(const Compilation& compilation,
                                                          uint32_t index) {
     ANeuralNetworksMemoryDesc* desc = nullptr;
@@ -493,6 +538,29 @@ void GeneratedTests::TearDown() {
     GeneratedTestBase::TearDown();
 }
 
+#ifndef NNTEST_CTS
+void XnnpackGeneratedTest::SetUp() {
+    GeneratedTests::SetUp();
+    if (IsSkipped()) {
+        return;
+    }
+    constexpr std::string_view kXnnpackDeviceName = "nnapi-sample_float_xnnpack";
+    uint32_t deviceCount = 0;
+    ASSERT_EQ(ANeuralNetworks_getDeviceCount(&deviceCount), ANEURALNETWORKS_NO_ERROR);
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        ANeuralNetworksDevice* device = nullptr;
+        const char* name = nullptr;
+        ASSERT_EQ(ANeuralNetworks_getDevice(i, &device), ANEURALNETWORKS_NO_ERROR);
+        ASSERT_EQ(ANeuralNetworksDevice_getName(device, &name), ANEURALNETWORKS_NO_ERROR);
+        if (name == kXnnpackDeviceName) {
+            mDevice = device;
+            return;
+        }
+    }
+    GTEST_SKIP() << kXnnpackDeviceName << " is not available";
+}
+#endif  // NNTEST_CTS
+
 #ifdef NNTEST_COMPUTE_MODE
 TEST_P(GeneratedTests, Sync) {
     mComputeMode = Execution::ComputeMode::SYNC;
@@ -535,6 +603,12 @@ TEST_P(FencedComputeTest, Test) {
     execute(testModel);
 }
 
+#ifndef NNTEST_CTS
+TEST_P(XnnpackGeneratedTest, Test) {
+    execute(testModel);
+}
+#endif  // NNTEST_CTS
+
 INSTANTIATE_GENERATED_TEST(GeneratedTests,
                            [](const TestModel& testModel) { return !testModel.expectFailure; });
 
@@ -567,4 +641,23 @@ INSTANTIATE_GENERATED_TEST(FencedComputeTest, [](const TestModel& testModel) {
                        });
 });
 
+#ifndef NNTEST_CTS
+INSTANTIATE_GENERATED_TEST(XnnpackGeneratedTest, [](const TestModel& testModel) {
+    const auto isFloat16OrQuant8 = [](const TestOperand& operand) {
+        switch (operand.type) {
+            case TestOperandType::TENSOR_FLOAT16:
+            case TestOperandType::TENSOR_QUANT8_ASYMM:
+            case TestOperandType::TENSOR_QUANT8_ASYMM_SIGNED:
+            case TestOperandType::TENSOR_QUANT8_SYMM_PER_CHANNEL:
+                return true;
+            default:
+                return false;
+        }
+    };
+    return !testModel.expectFailure && testModel.referenced.empty() &&
+           std::any_of(testModel.main.operands.begin(), testModel.main.operands.end(),
+                       isFloat16OrQuant8);
+});
+#endif  // NNTEST_CTS
+
 }  // namespace android::nn::generated_tests
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <SampleDriverPartial.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "CompilationBuilder.h"
+#include "ExecutionPlan.h"
+#include "HalUtils.h"
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using sample_driver::SampleDriverPartial;
+using Result = test_wrapper::Result;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperType = test_wrapper::Type;
+using WrapperModel = test_wrapper::Model;
+
+const char* kTestDriverName = "nnapi-test-add";
+
+// A driver that only supports ADD, so that the runtime interprets any WHILE loop around it.
+class AddTestDriver : public SampleDriverPartial {
+   public:
+    AddTestDriver() : SampleDriverPartial(kTestDriverName) {}
+
+    hardware::Return<void> getCapabilities_1_3(getCapabilities_1_3_cb cb) override {
+        cb(V1_3::ErrorStatus::NONE, makeCapabilities(0.1));  // Faster than CPU.
+        return hardware::Void();
+    }
+
+   private:
+    std::vector<bool> getSupportedOperationsImpl(const V1_3::Model& model) const override {
+        std::vector<bool> supported(model.main.operations.size());
+        std::transform(model.main.operations.begin(), model.main.operations.end(),
+                       supported.begin(), [](const V1_3::Operation& operation) {
+                           return operation.type == V1_3::OperationType::ADD;
+                       });
+        return supported;
+    }
+};
+
+// The condition and body models double a tensor x of two elements n times:
+//
+// i = 0
+// while i < n:
+//     i = i + 1
+//     x = x + x
+class InterpretedWhileTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* deviceManager = DeviceManager::get();
+        if (deviceManager->getUseCpuOnly() ||
+            !DeviceManager::partitioningAllowsFallback(deviceManager->getPartitioning())) {
+            GTEST_SKIP();
+        }
+        deviceManager->forTest_setDevices({
+                DeviceManager::forTest_makeDriverDevice(
+                        makeSharedDevice(kTestDriverName, new AddTestDriver())),
+                DeviceManager::getCpuDevice(),
+        });
+
+        WrapperOperandType floatType(WrapperType::TENSOR_FLOAT32, {2});
+        WrapperOperandType counterType(WrapperType::TENSOR_FLOAT32, {1});
+        WrapperOperandType boolType(WrapperType::TENSOR_BOOL8, {1});
+        WrapperOperandType activationType(WrapperType::INT32, {});
+        {
+            uint32_t i = mConditionModel.addOperand(&counterType);
+            uint32_t x = mConditionModel.addOperand(&floatType);
+            uint32_t n = mConditionModel.addOperand(&counterType);
+            uint32_t out = mConditionModel.addOperand(&boolType);
+            mConditionModel.addOperation(ANEURALNETWORKS_LESS, {i, n}, {out});
+            mConditionModel.identifyInputsAndOutputs({i, x, n}, {out});
+            ASSERT_EQ(mConditionModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mConditionModel.isValid());
+        }
+        {
+            uint32_t i = mBodyModel.addOperand(&counterType);
+            uint32_t x = mBodyModel.addOperand(&floatType);
+            uint32_t n = mBodyModel.addOperand(&counterType);
+            uint32_t one = mBodyModel.addConstantOperand(&counterType, 1.0f);
+            uint32_t noActivation =
+                    mBodyModel.addConstantOperand(&activationType, ANEURALNETWORKS_FUSED_NONE);
+            uint32_t iOut = mBodyModel.addOperand(&counterType);
+            uint32_t xOut = mBodyModel.addOperand(&floatType);
+            mBodyModel.addOperation(ANEURALNETWORKS_ADD, {i, one, noActivation}, {iOut});
+            mBodyModel.addOperation(ANEURALNETWORKS_ADD, {x, x, noActivation}, {xOut});
+            mBodyModel.identifyInputsAndOutputs({i, x, n}, {iOut, xOut});
+            ASSERT_EQ(mBodyModel.finish(), Result::NO_ERROR);
+            ASSERT_TRUE(mBodyModel.isValid());
+        }
+    }
+
+    void TearDown() override { DeviceManager::get()->forTest_reInitializeDeviceList(); }
+
+    WrapperModel mConditionModel;
+    WrapperModel mBodyModel;
+};
+
+// The outer output t of the first loop is the outer input of the second one, and is read again
+// after the second loop has run. Both loops reference the same condition and body models.
+//
+// Model:
+//     t = double x n times
+//     y = double t n times
+//     output = t + y
+TEST_F(InterpretedWhileTest, OutputIsAlsoInputOfAnotherLoop) {
+    WrapperOperandType floatType(WrapperType::TENSOR_FLOAT32, {2});
+    WrapperOperandType counterType(WrapperType::TENSOR_FLOAT32, {1});
+    WrapperOperandType activationType(WrapperType::INT32, {});
+
+    WrapperModel model;
+    {
+        uint32_t x = model.addOperand(&floatType);
+        uint32_t n = model.addOperand(&counterType);
+        uint32_t iInit = model.addConstantOperand(&counterType, 0.0f);
+        uint32_t noActivation =
+                model.addConstantOperand(&activationType, ANEURALNETWORKS_FUSED_NONE);
+        uint32_t cond = model.addModelOperand(&mConditionModel);
+        uint32_t body = model.addModelOperand(&mBodyModel);
+        uint32_t tCounter = model.addOperand(&counterType);
+        uint32_t t = model.addOperand(&floatType);
+        uint32_t yCounter = model.addOperand(&counterType);
+        uint32_t y = model.addOperand(&floatType);
+        uint32_t output = model.addOperand(&floatType);
+        model.addOperation(ANEURALNETWORKS_WHILE, {cond, body, iInit, x, n}, {tCounter, t});
+        model.addOperation(ANEURALNETWORKS_WHILE, {cond, body, iInit, t, n}, {yCounter, y});
+        model.addOperation(ANEURALNETWORKS_ADD, {t, y, noActivation}, {output});
+        model.identifyInputsAndOutputs({x, n}, {output});
+        ASSERT_TRUE(model.isValid());
+        ASSERT_EQ(model.finish(), Result::NO_ERROR);
+    }
+
+    WrapperCompilation compilation(&model);
+    ASSERT_EQ(compilation.finish(), Result::NO_ERROR);
+
+    const CompilationBuilder* compilationBuilder =
+            reinterpret_cast<CompilationBuilder*>(compilation.getHandle());
+    const ExecutionPlan& plan = compilationBuilder->forTest_getExecutionPlan();
+    ASSERT_FALSE(plan.isSimple());
+    const std::vector<std::shared_ptr<LogicalStep>>& steps = plan.forTest_compoundGetSteps();
+    ASSERT_EQ(std::count_if(steps.begin(), steps.end(),
+                            [](const auto& step) { return step->isWhile(); }),
+              2);
+
+    // An execution that aliases the loop outputs is followed by one that runs the loops zero
+    // times, which copies them instead.
+    const float x[] = {1, 3};
+    for (const float n : {2.0f, 0.0f, 3.0f, 1.0f}) {
+        SCOPED_TRACE(n);
+        const float scale = 1 << static_cast<int>(n);
+        float output[] = {0, 0};
+        WrapperExecution execution(&compilation);
+        ASSERT_EQ(execution.setInput(0, &x), Result::NO_ERROR);
+        ASSERT_EQ(execution.setInput(1, &n), Result::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, &output), Result::NO_ERROR);
+        ASSERT_EQ(execution.compute(), Result::NO_ERROR);
+        EXPECT_EQ(output[0], x[0] * scale * (1 + scale));
+        EXPECT_EQ(output[1], x[1] * scale * (1 + scale));
+    }
+}
+
+// Model:
+//     t = double x n times
+//     output = t + x
+TEST_F(InterpretedWhileTest, ZeroIterations) {
+    WrapperOperandType floatType(WrapperType::TENSOR_FLOAT32, {2});
+    WrapperOperandType counterType(WrapperType::TENSOR_FLOAT32, {1});
+    WrapperOperandType activationType(WrapperType::INT32, {});
+
+    WrapperModel model;
+    {
+        uint32_t x = model.addOperand(&floatType);
+        uint32_t n = model.addOperand(&counterType);
+        uint32_t iInit = model.addConstantOperand(&counterType, 0.0f);
+        uint32_t noActivation =
+                model.addConstantOperand(&activationType, ANEURALNETWORKS_FUSED_NONE);
+        uint32_t cond = model.addModelOperand(&mConditionModel);
+        uint32_t body = model.addModelOperand(&mBodyModel);
+        uint32_t tCounter = model.addOperand(&counterType);
+        uint32_t t = model.addOperand(&floatType);
+        uint32_t output = model.addOperand(&floatType);
+        model.addOperation(ANEURALNETWORKS_WHILE, {cond, body, iInit, x, n}, {tCounter, t});
+        model.addOperation(ANEURALNETWORKS_ADD, {t, x, noActivation}, {output});
+        model.identifyInputsAndOutputs({x, n}, {output});
+        ASSERT_TRUE(model.isValid());
+        ASSERT_EQ(model.finish(), Result::NO_ERROR);
+    }
+
+    WrapperCompilation compilation(&model);
+    ASSERT_EQ(compilation.finish(), Result::NO_ERROR);
+    ASSERT_FALSE(reinterpret_cast<CompilationBuilder*>(compilation.getHandle())
+                         ->forTest_getExecutionPlan()
+                         .isSimple());
+
+    // The loop output is a copy of the loop input, which must stay untouched.
+    const float x[] = {1, 3};
+    const float n = 0;
+    float output[] = {0, 0};
+    WrapperExecution execution(&compilation);
+    ASSERT_EQ(execution.setInput(0, &x), Result::NO_ERROR);
+    ASSERT_EQ(execution.setInput(1, &n), Result::NO_ERROR);
+    ASSERT_EQ(execution.setOutput(0, &output), Result::NO_ERROR);
+    ASSERT_EQ(execution.compute(), Result::NO_ERROR);
+    EXPECT_EQ(output[0], 2);
+    EXPECT_EQ(output[1], 6);
+}
+
+}  // namespace
+}  // namespace android::nn
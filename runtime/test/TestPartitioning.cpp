@@ -22,6 +22,8 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <functional>
 #include <iostream>
@@ -31,6 +33,7 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -170,6 +173,7 @@ using ModelBuilder = ::android::nn::ModelBuilder;
 using Operand = ::android::nn::Operand;
 using Operation = ::android::nn::Operation;
 using OptionalTimePoint = ::android::nn::OptionalTimePoint;
+using Priority = ::android::nn::Priority;
 using Result = ::android::nn::test_wrapper::Result;
 using SampleDriver = ::android::nn::sample_driver::SampleDriver;
 using SharedDevice = ::android::nn::SharedDevice;
@@ -3699,4 +3703,68 @@ TEST_F(MemoryStepRoleTest, NestedInterpretedControlFlow) {
                                                                 {"deviceC", IOType::OUTPUT}});
 }
 
+// Tests of the concurrent compilation of the step models of a compound plan.
+
+TEST(CompileConcurrentlyTest, CompilesEveryStepOnce) {
+    constexpr uint32_t kCount = 32;
+    std::vector<std::atomic<uint32_t>> calls(kCount);
+    const int n = ::android::nn::compileConcurrently(
+            kCount,
+            [&calls](uint32_t i) {
+                ++calls[i];
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                return ANEURALNETWORKS_NO_ERROR;
+            },
+            Priority::MEDIUM);
+    EXPECT_EQ(n, ANEURALNETWORKS_NO_ERROR);
+    for (uint32_t i = 0; i < kCount; ++i) {
+        EXPECT_EQ(calls[i].load(), 1u) << "step " << i;
+    }
+}
+
+TEST(CompileConcurrentlyTest, StopsStartingStepsAfterFailure) {
+    constexpr uint32_t kCount = 64;
+    std::atomic<uint32_t> callCount = 0;
+    const int n = ::android::nn::compileConcurrently(
+            kCount,
+            [&callCount](uint32_t i) {
+                ++callCount;
+                if (i == 0) {
+                    return ANEURALNETWORKS_BAD_DATA;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                return ANEURALNETWORKS_NO_ERROR;
+            },
+            Priority::MEDIUM);
+    EXPECT_EQ(n, ANEURALNETWORKS_BAD_DATA);
+    // Only the steps handed out before step 0 failed may run: at most one per compiling thread.
+    EXPECT_LT(callCount.load(), kCount / 4);
+}
+
+TEST(CompileConcurrentlyTest, ReportsFailureOfLowestStep) {
+    constexpr uint32_t kCount = 16;
+    for (int attempt = 0; attempt < 10; ++attempt) {
+        std::atomic<bool> ranStep3 = false;
+        const int n = ::android::nn::compileConcurrently(
+                kCount,
+                [&ranStep3](uint32_t i) {
+                    switch (i) {
+                        case 3:
+                            // Fails after the higher steps, which must not hide its error.
+                            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                            ranStep3 = true;
+                            return ANEURALNETWORKS_OP_FAILED;
+                        case 5:
+                        case 9:
+                            return ANEURALNETWORKS_BAD_DATA;
+                        default:
+                            return ANEURALNETWORKS_NO_ERROR;
+                    }
+                },
+                Priority::MEDIUM);
+        EXPECT_TRUE(ranStep3.load());
+        EXPECT_EQ(n, ANEURALNETWORKS_OP_FAILED) << "attempt " << attempt;
+    }
+}
+
 }  // namespace
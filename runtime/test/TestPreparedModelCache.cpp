@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "CompilationBuilder.h"
+#include "ExecutionPlan.h"
+#include "Manager.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+class PreparedModelCacheTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        DeviceManager* manager = DeviceManager::get();
+        mWasCpuOnly = manager->getUseCpuOnly();
+        mWasDeduplicating = manager->deduplicatePreparedModels();
+        manager->setUseCpuOnly(true);
+        manager->setDeduplicatePreparedModels(true);
+    }
+
+    void TearDown() override {
+        DeviceManager* manager = DeviceManager::get();
+        manager->setUseCpuOnly(mWasCpuOnly);
+        manager->setDeduplicatePreparedModels(mWasDeduplicating);
+    }
+
+    // Creates the model output = input + addend, where addend is a constant.
+    static void createModel(float addend, WrapperModel* model) {
+        WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {1});
+        WrapperOperandType scalarType(WrapperType::INT32, {});
+        const float addendValue[] = {addend};
+        const int32_t activation = ANEURALNETWORKS_FUSED_NONE;
+        uint32_t input = model->addOperand(&tensorType);
+        uint32_t constant = model->addOperand(&tensorType);
+        uint32_t act = model->addOperand(&scalarType);
+        uint32_t output = model->addOperand(&tensorType);
+        model->setOperandValue(constant, addendValue, sizeof(addendValue));
+        model->setOperandValue(act, &activation, sizeof(activation));
+        model->addOperation(ANEURALNETWORKS_ADD, {input, constant, act}, {output});
+        model->identifyInputsAndOutputs({input}, {output});
+        ASSERT_TRUE(model->isValid());
+        ASSERT_EQ(model->finish(), WrapperResult::NO_ERROR);
+    }
+
+    static std::shared_ptr<RuntimePreparedModel> getPreparedModel(
+            const WrapperCompilation& compilation) {
+        const CompilationBuilder* compilationBuilder =
+                reinterpret_cast<CompilationBuilder*>(compilation.getHandle());
+        const ExecutionPlan& plan = compilationBuilder->forTest_getExecutionPlan();
+        EXPECT_TRUE(plan.isSimple());
+        return plan.forTest_simpleGetPreparedModel();
+    }
+
+   private:
+    bool mWasCpuOnly = false;
+    bool mWasDeduplicating = false;
+};
+
+TEST_F(PreparedModelCacheTest, SameModelSharesPreparedModel) {
+    WrapperModel model1, model2;
+    createModel(1.0f, &model1);
+    createModel(1.0f, &model2);
+    WrapperCompilation compilation1(&model1), compilation2(&model2);
+    ASSERT_EQ(compilation1.finish(), WrapperResult::NO_ERROR);
+    ASSERT_EQ(compilation2.finish(), WrapperResult::NO_ERROR);
+    EXPECT_EQ(getPreparedModel(compilation1), getPreparedModel(compilation2));
+}
+
+TEST_F(PreparedModelCacheTest, DifferentWeightsDoNotShare) {
+    WrapperModel model1, model2;
+    createModel(1.0f, &model1);
+    createModel(2.0f, &model2);
+    WrapperCompilation compilation1(&model1), compilation2(&model2);
+    ASSERT_EQ(compilation1.finish(), WrapperResult::NO_ERROR);
+    ASSERT_EQ(compilation2.finish(), WrapperResult::NO_ERROR);
+    EXPECT_NE(getPreparedModel(compilation1), getPreparedModel(compilation2));
+}
+
+TEST_F(PreparedModelCacheTest, DifferentPreferenceDoesNotShare) {
+    WrapperModel model;
+    createModel(1.0f, &model);
+    WrapperCompilation compilation1(&model), compilation2(&model);
+    ASSERT_EQ(compilation2.setPreference(test_wrapper::ExecutePreference::PREFER_LOW_POWER),
+              WrapperResult::NO_ERROR);
+    ASSERT_EQ(compilation1.finish(), WrapperResult::NO_ERROR);
+    ASSERT_EQ(compilation2.finish(), WrapperResult::NO_ERROR);
+    EXPECT_NE(getPreparedModel(compilation1), getPreparedModel(compilation2));
+}
+
+TEST_F(PreparedModelCacheTest, Disabled) {
+    DeviceManager::get()->setDeduplicatePreparedModels(false);
+    WrapperModel model;
+    createModel(1.0f, &model);
+    WrapperCompilation compilation1(&model), compilation2(&model);
+    ASSERT_EQ(compilation1.finish(), WrapperResult::NO_ERROR);
+    ASSERT_EQ(compilation2.finish(), WrapperResult::NO_ERROR);
+    EXPECT_NE(getPreparedModel(compilation1), getPreparedModel(compilation2));
+}
+
+TEST_F(PreparedModelCacheTest, ReleasedWithLastCompilation) {
+    WrapperModel model;
+    createModel(1.0f, &model);
+    std::weak_ptr<RuntimePreparedModel> preparedModel;
+    {
+        WrapperCompilation compilation(&model);
+        ASSERT_EQ(compilation.finish(), WrapperResult::NO_ERROR);
+        preparedModel = getPreparedModel(compilation);
+        ASSERT_FALSE(preparedModel.expired());
+    }
+    EXPECT_TRUE(preparedModel.expired());
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <PriorityThreadPool.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace android::nn {
+namespace {
+
+// Occupies a worker of the pool until released.
+class Blocker {
+   public:
+    explicit Blocker(PriorityThreadPool* pool) {
+        auto started = std::make_shared<std::promise<void>>();
+        std::future<void> startedFuture = started->get_future();
+        std::shared_future<void> released = mReleased.get_future().share();
+        // The task only uses shared state, as it may still run after the blocker is destroyed.
+        pool->schedule(Priority::HIGH, [started, released] {
+            started->set_value();
+            released.wait();
+        });
+        startedFuture.wait();
+    }
+    void release() { mReleased.set_value(); }
+
+   private:
+    std::promise<void> mReleased;
+};
+
+TEST(PriorityThreadPoolTest, RunsAllTasks) {
+    std::atomic<int> count = 0;
+    {
+        PriorityThreadPool pool(/*maxThreads=*/4, /*maxQueuedTasks=*/8);
+        for (int i = 0; i < 100; i++) {
+            pool.schedule(Priority::MEDIUM, [&count] { count++; });
+        }
+    }
+    EXPECT_EQ(count, 100);
+}
+
+TEST(PriorityThreadPoolTest, RunsHigherPriorityFirst) {
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&mutex, &order](int task) {
+        return [&mutex, &order, task] {
+            std::lock_guard<std::mutex> guard(mutex);
+            order.push_back(task);
+        };
+    };
+    {
+        PriorityThreadPool pool(/*maxThreads=*/1, /*maxQueuedTasks=*/8);
+        Blocker blocker(&pool);
+        pool.schedule(Priority::LOW, record(0));
+        pool.schedule(Priority::MEDIUM, record(1));
+        pool.schedule(Priority::HIGH, record(2));
+        pool.schedule(Priority::LOW, record(3));
+        pool.schedule(Priority::HIGH, record(4));
+        blocker.release();
+    }
+    EXPECT_EQ(order, (std::vector<int>{2, 4, 1, 0, 3}));
+}
+
+TEST(PriorityThreadPoolTest, BlocksWhenQueueIsFull) {
+    PriorityThreadPool pool(/*maxThreads=*/1, /*maxQueuedTasks=*/1);
+    Blocker blocker(&pool);
+    pool.schedule(Priority::MEDIUM, [] {});
+
+    std::atomic<bool> scheduled = false;
+    std::thread client([&pool, &scheduled] {
+        pool.schedule(Priority::MEDIUM, [] {});
+        scheduled = true;
+    });
+    while (pool.getStats().blockedSchedules == 0) {
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(scheduled);
+
+    blocker.release();
+    client.join();
+    EXPECT_TRUE(scheduled);
+}
+
+TEST(PriorityThreadPoolTest, RecordsQueueTime) {
+    constexpr auto kDelay = std::chrono::milliseconds(10);
+    PriorityThreadPool pool(/*maxThreads=*/1, /*maxQueuedTasks=*/8);
+    Blocker blocker(&pool);
+    pool.schedule(Priority::MEDIUM, [] {});
+    std::this_thread::sleep_for(kDelay);
+    blocker.release();
+    while (pool.getStats().completedTasks < 2) {
+        std::this_thread::yield();
+    }
+
+    const PriorityThreadPool::Stats stats = pool.getStats();
+    EXPECT_GE(stats.maxQueueTime, kDelay);
+    EXPECT_GE(stats.totalQueueTime, stats.maxQueueTime);
+}
+
+TEST(PriorityThreadPoolTest, RunsEarliestDeadlineFirst) {
+    std::mutex mutex;
+    std::vector<int> order;
+    auto record = [&mutex, &order](int task) {
+        return [&mutex, &order, task] {
+            std::lock_guard<std::mutex> guard(mutex);
+            order.push_back(task);
+        };
+    };
+    const TimePoint now = Clock::now();
+    const auto deadline = [now](int seconds) -> OptionalTimePoint {
+        return now + std::chrono::seconds(seconds);
+    };
+    {
+        PriorityThreadPool pool(/*maxThreads=*/1, /*maxQueuedTasks=*/8);
+        Blocker blocker(&pool);
+        pool.schedule(Priority::MEDIUM, record(0));
+        pool.schedule(Priority::MEDIUM, deadline(30), record(1), [] {});
+        pool.schedule(Priority::MEDIUM, deadline(10), record(2), [] {});
+        pool.schedule(Priority::MEDIUM, record(3));
+        pool.schedule(Priority::MEDIUM, deadline(20), record(4), [] {});
+        pool.schedule(Priority::HIGH, deadline(40), record(5), [] {});
+        blocker.release();
+    }
+    EXPECT_EQ(order, (std::vector<int>{5, 2, 4, 1, 0, 3}));
+}
+
+TEST(PriorityThreadPoolTest, DropsTaskThatMissedItsDeadline) {
+    std::atomic<bool> ran = false;
+    std::atomic<bool> dropped = false;
+    PriorityThreadPool pool(/*maxThreads=*/1, /*maxQueuedTasks=*/8);
+    {
+        Blocker blocker(&pool);
+        pool.schedule(
+                Priority::HIGH, Clock::now() + std::chrono::milliseconds(1), [&ran] { ran = true; },
+                [&dropped] { dropped = true; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        blocker.release();
+    }
+    while (pool.getStats().droppedTasks == 0) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_FALSE(ran);
+    EXPECT_TRUE(dropped);
+    EXPECT_EQ(pool.getStats().droppedTasks, 1u);
+}
+
+TEST(PriorityThreadPoolTest, PrintsMeanQueueTime) {
+    PriorityThreadPool::Stats stats;
+    stats.completedTasks = 3;
+    stats.droppedTasks = 1;
+    stats.totalQueueTime = std::chrono::nanoseconds(100);
+    stats.maxQueueTime = std::chrono::nanoseconds(70);
+    std::ostringstream os;
+    os << stats;
+    EXPECT_EQ(os.str(),
+              "{.completedTasks=3, .droppedTasks=1, .lateTasks=0, .blockedSchedules=0, "
+              ".meanQueueTime=25ns, .maxQueueTime=70ns}");
+}
+
+TEST(PriorityThreadPoolTest, DriverThreadPoolIsShared) {
+    EXPECT_NE(getDriverThreadPool(), nullptr);
+    EXPECT_EQ(getDriverThreadPool(), getDriverThreadPool());
+}
+
+}  // namespace
+}  // namespace android::nn
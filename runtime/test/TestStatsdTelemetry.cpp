@@ -26,7 +26,7 @@
 namespace android::nn::telemetry {
 
 constexpr auto kNoTiming = std::numeric_limits<uint64_t>::max();
-constexpr auto kNoAggregateTiming = AtomValue::AccumulatedTiming{};
+const auto kNoAggregateTiming = AtomValue::AccumulatedTiming{};
 constexpr ModelArchHash kExampleModelArchHash = {1, 2, 3};
 constexpr const char* kExampleDeviceId = "driver1=version1,driver2=version2";
 constexpr auto kLongTime = std::chrono::seconds(60 * 60 * 24);
@@ -127,6 +127,20 @@ TEST(StatsdTelemetryTest, CombineAtomValues) {
     EXPECT_EQ(value1, valueResult);
 }
 
+TEST(StatsdTelemetryTest, CombineAtomValuesMergesHistograms) {
+    AtomValue value1 = {.count = 2};
+    value1.durationRuntimeMicros.histogram.record(10);
+    value1.durationRuntimeMicros.histogram.record(1000);
+    AtomValue value2 = {.count = 1};
+    value2.durationRuntimeMicros.histogram.record(10);
+
+    combineAtomValues(&value1, value2);
+    const auto& histogram = value1.durationRuntimeMicros.histogram;
+    EXPECT_EQ(histogram.count(), 3);
+    EXPECT_EQ(histogram.getQuantile(0.5), 10);
+    EXPECT_NEAR(histogram.getQuantile(1.0), 1000, 1000 / 16);
+}
+
 TEST(StatsdTelemetryTest, CombineAtomValueWithLeftIdentity) {
     AtomValue value1 = {};
     const AtomValue value2 = {
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <LegacyUtils.h>
+#include <android-base/scopeguard.h>
+#include <android-base/unique_fd.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "SwSyncTimeline.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperCompilation = test_wrapper::Compilation;
+using WrapperEvent = test_wrapper::Event;
+using WrapperExecution = test_wrapper::Execution;
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+class SwSyncTimelineTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        mTimeline = SwSyncTimeline::create();
+        if (mTimeline == nullptr) {
+            GTEST_SKIP() << "sw_sync is not available";
+        }
+    }
+
+    std::unique_ptr<SwSyncTimeline> mTimeline;
+};
+
+TEST_F(SwSyncTimelineTest, FenceSignalsWhenTimelineAdvances) {
+    const base::unique_fd first = mTimeline->createFence(1);
+    const base::unique_fd second = mTimeline->createFence(2);
+    ASSERT_TRUE(first.ok());
+    ASSERT_TRUE(second.ok());
+    EXPECT_EQ(syncWait(first.get(), 0), FenceState::ACTIVE);
+
+    ASSERT_TRUE(mTimeline->advance(1));
+    EXPECT_EQ(syncWait(first.get(), 0), FenceState::SIGNALED);
+    EXPECT_EQ(syncWait(second.get(), 0), FenceState::ACTIVE);
+
+    ASSERT_TRUE(mTimeline->advance(1));
+    EXPECT_EQ(syncWait(second.get(), 0), FenceState::SIGNALED);
+}
+
+TEST_F(SwSyncTimelineTest, DestroyingTimelineSignalsError) {
+    const base::unique_fd fence = mTimeline->createFence(1);
+    ASSERT_TRUE(fence.ok());
+
+    mTimeline.reset();
+    EXPECT_EQ(syncWaitWithStatus(fence.get(), 0), FenceState::ERROR);
+}
+
+TEST_F(SwSyncTimelineTest, SyncWaitReportsErrorSignaledFenceAsSignaled) {
+    const base::unique_fd fence = mTimeline->createFence(1);
+    ASSERT_TRUE(fence.ok());
+    EXPECT_EQ(syncWaitWithStatus(fence.get(), 0), FenceState::ACTIVE);
+
+    // Drivers wait for their input fences with syncWait, which only reports that the fence has
+    // signaled.
+    mTimeline.reset();
+    EXPECT_EQ(syncWait(fence.get(), 0), FenceState::SIGNALED);
+}
+
+TEST_F(SwSyncTimelineTest, SyncWaitWithStatusReportsSuccessfulFenceAsSignaled) {
+    const base::unique_fd fence = mTimeline->createFence(1);
+    ASSERT_TRUE(fence.ok());
+
+    ASSERT_TRUE(mTimeline->advance(1));
+    mTimeline.reset();
+    EXPECT_EQ(syncWaitWithStatus(fence.get(), 0), FenceState::SIGNALED);
+}
+
+// Runs fenced executions of an ADD model on the NNAPI CPU reference implementation, which
+// signals the fences it returns through a SwSyncTimeline when sw_sync is available.
+class CpuFencedExecutionTest : public ::testing::Test {
+   protected:
+    void SetUp() override;
+
+    // Starts an execution that adds kInput to itself into mOutput once the dependencies signal.
+    WrapperResult startCompute(const std::vector<const WrapperEvent*>& dependencies,
+                               WrapperEvent* event);
+
+    static constexpr float kInput[] = {1.0f, 2.0f, 3.0f, 4.0f};
+    static constexpr float kExpectedOutput[] = {2.0f, 4.0f, 6.0f, 8.0f};
+
+    WrapperModel mModel;
+    WrapperCompilation mCompilation;
+    std::unique_ptr<WrapperExecution> mExecution;
+    float mOutput[std::size(kInput)] = {};
+};
+
+void CpuFencedExecutionTest::SetUp() {
+    uint32_t numDevices = 0;
+    ASSERT_EQ(ANeuralNetworks_getDeviceCount(&numDevices), ANEURALNETWORKS_NO_ERROR);
+    const ANeuralNetworksDevice* cpuDevice = nullptr;
+    for (uint32_t i = 0; i < numDevices && cpuDevice == nullptr; ++i) {
+        ANeuralNetworksDevice* device = nullptr;
+        const char* name = nullptr;
+        ASSERT_EQ(ANeuralNetworks_getDevice(i, &device), ANEURALNETWORKS_NO_ERROR);
+        ASSERT_EQ(ANeuralNetworksDevice_getName(device, &name), ANEURALNETWORKS_NO_ERROR);
+        if (std::string_view(name) == "nnapi-reference") {
+            cpuDevice = device;
+        }
+    }
+    ASSERT_NE(cpuDevice, nullptr);
+
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {std::size(kInput)});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const uint32_t input = mModel.addOperand(&tensorType);
+    const int32_t fuseCode = ANEURALNETWORKS_FUSED_NONE;
+    const uint32_t activation = mModel.addConstantOperand(&scalarType, fuseCode);
+    const uint32_t output = mModel.addOperand(&tensorType);
+    mModel.addOperation(ANEURALNETWORKS_ADD, {input, input, activation}, {output});
+    mModel.identifyInputsAndOutputs({input}, {output});
+    ASSERT_EQ(mModel.finish(), WrapperResult::NO_ERROR);
+
+    auto [result, compilation] = WrapperCompilation::createForDevice(&mModel, cpuDevice);
+    ASSERT_EQ(result, WrapperResult::NO_ERROR);
+    mCompilation = std::move(compilation);
+    ASSERT_EQ(mCompilation.finish(), WrapperResult::NO_ERROR);
+}
+
+WrapperResult CpuFencedExecutionTest::startCompute(
+        const std::vector<const WrapperEvent*>& dependencies, WrapperEvent* event) {
+    mExecution = std::make_unique<WrapperExecution>(&mCompilation);
+    EXPECT_EQ(mExecution->setInput(0, kInput, sizeof(kInput)), WrapperResult::NO_ERROR);
+    EXPECT_EQ(mExecution->setOutput(0, mOutput, sizeof(mOutput)), WrapperResult::NO_ERROR);
+    return mExecution->startComputeWithDependencies(dependencies, /*duration=*/0, event);
+}
+
+TEST_F(CpuFencedExecutionTest, RunsSynchronouslyWithoutSwSync) {
+    SwSyncTimeline::forTest_setAvailable(false);
+    const auto guard = base::make_scope_guard([] { SwSyncTimeline::forTest_setAvailable(true); });
+
+    WrapperEvent event;
+    ASSERT_EQ(startCompute({}, &event), WrapperResult::NO_ERROR);
+
+    // The execution has completed before startComputeWithDependencies returns, and no sync
+    // fence is returned for it.
+    EXPECT_TRUE(std::equal(std::begin(mOutput), std::end(mOutput), std::begin(kExpectedOutput)));
+    int syncFenceFd = -1;
+    EXPECT_EQ(event.getSyncFenceFd(&syncFenceFd), WrapperResult::BAD_DATA);
+    EXPECT_EQ(syncFenceFd, -1);
+    EXPECT_EQ(event.wait(), WrapperResult::NO_ERROR);
+}
+
+TEST_F(CpuFencedExecutionTest, FailsWithoutSwSyncOnErrorSignaledDependency) {
+    // The dependency is created before sw_sync is made unavailable to the runtime.
+    std::unique_ptr<SwSyncTimeline> timeline = SwSyncTimeline::create();
+    if (timeline == nullptr) {
+        GTEST_SKIP() << "sw_sync is not available";
+    }
+    base::unique_fd fence = timeline->createFence(1);
+    ASSERT_TRUE(fence.ok());
+    timeline.reset();
+    const WrapperEvent dependency(fence.get());
+    ASSERT_TRUE(dependency.isValid());
+
+    SwSyncTimeline::forTest_setAvailable(false);
+    const auto guard = base::make_scope_guard([] { SwSyncTimeline::forTest_setAvailable(true); });
+
+    WrapperEvent event;
+    EXPECT_EQ(startCompute({&dependency}, &event), WrapperResult::OP_FAILED);
+    EXPECT_TRUE(std::all_of(std::begin(mOutput), std::end(mOutput),
+                            [](float value) { return value == 0.0f; }));
+}
+
+TEST_F(CpuFencedExecutionTest, ReturnsFenceThatSignalsWhenExecutionCompletes) {
+    if (SwSyncTimeline::create() == nullptr) {
+        GTEST_SKIP() << "sw_sync is not available";
+    }
+
+    WrapperEvent event;
+    ASSERT_EQ(startCompute({}, &event), WrapperResult::NO_ERROR);
+    int syncFenceFd = -1;
+    ASSERT_EQ(event.getSyncFenceFd(&syncFenceFd), WrapperResult::NO_ERROR);
+    const base::unique_fd syncFence(syncFenceFd);
+
+    EXPECT_EQ(event.wait(), WrapperResult::NO_ERROR);
+    EXPECT_EQ(syncWaitWithStatus(syncFence.get(), 0), FenceState::SIGNALED);
+    EXPECT_TRUE(std::equal(std::begin(mOutput), std::end(mOutput), std::begin(kExpectedOutput)));
+}
+
+TEST_F(CpuFencedExecutionTest, ReportsErrorSignaledDependencyThroughEvent) {
+    std::unique_ptr<SwSyncTimeline> timeline = SwSyncTimeline::create();
+    if (timeline == nullptr) {
+        GTEST_SKIP() << "sw_sync is not available";
+    }
+    base::unique_fd fence = timeline->createFence(1);
+    ASSERT_TRUE(fence.ok());
+    const WrapperEvent dependency(fence.get());
+    ASSERT_TRUE(dependency.isValid());
+
+    // The execution is queued behind the dependency, which then signals with an error.
+    WrapperEvent event;
+    ASSERT_EQ(startCompute({&dependency}, &event), WrapperResult::NO_ERROR);
+    timeline.reset();
+    EXPECT_EQ(event.wait(), WrapperResult::OP_FAILED);
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -16,6 +16,7 @@
 
 #include <android-base/scopeguard.h>
 #include <gtest/gtest.h>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -75,6 +76,43 @@ TEST_F(TelemetryTest, TestAtomGeneration) {
     android::nn::telemetry::clearTelemetryCallbacks();
 }
 
+TEST_F(TelemetryTest, TestLocalTimingHistograms) {
+    android::nn::telemetry::enableLocalTimingHistograms(true);
+    const auto guard = android::base::make_scope_guard(
+            [] { android::nn::telemetry::enableLocalTimingHistograms(false); });
+
+    Model modelAdd2;
+    OperandType matrixType(Type::TENSOR_FLOAT32, {3, 4});
+    OperandType scalarType(Type::INT32, {});
+    auto a = modelAdd2.addOperand(&matrixType);
+    auto b = modelAdd2.addOperand(&matrixType);
+    auto c = modelAdd2.addOperand(&matrixType);
+    auto d = modelAdd2.addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    modelAdd2.addOperation(ANEURALNETWORKS_ADD, {a, b, d}, {c});
+    modelAdd2.identifyInputsAndOutputs({a, b}, {c});
+    ASSERT_TRUE(modelAdd2.isValid());
+    modelAdd2.finish();
+
+    Matrix3x4 matrix;
+    memset(&matrix, 0, sizeof(matrix));
+    Compilation compilation(&modelAdd2);
+    compilation.finish();
+    for (int i = 0; i < 3; ++i) {
+        Execution execution(&compilation);
+        ASSERT_EQ(execution.setInput(0, matrix, sizeof(Matrix3x4)), Result::NO_ERROR);
+        ASSERT_EQ(execution.setInput(1, matrix, sizeof(Matrix3x4)), Result::NO_ERROR);
+        ASSERT_EQ(execution.setOutput(0, matrix, sizeof(Matrix3x4)), Result::NO_ERROR);
+        ASSERT_EQ(execution.compute(), Result::NO_ERROR);
+    }
+
+    const std::string dump = android::nn::telemetry::dumpLocalTimingHistograms();
+    EXPECT_NE(dump.find("compilationTimeMillis count=1 "), std::string::npos) << dump;
+    EXPECT_NE(dump.find("durationRuntimeMicros count=3 "), std::string::npos) << dump;
+
+    android::nn::telemetry::enableLocalTimingHistograms(false);
+    EXPECT_EQ(android::nn::telemetry::dumpLocalTimingHistograms(), "");
+}
+
 TEST_F(TelemetryTest, TestEvalDataClass) {
     std::vector<std::pair<DataClass, std::vector<android::nn::OperandType>>> data = {
             {DataClass::FLOAT32, {android::nn::OperandType::TENSOR_FLOAT32}},
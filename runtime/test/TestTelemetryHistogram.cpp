@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "TelemetryHistogram.h"
+
+namespace android::nn::telemetry {
+namespace {
+
+// The largest relative error of a quantile estimate.
+constexpr double kRelativeError = 1.0 / (2 * TimingHistogram::kSubBucketCount);
+
+// Returns the nearest-rank quantile of the values.
+int64_t exactQuantile(std::vector<int64_t> values, double quantile) {
+    std::sort(values.begin(), values.end());
+    const size_t rank = std::max<size_t>(1, std::ceil(quantile * values.size()));
+    return values[rank - 1];
+}
+
+TEST(TelemetryHistogramTest, StartsEmpty) {
+    const TimingHistogram histogram;
+    EXPECT_TRUE(histogram.empty());
+    EXPECT_EQ(histogram.count(), 0);
+    EXPECT_TRUE(histogram.getBuckets().empty());
+}
+
+TEST(TelemetryHistogramTest, SmallValuesAreExact) {
+    TimingHistogram histogram;
+    for (int64_t value = 0; value < TimingHistogram::kSubBucketCount; ++value) {
+        histogram.record(value);
+    }
+    EXPECT_EQ(histogram.count(), TimingHistogram::kSubBucketCount);
+    EXPECT_EQ(histogram.getQuantile(0.0), 0);
+    EXPECT_EQ(histogram.getQuantile(0.5), TimingHistogram::kSubBucketCount / 2 - 1);
+    EXPECT_EQ(histogram.getQuantile(1.0), TimingHistogram::kSubBucketCount - 1);
+}
+
+TEST(TelemetryHistogramTest, BucketsCoverAllValues) {
+    for (uint32_t index = 0; index < TimingHistogram::kBucketCount; ++index) {
+        const int64_t lower = TimingHistogram::getBucketLowerBound(index);
+        const int64_t upper = TimingHistogram::getBucketUpperBound(index);
+        ASSERT_LE(lower, upper);
+        EXPECT_EQ(TimingHistogram::getBucketIndex(lower), index);
+        EXPECT_EQ(TimingHistogram::getBucketIndex(upper), index);
+        if (index + 1 < TimingHistogram::kBucketCount) {
+            EXPECT_EQ(TimingHistogram::getBucketLowerBound(index + 1), upper + 1);
+        }
+    }
+    EXPECT_EQ(TimingHistogram::getBucketUpperBound(TimingHistogram::kBucketCount - 1),
+              std::numeric_limits<int64_t>::max());
+}
+
+TEST(TelemetryHistogramTest, QuantilesAreWithinRelativeError) {
+    std::mt19937 generator(0);
+    std::lognormal_distribution<double> distribution(8.0, 1.5);
+    std::vector<int64_t> values;
+    TimingHistogram histogram;
+    for (int i = 0; i < 10000; ++i) {
+        const auto value = static_cast<int64_t>(distribution(generator));
+        values.push_back(value);
+        histogram.record(value);
+    }
+
+    for (double quantile : {0.0, 0.5, 0.9, 0.95, 0.99, 0.999, 1.0}) {
+        const int64_t expected = exactQuantile(values, quantile);
+        EXPECT_NEAR(histogram.getQuantile(quantile), expected, expected * kRelativeError)
+                << "quantile " << quantile;
+    }
+    EXPECT_LE(histogram.getBuckets().size(), TimingHistogram::kBucketCount);
+}
+
+TEST(TelemetryHistogramTest, MergeEqualsRecordingAllValues) {
+    TimingHistogram histogram1, histogram2, combined;
+    for (int64_t value : {1, 100, 5000, 100}) {
+        histogram1.record(value);
+        combined.record(value);
+    }
+    for (int64_t value : {3, 100, 70000}) {
+        histogram2.record(value);
+        combined.record(value);
+    }
+
+    histogram1.merge(histogram2);
+    EXPECT_EQ(histogram1, combined);
+    EXPECT_EQ(histogram1.count(), 7);
+}
+
+TEST(TelemetryHistogramTest, MergeWithEmpty) {
+    TimingHistogram histogram, empty;
+    histogram.record(42);
+    const TimingHistogram original = histogram;
+
+    histogram.merge(empty);
+    EXPECT_EQ(histogram, original);
+
+    empty.merge(histogram);
+    EXPECT_EQ(empty, original);
+}
+
+TEST(TelemetryHistogramTest, ToString) {
+    TimingHistogram histogram;
+    EXPECT_EQ(toString(histogram), "count=0");
+    histogram.record(4);
+    EXPECT_EQ(toString(histogram), "count=1 p50=4 p95=4 p99=4");
+}
+
+}  // namespace
+}  // namespace android::nn::telemetry
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ValidatedModelCache.h>
+#include <gtest/gtest.h>
+#include <nnapi/Types.h>
+#include <nnapi/Validation.h>
+
+#include "ModelBuilder.h"
+#include "TestNeuralNetworksWrapper.h"
+
+namespace android::nn {
+namespace {
+
+using WrapperModel = test_wrapper::Model;
+using WrapperOperandType = test_wrapper::OperandType;
+using WrapperResult = test_wrapper::Result;
+using WrapperType = test_wrapper::Type;
+
+// output = input + bias, where bias has the given value.
+Model createAddModel(WrapperModel* model, float biasValue) {
+    WrapperOperandType tensorType(WrapperType::TENSOR_FLOAT32, {2});
+    WrapperOperandType scalarType(WrapperType::INT32, {});
+    const float bias[] = {biasValue, biasValue};
+    const uint32_t input = model->addOperand(&tensorType);
+    const uint32_t biasOperand = model->addOperand(&tensorType);
+    model->setOperandValue(biasOperand, bias, sizeof(bias));
+    const uint32_t activation = model->addConstantOperand(&scalarType, ANEURALNETWORKS_FUSED_NONE);
+    const uint32_t output = model->addOperand(&tensorType);
+    model->addOperation(ANEURALNETWORKS_ADD, {input, biasOperand, activation}, {output});
+    model->identifyInputsAndOutputs({input}, {output});
+    EXPECT_EQ(model->finish(), WrapperResult::NO_ERROR);
+    return reinterpret_cast<const ModelBuilder*>(model->getHandle())->makeModel();
+}
+
+class ValidatedModelCacheTest : public ::testing::Test {
+   protected:
+    ValidatedModelCache mCache;
+};
+
+TEST_F(ValidatedModelCacheTest, RemembersValidModels) {
+    WrapperModel wrapperModel;
+    const Model model = createAddModel(&wrapperModel, 1.0f);
+    EXPECT_FALSE(mCache.lookup(model).has_value());
+
+    const auto version = mCache.validate(model);
+    ASSERT_TRUE(version.ok()) << version.error();
+    EXPECT_EQ(version.value(), validate(model).value());
+    EXPECT_EQ(mCache.size(), 1u);
+
+    // Every stage of a compilation makes its own copy of the model.
+    const Model copy = model;
+    EXPECT_EQ(mCache.lookup(copy), version.value());
+    EXPECT_TRUE(mCache.validate(copy).ok());
+    EXPECT_EQ(mCache.size(), 1u);
+
+    mCache.clear();
+    EXPECT_FALSE(mCache.lookup(model).has_value());
+}
+
+// validate() does not read the values of constants, so models that differ only by them are
+// identical to it.
+TEST_F(ValidatedModelCacheTest, IgnoresConstantValues) {
+    WrapperModel wrapperModel;
+    WrapperModel otherWrapperModel;
+    const Model model = createAddModel(&wrapperModel, 1.0f);
+    const Model other = createAddModel(&otherWrapperModel, 2.0f);
+    ASSERT_TRUE(mCache.validate(model).ok());
+    EXPECT_TRUE(mCache.lookup(other).has_value());
+}
+
+TEST_F(ValidatedModelCacheTest, DistinguishesModifiedModels) {
+    WrapperModel wrapperModel;
+    const Model model = createAddModel(&wrapperModel, 1.0f);
+    ASSERT_TRUE(mCache.validate(model).ok());
+
+    Model modified = model;
+    modified.main.operands[0].dimensions = {3};
+    EXPECT_FALSE(mCache.lookup(modified).has_value());
+}
+
+TEST_F(ValidatedModelCacheTest, DoesNotRememberInvalidModels) {
+    WrapperModel wrapperModel;
+    Model model = createAddModel(&wrapperModel, 1.0f);
+    model.main.operations[0].inputs[0] = model.main.operands.size();
+    EXPECT_FALSE(mCache.validate(model).ok());
+    EXPECT_EQ(mCache.size(), 0u);
+    EXPECT_FALSE(mCache.lookup(model).has_value());
+}
+
+}  // namespace
+}  // namespace android::nn
@@ -23,14 +23,17 @@
 #include <android-base/mapped_file.h>
 #include <android-base/scopeguard.h>
 #include <android/hardware_buffer.h>
+#include <cutils/ashmem.h>
 #include <cutils/native_handle.h>
 #include <nnapi/TypeUtils.h>
 #include <nnapi/hal/aidl/Conversions.h>
 #include <nnapi/hal/aidl/Utils.h>
 #include <sys/mman.h>
+#include <unistd.h>
 #include <vndk/hardware_buffer.h>
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -48,7 +51,7 @@ ANeuralNetworksModel* convertSubgraphFromHAL(
         const std::vector<std::unique_ptr<::android::nn::sl_wrapper::Memory>>& memoryPools,
         const neuralnetworks::Model& model,
         std::vector<std::optional<::android::nn::sl_wrapper::Model>>* allModels,
-        size_t subgraphIndex, const std::vector<uint8_t>& copiedOperandValues,
+        size_t subgraphIndex, const ::android::nn::sl_wrapper::Memory* operandValuesMemory,
         ErrorStatus* errorStatus) {
     *errorStatus = ErrorStatus::NONE;
     if ((*allModels)[subgraphIndex].has_value()) {
@@ -141,11 +144,12 @@ ANeuralNetworksModel* convertSubgraphFromHAL(
                             operand.location.length);
                 } else {
                     // If length is larger than 128 bytes, we are responsible for making sure
-                    // that value outlives the model. If this case exists, then we created
-                    // an internal copy, that is used here:
-                    resultModel.setOperandValue(
-                            i, copiedOperandValues.data() + operand.location.offset,
-                            operand.location.length);
+                    // that value outlives the model. If this case exists, then the operand
+                    // values have been placed into a shared memory pool, that is used here:
+                    CHECK(operandValuesMemory != nullptr);
+                    resultModel.setOperandValueFromMemory(i, operandValuesMemory,
+                                                          operand.location.offset,
+                                                          operand.location.length);
                 }
                 break;
             }
@@ -159,7 +163,7 @@ ANeuralNetworksModel* convertSubgraphFromHAL(
                 ErrorStatus otherErrorStatus = ErrorStatus::NONE;
                 auto subgraph = convertSubgraphFromHAL(nnapi, memoryPools, model, allModels,
                                                        operand.location.offset + 1,
-                                                       copiedOperandValues, &otherErrorStatus);
+                                                       operandValuesMemory, &otherErrorStatus);
                 if (subgraph) {
                     resultModel.setOperandValueFromModel(i, subgraph);
                 } else {
@@ -255,8 +259,8 @@ ANeuralNetworksModel* convertSubgraphFromHAL(
 }
 
 // This is needed for CONSTANT_COPY operands > 128 bytes, we have to
-// store them in intenal buffer
-bool needsCopiedOperandValues(const neuralnetworks::Model& model) {
+// store them in a memory pool that outlives the model
+bool needsOperandValuesMemory(const neuralnetworks::Model& model) {
     for (int sindex = 0; sindex < model.referenced.size() + 1; ++sindex) {
         const auto& subgraph = sindex == 0 ? model.main : model.referenced[sindex - 1];
         for (int i = 0; i < subgraph.operands.size(); ++i) {
@@ -273,6 +277,36 @@ bool needsCopiedOperandValues(const neuralnetworks::Model& model) {
     return false;
 }
 
+// Copies the operand values into a new ashmem region, keeping their offsets, and returns the SL
+// memory of the region.
+std::unique_ptr<::android::nn::sl_wrapper::Memory> copyOperandValuesToMemory(
+        const NnApiSupportLibrary* nnapi, const std::vector<uint8_t>& operandValues) {
+    const size_t size = operandValues.size();
+    int fd = ashmem_create_region("nnapi_shim_operand_values", size);
+    if (fd < 0) {
+        LOG(ERROR) << "ashmem_create_region failed";
+        return nullptr;
+    }
+    auto fdGuard = ::android::base::make_scope_guard([fd] { close(fd); });
+
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        PLOG(ERROR) << "Failed to map the operand values memory";
+        return nullptr;
+    }
+    std::memcpy(data, operandValues.data(), size);
+    munmap(data, size);
+
+    // Takes ownership of fd
+    fdGuard.Disable();
+    auto memory = std::make_unique<::android::nn::sl_wrapper::Memory>(nnapi, size, PROT_READ, fd,
+                                                                      0, /*ownsFd=*/true);
+    if (!memory->isValid()) {
+        return nullptr;
+    }
+    return memory;
+}
+
 bool isValid(const Subgraph& subgraph) {
     // Either the operand has a known value before model execution begins, or we've seen a writer
     // for this operand while walking operands in execution order. Initialize to known operands.
@@ -360,10 +394,7 @@ bool isValid(const neuralnetworks::Model& model) {
 
 std::optional<ShimConvertedModel> convertFromHAL(const NnApiSupportLibrary* nnapi,
                                                  const neuralnetworks::Model& model,
-                                                 std::vector<uint8_t>* copiedOperandValues,
                                                  ErrorStatus* errorStatus) {
-    CHECK(copiedOperandValues != nullptr);
-
     *errorStatus = ErrorStatus::NONE;
 
     // Using this pulls in OperationResolver and huge chunk of dependencies.
@@ -390,12 +421,23 @@ std::optional<ShimConvertedModel> convertFromHAL(const NnApiSupportLibrary* nnap
     std::vector<std::optional<::android::nn::sl_wrapper::Model>> allModels(model.referenced.size() +
                                                                            1);
 
-    if (needsCopiedOperandValues(model)) {
-        *copiedOperandValues = model.operandValues;
+    // Large constant values are referenced from a shared memory pool rather than copied into a
+    // buffer owned by the prepared model. The SL runtime uses the pool as is, whereas it would copy
+    // the values of a buffer once more into its own shared memory when the model is finished.
+    const ::android::nn::sl_wrapper::Memory* operandValuesMemory = nullptr;
+    if (needsOperandValuesMemory(model)) {
+        auto memory = copyOperandValuesToMemory(nnapi, model.operandValues);
+        if (!memory) {
+            LOG(ERROR) << "Failed to copy operand values into SL memory";
+            *errorStatus = ErrorStatus::GENERAL_FAILURE;
+            return std::nullopt;
+        }
+        operandValuesMemory = memory.get();
+        memoryPools.push_back(std::move(memory));
     }
 
     for (size_t i = 0; i < allModels.size(); ++i) {
-        if (convertSubgraphFromHAL(nnapi, memoryPools, model, &allModels, i, *copiedOperandValues,
+        if (convertSubgraphFromHAL(nnapi, memoryPools, model, &allModels, i, operandValuesMemory,
                                    errorStatus) == nullptr) {
             LOG(ERROR) << "Failed to convert HAL subgraphs into SL subgraphs, index: " << i;
             // Error status already set by convertSubgraphFromHAL
@@ -480,9 +480,7 @@ ndk::ScopedAStatus ShimDevice::getSupportedOperations(const Model& model,
     supportedOperations->resize(numOperations);
 
     ErrorStatus convertErrorStatus = ErrorStatus::NONE;
-    std::vector<uint8_t> copiedOperandValues;
-    auto modelAndMemory =
-            convertFromHAL(mNnapi.get(), model, &copiedOperandValues, &convertErrorStatus);
+    auto modelAndMemory = convertFromHAL(mNnapi.get(), model, &convertErrorStatus);
     if (!modelAndMemory || modelAndMemory->models.empty()) {
         LOG(ERROR) << "Failed to convert HAL model to SL model";
         return toAStatus(convertErrorStatus);
@@ -549,9 +547,7 @@ ndk::ScopedAStatus ShimDevice::prepareModelCommon(
     }
 
     ErrorStatus convertErrorStatus = ErrorStatus::NONE;
-    std::vector<uint8_t> copiedOperandValues;
-    auto modelAndMemory =
-            convertFromHAL(mNnapi.get(), model, &copiedOperandValues, &convertErrorStatus);
+    auto modelAndMemory = convertFromHAL(mNnapi.get(), model, &convertErrorStatus);
 
     if (!modelAndMemory || modelAndMemory->models.empty()) {
         callback->notify(ErrorStatus::INVALID_ARGUMENT, nullptr);
@@ -617,8 +613,7 @@ ndk::ScopedAStatus ShimDevice::prepareModelCommon(
     const std::shared_ptr<ShimPreparedModel> preparedModel =
             ndk::SharedRefBase::make<ShimPreparedModel>(
                     mNnapi, mBufferTracker, std::move(compilation.second),
-                    std::move(modelAndMemory->models), std::move(modelAndMemory->memory),
-                    std::move(copiedOperandValues));
+                    std::move(modelAndMemory->models), std::move(modelAndMemory->memory));
 
     callback->notify(ErrorStatus::NONE, preparedModel);
     return ndk::ScopedAStatus::ok();
@@ -33,7 +33,9 @@
 #include <algorithm>
 #include <chrono>
 #include <limits>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <unordered_map>
 #include <utility>
@@ -44,6 +46,26 @@
 
 namespace aidl::android::hardware::neuralnetworks {
 
+std::shared_ptr<::android::nn::sl_wrapper::Memory> ShimPreparedModel::convertRequestMemoryPool(
+        const RequestMemoryPool& requestPool) {
+    switch (requestPool.getTag()) {
+        case RequestMemoryPool::pool: {
+            const auto& memoryPool = requestPool.get<RequestMemoryPool::pool>();
+            std::shared_ptr<::android::nn::sl_wrapper::Memory> mem =
+                    convertFromHAL(mNnapi.get(), memoryPool);
+            if (!mem) {
+                LOG(ERROR) << "Failed to convert request HAL memory pools into SL memory";
+            }
+            return mem;
+        }
+        case RequestMemoryPool::token: {
+            int token = requestPool.get<RequestMemoryPool::token>();
+            return mBufferTracker->get(static_cast<uint32_t>(token));
+        }
+    }
+    return nullptr;
+}
+
 ErrorStatus ShimPreparedModel::parseInputs(
         const Request& request, bool measure, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
         ::android::nn::sl_wrapper::Execution* execution,
@@ -51,33 +73,22 @@ ErrorStatus ShimPreparedModel::parseInputs(
         const std::vector<TokenValuePair>& executionHints,
         const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix) {
     for (const auto& requestPool : request.pools) {
-        switch (requestPool.getTag()) {
-            case RequestMemoryPool::pool: {
-                const auto& memoryPool = requestPool.get<RequestMemoryPool::pool>();
-                std::shared_ptr<::android::nn::sl_wrapper::Memory> mem =
-                        convertFromHAL(mNnapi.get(), memoryPool);
-                if (!mem) {
-                    LOG(ERROR) << "Failed to convert request HAL memory pools into SL memory";
-                    return ErrorStatus::INVALID_ARGUMENT;
-                }
-
-                requestMemoryPools->push_back(mem);
-                break;
-            }
-            case RequestMemoryPool::token: {
-                int token = requestPool.get<RequestMemoryPool::token>();
-
-                auto memory = mBufferTracker->get(static_cast<uint32_t>(token));
-                if (memory == nullptr) {
-                    return ErrorStatus::INVALID_ARGUMENT;
-                }
-
-                requestMemoryPools->push_back(memory);
-                break;
-            }
+        auto memory = convertRequestMemoryPool(requestPool);
+        if (memory == nullptr) {
+            return ErrorStatus::INVALID_ARGUMENT;
         }
+        requestMemoryPools->push_back(std::move(memory));
     }
+    return setRequestArguments(request, measure, deadlineNs, loopTimeoutDurationNs, execution,
+                               *requestMemoryPools, executionHints, extensionNameToPrefix);
+}
 
+ErrorStatus ShimPreparedModel::setRequestArguments(
+        const Request& request, bool measure, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
+        ::android::nn::sl_wrapper::Execution* execution,
+        const std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>>& requestMemoryPools,
+        const std::vector<TokenValuePair>& executionHints,
+        const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix) {
     // enable input and output padding
     const auto enablePaddingResult = execution->enableInputAndOutputPadding(true);
     if (enablePaddingResult != Result::NO_ERROR) {
@@ -99,7 +110,7 @@ ErrorStatus ShimPreparedModel::parseInputs(
                 operandType.updateDimensions(::android::nn::toUnsigned(input.dimensions).value());
             }
             auto result = execution->setInputFromMemory(
-                    i, requestMemoryPools->at(input.location.poolIndex).get(),
+                    i, requestMemoryPools.at(input.location.poolIndex).get(),
                     input.location.offset, input.location.length, &operandType.operandType);
             if (result != Result::NO_ERROR) {
                 return convertResultToErrorStatus(result);
@@ -126,7 +137,7 @@ ErrorStatus ShimPreparedModel::parseInputs(
                 operandType.updateDimensions(::android::nn::toUnsigned(output.dimensions).value());
             }
             auto result = execution->setOutputFromMemory(
-                    i, requestMemoryPools->at(output.location.poolIndex).get(),
+                    i, requestMemoryPools.at(output.location.poolIndex).get(),
                     output.location.offset, output.location.length, &operandType.operandType);
             if (result != Result::NO_ERROR) {
                 return convertResultToErrorStatus(result);
@@ -465,8 +476,46 @@ class ShimBurst : public BnBurst {
     ndk::ScopedAStatus releaseMemoryResource(int64_t memoryIdentifierToken) override;
 
    protected:
+    // The number of reusable executions kept for repeated request layouts.
+    static constexpr size_t kMaxCachedExecutions = 4;
+
+    // A reusable SL execution, together with the request layout and the execution configuration
+    // it was set up for.
+    struct CachedExecution {
+        std::vector<int64_t> memoryIdentifierTokens;
+        std::vector<RequestArgument> inputs;
+        std::vector<RequestArgument> outputs;
+        bool measureTiming;
+        int64_t loopTimeoutDurationNs;
+        std::vector<TokenValuePair> executionHints;
+        std::vector<ExtensionNameAndPrefix> extensionNameToPrefix;
+        // The memories the execution is bound to, which must outlive it.
+        std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>> memories;
+        std::shared_ptr<::android::nn::sl_wrapper::Execution> execution;
+    };
+
+    ndk::ScopedAStatus executeSynchronouslyCommon(
+            const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
+            bool measureTiming, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
+            const std::vector<TokenValuePair>& executionHints,
+            const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix,
+            ExecutionResult* executionResult);
+
+    // Returns the SL memories of the request pools, converting only those pools that are not
+    // cached by memory identifier token yet.
+    ErrorStatus getRequestMemoryPools(
+            const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
+            std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>>* requestMemoryPools);
+
     std::atomic_flag mExecutionInFlight = ATOMIC_FLAG_INIT;
     const std::shared_ptr<ShimPreparedModel> kPreparedModel;
+
+    // Guards mMemoryCache and mCachedExecutions, which releaseMemoryResource may modify while an
+    // execution is in flight.
+    std::mutex mMutex;
+    std::unordered_map<int64_t, std::shared_ptr<::android::nn::sl_wrapper::Memory>> mMemoryCache;
+    // Most recently used first.
+    std::list<CachedExecution> mCachedExecutions;
 };
 
 ndk::ScopedAStatus ShimPreparedModel::configureExecutionBurst(std::shared_ptr<IBurst>* burst) {
@@ -480,10 +529,45 @@ ShimBurst::ShimBurst(std::shared_ptr<ShimPreparedModel> preparedModel)
     CHECK(kPreparedModel != nullptr);
 }
 
-ndk::ScopedAStatus ShimBurst::executeSynchronously(
+ErrorStatus ShimBurst::getRequestMemoryPools(
+        const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
+        std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>>* requestMemoryPools) {
+    requestMemoryPools->reserve(request.pools.size());
+    for (size_t i = 0; i < request.pools.size(); ++i) {
+        const auto& requestPool = request.pools[i];
+        const int64_t token = memoryIdentifierTokens[i];
+        // Driver-managed buffers are looked up on every execution, so that a buffer that has been
+        // freed is not used.
+        const bool cacheable = token != -1 && requestPool.getTag() == RequestMemoryPool::pool;
+        if (cacheable) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const auto it = mMemoryCache.find(token);
+            if (it != mMemoryCache.end()) {
+                requestMemoryPools->push_back(it->second);
+                continue;
+            }
+        }
+        auto memory = kPreparedModel->convertRequestMemoryPool(requestPool);
+        if (memory == nullptr) {
+            return ErrorStatus::INVALID_ARGUMENT;
+        }
+        if (cacheable) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMemoryCache.emplace(token, memory);
+        }
+        requestMemoryPools->push_back(std::move(memory));
+    }
+    return ErrorStatus::NONE;
+}
+
+ndk::ScopedAStatus ShimBurst::executeSynchronouslyCommon(
         const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
         bool measureTiming, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
+        const std::vector<TokenValuePair>& executionHints,
+        const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix,
         ExecutionResult* executionResult) {
+    CHECK(executionResult != nullptr);
+
     if (request.pools.size() != memoryIdentifierTokens.size()) {
         return toAStatus(ErrorStatus::INVALID_ARGUMENT,
                          "request.pools.size() != memoryIdentifierTokens.size()");
@@ -492,6 +576,11 @@ ndk::ScopedAStatus ShimBurst::executeSynchronously(
                      [](int64_t token) { return token >= -1; })) {
         return toAStatus(ErrorStatus::INVALID_ARGUMENT, "Invalid memoryIdentifierTokens");
     }
+    if (deadlineNs < -1) {
+        LOG(ERROR) << "Invalid deadline value, must be >= -1";
+        return ndk::ScopedAStatus::fromServiceSpecificError(
+                static_cast<int>(ErrorStatus::INVALID_ARGUMENT));
+    }
 
     // Ensure at most one execution is in flight at a time.
     const bool executionAlreadyInFlight = mExecutionInFlight.test_and_set();
@@ -501,38 +590,106 @@ ndk::ScopedAStatus ShimBurst::executeSynchronously(
     }
     const auto guard = ::android::base::make_scope_guard([this] { mExecutionInFlight.clear(); });
 
-    return kPreparedModel->executeSynchronously(request, measureTiming, deadlineNs,
-                                                loopTimeoutDurationNs, executionResult);
-}
+    // An execution can be reused if every memory pool is identified by a token, so that the
+    // memories it is bound to are known to be the same. The timeout of a reusable execution cannot
+    // change between computations, so executions with a deadline are not reused.
+    const bool reusable =
+            deadlineNs == kNoDeadline &&
+            std::none_of(memoryIdentifierTokens.begin(), memoryIdentifierTokens.end(),
+                         [](int64_t token) { return token == -1; }) &&
+            std::all_of(request.pools.begin(), request.pools.end(), [](const auto& pool) {
+                return pool.getTag() == RequestMemoryPool::pool;
+            });
+    const auto isSameLayout = [&](const CachedExecution& cached) {
+        return cached.memoryIdentifierTokens == memoryIdentifierTokens &&
+               cached.inputs == request.inputs && cached.outputs == request.outputs &&
+               cached.measureTiming == measureTiming &&
+               cached.loopTimeoutDurationNs == loopTimeoutDurationNs &&
+               cached.executionHints == executionHints &&
+               cached.extensionNameToPrefix == extensionNameToPrefix;
+    };
+    if (reusable) {
+        // Copied out of the cache so that releaseMemoryResource cannot free the execution or its
+        // memories while it is computing.
+        std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>> memories;
+        std::shared_ptr<::android::nn::sl_wrapper::Execution> execution;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const auto it =
+                    std::find_if(mCachedExecutions.begin(), mCachedExecutions.end(), isSameLayout);
+            if (it != mCachedExecutions.end()) {
+                mCachedExecutions.splice(mCachedExecutions.begin(), mCachedExecutions, it);
+                memories = it->memories;
+                execution = it->execution;
+            }
+        }
+        if (execution != nullptr) {
+            return executeSynchronouslyInternal(execution, measureTiming, request.outputs.size(),
+                                                executionResult);
+        }
+    }
 
-ndk::ScopedAStatus ShimBurst::executeSynchronouslyWithConfig(
-        const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
-        const ExecutionConfig& config, int64_t deadlineNs, ExecutionResult* executionResult) {
-    if (request.pools.size() != memoryIdentifierTokens.size()) {
-        return toAStatus(ErrorStatus::INVALID_ARGUMENT,
-                         "request.pools.size() != memoryIdentifierTokens.size()");
+    std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>> requestMemoryPools;
+    auto errorStatus = getRequestMemoryPools(request, memoryIdentifierTokens, &requestMemoryPools);
+    if (errorStatus != ErrorStatus::NONE) {
+        return toAStatus(errorStatus);
     }
-    if (!std::all_of(memoryIdentifierTokens.begin(), memoryIdentifierTokens.end(),
-                     [](int64_t token) { return token >= -1; })) {
-        return toAStatus(ErrorStatus::INVALID_ARGUMENT, "Invalid memoryIdentifierTokens");
+    auto execution = std::make_shared<::android::nn::sl_wrapper::Execution>(
+            kPreparedModel->mNnapi.get(), &kPreparedModel->mCompilation);
+    errorStatus = kPreparedModel->setRequestArguments(
+            request, measureTiming, deadlineNs, loopTimeoutDurationNs, execution.get(),
+            requestMemoryPools, executionHints, extensionNameToPrefix);
+    if (errorStatus != ErrorStatus::NONE) {
+        return toAStatus(errorStatus);
     }
-
-    // Ensure at most one execution is in flight at a time.
-    const bool executionAlreadyInFlight = mExecutionInFlight.test_and_set();
-    if (executionAlreadyInFlight) {
-        return toAStatus(ErrorStatus::GENERAL_FAILURE,
-                         "Burst object supports at most one execution at a time");
+    if (reusable && execution->setReusable(true) == Result::NO_ERROR) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCachedExecutions.push_front({.memoryIdentifierTokens = memoryIdentifierTokens,
+                                      .inputs = request.inputs,
+                                      .outputs = request.outputs,
+                                      .measureTiming = measureTiming,
+                                      .loopTimeoutDurationNs = loopTimeoutDurationNs,
+                                      .executionHints = executionHints,
+                                      .extensionNameToPrefix = extensionNameToPrefix,
+                                      .memories = requestMemoryPools,
+                                      .execution = execution});
+        if (mCachedExecutions.size() > kMaxCachedExecutions) {
+            mCachedExecutions.pop_back();
+        }
     }
-    const auto guard = ::android::base::make_scope_guard([this] { mExecutionInFlight.clear(); });
+    return executeSynchronouslyInternal(execution, measureTiming, request.outputs.size(),
+                                        executionResult);
+}
 
-    return kPreparedModel->executeSynchronouslyWithConfig(request, config, deadlineNs,
-                                                          executionResult);
+ndk::ScopedAStatus ShimBurst::executeSynchronously(
+        const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
+        bool measureTiming, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
+        ExecutionResult* executionResult) {
+    return executeSynchronouslyCommon(request, memoryIdentifierTokens, measureTiming, deadlineNs,
+                                      loopTimeoutDurationNs, /*executionHints=*/{},
+                                      /*extensionNameToPrefix=*/{}, executionResult);
+}
+
+ndk::ScopedAStatus ShimBurst::executeSynchronouslyWithConfig(
+        const Request& request, const std::vector<int64_t>& memoryIdentifierTokens,
+        const ExecutionConfig& config, int64_t deadlineNs, ExecutionResult* executionResult) {
+    return executeSynchronouslyCommon(request, memoryIdentifierTokens, config.measureTiming,
+                                      deadlineNs, config.loopTimeoutDurationNs,
+                                      config.executionHints, config.extensionNameToPrefix,
+                                      executionResult);
 }
 
 ndk::ScopedAStatus ShimBurst::releaseMemoryResource(int64_t memoryIdentifierToken) {
     if (memoryIdentifierToken < -1) {
         return toAStatus(ErrorStatus::INVALID_ARGUMENT, "Invalid memoryIdentifierToken");
     }
+    std::lock_guard<std::mutex> lock(mMutex);
+    mMemoryCache.erase(memoryIdentifierToken);
+    mCachedExecutions.remove_if([memoryIdentifierToken](const CachedExecution& cached) {
+        return std::find(cached.memoryIdentifierTokens.begin(),
+                         cached.memoryIdentifierTokens.end(),
+                         memoryIdentifierToken) != cached.memoryIdentifierTokens.end();
+    });
     return ndk::ScopedAStatus::ok();
 }
 
@@ -41,16 +41,12 @@ bool isValid(const neuralnetworks::Model& model);
  8
  * @param nnapi NNAPI SL Driver implementation
  * @param model HAL NNAPI Model
- * @param copiedOperandValues If model requires it (contains CONSTANT_COPY operands larger
- *                            then 128 bytes), this vector will be used to hold a copy of
- *                            model operand values. Must be non-null.
  * @param errorStatus Output error status in case of failure.
  * @return ShimConvertedModel with all converted memories and models.
  *
  */
 std::optional<ShimConvertedModel> convertFromHAL(const NnApiSupportLibrary* nnapi,
                                                  const neuralnetworks::Model& model,
-                                                 std::vector<uint8_t>* copiedOperandValues,
                                                  ErrorStatus* errorStatus);
 std::unique_ptr<::android::nn::sl_wrapper::Memory> convertFromHAL(
         const NnApiSupportLibrary* nnapi, const neuralnetworks::Memory& pool);
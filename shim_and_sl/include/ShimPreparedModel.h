@@ -35,14 +35,12 @@ class ShimPreparedModel : public BnPreparedModel {
                       std::shared_ptr<ShimBufferTracker> bufferTracker,
                       ::android::nn::sl_wrapper::Compilation compilation,
                       std::vector<::android::nn::sl_wrapper::Model> mainAndReferencedModels,
-                      std::vector<std::unique_ptr<::android::nn::sl_wrapper::Memory>> memoryPools,
-                      std::vector<uint8_t> copiedOperandValues)
+                      std::vector<std::unique_ptr<::android::nn::sl_wrapper::Memory>> memoryPools)
         : mNnapi(nnapi),
           mBufferTracker(bufferTracker),
           mCompilation(std::move(compilation)),
           mMainAndReferencedModels(std::move(mainAndReferencedModels)),
-          mMemoryPools(std::move(memoryPools)),
-          mCopiedOperandValues(std::move(copiedOperandValues)) {
+          mMemoryPools(std::move(memoryPools)) {
         CHECK(mMainAndReferencedModels.size() > 0);
     };
 
@@ -74,6 +72,14 @@ class ShimPreparedModel : public BnPreparedModel {
     }
 
    private:
+    friend class ShimBurst;
+
+    // Converts a memory pool of a request into an SL memory. Returns nullptr if the pool is
+    // invalid.
+    std::shared_ptr<::android::nn::sl_wrapper::Memory> convertRequestMemoryPool(
+            const RequestMemoryPool& requestPool);
+
+    // Converts the memory pools of the request and sets up the execution for it.
     ErrorStatus parseInputs(
             const Request& request, bool measure, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
             ::android::nn::sl_wrapper::Execution* execution,
@@ -81,6 +87,15 @@ class ShimPreparedModel : public BnPreparedModel {
             const std::vector<TokenValuePair>& executionHints,
             const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix);
 
+    // Sets up the execution for the request, whose memory pools have already been converted.
+    ErrorStatus setRequestArguments(
+            const Request& request, bool measure, int64_t deadlineNs, int64_t loopTimeoutDurationNs,
+            ::android::nn::sl_wrapper::Execution* execution,
+            const std::vector<std::shared_ptr<::android::nn::sl_wrapper::Memory>>&
+                    requestMemoryPools,
+            const std::vector<TokenValuePair>& executionHints,
+            const std::vector<ExtensionNameAndPrefix>& extensionNameToPrefix);
+
     ::ndk::ScopedAStatus executeSynchronouslyCommon(
             const Request& request, bool measureTiming, int64_t deadlineNs,
             int64_t loopTimeoutDurationNs, const std::vector<TokenValuePair>& executionHints,
@@ -99,7 +114,6 @@ class ShimPreparedModel : public BnPreparedModel {
     ::android::nn::sl_wrapper::Compilation mCompilation;
     std::vector<::android::nn::sl_wrapper::Model> mMainAndReferencedModels;
     std::vector<std::unique_ptr<::android::nn::sl_wrapper::Memory>> mMemoryPools;
-    std::vector<uint8_t> mCopiedOperandValues;
 };
 
 }  // namespace aidl::android::hardware::neuralnetworks
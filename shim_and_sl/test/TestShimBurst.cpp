@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <aidl/android/hardware/neuralnetworks/IBurst.h>
+#include <aidl/android/hardware/neuralnetworks/Request.h>
+#include <android/binder_auto_utils.h>
+#include <cutils/ashmem.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "ShimBufferTracker.h"
+#include "ShimPreparedModel.h"
+#include "ShimUtils.h"
+#include "SupportLibrary.h"
+#include "SupportLibraryWrapper.h"
+
+extern std::string SUPPORT_LIBRARY_NAME;
+
+namespace aidl::android::hardware::neuralnetworks {
+namespace {
+
+using SlCompilation = ::android::nn::sl_wrapper::Compilation;
+using SlModel = ::android::nn::sl_wrapper::Model;
+using SlOperandType = ::android::nn::wrapper::OperandType;
+using SlResult = ::android::nn::wrapper::Result;
+using SlType = ::android::nn::wrapper::Type;
+
+constexpr int64_t kMemoryToken = 7;
+constexpr int64_t kDefaultLoopTimeout = -1;
+
+// The request pool holds the two inputs of the ADD model, followed by slots for kOutputSlots
+// different output locations, so that the same pool can be used with different request layouts.
+constexpr size_t kElementCount = 2;
+constexpr size_t kOperandSize = kElementCount * sizeof(float);
+constexpr size_t kOutputSlots = 5;
+constexpr size_t kPoolSize = (2 + kOutputSlots) * kOperandSize;
+
+// The SL entry points wrapped below count the executions and memories that the shim creates and
+// frees, and forward to the loaded support library.
+const NnApiSLDriverImplFL5* gSupportLibrary = nullptr;
+int gExecutionsCreated = 0;
+int gExecutionsFreed = 0;
+int gMemoriesCreated = 0;
+int gMemoriesFreed = 0;
+// Called once at the start of the next computation, while the burst execution is in flight.
+std::function<void()> gOnCompute;
+
+int createExecution(ANeuralNetworksCompilation* compilation, ANeuralNetworksExecution** execution) {
+    ++gExecutionsCreated;
+    return gSupportLibrary->ANeuralNetworksExecution_create(compilation, execution);
+}
+
+void freeExecution(ANeuralNetworksExecution* execution) {
+    ++gExecutionsFreed;
+    gSupportLibrary->ANeuralNetworksExecution_free(execution);
+}
+
+int computeExecution(ANeuralNetworksExecution* execution) {
+    if (auto onCompute = std::exchange(gOnCompute, nullptr)) {
+        onCompute();
+    }
+    return gSupportLibrary->ANeuralNetworksExecution_compute(execution);
+}
+
+int createMemoryFromFd(size_t size, int protect, int fd, size_t offset,
+                       ANeuralNetworksMemory** memory) {
+    ++gMemoriesCreated;
+    return gSupportLibrary->ANeuralNetworksMemory_createFromFd(size, protect, fd, offset, memory);
+}
+
+void freeMemory(ANeuralNetworksMemory* memory) {
+    ++gMemoriesFreed;
+    gSupportLibrary->ANeuralNetworksMemory_free(memory);
+}
+
+class ShimBurstTest : public ::testing::Test {
+   protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    // Computes the ADD model with the output at the given slot of the request pool, and checks
+    // the result.
+    void execute(size_t outputSlot);
+
+    std::unique_ptr<const NnApiSupportLibrary> mLoadedNnapi;
+    std::shared_ptr<NnApiSupportLibrary> mNnapi;
+    int mPoolFd = -1;
+    float* mPoolData = nullptr;
+    Request mRequest;
+    std::shared_ptr<IBurst> mBurst;
+};
+
+void ShimBurstTest::SetUp() {
+    mLoadedNnapi = loadNnApiSupportLibrary(SUPPORT_LIBRARY_NAME);
+    ASSERT_NE(mLoadedNnapi, nullptr);
+    gSupportLibrary = mLoadedNnapi->getFL5();
+
+    // A copy of the support library that does not own the library handle, with the counting
+    // entry points.
+    mNnapi = std::visit(
+            [](const auto& impl) { return std::make_shared<NnApiSupportLibrary>(impl, nullptr); },
+            mLoadedNnapi->impl);
+    std::visit(
+            [](auto& impl) {
+                auto* fl5 = reinterpret_cast<NnApiSLDriverImplFL5*>(&impl);
+                fl5->ANeuralNetworksExecution_create = createExecution;
+                fl5->ANeuralNetworksExecution_free = freeExecution;
+                fl5->ANeuralNetworksExecution_compute = computeExecution;
+                fl5->ANeuralNetworksMemory_createFromFd = createMemoryFromFd;
+                fl5->ANeuralNetworksMemory_free = freeMemory;
+            },
+            mNnapi->impl);
+
+    SlModel model(mNnapi.get());
+    SlOperandType tensorType(SlType::TENSOR_FLOAT32, {kElementCount});
+    SlOperandType scalarType(SlType::INT32, {});
+    const uint32_t a = model.addOperand(&tensorType);
+    const uint32_t b = model.addOperand(&tensorType);
+    const int32_t fuseCode = ANEURALNETWORKS_FUSED_NONE;
+    const uint32_t activation = model.addConstantOperand(&scalarType, fuseCode);
+    const uint32_t sum = model.addOperand(&tensorType);
+    model.addOperation(ANEURALNETWORKS_ADD, {a, b, activation}, {sum});
+    model.identifyInputsAndOutputs({a, b}, {sum});
+    ASSERT_EQ(model.finish(), SlResult::NO_ERROR);
+
+    uint32_t deviceCount = 0;
+    ASSERT_EQ(mNnapi->getFL5()->ANeuralNetworks_getDeviceCount(&deviceCount),
+              ANEURALNETWORKS_NO_ERROR);
+    std::vector<const ANeuralNetworksDevice*> devices(deviceCount);
+    for (uint32_t i = 0; i < deviceCount; ++i) {
+        ANeuralNetworksDevice* device = nullptr;
+        ASSERT_EQ(mNnapi->getFL5()->ANeuralNetworks_getDevice(i, &device),
+                  ANEURALNETWORKS_NO_ERROR);
+        devices[i] = device;
+    }
+    auto [result, compilation] = SlCompilation::createForDevices(mNnapi.get(), &model, devices);
+    ASSERT_EQ(result, SlResult::NO_ERROR);
+    ASSERT_EQ(compilation.finish(), SlResult::NO_ERROR);
+
+    std::vector<SlModel> models;
+    models.push_back(std::move(model));
+    auto preparedModel = ndk::SharedRefBase::make<ShimPreparedModel>(
+            mNnapi, ShimBufferTracker::create(), std::move(compilation), std::move(models),
+            std::vector<std::unique_ptr<::android::nn::sl_wrapper::Memory>>{});
+    ASSERT_TRUE(preparedModel->configureExecutionBurst(&mBurst).isOk());
+
+    mPoolFd = ashmem_create_region("ShimBurstTest", kPoolSize);
+    ASSERT_GE(mPoolFd, 0);
+    void* data = mmap(nullptr, kPoolSize, PROT_READ | PROT_WRITE, MAP_SHARED, mPoolFd, 0);
+    ASSERT_NE(data, MAP_FAILED);
+    mPoolData = static_cast<float*>(data);
+    const float inputs[] = {1.0f, 2.0f, 10.0f, 20.0f};
+    std::copy(std::begin(inputs), std::end(inputs), mPoolData);
+
+    const auto makeArgument = [](size_t offset) {
+        return RequestArgument{.hasNoValue = false,
+                               .location = {.poolIndex = 0,
+                                            .offset = static_cast<int64_t>(offset),
+                                            .length = static_cast<int64_t>(kOperandSize)}};
+    };
+    mRequest.inputs = {makeArgument(0), makeArgument(kOperandSize)};
+    mRequest.outputs = {makeArgument(2 * kOperandSize)};
+    auto pool = Memory::make<Memory::ashmem>(
+            common::Ashmem{.fd = ndk::ScopedFileDescriptor(dup(mPoolFd)), .size = kPoolSize});
+    mRequest.pools.push_back(RequestMemoryPool::make<RequestMemoryPool::pool>(std::move(pool)));
+
+    gExecutionsCreated = 0;
+    gExecutionsFreed = 0;
+    gMemoriesCreated = 0;
+    gMemoriesFreed = 0;
+}
+
+void ShimBurstTest::TearDown() {
+    gOnCompute = nullptr;
+    mBurst.reset();
+    if (mPoolData != nullptr) {
+        munmap(mPoolData, kPoolSize);
+    }
+    if (mPoolFd >= 0) {
+        close(mPoolFd);
+    }
+    mNnapi.reset();
+    mLoadedNnapi.reset();
+    gSupportLibrary = nullptr;
+}
+
+void ShimBurstTest::execute(size_t outputSlot) {
+    const size_t offset = (2 + outputSlot) * kOperandSize;
+    mRequest.outputs[0].location.offset = offset;
+    float* output = mPoolData + offset / sizeof(float);
+    std::fill(output, output + kElementCount, 0.0f);
+
+    ExecutionResult executionResult;
+    ASSERT_TRUE(mBurst->executeSynchronously(mRequest, {kMemoryToken}, /*measureTiming=*/false,
+                                             kNoDeadline, kDefaultLoopTimeout, &executionResult)
+                        .isOk());
+    ASSERT_TRUE(executionResult.outputSufficientSize);
+    EXPECT_EQ(output[0], 11.0f);
+    EXPECT_EQ(output[1], 22.0f);
+}
+
+TEST_F(ShimBurstTest, ReusesExecutionAndMemoryForSameLayout) {
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 1);
+    EXPECT_EQ(gMemoriesCreated, 1);
+
+    execute(0);
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 1);
+    EXPECT_EQ(gMemoriesCreated, 1);
+    EXPECT_EQ(gExecutionsFreed, 0);
+
+    // A different layout gets its own execution, but the memory of the token is shared.
+    execute(1);
+    EXPECT_EQ(gExecutionsCreated, 2);
+    EXPECT_EQ(gMemoriesCreated, 1);
+}
+
+TEST_F(ShimBurstTest, EvictsLeastRecentlyUsedExecution) {
+    // Fill the cache with four layouts, then use the first one again so that the second one is
+    // the least recently used.
+    for (size_t slot = 0; slot < 4; ++slot) {
+        execute(slot);
+    }
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 4);
+    EXPECT_EQ(gExecutionsFreed, 0);
+
+    execute(4);
+    EXPECT_EQ(gExecutionsCreated, 5);
+    EXPECT_EQ(gExecutionsFreed, 1);
+
+    // The first layout is still cached, and the second one was evicted.
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 5);
+    execute(1);
+    EXPECT_EQ(gExecutionsCreated, 6);
+    EXPECT_EQ(gExecutionsFreed, 2);
+    EXPECT_EQ(gMemoriesCreated, 1);
+}
+
+TEST_F(ShimBurstTest, ReleaseMemoryResourceDropsCachedExecutions) {
+    execute(0);
+    execute(1);
+    ASSERT_TRUE(mBurst->releaseMemoryResource(kMemoryToken).isOk());
+    EXPECT_EQ(gExecutionsFreed, 2);
+    EXPECT_EQ(gMemoriesFreed, 1);
+
+    // The memory is converted again, and the layout gets a new execution.
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 3);
+    EXPECT_EQ(gMemoriesCreated, 2);
+}
+
+TEST_F(ShimBurstTest, ReleaseMemoryResourceDuringExecution) {
+    execute(0);
+    ASSERT_EQ(gExecutionsCreated, 1);
+
+    // Releases the memory while the cached execution is computing. The in-flight execution and
+    // the memory it is bound to must stay alive until the computation returns.
+    int executionsFreedDuringCompute = -1;
+    int memoriesFreedDuringCompute = -1;
+    gOnCompute = [this, &executionsFreedDuringCompute, &memoriesFreedDuringCompute] {
+        EXPECT_TRUE(mBurst->releaseMemoryResource(kMemoryToken).isOk());
+        executionsFreedDuringCompute = gExecutionsFreed;
+        memoriesFreedDuringCompute = gMemoriesFreed;
+    };
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 1);
+    EXPECT_EQ(executionsFreedDuringCompute, 0);
+    EXPECT_EQ(memoriesFreedDuringCompute, 0);
+    EXPECT_EQ(gExecutionsFreed, 1);
+    EXPECT_EQ(gMemoriesFreed, 1);
+
+    execute(0);
+    EXPECT_EQ(gExecutionsCreated, 2);
+    EXPECT_EQ(gMemoriesCreated, 2);
+}
+
+}  // namespace
+}  // namespace aidl::android::hardware::neuralnetworks